@@ -59,7 +59,10 @@ void usage(const char *name)
   banner();
   printf("usage: %s [options] input\n\n", name);
   puts("Options:");
-  puts("  -o ASMFILE    Name the output ASMFILE (default output.asm)");
+  puts("  -g            Emit the source line of each instruction, to be");
+  puts("                used by asrv32im and simrv32im");
+  puts("  -o ASMFILE    Name the output ASMFILE (default output.asm), or");
+  puts("                \"-\" for the standard output");
   puts("  -v, --version Display version number");
   puts("  -h, --help    Displays available options");
 }
@@ -78,9 +81,13 @@ int main(int argc, char *argv[])
   };
 
   char *outputFn = "output.asm";
+  bool lineInfo = false;
 
-  while ((ch = getopt_long(argc, argv, "ho:v", options, NULL)) != -1) {
+  while ((ch = getopt_long(argc, argv, "gho:v", options, NULL)) != -1) {
     switch (ch) {
+      case 'g':
+        lineInfo = true;
+        break;
       case 'o':
         outputFn = optarg;
         break;
@@ -173,7 +180,7 @@ int main(int argc, char *argv[])
       listLength(program->symbols));
   fprintf(stderr, " -> Number of labels: %d\n", listLength(program->labels));
 #endif
-  bool ok = writeAssembly(program, outputFn);
+  bool ok = writeAssembly(program, outputFn, lineInfo);
   if (!ok) {
     emitError(nullFileLocation, "could not write output file");
     goto fail;
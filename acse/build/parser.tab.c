@@ -0,0 +1,1893 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 5 "parser.y"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "errors.h"
+#include "list.h"
+#include "codegen.h"
+#include "scanner.h"
+#include "parser.h"
+
+/*
+ * Global variables
+ */
+
+// The program currently being compiled.
+static t_program *program;
+
+void yyerror(const char *msg)
+{
+  emitError(curFileLoc, "%s", msg);
+}
+
+
+#line 95 "build/parser.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "parser.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_EOF_TOK = 3,                    /* EOF_TOK  */
+  YYSYMBOL_LPAR = 4,                       /* LPAR  */
+  YYSYMBOL_RPAR = 5,                       /* RPAR  */
+  YYSYMBOL_LSQUARE = 6,                    /* LSQUARE  */
+  YYSYMBOL_RSQUARE = 7,                    /* RSQUARE  */
+  YYSYMBOL_LBRACE = 8,                     /* LBRACE  */
+  YYSYMBOL_RBRACE = 9,                     /* RBRACE  */
+  YYSYMBOL_COMMA = 10,                     /* COMMA  */
+  YYSYMBOL_SEMI = 11,                      /* SEMI  */
+  YYSYMBOL_PLUS = 12,                      /* PLUS  */
+  YYSYMBOL_MINUS = 13,                     /* MINUS  */
+  YYSYMBOL_MUL_OP = 14,                    /* MUL_OP  */
+  YYSYMBOL_DIV_OP = 15,                    /* DIV_OP  */
+  YYSYMBOL_MOD_OP = 16,                    /* MOD_OP  */
+  YYSYMBOL_AND_OP = 17,                    /* AND_OP  */
+  YYSYMBOL_XOR_OP = 18,                    /* XOR_OP  */
+  YYSYMBOL_OR_OP = 19,                     /* OR_OP  */
+  YYSYMBOL_NOT_OP = 20,                    /* NOT_OP  */
+  YYSYMBOL_ASSIGN = 21,                    /* ASSIGN  */
+  YYSYMBOL_LT = 22,                        /* LT  */
+  YYSYMBOL_GT = 23,                        /* GT  */
+  YYSYMBOL_SHL_OP = 24,                    /* SHL_OP  */
+  YYSYMBOL_SHR_OP = 25,                    /* SHR_OP  */
+  YYSYMBOL_EQ = 26,                        /* EQ  */
+  YYSYMBOL_NOTEQ = 27,                     /* NOTEQ  */
+  YYSYMBOL_LTEQ = 28,                      /* LTEQ  */
+  YYSYMBOL_GTEQ = 29,                      /* GTEQ  */
+  YYSYMBOL_ANDAND = 30,                    /* ANDAND  */
+  YYSYMBOL_OROR = 31,                      /* OROR  */
+  YYSYMBOL_TYPE = 32,                      /* TYPE  */
+  YYSYMBOL_RETURN = 33,                    /* RETURN  */
+  YYSYMBOL_READ = 34,                      /* READ  */
+  YYSYMBOL_WRITE = 35,                     /* WRITE  */
+  YYSYMBOL_ELSE = 36,                      /* ELSE  */
+  YYSYMBOL_IF = 37,                        /* IF  */
+  YYSYMBOL_WHILE = 38,                     /* WHILE  */
+  YYSYMBOL_DO = 39,                        /* DO  */
+  YYSYMBOL_IDENTIFIER = 40,                /* IDENTIFIER  */
+  YYSYMBOL_NUMBER = 41,                    /* NUMBER  */
+  YYSYMBOL_YYACCEPT = 42,                  /* $accept  */
+  YYSYMBOL_program = 43,                   /* program  */
+  YYSYMBOL_var_declarations = 44,          /* var_declarations  */
+  YYSYMBOL_var_declaration = 45,           /* var_declaration  */
+  YYSYMBOL_declarator_list = 46,           /* declarator_list  */
+  YYSYMBOL_declarator = 47,                /* declarator  */
+  YYSYMBOL_code_block = 48,                /* code_block  */
+  YYSYMBOL_statements = 49,                /* statements  */
+  YYSYMBOL_statement = 50,                 /* statement  */
+  YYSYMBOL_assign_statement = 51,          /* assign_statement  */
+  YYSYMBOL_if_statement = 52,              /* if_statement  */
+  YYSYMBOL_53_1 = 53,                      /* $@1  */
+  YYSYMBOL_54_2 = 54,                      /* $@2  */
+  YYSYMBOL_else_part = 55,                 /* else_part  */
+  YYSYMBOL_while_statement = 56,           /* while_statement  */
+  YYSYMBOL_57_3 = 57,                      /* $@3  */
+  YYSYMBOL_58_4 = 58,                      /* $@4  */
+  YYSYMBOL_do_while_statement = 59,        /* do_while_statement  */
+  YYSYMBOL_60_5 = 60,                      /* $@5  */
+  YYSYMBOL_return_statement = 61,          /* return_statement  */
+  YYSYMBOL_read_statement = 62,            /* read_statement  */
+  YYSYMBOL_write_statement = 63,           /* write_statement  */
+  YYSYMBOL_exp = 64,                       /* exp  */
+  YYSYMBOL_var_id = 65                     /* var_id  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  3
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   401
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  42
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  24
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  60
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  124
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   296
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    41
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,   126,   126,   139,   140,   146,   150,   151,   157,   161,
+     169,   173,   174,   178,   179,   180,   181,   182,   183,   184,
+     185,   191,   195,   206,   212,   205,   228,   229,   237,   243,
+     236,   262,   261,   278,   287,   298,   313,   318,   322,   326,
+     330,   335,   340,   345,   350,   355,   360,   365,   370,   375,
+     380,   385,   390,   395,   400,   405,   410,   415,   420,   429,
+     441
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "EOF_TOK", "LPAR",
+  "RPAR", "LSQUARE", "RSQUARE", "LBRACE", "RBRACE", "COMMA", "SEMI",
+  "PLUS", "MINUS", "MUL_OP", "DIV_OP", "MOD_OP", "AND_OP", "XOR_OP",
+  "OR_OP", "NOT_OP", "ASSIGN", "LT", "GT", "SHL_OP", "SHR_OP", "EQ",
+  "NOTEQ", "LTEQ", "GTEQ", "ANDAND", "OROR", "TYPE", "RETURN", "READ",
+  "WRITE", "ELSE", "IF", "WHILE", "DO", "IDENTIFIER", "NUMBER", "$accept",
+  "program", "var_declarations", "var_declaration", "declarator_list",
+  "declarator", "code_block", "statements", "statement",
+  "assign_statement", "if_statement", "$@1", "$@2", "else_part",
+  "while_statement", "$@3", "$@4", "do_while_statement", "$@5",
+  "return_statement", "read_statement", "write_statement", "exp", "var_id", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-106)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+    -106,     7,   -14,  -106,   -21,  -106,    18,    16,     1,  -106,
+    -106,  -106,  -106,    19,    20,    21,  -106,  -106,  -106,  -106,
+      17,  -106,  -106,    43,    57,    58,    77,    -4,   -11,   -21,
+    -106,   -13,    46,    46,    93,    90,  -106,  -106,  -106,  -106,
+    -106,    46,    46,   100,  -106,   103,    46,    46,    46,  -106,
+      87,   115,   114,    46,  -106,    82,   220,   265,  -106,  -106,
+     141,   -10,  -106,  -106,    46,    46,    46,    46,    46,    46,
+      46,    46,    46,    46,    46,    46,    46,    46,    46,    46,
+      46,    46,    46,  -106,   168,    56,   118,   102,  -106,   -10,
+     -10,  -106,  -106,  -106,    48,   340,   322,   376,   376,    69,
+      69,   358,   358,   376,   376,   304,   285,   245,    90,  -106,
+    -106,    46,    46,  -106,  -106,    90,   195,   265,    88,  -106,
+    -106,    90,  -106,  -106
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       4,     0,    12,     1,     0,     3,     0,     8,     0,     7,
+       2,    20,    33,     0,     0,     0,    28,    31,    60,    11,
+       0,    14,    15,     0,     0,     0,     0,     0,     0,     0,
+       5,     0,     0,     0,     0,     0,    13,    16,    17,    18,
+      19,     0,     0,     0,     6,     0,     0,     0,     0,    36,
+       0,    37,     0,     0,    12,     0,     0,    21,     9,    34,
+       0,    40,    57,    35,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,    23,     0,     0,     0,     0,    39,    41,
+      42,    43,    44,    45,    46,    47,    48,    51,    52,    49,
+      50,    53,    54,    55,    56,    58,    59,     0,     0,    29,
+      10,     0,     0,    38,    24,     0,     0,    22,    27,    30,
+      32,     0,    25,    26
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
+{
+    -106,  -106,  -106,  -106,  -106,    96,  -105,    80,  -106,  -106,
+    -106,  -106,  -106,  -106,  -106,  -106,  -106,  -106,  -106,  -106,
+    -106,  -106,   -33,    -5
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     1,     2,     5,     8,     9,    55,     6,    19,    20,
+      21,   108,   118,   122,    22,    34,   115,    23,    35,    24,
+      25,    26,    50,    51
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
+{
+      52,    27,    41,   114,    66,    67,    68,     3,    56,    57,
+     119,    29,    30,    60,    61,    62,   123,    42,     4,     7,
+      84,    10,    28,    31,    32,    33,    45,    18,    36,    11,
+      43,    89,    90,    91,    92,    93,    94,    95,    96,    97,
+      98,    99,   100,   101,   102,   103,   104,   105,   106,   107,
+      46,    12,    13,    14,    37,    15,    16,    17,    18,    47,
+      64,    65,    66,    67,    68,   110,    48,    11,    38,    39,
+      72,    73,    74,    75,    76,    77,    78,    79,   116,   117,
+      27,    64,    65,    66,    67,    68,    18,    49,    40,    12,
+      13,    14,    63,    15,    16,    17,    18,    53,    54,    64,
+      65,    66,    67,    68,    69,    70,    71,    58,    59,    72,
+      73,    74,    75,    76,    77,    78,    79,    80,    81,    83,
+      86,    82,   111,   112,   121,    44,    64,    65,    66,    67,
+      68,    69,    70,    71,    85,     0,    72,    73,    74,    75,
+      76,    77,    78,    79,    80,    81,    88,     0,     0,     0,
+       0,     0,     0,    64,    65,    66,    67,    68,    69,    70,
+      71,     0,     0,    72,    73,    74,    75,    76,    77,    78,
+      79,    80,    81,   109,     0,     0,     0,     0,     0,     0,
+      64,    65,    66,    67,    68,    69,    70,    71,     0,     0,
+      72,    73,    74,    75,    76,    77,    78,    79,    80,    81,
+     120,     0,     0,     0,     0,     0,     0,    64,    65,    66,
+      67,    68,    69,    70,    71,     0,     0,    72,    73,    74,
+      75,    76,    77,    78,    79,    80,    81,    87,     0,     0,
+       0,     0,    64,    65,    66,    67,    68,    69,    70,    71,
+       0,     0,    72,    73,    74,    75,    76,    77,    78,    79,
+      80,    81,   113,     0,     0,     0,     0,    64,    65,    66,
+      67,    68,    69,    70,    71,     0,     0,    72,    73,    74,
+      75,    76,    77,    78,    79,    80,    81,    64,    65,    66,
+      67,    68,    69,    70,    71,     0,     0,    72,    73,    74,
+      75,    76,    77,    78,    79,    80,    81,    64,    65,    66,
+      67,    68,    69,    70,    71,     0,     0,    72,    73,    74,
+      75,    76,    77,    78,    79,    80,    64,    65,    66,    67,
+      68,    69,    70,    71,     0,     0,    72,    73,    74,    75,
+      76,    77,    78,    79,    64,    65,    66,    67,    68,    69,
+      70,     0,     0,     0,    72,    73,    74,    75,    76,    77,
+      78,    79,    64,    65,    66,    67,    68,    69,     0,     0,
+       0,     0,    72,    73,    74,    75,    76,    77,    78,    79,
+      64,    65,    66,    67,    68,     0,     0,     0,     0,     0,
+      72,    73,    74,    75,     0,     0,    78,    79,    64,    65,
+      66,    67,    68,     0,     0,     0,     0,     0,     0,     0,
+      74,    75
+};
+
+static const yytype_int8 yycheck[] =
+{
+      33,     6,     6,   108,    14,    15,    16,     0,    41,    42,
+     115,    10,    11,    46,    47,    48,   121,    21,    32,    40,
+      53,     3,     6,     4,     4,     4,    31,    40,    11,    11,
+      41,    64,    65,    66,    67,    68,    69,    70,    71,    72,
+      73,    74,    75,    76,    77,    78,    79,    80,    81,    82,
+       4,    33,    34,    35,    11,    37,    38,    39,    40,    13,
+      12,    13,    14,    15,    16,     9,    20,    11,    11,    11,
+      22,    23,    24,    25,    26,    27,    28,    29,   111,   112,
+      85,    12,    13,    14,    15,    16,    40,    41,    11,    33,
+      34,    35,     5,    37,    38,    39,    40,     4,     8,    12,
+      13,    14,    15,    16,    17,    18,    19,     7,     5,    22,
+      23,    24,    25,    26,    27,    28,    29,    30,    31,     5,
+      38,     6,     4,    21,    36,    29,    12,    13,    14,    15,
+      16,    17,    18,    19,    54,    -1,    22,    23,    24,    25,
+      26,    27,    28,    29,    30,    31,     5,    -1,    -1,    -1,
+      -1,    -1,    -1,    12,    13,    14,    15,    16,    17,    18,
+      19,    -1,    -1,    22,    23,    24,    25,    26,    27,    28,
+      29,    30,    31,     5,    -1,    -1,    -1,    -1,    -1,    -1,
+      12,    13,    14,    15,    16,    17,    18,    19,    -1,    -1,
+      22,    23,    24,    25,    26,    27,    28,    29,    30,    31,
+       5,    -1,    -1,    -1,    -1,    -1,    -1,    12,    13,    14,
+      15,    16,    17,    18,    19,    -1,    -1,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,     7,    -1,    -1,
+      -1,    -1,    12,    13,    14,    15,    16,    17,    18,    19,
+      -1,    -1,    22,    23,    24,    25,    26,    27,    28,    29,
+      30,    31,     7,    -1,    -1,    -1,    -1,    12,    13,    14,
+      15,    16,    17,    18,    19,    -1,    -1,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    12,    13,    14,
+      15,    16,    17,    18,    19,    -1,    -1,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    12,    13,    14,
+      15,    16,    17,    18,    19,    -1,    -1,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    12,    13,    14,    15,
+      16,    17,    18,    19,    -1,    -1,    22,    23,    24,    25,
+      26,    27,    28,    29,    12,    13,    14,    15,    16,    17,
+      18,    -1,    -1,    -1,    22,    23,    24,    25,    26,    27,
+      28,    29,    12,    13,    14,    15,    16,    17,    -1,    -1,
+      -1,    -1,    22,    23,    24,    25,    26,    27,    28,    29,
+      12,    13,    14,    15,    16,    -1,    -1,    -1,    -1,    -1,
+      22,    23,    24,    25,    -1,    -1,    28,    29,    12,    13,
+      14,    15,    16,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      24,    25
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,    43,    44,     0,    32,    45,    49,    40,    46,    47,
+       3,    11,    33,    34,    35,    37,    38,    39,    40,    50,
+      51,    52,    56,    59,    61,    62,    63,    65,     6,    10,
+      11,     4,     4,     4,    57,    60,    11,    11,    11,    11,
+      11,     6,    21,    41,    47,    65,     4,    13,    20,    41,
+      64,    65,    64,     4,     8,    48,    64,    64,     7,     5,
+      64,    64,    64,     5,    12,    13,    14,    15,    16,    17,
+      18,    19,    22,    23,    24,    25,    26,    27,    28,    29,
+      30,    31,     6,     5,    64,    49,    38,     7,     5,    64,
+      64,    64,    64,    64,    64,    64,    64,    64,    64,    64,
+      64,    64,    64,    64,    64,    64,    64,    64,    53,     5,
+       9,     4,    21,     7,    48,    58,    64,    64,    54,    48,
+       5,    36,    55,    48
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    42,    43,    44,    44,    45,    46,    46,    47,    47,
+      48,    49,    49,    50,    50,    50,    50,    50,    50,    50,
+      50,    51,    51,    53,    54,    52,    55,    55,    57,    58,
+      56,    60,    59,    61,    62,    63,    64,    64,    64,    64,
+      64,    64,    64,    64,    64,    64,    64,    64,    64,    64,
+      64,    64,    64,    64,    64,    64,    64,    64,    64,    64,
+      65
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     3,     2,     0,     3,     3,     1,     1,     4,
+       3,     2,     0,     2,     1,     1,     2,     2,     2,     2,
+       1,     3,     6,     0,     0,     8,     2,     0,     0,     0,
+       7,     0,     7,     1,     4,     4,     1,     1,     4,     3,
+       2,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     2,     3,     3,
+       1
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* program: var_declarations statements EOF_TOK  */
+#line 127 "parser.y"
+  {
+    // Generate the epilog of the program, that is, a call to the
+    // `exit' syscall.
+    genEpilog(program);
+    // Return from yyparse().
+    YYACCEPT;
+  }
+#line 1290 "build/parser.tab.c"
+    break;
+
+  case 8: /* declarator: IDENTIFIER  */
+#line 158 "parser.y"
+  {
+    createSymbol(program, (yyvsp[0].string), TYPE_INT, 0);
+  }
+#line 1298 "build/parser.tab.c"
+    break;
+
+  case 9: /* declarator: IDENTIFIER LSQUARE NUMBER RSQUARE  */
+#line 162 "parser.y"
+  {
+    createSymbol(program, (yyvsp[-3].string), TYPE_INT_ARRAY, (yyvsp[-1].integer));
+  }
+#line 1306 "build/parser.tab.c"
+    break;
+
+  case 21: /* assign_statement: var_id ASSIGN exp  */
+#line 192 "parser.y"
+  {
+    genStoreRegisterToVariable(program, (yyvsp[-2].var), (yyvsp[0].reg));
+  }
+#line 1314 "build/parser.tab.c"
+    break;
+
+  case 22: /* assign_statement: var_id LSQUARE exp RSQUARE ASSIGN exp  */
+#line 196 "parser.y"
+  {
+    genStoreRegisterToArrayElement(program, (yyvsp[-5].var), (yyvsp[-3].reg), (yyvsp[0].reg));
+  }
+#line 1322 "build/parser.tab.c"
+    break;
+
+  case 23: /* $@1: %empty  */
+#line 206 "parser.y"
+  {
+    // Generate a jump to the else part if the expression is equal to zero.
+    (yyvsp[-3].ifStmt).lElse = createLabel(program);
+    genBEQ(program, (yyvsp[-1].reg), REG_0, (yyvsp[-3].ifStmt).lElse);
+  }
+#line 1332 "build/parser.tab.c"
+    break;
+
+  case 24: /* $@2: %empty  */
+#line 212 "parser.y"
+  {
+    // After the `then' part, generate a jump to the end of the statement.
+    (yyvsp[-5].ifStmt).lExit = createLabel(program);
+    genJ(program, (yyvsp[-5].ifStmt).lExit);
+    // Assign the label which points to the first instruction of the else part.
+    assignLabel(program, (yyvsp[-5].ifStmt).lElse);
+  }
+#line 1344 "build/parser.tab.c"
+    break;
+
+  case 25: /* if_statement: IF LPAR exp RPAR $@1 code_block $@2 else_part  */
+#line 220 "parser.y"
+  {
+    // Assign the label to the end of the statement.
+    assignLabel(program, (yyvsp[-7].ifStmt).lExit);
+  }
+#line 1353 "build/parser.tab.c"
+    break;
+
+  case 28: /* $@3: %empty  */
+#line 237 "parser.y"
+  {
+    // Assign a label at the beginning of the loop for the back-edge.
+    (yyvsp[0].whileStmt).lLoop = createLabel(program);
+    assignLabel(program, (yyvsp[0].whileStmt).lLoop);
+  }
+#line 1363 "build/parser.tab.c"
+    break;
+
+  case 29: /* $@4: %empty  */
+#line 243 "parser.y"
+  {
+    // Generate a jump out of the loop if the condition is equal to zero.
+    (yyvsp[-4].whileStmt).lExit = createLabel(program);
+    genBEQ(program, (yyvsp[-1].reg), REG_0, (yyvsp[-4].whileStmt).lExit);
+  }
+#line 1373 "build/parser.tab.c"
+    break;
+
+  case 30: /* while_statement: WHILE $@3 LPAR exp RPAR $@4 code_block  */
+#line 249 "parser.y"
+  {
+    // Generate a jump back to the beginning of the loop after its body.
+    genJ(program, (yyvsp[-6].whileStmt).lLoop);
+    // Assign the label to the end of the loop.
+    assignLabel(program, (yyvsp[-6].whileStmt).lExit);
+  }
+#line 1384 "build/parser.tab.c"
+    break;
+
+  case 31: /* $@5: %empty  */
+#line 262 "parser.y"
+  {
+    // Assign a label at the beginning of the loop for the back-edge.
+    (yyvsp[0].label) = createLabel(program);
+    assignLabel(program, (yyvsp[0].label));
+  }
+#line 1394 "build/parser.tab.c"
+    break;
+
+  case 32: /* do_while_statement: DO $@5 code_block WHILE LPAR exp RPAR  */
+#line 268 "parser.y"
+  {
+    // Generate a jump to the beginning of the loop to repeat the code block
+    // if the condition is not equal to zero.
+    genBNE(program, (yyvsp[-1].reg), REG_0, (yyvsp[-6].label));
+  }
+#line 1404 "build/parser.tab.c"
+    break;
+
+  case 33: /* return_statement: RETURN  */
+#line 279 "parser.y"
+  {
+    genExit0Syscall(program);
+  }
+#line 1412 "build/parser.tab.c"
+    break;
+
+  case 34: /* read_statement: READ LPAR var_id RPAR  */
+#line 288 "parser.y"
+  {
+    t_regID rTmp = getNewRegister(program);
+    genReadIntSyscall(program, rTmp);
+    genStoreRegisterToVariable(program, (yyvsp[-1].var), rTmp);
+  }
+#line 1422 "build/parser.tab.c"
+    break;
+
+  case 35: /* write_statement: WRITE LPAR exp RPAR  */
+#line 299 "parser.y"
+  {
+    // Generate a call to the PrintInt syscall.
+    genPrintIntSyscall(program, (yyvsp[-1].reg));
+    // Also generate code to print a newline after the integer.
+    t_regID rTmp = getNewRegister(program);
+    genLI(program, rTmp, '\n');
+    genPrintCharSyscall(program, rTmp);
+  }
+#line 1435 "build/parser.tab.c"
+    break;
+
+  case 36: /* exp: NUMBER  */
+#line 314 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genLI(program, (yyval.reg), (yyvsp[0].integer));
+  }
+#line 1444 "build/parser.tab.c"
+    break;
+
+  case 37: /* exp: var_id  */
+#line 319 "parser.y"
+  {
+    (yyval.reg) = genLoadVariable(program, (yyvsp[0].var));
+  }
+#line 1452 "build/parser.tab.c"
+    break;
+
+  case 38: /* exp: var_id LSQUARE exp RSQUARE  */
+#line 323 "parser.y"
+  {
+    (yyval.reg) = genLoadArrayElement(program, (yyvsp[-3].var), (yyvsp[-1].reg));
+  }
+#line 1460 "build/parser.tab.c"
+    break;
+
+  case 39: /* exp: LPAR exp RPAR  */
+#line 327 "parser.y"
+  {
+    (yyval.reg) = (yyvsp[-1].reg);
+  }
+#line 1468 "build/parser.tab.c"
+    break;
+
+  case 40: /* exp: MINUS exp  */
+#line 331 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSUB(program, (yyval.reg), REG_0, (yyvsp[0].reg));
+  }
+#line 1477 "build/parser.tab.c"
+    break;
+
+  case 41: /* exp: exp PLUS exp  */
+#line 336 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genADD(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1486 "build/parser.tab.c"
+    break;
+
+  case 42: /* exp: exp MINUS exp  */
+#line 341 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSUB(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1495 "build/parser.tab.c"
+    break;
+
+  case 43: /* exp: exp MUL_OP exp  */
+#line 346 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genMUL(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1504 "build/parser.tab.c"
+    break;
+
+  case 44: /* exp: exp DIV_OP exp  */
+#line 351 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genDIV(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1513 "build/parser.tab.c"
+    break;
+
+  case 45: /* exp: exp MOD_OP exp  */
+#line 356 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genREM(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1522 "build/parser.tab.c"
+    break;
+
+  case 46: /* exp: exp AND_OP exp  */
+#line 361 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genAND(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1531 "build/parser.tab.c"
+    break;
+
+  case 47: /* exp: exp XOR_OP exp  */
+#line 366 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genXOR(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1540 "build/parser.tab.c"
+    break;
+
+  case 48: /* exp: exp OR_OP exp  */
+#line 371 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genOR(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1549 "build/parser.tab.c"
+    break;
+
+  case 49: /* exp: exp SHL_OP exp  */
+#line 376 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSLL(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1558 "build/parser.tab.c"
+    break;
+
+  case 50: /* exp: exp SHR_OP exp  */
+#line 381 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSRA(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1567 "build/parser.tab.c"
+    break;
+
+  case 51: /* exp: exp LT exp  */
+#line 386 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSLT(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1576 "build/parser.tab.c"
+    break;
+
+  case 52: /* exp: exp GT exp  */
+#line 391 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSGT(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1585 "build/parser.tab.c"
+    break;
+
+  case 53: /* exp: exp EQ exp  */
+#line 396 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSEQ(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1594 "build/parser.tab.c"
+    break;
+
+  case 54: /* exp: exp NOTEQ exp  */
+#line 401 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSNE(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1603 "build/parser.tab.c"
+    break;
+
+  case 55: /* exp: exp LTEQ exp  */
+#line 406 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSLE(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1612 "build/parser.tab.c"
+    break;
+
+  case 56: /* exp: exp GTEQ exp  */
+#line 411 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSGE(program, (yyval.reg), (yyvsp[-2].reg), (yyvsp[0].reg));
+  }
+#line 1621 "build/parser.tab.c"
+    break;
+
+  case 57: /* exp: NOT_OP exp  */
+#line 416 "parser.y"
+  {
+    (yyval.reg) = getNewRegister(program);
+    genSEQ(program, (yyval.reg), (yyvsp[0].reg), REG_0);
+  }
+#line 1630 "build/parser.tab.c"
+    break;
+
+  case 58: /* exp: exp ANDAND exp  */
+#line 421 "parser.y"
+  {
+    t_regID rNormalizedOp1 = getNewRegister(program);
+    genSNE(program, rNormalizedOp1, (yyvsp[-2].reg), REG_0);
+    t_regID rNormalizedOp2 = getNewRegister(program);
+    genSNE(program, rNormalizedOp2, (yyvsp[0].reg), REG_0);
+    (yyval.reg) = getNewRegister(program);
+    genAND(program, (yyval.reg), rNormalizedOp1, rNormalizedOp2);
+  }
+#line 1643 "build/parser.tab.c"
+    break;
+
+  case 59: /* exp: exp OROR exp  */
+#line 430 "parser.y"
+  {
+    t_regID rNormalizedOp1 = getNewRegister(program);
+    genSNE(program, rNormalizedOp1, (yyvsp[-2].reg), REG_0);
+    t_regID rNormalizedOp2 = getNewRegister(program);
+    genSNE(program, rNormalizedOp2, (yyvsp[0].reg), REG_0);
+    (yyval.reg) = getNewRegister(program);
+    genOR(program, (yyval.reg), rNormalizedOp1, rNormalizedOp2);
+  }
+#line 1656 "build/parser.tab.c"
+    break;
+
+  case 60: /* var_id: IDENTIFIER  */
+#line 442 "parser.y"
+  {
+    t_symbol *var = getSymbol(program, (yyvsp[0].string));
+    if (var == NULL) {
+      yyerror("variable not declared");
+      YYERROR;
+    }
+    (yyval.var) = var;
+    free((yyvsp[0].string));
+  }
+#line 1670 "build/parser.tab.c"
+    break;
+
+
+#line 1674 "build/parser.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 453 "parser.y"
+
+
+t_program *parseProgram(char *fn)
+{
+  FILE *fp = fopen(fn, "r");
+  if (!fp) {
+    emitError(nullFileLocation, "could not open input file");
+    return NULL;
+  }
+
+  program = newProgram();
+  curFileLoc.file = fn;
+  curFileLoc.row = 0;
+  numErrors = 0;
+  yyin = fp;
+  yyparse();
+
+  if (numErrors > 0) {
+    fprintf(stderr, "%d error(s) generated.\n", numErrors);
+    fclose(fp);
+    deleteProgram(program);
+    return NULL;
+  }
+
+  fclose(fp);
+  return program;
+}
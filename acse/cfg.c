@@ -197,6 +197,9 @@ t_bbNode *bbInsertInstructionBefore(
   if (listIP == NULL)
     fatalError("bug: invalid basic block node; corrupt CFG?");
 
+  // Spill code belongs to the same source line as the instruction
+  if (instr->location.row < 0)
+    instr->location = ip->instr->location;
   t_bbNode *newNode = newBBNode(instr);
   block->nodes = listInsertBefore(block->nodes, listIP, newNode);
   newNode->parent = block;
@@ -211,6 +214,9 @@ t_bbNode *bbInsertInstructionAfter(
   if (listIP == NULL)
     fatalError("bug: invalid basic block node; corrupt CFG?");
 
+  // Spill code belongs to the same source line as the instruction
+  if (instr->location.row < 0)
+    instr->location = ip->instr->location;
   t_bbNode *newNode = newBBNode(instr);
   block->nodes = listInsertAfter(block->nodes, listIP, newNode);
   newNode->parent = block;
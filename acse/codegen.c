@@ -438,6 +438,13 @@ t_instruction *genPrintCharSyscall(t_program *program, t_regID rs1)
       program, OPC_CALL_PRINT_CHAR, REG_INVALID, rs1, REG_INVALID, NULL, 0);
 }
 
+t_instruction *genSimControlSyscall(t_program *program, t_regID rs1)
+{
+  validateRegisterId(program, rs1);
+  return genInstruction(
+      program, OPC_CALL_SIM_CONTROL, REG_INVALID, rs1, REG_INVALID, NULL, 0);
+}
+
 
 t_regID genLoadVariable(t_program *program, t_symbol *var)
 {
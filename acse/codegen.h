@@ -905,6 +905,18 @@ t_instruction *genPrintIntSyscall(t_program *program, t_regID rs1);
  *        use ECALL to transfer control to the supervisor/operating system. */
 t_instruction *genPrintCharSyscall(t_program *program, t_regID rs1);
 
+/** Add a new SimControl syscall instruction at the end of the instruction
+ *  list of the specified program. At runtime, this instruction passes the
+ *  command in the source register to the simulator, to mark the region of
+ *  interest of the program or to reset and print the simulation statistics.
+ *  @param program The program where the instruction will be added.
+ *  @param rs1     Identifier of the source register (command).
+ *  @returns the instruction object added to the instruction list.
+ *  @note During the target-specific transformation passes, ACSE replaces
+ *        syscall instructions with a sequence of lower-level instructions that
+ *        use ECALL to transfer control to the supervisor/operating system. */
+t_instruction *genSimControlSyscall(t_program *program, t_regID rs1);
+
 /// @}
 
 
@@ -70,6 +70,7 @@ void yyerror(const char *msg)
 %token TYPE
 %token RETURN
 %token READ WRITE ELSE
+%token SIMCTL
 
 // These are the tokens with a semantic value.
 %token <ifStmt> IF
@@ -182,6 +183,7 @@ statement
   | return_statement SEMI
   | read_statement SEMI
   | write_statement SEMI
+  | simctl_statement SEMI
   | SEMI
 ;
 
@@ -306,6 +308,16 @@ write_statement
   }
 ;
 
+/* A simctl statement translates to a SimControl syscall, which lets the
+ * simulator know where the region of interest of the program begins (0) and
+ * ends (1), or resets (2) or prints (3) its statistics. */
+simctl_statement
+  : SIMCTL LPAR exp RPAR
+  {
+    genSimControlSyscall(program, $3);
+  }
+;
+
 /* The exp rule represents the syntax of expressions. The semantic value of
  * the rule is the register ID that will contain the value of the expression
  * at runtime. */
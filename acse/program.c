@@ -65,6 +65,7 @@ t_instruction *newInstruction(int opcode)
   result->label = NULL;
   result->addressParam = NULL;
   result->comment = NULL;
+  result->location = nullFileLocation;
   return result;
 }
 
@@ -330,6 +331,7 @@ void addInstruction(t_program *program, t_instruction *instr)
     }
   }
   lastFileLoc = curFileLoc;
+  instr->location = curFileLoc;
 
   // Update the list of instructions.
   program->instructions = listInsert(program->instructions, instr, -1);
@@ -155,6 +155,8 @@ const char *opcodeToString(int opcode)
       return "PrintInt";
     case OPC_CALL_PRINT_CHAR:
       return "PrintChar";
+    case OPC_CALL_SIM_CONTROL:
+      return "SimControl";
   }
   return "<unknown>";
 }
@@ -254,6 +256,7 @@ static int opcodeToFormat(int opcode)
     case OPC_CALL_READ_INT:
     case OPC_CALL_PRINT_INT:
     case OPC_CALL_PRINT_CHAR:
+    case OPC_CALL_SIM_CONTROL:
       return FORMAT_FUNC;
   }
   return -1;
@@ -459,7 +462,21 @@ bool printInstruction(t_instruction *instr, FILE *fp, bool machineRegIDs)
   return true;
 }
 
-bool translateCodeSegment(t_program *program, FILE *fp)
+/* Writes a .file directive which numbers the source file. */
+static bool printFileDirective(int fileNum, const char *file, FILE *fp)
+{
+  if (fprintf(fp, "%-8s.file %d \"", "", fileNum) < 0)
+    return false;
+  for (const char *p = file; *p != '\0'; p++) {
+    if ((*p == '"' || *p == '\\') && fputc('\\', fp) == EOF)
+      return false;
+    if (fputc(*p, fp) == EOF)
+      return false;
+  }
+  return fprintf(fp, "\"\n") >= 0;
+}
+
+bool translateCodeSegment(t_program *program, FILE *fp, bool lineInfo)
 {
   if (!program->instructions)
     return true;
@@ -468,12 +485,34 @@ bool translateCodeSegment(t_program *program, FILE *fp)
   if (fprintf(fp, "%-8s.text\n", "") < 0)
     return false;
 
+  // Line information is written as a .loc directive before every
+  // instruction which starts a different source line. Line zero marks the
+  // instructions which were not generated by a line of the source.
+  char *lastFile = NULL;
+  int lastRow = -1, fileNum = 0;
+
   t_listNode *curNode = program->instructions;
   while (curNode != NULL) {
     t_instruction *curInstr = (t_instruction *)curNode->data;
     if (curInstr == NULL)
       fatalError("bug: NULL instruction found in the program");
 
+    t_fileLocation loc = curInstr->location;
+    if (lineInfo && loc.row >= 0 &&
+        (loc.file != lastFile || loc.row != lastRow)) {
+      if (loc.file != lastFile) {
+        if (!printFileDirective(++fileNum, loc.file, fp))
+          return false;
+        lastFile = loc.file;
+      }
+      if (fprintf(fp, "%-8s.loc %d %d\n", "", fileNum, loc.row + 1) < 0)
+        return false;
+      lastRow = loc.row;
+    } else if (lineInfo && loc.row < 0 && lastRow >= 0) {
+      if (fprintf(fp, "%-8s.loc %d 0\n", "", fileNum) < 0)
+        return false;
+      lastRow = -1;
+    }
     if (!printInstruction(curInstr, fp, true))
       return false;
     if (fprintf(fp, "\n") < 0)
@@ -543,10 +582,12 @@ bool translateDataSegment(t_program *program, FILE *fp)
 }
 
 
-bool writeAssembly(t_program *program, const char *fn)
+bool writeAssembly(t_program *program, const char *fn, bool lineInfo)
 {
   bool res = false;
-  FILE *fp = fopen(fn, "w");
+  // "-" writes to the standard output, to be piped into the assembler
+  bool toStdout = strcmp(fn, "-") == 0;
+  FILE *fp = toStdout ? stdout : fopen(fn, "w");
   if (fp == NULL)
     return res;
 
@@ -554,12 +595,12 @@ bool writeAssembly(t_program *program, const char *fn)
     goto fail;
   if (!translateDataSegment(program, fp))
     goto fail;
-  if (!translateCodeSegment(program, fp))
+  if (!translateCodeSegment(program, fp, lineInfo))
     goto fail;
 
   res = true;
 fail:
-  if (fclose(fp) == EOF)
+  if ((toStdout ? fflush(fp) : fclose(fp)) == EOF)
     res = false;
   return res;
 }
@@ -37,10 +37,14 @@ char *registerIDToString(t_regID regID, bool machineRegIDs);
 bool printInstruction(t_instruction *inst, FILE *fp, bool machineRegIDs);
 
 /** Write the final assembly code for the program to the specified file.
- *  @param program The program being compiled.
- *  @param fn      The path of the output file.
+ *  @param program  The program being compiled.
+ *  @param fn       The path of the output file.
+ *  @param lineInfo True to precede the instructions with .file and .loc
+ *                  directives, which map them to the lines of the source
+ *                  code. The directives are understood by asrv32im, but not
+ *                  by RARS.
  *  @returns false if an error occurred while writing to the file. */
-bool writeAssembly(t_program *program, const char *fn);
+bool writeAssembly(t_program *program, const char *fn, bool lineInfo);
 
 /**
  * @}
@@ -164,7 +164,8 @@ enum {
   OPC_CALL_EXIT_0,
   OPC_CALL_READ_INT,
   OPC_CALL_PRINT_INT,
-  OPC_CALL_PRINT_CHAR
+  OPC_CALL_PRINT_CHAR,
+  OPC_CALL_SIM_CONTROL
 };
 
 
@@ -20,11 +20,15 @@
 #define SYSCALL_ID_READ_INT 5
 #define SYSCALL_ID_EXIT_0 10
 #define SYSCALL_ID_PRINT_CHAR 11
+#define SYSCALL_ID_SIM_CONTROL 2080
 
 
 t_listNode *addInstrAfter(
     t_program *program, t_listNode *prev, t_instruction *instr)
 {
+  // The expansion of an instruction keeps its source line
+  if (prev && instr->location.row < 0)
+    instr->location = ((t_instruction *)prev->data)->location;
   program->instructions =
       listInsertAfter(program->instructions, prev, (void *)instr);
   if (prev == NULL)
@@ -290,7 +294,8 @@ void fixSyscalls(t_program *program)
     if (instr->opcode != OPC_CALL_EXIT_0 &&
         instr->opcode != OPC_CALL_READ_INT &&
         instr->opcode != OPC_CALL_PRINT_INT &&
-        instr->opcode != OPC_CALL_PRINT_CHAR) {
+        instr->opcode != OPC_CALL_PRINT_CHAR &&
+        instr->opcode != OPC_CALL_SIM_CONTROL) {
       curi = curi->next;
       continue;
     }
@@ -303,8 +308,10 @@ void fixSyscalls(t_program *program)
       func = SYSCALL_ID_PRINT_INT;
     else if (instr->opcode == OPC_CALL_READ_INT)
       func = SYSCALL_ID_READ_INT;
-    else // if (instr->opcode == OPC_CALL_PRINT_CHAR)
+    else if (instr->opcode == OPC_CALL_PRINT_CHAR)
       func = SYSCALL_ID_PRINT_CHAR;
+    else // if (instr->opcode == OPC_CALL_SIM_CONTROL)
+      func = SYSCALL_ID_SIM_CONTROL;
     t_regID rFunc = getNewRegister(program);
     curi = addInstrAfter(program, curi, genLI(NULL, rFunc, func));
 
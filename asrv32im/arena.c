@@ -0,0 +1,83 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "arena.h"
+#include "errors.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+// Every allocation is aligned for any of these types
+typedef union {
+  void *ptr;
+  long long ll;
+  double d;
+} t_arenaAlign;
+#define ARENA_ALIGN (sizeof(t_arenaAlign))
+
+typedef struct t_arenaBlock {
+  struct t_arenaBlock *next;
+  t_arenaAlign data[];
+} t_arenaBlock;
+
+struct t_arena {
+  t_arenaBlock *blocks;
+  char *next;
+  char *end;
+};
+
+
+t_arena *newArena(void)
+{
+  t_arena *arena = calloc(1, sizeof(t_arena));
+  if (!arena)
+    fatalError("out of memory");
+  return arena;
+}
+
+void deleteArena(t_arena *arena)
+{
+  t_arenaBlock *block, *next;
+
+  if (!arena)
+    return;
+  for (block = arena->blocks; block != NULL; block = next) {
+    next = block->next;
+    free(block);
+  }
+  free(arena);
+}
+
+
+static void *arenaNewBlock(t_arena *arena, size_t size)
+{
+  t_arenaBlock *block = malloc(sizeof(t_arenaBlock) + size);
+  if (!block)
+    fatalError("out of memory");
+  block->next = arena->blocks;
+  arena->blocks = block;
+  return block->data;
+}
+
+void *arenaAlloc(t_arena *arena, size_t size)
+{
+  size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+  if (size > (size_t)(arena->end - arena->next)) {
+    // Large allocations get a block of their own, so that the free space
+    // left in the current block is not wasted
+    if (size > ARENA_BLOCK_SIZE / 4)
+      return arenaNewBlock(arena, size);
+    arena->next = arenaNewBlock(arena, ARENA_BLOCK_SIZE);
+    arena->end = arena->next + ARENA_BLOCK_SIZE;
+  }
+  void *res = arena->next;
+  arena->next += size;
+  return res;
+}
+
+char *arenaStrndup(t_arena *arena, const char *str, size_t len)
+{
+  char *res = arenaAlloc(arena, len + 1);
+  memcpy(res, str, len);
+  res[len] = '\0';
+  return res;
+}
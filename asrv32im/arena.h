@@ -0,0 +1,19 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/* Bump allocator for objects which live as long as the lexer or the object
+ * file. Memory is taken from large blocks, and all of it is released at once
+ * by deleteArena. Allocations never fail: running out of memory is fatal. */
+
+typedef struct t_arena t_arena;
+
+t_arena *newArena(void);
+void deleteArena(t_arena *arena);
+
+void *arenaAlloc(t_arena *arena, size_t size);
+/* Copies `len' characters of `str' and terminates the copy */
+char *arenaStrndup(t_arena *arena, const char *str, size_t len);
+
+#endif
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdbool.h>
 #include <getopt.h>
 #include "lexer.h"
 #include "parser.h"
@@ -12,8 +13,10 @@ void usage(const char *name)
   puts("ACSE RISC-V RV32IM assembler, (c) 2022-24 Politecnico di Milano");
   printf("usage: %s [options] input\n\n", name);
   puts("Options:");
-  puts("  -o OBJFILE    Name the output OBJFILE (default output.o)");
-  puts("  -h, --help    Displays available options");
+  puts("  -o OBJFILE        Name the output OBJFILE (default output.o)");
+  puts("  -c, --compress     Use RV32C compressed instructions where possible");
+  puts("  -h, --help         Displays available options");
+  puts("The input is read from the standard input if it is \"-\".");
 }
 
 int main(int argc, char *argv[])
@@ -22,12 +25,18 @@ int main(int argc, char *argv[])
   int ch, res = 0;
   static const struct option options[] = {
       {"help", no_argument, NULL, 'h'},
+      {"compress", no_argument, NULL, 'c'},
+      {NULL, 0, NULL, 0}
   };
 
   char *out = "output.o";
+  bool compress = false;
 
-  while ((ch = getopt_long(argc, argv, "ho:", options, NULL)) != -1) {
+  while ((ch = getopt_long(argc, argv, "cho:", options, NULL)) != -1) {
     switch (ch) {
+      case 'c':
+        compress = true;
+        break;
       case 'o':
         out = optarg;
         break;
@@ -57,7 +66,7 @@ int main(int argc, char *argv[])
     emitError(nullFileLocation, "could not read input file");
     goto fail;
   }
-  obj = parseObject(lex);
+  obj = parseObject(lex, compress);
   if (obj == NULL)
     goto fail;
   if (!objMaterialize(obj))
@@ -0,0 +1,42 @@
+#!/bin/sh
+# Writes an assembly file of LINES lines, with the mix of labels,
+# instructions, registers and directives of compiler generated code.
+#
+# usage: gen.sh LINES
+
+awk -v lines="${1:-200000}" 'BEGIN {
+  split("add sub mul div rem and or xor sll srl sra slt sltu", rr, " ")
+  split("addi andi ori xori slli srli srai slti", ri, " ")
+  split("zero ra sp t0 t1 t2 s0 s1 a0 a1 a2 a3 a4 a5 a6 a7 s2 s3 t3 t4", \
+      reg, " ")
+  print "        .text"
+  print "_start:"
+  for (i = 0; i < lines; i++) {
+    k = i % 16
+    r1 = reg[i % 20 + 1]
+    r2 = reg[(i * 7) % 20 + 1]
+    r3 = reg[(i * 13) % 20 + 1]
+    if (k == 0)
+      printf "L%d:\n", i
+    else if (k < 6)
+      printf "        %s %s, %s, %s\n", rr[i % 13 + 1], r1, r2, r3
+    else if (k < 9)
+      printf "        %s %s, %s, %d  # immediate\n", ri[i % 8 + 1], r1, r2, \
+          i % 32
+    else if (k < 11)
+      printf "        lw %s, %d(%s)\n", r1, (i % 512) * 4, r2
+    else if (k == 11)
+      printf "        sw %s, -%d(%s)\n", r1, (i % 64) * 4, r2
+    else if (k == 12)
+      printf "        li %s, %d\n", r1, i * 31
+    else if (k == 13)
+      printf "        beq %s, %s, L%d\n", r1, r2, i - i % 16
+    else if (k == 14)
+      printf "        la %s, L%d\n", r1, i - i % 16
+    else
+      printf "        jal ra, L%d\n", i - i % 16
+  }
+  print "        .data"
+  for (i = 0; i < lines / 16; i++)
+    printf "D%d:     .word %d, %d\n", i, i, -i
+}'
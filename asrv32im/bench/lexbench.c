@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+#include "lexer.h"
+
+/* Lexer microbenchmark: tokenizes a file RUNS times and prints the best
+ * throughput. The whole file is read by newLexer, so only tokenization is
+ * timed. */
+
+static double elapsed(struct timespec *start, struct timespec *end)
+{
+  return (double)(end->tv_sec - start->tv_sec) +
+      (double)(end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s FILE [RUNS]\n", argv[0]);
+    return 1;
+  }
+  int runs = argc > 2 ? atoi(argv[2]) : 5;
+  double best = 0;
+  uint64_t tokens = 0, bytes = 0;
+
+  for (int run = 0; run < runs; run++) {
+    t_lexer *lex = newLexer(argv[1]);
+    if (!lex) {
+      fprintf(stderr, "could not open %s\n", argv[1]);
+      return 1;
+    }
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    tokens = 0;
+    while (lexNextToken(lex).id != TOK_EOF)
+      tokens++;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double t = elapsed(&start, &end);
+    if (run == 0 || t < best)
+      best = t;
+    deleteLexer(lex);
+  }
+
+  FILE *fp = fopen(argv[1], "rb");
+  if (fp) {
+    fseek(fp, 0, SEEK_END);
+    bytes = (uint64_t)ftell(fp);
+    fclose(fp);
+  }
+  printf("%" PRIu64 " tokens, %" PRIu64 " bytes in %.3f ms\n", tokens, bytes,
+      best * 1e3);
+  printf("%.2f Mtokens/s, %.2f MB/s\n", (double)tokens / best * 1e-6,
+      (double)bytes / best * 1e-6);
+  return 0;
+}
@@ -0,0 +1,68 @@
+/* Generated by isagen from rv32im.isa, do not edit */
+
+static const t_encInstrData encInstrData[] = {
+    [INSTR_OPC_LUI] = {'U', 0x00000037},
+    [INSTR_OPC_AUIPC] = {'U', 0x00000017},
+    [INSTR_OPC_JAL] = {'J', 0x0000006F},
+    [INSTR_OPC_JALR] = {'I', 0x00000067},
+    [INSTR_OPC_BEQ] = {'B', 0x00000063},
+    [INSTR_OPC_BNE] = {'B', 0x00001063},
+    [INSTR_OPC_BLT] = {'B', 0x00004063},
+    [INSTR_OPC_BGE] = {'B', 0x00005063},
+    [INSTR_OPC_BLTU] = {'B', 0x00006063},
+    [INSTR_OPC_BGEU] = {'B', 0x00007063},
+    [INSTR_OPC_LB] = {'I', 0x00000003},
+    [INSTR_OPC_LH] = {'I', 0x00001003},
+    [INSTR_OPC_LW] = {'I', 0x00002003},
+    [INSTR_OPC_LBU] = {'I', 0x00004003},
+    [INSTR_OPC_LHU] = {'I', 0x00005003},
+    [INSTR_OPC_SB] = {'S', 0x00000023},
+    [INSTR_OPC_SH] = {'S', 0x00001023},
+    [INSTR_OPC_SW] = {'S', 0x00002023},
+    [INSTR_OPC_ADDI] = {'I', 0x00000013},
+    [INSTR_OPC_SLTI] = {'I', 0x00002013},
+    [INSTR_OPC_SLTIU] = {'I', 0x00003013},
+    [INSTR_OPC_XORI] = {'I', 0x00004013},
+    [INSTR_OPC_ORI] = {'I', 0x00006013},
+    [INSTR_OPC_ANDI] = {'I', 0x00007013},
+    [INSTR_OPC_SLLI] = {'I', 0x00001013},
+    [INSTR_OPC_SRLI] = {'I', 0x00005013},
+    [INSTR_OPC_SRAI] = {'I', 0x40005013},
+    [INSTR_OPC_ADD] = {'R', 0x00000033},
+    [INSTR_OPC_SUB] = {'R', 0x40000033},
+    [INSTR_OPC_SLL] = {'R', 0x00001033},
+    [INSTR_OPC_SLT] = {'R', 0x00002033},
+    [INSTR_OPC_SLTU] = {'R', 0x00003033},
+    [INSTR_OPC_XOR] = {'R', 0x00004033},
+    [INSTR_OPC_SRL] = {'R', 0x00005033},
+    [INSTR_OPC_SRA] = {'R', 0x40005033},
+    [INSTR_OPC_OR] = {'R', 0x00006033},
+    [INSTR_OPC_AND] = {'R', 0x00007033},
+    [INSTR_OPC_ECALL] = {'I', 0x00000073},
+    [INSTR_OPC_EBREAK] = {'I', 0x00100073},
+    [INSTR_OPC_CSRRW] = {'I', 0x00001073},
+    [INSTR_OPC_CSRRS] = {'I', 0x00002073},
+    [INSTR_OPC_CSRRC] = {'I', 0x00003073},
+    [INSTR_OPC_CSRRWI] = {'I', 0x00005073},
+    [INSTR_OPC_CSRRSI] = {'I', 0x00006073},
+    [INSTR_OPC_CSRRCI] = {'I', 0x00007073},
+    [INSTR_OPC_MUL] = {'R', 0x02000033},
+    [INSTR_OPC_MULH] = {'R', 0x02001033},
+    [INSTR_OPC_MULHSU] = {'R', 0x02002033},
+    [INSTR_OPC_MULHU] = {'R', 0x02003033},
+    [INSTR_OPC_DIV] = {'R', 0x02004033},
+    [INSTR_OPC_DIVU] = {'R', 0x02005033},
+    [INSTR_OPC_REM] = {'R', 0x02006033},
+    [INSTR_OPC_REMU] = {'R', 0x02007033},
+    [INSTR_OPC_LR_W] = {'A', 0x1000202F},
+    [INSTR_OPC_SC_W] = {'A', 0x1800202F},
+    [INSTR_OPC_AMOSWAP_W] = {'A', 0x0800202F},
+    [INSTR_OPC_AMOADD_W] = {'A', 0x0000202F},
+    [INSTR_OPC_AMOXOR_W] = {'A', 0x2000202F},
+    [INSTR_OPC_AMOAND_W] = {'A', 0x6000202F},
+    [INSTR_OPC_AMOOR_W] = {'A', 0x4000202F},
+    [INSTR_OPC_AMOMIN_W] = {'A', 0x8000202F},
+    [INSTR_OPC_AMOMAX_W] = {'A', 0xA000202F},
+    [INSTR_OPC_AMOMINU_W] = {'A', 0xC000202F},
+    [INSTR_OPC_AMOMAXU_W] = {'A', 0xE000202F},
+};
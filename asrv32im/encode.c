@@ -6,68 +6,45 @@
 #define MASK(n)             (((uint32_t)1 << (uint32_t)(n)) - (uint32_t)1)
 #define SHIFT_MASK(x, a, b) (((uint32_t)(x) & MASK(b - a)) << a)
 
-#define ENC_OPCODE_CODE(x) (((x) << 2) | 3)
-#define ENC_OPCODE_LOAD    ENC_OPCODE_CODE(0x00)
-#define ENC_OPCODE_OPIMM   ENC_OPCODE_CODE(0x04)
-#define ENC_OPCODE_AUIPC   ENC_OPCODE_CODE(0x05)
-#define ENC_OPCODE_STORE   ENC_OPCODE_CODE(0x08)
-#define ENC_OPCODE_OP      ENC_OPCODE_CODE(0x0C)
-#define ENC_OPCODE_LUI     ENC_OPCODE_CODE(0x0D)
-#define ENC_OPCODE_BRANCH  ENC_OPCODE_CODE(0x18)
-#define ENC_OPCODE_JALR    ENC_OPCODE_CODE(0x19)
-#define ENC_OPCODE_JAL     ENC_OPCODE_CODE(0x1B)
-#define ENC_OPCODE_SYSTEM  ENC_OPCODE_CODE(0x1C)
-
 #define HI_20(x) ((((x) >> 12) + ((x) & 0x800 ? 1 : 0)) & 0xFFFFF)
 #define LO_12(x) ((x) & 0xFFF)
 
 
-static uint32_t encPackRFormat(
-    int opcode, int funct3, int funct7, int rd, int rs1, int rs2)
+/* The pack functions place the operands, the fixed bits of each
+ * instruction come from the tables generated from isa/rv32im.isa */
+static uint32_t encPackRFormat(int rd, int rs1, int rs2)
 {
   uint32_t res = 0;
-  res |= SHIFT_MASK(opcode, 0, 7);
   res |= SHIFT_MASK(rd, 7, 12);
-  res |= SHIFT_MASK(funct3, 12, 15);
   res |= SHIFT_MASK(rs1, 15, 20);
   res |= SHIFT_MASK(rs2, 20, 25);
-  res |= SHIFT_MASK(funct7, 25, 32);
   return res;
 }
 
-static uint32_t encPackIFormat(
-    int opcode, int funct3, int rd, int rs1, int32_t imm)
+static uint32_t encPackIFormat(int rd, int rs1, int32_t imm)
 {
   uint32_t res = 0;
-  res |= SHIFT_MASK(opcode, 0, 7);
   res |= SHIFT_MASK(rd, 7, 12);
-  res |= SHIFT_MASK(funct3, 12, 15);
   res |= SHIFT_MASK(rs1, 15, 20);
   res |= SHIFT_MASK(imm, 20, 32);
   return res;
 }
 
-static uint32_t encPackSFormat(
-    int opcode, int funct3, int rs1, int rs2, int32_t imm)
+static uint32_t encPackSFormat(int rs1, int rs2, int32_t imm)
 {
   uint32_t res = 0;
-  res |= SHIFT_MASK(opcode, 0, 7);
   res |= SHIFT_MASK(imm, 7, 12);
-  res |= SHIFT_MASK(funct3, 12, 15);
   res |= SHIFT_MASK(rs1, 15, 20);
   res |= SHIFT_MASK(rs2, 20, 25);
   res |= SHIFT_MASK(imm >> 5, 25, 32);
   return res;
 }
 
-static uint32_t encPackBFormat(
-    int opcode, int funct3, int rs1, int rs2, int32_t imm)
+static uint32_t encPackBFormat(int rs1, int rs2, int32_t imm)
 {
   uint32_t res = 0;
-  res |= SHIFT_MASK(opcode, 0, 7);
   res |= SHIFT_MASK(imm >> 11, 7, 8);
   res |= SHIFT_MASK(imm >> 1, 8, 12);
-  res |= SHIFT_MASK(funct3, 12, 15);
   res |= SHIFT_MASK(rs1, 15, 20);
   res |= SHIFT_MASK(rs2, 20, 25);
   res |= SHIFT_MASK(imm >> 5, 25, 31);
@@ -75,19 +52,17 @@ static uint32_t encPackBFormat(
   return res;
 }
 
-static uint32_t encPackUFormat(int opcode, int rd, int32_t imm)
+static uint32_t encPackUFormat(int rd, int32_t imm)
 {
   uint32_t res = 0;
-  res |= SHIFT_MASK(opcode, 0, 7);
   res |= SHIFT_MASK(rd, 7, 12);
   res |= SHIFT_MASK(imm, 12, 32);
   return res;
 }
 
-static uint32_t encPackJFormat(int opcode, int rd, int32_t imm)
+static uint32_t encPackJFormat(int rd, int32_t imm)
 {
   uint32_t res = 0;
-  res |= SHIFT_MASK(opcode, 0, 7);
   res |= SHIFT_MASK(rd, 7, 12);
   res |= SHIFT_MASK(imm >> 12, 12, 20);
   res |= SHIFT_MASK(imm >> 11, 20, 21);
@@ -97,107 +72,309 @@ static uint32_t encPackJFormat(int opcode, int rd, int32_t imm)
 }
 
 
+#define C_BITS(x, hi, lo, at) \
+  ((((uint32_t)(x) >> (lo)) & MASK((hi) - (lo) + 1)) << (at))
+#define C_OPCODE_Q0 0
+#define C_OPCODE_Q1 1
+#define C_OPCODE_Q2 2
+
+static bool encIsCReg(t_instrRegID reg)
+{
+  return reg >= 8 && reg < 16;
+}
+
+static bool encFitsSImm(int32_t x, int bits)
+{
+  return x >= -(1 << (bits - 1)) && x < (1 << (bits - 1));
+}
+
+static int32_t encSExt(int32_t x, int bits)
+{
+  uint32_t m = (uint32_t)1 << (bits - 1);
+  uint32_t v = (uint32_t)x & MASK(bits);
+  return (int32_t)((v ^ m) - m);
+}
+
+static uint16_t encPackCRFormat(int op, int funct4, int rd, int rs2)
+{
+  return (uint16_t)(SHIFT_MASK(op, 0, 2) | SHIFT_MASK(rs2, 2, 7) |
+      SHIFT_MASK(rd, 7, 12) | SHIFT_MASK(funct4, 12, 16));
+}
+
+static uint16_t encPackCIFormat(int op, int funct3, int rd, int32_t imm)
+{
+  return (uint16_t)(SHIFT_MASK(op, 0, 2) | C_BITS(imm, 4, 0, 2) |
+      SHIFT_MASK(rd, 7, 12) | C_BITS(imm, 5, 5, 12) |
+      SHIFT_MASK(funct3, 13, 16));
+}
+
+static uint16_t encPackCLSFormat(
+    int op, int funct3, int rs1, int rdRs2, int32_t imm)
+{
+  return (uint16_t)(SHIFT_MASK(op, 0, 2) | SHIFT_MASK(rdRs2 - 8, 2, 5) |
+      C_BITS(imm, 6, 6, 5) | C_BITS(imm, 2, 2, 6) |
+      SHIFT_MASK(rs1 - 8, 7, 10) | C_BITS(imm, 5, 3, 10) |
+      SHIFT_MASK(funct3, 13, 16));
+}
+
+static uint16_t encPackCAFormat(int funct2, int rd, int rs2)
+{
+  return (uint16_t)(SHIFT_MASK(C_OPCODE_Q1, 0, 2) |
+      SHIFT_MASK(rs2 - 8, 2, 5) | SHIFT_MASK(funct2, 5, 7) |
+      SHIFT_MASK(rd - 8, 7, 10) | SHIFT_MASK(3, 10, 12) |
+      SHIFT_MASK(4, 13, 16));
+}
+
+static uint16_t encPackCBFormat(int funct2, int rd, int32_t imm)
+{
+  return (uint16_t)(SHIFT_MASK(C_OPCODE_Q1, 0, 2) | C_BITS(imm, 4, 0, 2) |
+      SHIFT_MASK(rd - 8, 7, 10) | SHIFT_MASK(funct2, 10, 12) |
+      C_BITS(imm, 5, 5, 12) | SHIFT_MASK(4, 13, 16));
+}
+
+static uint16_t encPackCBranchFormat(int funct3, int rs1, int32_t imm)
+{
+  return (uint16_t)(SHIFT_MASK(C_OPCODE_Q1, 0, 2) | C_BITS(imm, 5, 5, 2) |
+      C_BITS(imm, 2, 1, 3) | C_BITS(imm, 7, 6, 5) |
+      SHIFT_MASK(rs1 - 8, 7, 10) | C_BITS(imm, 4, 3, 10) |
+      C_BITS(imm, 8, 8, 12) | SHIFT_MASK(funct3, 13, 16));
+}
+
+static uint16_t encPackCJFormat(int funct3, int32_t imm)
+{
+  return (uint16_t)(SHIFT_MASK(C_OPCODE_Q1, 0, 2) | C_BITS(imm, 5, 5, 2) |
+      C_BITS(imm, 3, 1, 3) | C_BITS(imm, 7, 7, 6) | C_BITS(imm, 6, 6, 7) |
+      C_BITS(imm, 10, 10, 8) | C_BITS(imm, 9, 8, 9) | C_BITS(imm, 4, 4, 11) |
+      C_BITS(imm, 11, 11, 12) | SHIFT_MASK(funct3, 13, 16));
+}
+
+/* Returns the RV32C encoding of a (non-pseudo) instruction if one exists for
+ * its operands. */
+static bool encPackCompressed(t_instruction instr, uint16_t *res)
+{
+  int rd = instr.dest, rs1 = instr.src1, rs2 = instr.src2;
+  int32_t imm = instr.constant;
+
+  switch (instr.opcode) {
+    case INSTR_OPC_ADDI:
+      imm = encSExt(imm, 12);
+      if (rd == 0 && rs1 == 0 && imm == 0) {
+        *res = encPackCIFormat(C_OPCODE_Q1, 0, 0, 0); // c.nop
+      } else if (rd == 2 && rs1 == 2 && imm != 0 && imm % 16 == 0 &&
+          encFitsSImm(imm, 10)) {
+        *res = (uint16_t)(SHIFT_MASK(C_OPCODE_Q1, 0, 2) |
+            C_BITS(imm, 5, 5, 2) | C_BITS(imm, 8, 7, 3) |
+            C_BITS(imm, 6, 6, 5) | C_BITS(imm, 4, 4, 6) |
+            SHIFT_MASK(2, 7, 12) | C_BITS(imm, 9, 9, 12) |
+            SHIFT_MASK(3, 13, 16)); // c.addi16sp
+      } else if (rs1 == 2 && encIsCReg(rd) && imm > 0 && imm % 4 == 0 &&
+          imm < 1024) {
+        *res = (uint16_t)(SHIFT_MASK(C_OPCODE_Q0, 0, 2) |
+            SHIFT_MASK(rd - 8, 2, 5) | C_BITS(imm, 3, 3, 5) |
+            C_BITS(imm, 2, 2, 6) | C_BITS(imm, 9, 6, 7) |
+            C_BITS(imm, 5, 4, 11)); // c.addi4spn
+      } else if (rd != 0 && rs1 == 0 && encFitsSImm(imm, 6)) {
+        *res = encPackCIFormat(C_OPCODE_Q1, 2, rd, imm); // c.li
+      } else if (rd != 0 && rd == rs1 && imm != 0 && encFitsSImm(imm, 6)) {
+        *res = encPackCIFormat(C_OPCODE_Q1, 0, rd, imm); // c.addi
+      } else if (rd != 0 && rs1 != 0 && imm == 0) {
+        *res = encPackCRFormat(C_OPCODE_Q2, 8, rd, rs1); // c.mv
+      } else
+        return false;
+      return true;
+
+    case INSTR_OPC_ADD:
+      if (rd == 0)
+        return false;
+      if (rd == rs1 && rs2 != 0)
+        *res = encPackCRFormat(C_OPCODE_Q2, 9, rd, rs2); // c.add
+      else if (rd == rs2 && rs1 != 0)
+        *res = encPackCRFormat(C_OPCODE_Q2, 9, rd, rs1); // c.add
+      else if (rs1 == 0 && rs2 != 0)
+        *res = encPackCRFormat(C_OPCODE_Q2, 8, rd, rs2); // c.mv
+      else if (rs2 == 0 && rs1 != 0)
+        *res = encPackCRFormat(C_OPCODE_Q2, 8, rd, rs1); // c.mv
+      else
+        return false;
+      return true;
+
+    case INSTR_OPC_SUB:
+    case INSTR_OPC_XOR:
+    case INSTR_OPC_OR:
+    case INSTR_OPC_AND:
+      if (instr.opcode != INSTR_OPC_SUB && rd == rs2) {
+        rs2 = rs1;
+        rs1 = rd;
+      }
+      if (rd != rs1 || !encIsCReg(rd) || !encIsCReg(rs2))
+        return false;
+      if (instr.opcode == INSTR_OPC_SUB)
+        *res = encPackCAFormat(0, rd, rs2);
+      else if (instr.opcode == INSTR_OPC_XOR)
+        *res = encPackCAFormat(1, rd, rs2);
+      else if (instr.opcode == INSTR_OPC_OR)
+        *res = encPackCAFormat(2, rd, rs2);
+      else
+        *res = encPackCAFormat(3, rd, rs2);
+      return true;
+
+    case INSTR_OPC_SLLI:
+      if (rd == 0 || rd != rs1 || imm == 0)
+        return false;
+      *res = encPackCIFormat(C_OPCODE_Q2, 0, rd, imm);
+      return true;
+
+    case INSTR_OPC_SRLI:
+    case INSTR_OPC_SRAI:
+      if (!encIsCReg(rd) || rd != rs1 || imm == 0)
+        return false;
+      *res = encPackCBFormat(instr.opcode == INSTR_OPC_SRLI ? 0 : 1, rd, imm);
+      return true;
+
+    case INSTR_OPC_ANDI:
+      imm = encSExt(imm, 12);
+      if (!encIsCReg(rd) || rd != rs1 || !encFitsSImm(imm, 6))
+        return false;
+      *res = encPackCBFormat(2, rd, imm);
+      return true;
+
+    case INSTR_OPC_LUI:
+      imm = encSExt(imm, 20);
+      if (rd == 0 || rd == 2 || imm == 0 || !encFitsSImm(imm, 6))
+        return false;
+      *res = encPackCIFormat(C_OPCODE_Q1, 3, rd, imm);
+      return true;
+
+    case INSTR_OPC_LW:
+    case INSTR_OPC_SW:
+      imm = encSExt(imm, 12);
+      if (imm < 0 || imm % 4 != 0)
+        return false;
+      if (instr.opcode == INSTR_OPC_LW)
+        rs2 = rd;
+      if (rs1 == 2 && imm < 256) {
+        if (instr.opcode == INSTR_OPC_LW && rd == 0)
+          return false;
+        if (instr.opcode == INSTR_OPC_LW)
+          *res = (uint16_t)(SHIFT_MASK(C_OPCODE_Q2, 0, 2) |
+              C_BITS(imm, 7, 6, 2) | C_BITS(imm, 4, 2, 4) |
+              SHIFT_MASK(rd, 7, 12) | C_BITS(imm, 5, 5, 12) |
+              SHIFT_MASK(2, 13, 16)); // c.lwsp
+        else
+          *res = (uint16_t)(SHIFT_MASK(C_OPCODE_Q2, 0, 2) |
+              SHIFT_MASK(rs2, 2, 7) | C_BITS(imm, 7, 6, 7) |
+              C_BITS(imm, 5, 2, 9) | SHIFT_MASK(6, 13, 16)); // c.swsp
+      } else if (encIsCReg(rs1) && encIsCReg(rs2) && imm < 128) {
+        *res = encPackCLSFormat(
+            C_OPCODE_Q0, instr.opcode == INSTR_OPC_LW ? 2 : 6, rs1, rs2, imm);
+      } else
+        return false;
+      return true;
+
+    case INSTR_OPC_JAL:
+      if ((rd != 0 && rd != 1) || imm % 2 != 0 || !encFitsSImm(imm, 12))
+        return false;
+      *res = encPackCJFormat(rd == 0 ? 5 : 1, imm);
+      return true;
+
+    case INSTR_OPC_JALR:
+      if ((rd != 0 && rd != 1) || rs1 == 0 || imm != 0)
+        return false;
+      *res = encPackCRFormat(C_OPCODE_Q2, rd == 0 ? 8 : 9, rs1, 0);
+      return true;
+
+    case INSTR_OPC_BEQ:
+    case INSTR_OPC_BNE:
+      if (rs1 == 0)
+        rs1 = rs2;
+      else if (rs2 != 0)
+        return false;
+      if (!encIsCReg(rs1) || imm % 2 != 0 || !encFitsSImm(imm, 9))
+        return false;
+      *res = encPackCBranchFormat(
+          instr.opcode == INSTR_OPC_BEQ ? 6 : 7, rs1, imm);
+      return true;
+
+    case INSTR_OPC_EBREAK:
+      *res = encPackCRFormat(C_OPCODE_Q2, 9, 0, 0);
+      return true;
+  }
+  return false;
+}
+
+bool encCanCompress(t_instruction instr, uint32_t pc)
+{
+  uint16_t tmp;
+
+  if (instr.immMode == INSTR_IMM_LBL) {
+    if (!objLabelGetPointedItem(instr.label))
+      return false;
+    instr.constant = (int32_t)(objLabelGetPointer(instr.label) - pc);
+  } else if (instr.immMode != INSTR_IMM_CONST)
+    return false;
+  return encPackCompressed(instr, &tmp);
+}
+
 size_t encGetInstrLength(t_instruction instr)
 {
-  return 4;
+  return instr.compressed ? 2 : 4;
 }
 
 
 typedef struct t_encInstrData {
-  t_instrOpcode instID;
   char type;
-  int opcode;
-  int funct3;
-  int funct7; // also used for immediates
+  uint32_t match; // opcode, funct3 and the other fixed bits
 } t_encInstrData;
 
+#include "encode_gen.h"
+
 bool encPhysicalInstruction(t_instruction instr, uint32_t pc, t_data *res)
 {
-  static const t_encInstrData opInstData[] = {
-      {   INSTR_OPC_ADD, 'R',     ENC_OPCODE_OP,  0,      0x00},
-      {   INSTR_OPC_SUB, 'R',     ENC_OPCODE_OP,  0,      0x20},
-      {   INSTR_OPC_SLL, 'R',     ENC_OPCODE_OP,  1,      0x00},
-      {   INSTR_OPC_SLT, 'R',     ENC_OPCODE_OP,  2,      0x00},
-      {  INSTR_OPC_SLTU, 'R',     ENC_OPCODE_OP,  3,      0x00},
-      {   INSTR_OPC_XOR, 'R',     ENC_OPCODE_OP,  4,      0x00},
-      {   INSTR_OPC_SRL, 'R',     ENC_OPCODE_OP,  5,      0x00},
-      {   INSTR_OPC_SRA, 'R',     ENC_OPCODE_OP,  5,      0x20},
-      {    INSTR_OPC_OR, 'R',     ENC_OPCODE_OP,  6,      0x00},
-      {   INSTR_OPC_AND, 'R',     ENC_OPCODE_OP,  7,      0x00},
-      {   INSTR_OPC_MUL, 'R',     ENC_OPCODE_OP,  0,      0x01},
-      {  INSTR_OPC_MULH, 'R',     ENC_OPCODE_OP,  1,      0x01},
-      {INSTR_OPC_MULHSU, 'R',     ENC_OPCODE_OP,  2,      0x01},
-      { INSTR_OPC_MULHU, 'R',     ENC_OPCODE_OP,  3,      0x01},
-      {   INSTR_OPC_DIV, 'R',     ENC_OPCODE_OP,  4,      0x01},
-      {  INSTR_OPC_DIVU, 'R',     ENC_OPCODE_OP,  5,      0x01},
-      {   INSTR_OPC_REM, 'R',     ENC_OPCODE_OP,  6,      0x01},
-      {  INSTR_OPC_REMU, 'R',     ENC_OPCODE_OP,  7,      0x01},
-      {  INSTR_OPC_ADDI, 'I',  ENC_OPCODE_OPIMM,  0, 0x00 << 5},
-      {  INSTR_OPC_SLLI, 'I',  ENC_OPCODE_OPIMM,  1, 0x00 << 5},
-      {  INSTR_OPC_SLTI, 'I',  ENC_OPCODE_OPIMM,  2, 0x00 << 5},
-      { INSTR_OPC_SLTIU, 'I',  ENC_OPCODE_OPIMM,  3, 0x00 << 5},
-      {  INSTR_OPC_XORI, 'I',  ENC_OPCODE_OPIMM,  4, 0x00 << 5},
-      {  INSTR_OPC_SRLI, 'I',  ENC_OPCODE_OPIMM,  5, 0x00 << 5},
-      {  INSTR_OPC_SRAI, 'I',  ENC_OPCODE_OPIMM,  5, 0x20 << 5},
-      {   INSTR_OPC_ORI, 'I',  ENC_OPCODE_OPIMM,  6, 0x00 << 5},
-      {  INSTR_OPC_ANDI, 'I',  ENC_OPCODE_OPIMM,  7, 0x00 << 5},
-      {    INSTR_OPC_LB, 'I',   ENC_OPCODE_LOAD,  0, 0x00 << 5},
-      {    INSTR_OPC_LH, 'I',   ENC_OPCODE_LOAD,  1, 0x00 << 5},
-      {    INSTR_OPC_LW, 'I',   ENC_OPCODE_LOAD,  2, 0x00 << 5},
-      {   INSTR_OPC_LBU, 'I',   ENC_OPCODE_LOAD,  4, 0x00 << 5},
-      {   INSTR_OPC_LHU, 'I',   ENC_OPCODE_LOAD,  5, 0x00 << 5},
-      {   INSTR_OPC_LUI, 'U',    ENC_OPCODE_LUI,  0,         0},
-      { INSTR_OPC_AUIPC, 'U',  ENC_OPCODE_AUIPC,  0,         0},
-      {    INSTR_OPC_SB, 'S',  ENC_OPCODE_STORE,  0, 0x00 << 5},
-      {    INSTR_OPC_SH, 'S',  ENC_OPCODE_STORE,  1, 0x00 << 5},
-      {    INSTR_OPC_SW, 'S',  ENC_OPCODE_STORE,  2, 0x00 << 5},
-      {   INSTR_OPC_JAL, 'J',    ENC_OPCODE_JAL,  0,         0},
-      {  INSTR_OPC_JALR, 'I',   ENC_OPCODE_JALR,  0,         0},
-      {   INSTR_OPC_BEQ, 'B', ENC_OPCODE_BRANCH,  0,         0},
-      {   INSTR_OPC_BNE, 'B', ENC_OPCODE_BRANCH,  1,         0},
-      {   INSTR_OPC_BLT, 'B', ENC_OPCODE_BRANCH,  4,         0},
-      {   INSTR_OPC_BGE, 'B', ENC_OPCODE_BRANCH,  5,         0},
-      {  INSTR_OPC_BLTU, 'B', ENC_OPCODE_BRANCH,  6,         0},
-      {  INSTR_OPC_BGEU, 'B', ENC_OPCODE_BRANCH,  7,         0},
-      { INSTR_OPC_ECALL, 'I', ENC_OPCODE_SYSTEM,  0,         0},
-      {INSTR_OPC_EBREAK, 'I', ENC_OPCODE_SYSTEM,  0,         1},
-      {              -1,  -1,                -1, -1,        -1}
-  };
   const t_encInstrData *info;
   uint32_t buf;
-
-  for (info = opInstData; info->instID != -1; info++) {
-    if (info->instID == instr.opcode)
-      break;
+  uint16_t cbuf;
+
+  if (instr.compressed) {
+    bool ok = encPackCompressed(instr, &cbuf);
+    assert(ok && "instruction does not fit the compressed encoding");
+    res->initialized = 1;
+    res->dataSize = 2;
+    res->data[0] = cbuf & 0xFF;
+    res->data[1] = (cbuf >> 8) & 0xFF;
+    return true;
   }
-  assert(info->instID != -1);
+
+  assert((size_t)instr.opcode < sizeof(encInstrData) / sizeof(encInstrData[0]));
+  info = &encInstrData[instr.opcode];
 
   switch (info->type) {
     case 'R':
-      buf = encPackRFormat(info->opcode, info->funct3, info->funct7, instr.dest,
-          instr.src1, instr.src2);
+      buf = encPackRFormat(instr.dest, instr.src1, instr.src2);
+      break;
+    case 'A':
+      // aq and rl are the two lowest bits of funct7
+      buf = encPackRFormat(instr.dest, instr.src1, instr.src2) |
+          SHIFT_MASK(instr.constant, 25, 27);
       break;
     case 'I':
-      buf = encPackIFormat(info->opcode, info->funct3, instr.dest, instr.src1,
-          instr.constant | info->funct7);
+      buf = encPackIFormat(instr.dest, instr.src1, instr.constant);
       break;
     case 'S':
-      buf = encPackSFormat(info->opcode, info->funct3, instr.src1, instr.src2,
-          instr.constant | info->funct7);
+      buf = encPackSFormat(instr.src1, instr.src2, instr.constant);
       break;
     case 'B':
-      buf = encPackBFormat(
-          info->opcode, info->funct3, instr.src1, instr.src2, instr.constant);
+      buf = encPackBFormat(instr.src1, instr.src2, instr.constant);
       break;
     case 'U':
-      buf = encPackUFormat(info->opcode, instr.dest, instr.constant);
+      buf = encPackUFormat(instr.dest, instr.constant);
       break;
     case 'J':
-      buf = encPackJFormat(info->opcode, instr.dest, instr.constant);
+      buf = encPackJFormat(instr.dest, instr.constant);
       break;
     default:
       assert(0 && "invalid instruction encoding type");
   }
+  buf |= info->match;
 
   res->initialized = 1;
   res->dataSize = 4;
@@ -350,6 +527,34 @@ int encExpandPseudoInstruction(
       mInstSz++;
       break;
 
+    case INSTR_OPC_CSRR:
+      mInstBuf[mInstSz].constant = instr.constant;
+      goto all_csr_reads;
+    case INSTR_OPC_RDCYCLE:
+      mInstBuf[mInstSz].constant = 0xC00;
+      goto all_csr_reads;
+    case INSTR_OPC_RDTIME:
+      mInstBuf[mInstSz].constant = 0xC01;
+      goto all_csr_reads;
+    case INSTR_OPC_RDINSTRET:
+      mInstBuf[mInstSz].constant = 0xC02;
+      goto all_csr_reads;
+    case INSTR_OPC_RDCYCLEH:
+      mInstBuf[mInstSz].constant = 0xC80;
+      goto all_csr_reads;
+    case INSTR_OPC_RDTIMEH:
+      mInstBuf[mInstSz].constant = 0xC81;
+      goto all_csr_reads;
+    case INSTR_OPC_RDINSTRETH:
+      mInstBuf[mInstSz].constant = 0xC82;
+    all_csr_reads:
+      mInstBuf[mInstSz].opcode = INSTR_OPC_CSRRS;
+      mInstBuf[mInstSz].dest = instr.dest;
+      mInstBuf[mInstSz].src1 = 0;
+      mInstBuf[mInstSz].immMode = INSTR_IMM_CONST;
+      mInstSz++;
+      break;
+
     case INSTR_OPC_J:
       mInstBuf[mInstSz].opcode = INSTR_OPC_JAL;
       mInstBuf[mInstSz].dest = 0;
@@ -362,8 +567,11 @@ int encExpandPseudoInstruction(
       mInstBuf[mInstSz++] = instr;
   }
 
-  for (int i = 0; i < mInstSz; i++)
+  for (int i = 0; i < mInstSz; i++) {
     mInstBuf[i].location = instr.location;
+    mInstBuf[i].srcFile = instr.srcFile;
+    mInstBuf[i].srcLine = instr.srcLine;
+  }
   return mInstSz;
 }
 
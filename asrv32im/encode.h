@@ -8,6 +8,7 @@
 
 #define MAX_EXP_FACTOR 2
 
+bool encCanCompress(t_instruction instr, uint32_t pc);
 size_t encGetInstrLength(t_instruction instr);
 int encExpandPseudoInstruction(
     t_instruction instr, t_instruction res[MAX_EXP_FACTOR]);
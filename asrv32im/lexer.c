@@ -4,65 +4,91 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "lexer.h"
 #include "errors.h"
+#include "arena.h"
+
+#define LEX_CHUNK_SIZE 65536
 
 struct t_lexer {
+  // Holds the values of identifier and string tokens
+  t_arena *arena;
   char *buf;
   size_t bufSize;
+  // Size of the mapping of the input file, or zero if it was read instead
+  size_t mapSize;
+  // Streamed input, read in chunks of whole lines up to `lineEnd'. At the
+  // end of the input, and for mapped files, `lineEnd' is past the buffer.
+  int fd;
+  size_t bufCapacity;
+  char *lineEnd;
   char *nextTokenPtr;
   t_fileLocation nextTokenLoc;
   char *lookahead;
 };
 
 
-static char *lexRangeToString(const char *begin, const char *end)
+/* Maps the input file read-only, followed by at least one zero byte which
+ * terminates the buffer. */
+static char *lexMapFile(int fd, size_t fileSize, size_t *mapSize)
 {
-  size_t len = (size_t)(end - begin);
-  char *res = malloc(len + 1);
-  if (!res)
-    fatalError("out of memory");
-  memcpy(res, begin, len);
-  res[len] = '\0';
-  return res;
+  size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+  *mapSize = (fileSize + pageSize) & ~(pageSize - 1);
+  char *map = mmap(
+      NULL, *mapSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED)
+    return NULL;
+  // The rest of the last page of the file reads as zeros
+  if (mmap(map, fileSize, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) ==
+      MAP_FAILED) {
+    munmap(map, *mapSize);
+    return NULL;
+  }
+  return map;
 }
 
-
 t_lexer *newLexer(const char *fn)
 {
   t_lexer *lex = calloc(1, sizeof(t_lexer));
   if (!lex)
     fatalError("out of memory");
 
-  FILE *fp = fopen(fn, "r");
-  if (fp == NULL) {
+  // Regular files are mapped, the standard input (`-') and pipes are
+  // streamed
+  bool isStdin = strcmp(fn, "-") == 0;
+  int fd = isStdin ? STDIN_FILENO : open(fn, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) < 0) {
+    if (fd >= 0 && !isStdin)
+      close(fd);
     free(lex);
     return NULL;
   }
-  fseek(fp, 0, SEEK_END);
-  long fileSize = ftell(fp);
-  if (fileSize < 0) {
-    free(lex);
-    return NULL;
-  }
-  fseek(fp, 0, SEEK_SET);
-
-  if (fileSize == 0) {
-    lex->buf = strdup("");
+  lex->fd = -1;
+  if (S_ISREG(st.st_mode) && st.st_size > 0)
+    lex->buf = lexMapFile(fd, (size_t)st.st_size, &lex->mapSize);
+  if (lex->buf) {
+    lex->bufSize = (size_t)st.st_size;
+    if (!isStdin)
+      close(fd);
   } else {
-    lex->buf = malloc(fileSize + 1);
-    if (lex->buf) {
-      size_t readSz = fread(lex->buf, 1, fileSize, fp);
-      lex->buf[readSz] = '\0';
-      lex->bufSize = readSz;
-    }
+    lex->fd = fd;
+    lex->bufCapacity = LEX_CHUNK_SIZE + 1;
+    lex->buf = malloc(lex->bufCapacity);
+    if (!lex->buf)
+      fatalError("out of memory");
+    lex->buf[0] = '\0';
   }
-  if (!lex->buf)
-    fatalError("out of memory");
-  fclose(fp);
+  lex->lineEnd = lex->fd < 0 ? lex->buf + lex->bufSize + 1 : lex->buf;
 
+  lex->arena = newArena();
   lex->nextTokenPtr = lex->buf;
-  lex->nextTokenLoc.file = strdup(fn);
+  lex->nextTokenLoc.file = strdup(isStdin ? "<stdin>" : fn);
   if (!lex->nextTokenLoc.file)
     fatalError("out of memory");
   lex->nextTokenLoc.row = 0;
@@ -75,7 +101,13 @@ void deleteLexer(t_lexer *lex)
 {
   if (lex == NULL)
     return;
-  free(lex->buf);
+  deleteArena(lex->arena);
+  if (lex->mapSize)
+    munmap(lex->buf, lex->mapSize);
+  else
+    free(lex->buf);
+  if (lex->fd > STDIN_FILENO)
+    close(lex->fd);
   free(lex->nextTokenLoc.file);
   free(lex);
 }
@@ -142,6 +174,21 @@ static bool lexIdentEquals(t_lexer *lex, const char *str)
   return *str == '\0';
 }
 
+static bool lexIdentEndsWith(t_lexer *lex, const char *str)
+{
+  size_t len = strlen(str);
+  if ((size_t)(lex->lookahead - lex->nextTokenPtr) <= len)
+    return false;
+  char *p = lex->lookahead - len;
+  while (*str != '\0') {
+    if (toupper(*p) != toupper(*str))
+      return false;
+    p++;
+    str++;
+  }
+  return true;
+}
+
 
 static void lexAdvance(t_lexer *lex)
 {
@@ -159,35 +206,77 @@ static void lexAdvance(t_lexer *lex)
   }
 }
 
-static t_token *createToken(t_lexer *lex, t_tokenID id)
+static t_token createToken(t_lexer *lex, t_tokenID id)
 {
-  t_token *tok = calloc(1, sizeof(t_token));
-  if (!tok)
-    fatalError("out of memory");
-
-  tok->location = lex->nextTokenLoc;
-  tok->id = id;
-  tok->begin = lex->nextTokenPtr;
-  tok->end = lex->lookahead;
+  t_token tok = {0};
+  tok.location = lex->nextTokenLoc;
+  tok.id = id;
+  tok.begin = lex->nextTokenPtr;
+  tok.end = lex->lookahead;
   lexAdvance(lex);
   return tok;
 }
 
-void deleteToken(t_token *tok)
+
+/* Reads the next chunk of streamed input after the line of the lookahead,
+ * discarding the characters before the next token. */
+static void lexReadChunk(t_lexer *lex)
+{
+  size_t done = (size_t)(lex->nextTokenPtr - lex->buf);
+  size_t lookahead = (size_t)(lex->lookahead - lex->nextTokenPtr);
+  size_t keep = lex->bufSize - done;
+  memmove(lex->buf, lex->nextTokenPtr, keep);
+  if (lex->bufCapacity < keep + LEX_CHUNK_SIZE + 1) {
+    lex->bufCapacity = (keep + LEX_CHUNK_SIZE + 1) * 2;
+    lex->buf = realloc(lex->buf, lex->bufCapacity);
+    if (!lex->buf)
+      fatalError("out of memory");
+  }
+  lex->bufSize = keep;
+  lex->nextTokenPtr = lex->buf;
+  lex->lookahead = lex->buf + lookahead;
+
+  ssize_t n;
+  do {
+    n = read(lex->fd, lex->buf + keep, LEX_CHUNK_SIZE);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0)
+    fatalError("could not read input file");
+  lex->bufSize += (size_t)n;
+  lex->buf[lex->bufSize] = '\0';
+
+  if (n == 0) {
+    if (lex->fd > STDIN_FILENO)
+      close(lex->fd);
+    lex->fd = -1;
+    lex->lineEnd = lex->buf + lex->bufSize + 1;
+    return;
+  }
+  char *p = lex->buf + lex->bufSize;
+  while (p > lex->buf + keep && p[-1] != '\n')
+    p--;
+  lex->lineEnd = p > lex->buf + keep ? p : lex->buf;
+}
+
+/* Makes sure that the whole line of the lookahead is in the buffer, so that
+ * no token is split between two chunks. Only called between tokens. */
+static void lexFillLine(t_lexer *lex)
 {
-  if (!tok)
+  if (lex->lookahead < lex->lineEnd)
     return;
-  if (tok->id == TOK_ID)
-    free(tok->value.id);
-  else if (tok->id == TOK_STRING || tok->id == TOK_CHARACTER)
-    free(tok->value.string);
+  lexAdvance(lex);
+  while (lex->lookahead >= lex->lineEnd)
+    lexReadChunk(lex);
 }
 
 
 static void lexSkipWhitespaceAndComments(t_lexer *lex)
 {
   int state = 0;
-  while (state != -1 && *lex->lookahead != '\0') {
+  while (state != -1) {
+    lexFillLine(lex);
+    if (*lex->lookahead == '\0')
+      break;
     if (state == 0) {
       // normal whitespace
       if (!lexAcceptSet(lex, "\t ")) {
@@ -233,7 +322,7 @@ static void lexSkipWhitespaceAndComments(t_lexer *lex)
 }
 
 
-static t_token *lexExpectUnrecognized(t_lexer *lex)
+static t_token lexExpectUnrecognized(t_lexer *lex)
 {
   assert(*lex->lookahead);
   // Accept at least one character otherwise the lexer gets stuck
@@ -290,7 +379,7 @@ static t_strToIntErr lexStringToU32(char **next, int base, uint32_t *res)
   return STRTOI_OK;
 }
 
-static t_token *lexExpectNumberOrLocalRef(t_lexer *lex)
+static t_token lexExpectNumberOrLocalRef(t_lexer *lex)
 {
   bool negative = lexAcceptSet(lex, "+-") == '-';
   bool decimal = false;
@@ -323,18 +412,18 @@ static t_token *lexExpectNumberOrLocalRef(t_lexer *lex)
       emitError(lex->nextTokenLoc, "local label ID too large");
       return lexExpectUnrecognized(lex);
     }
-    t_token *res = createToken(lex, TOK_LOCAL_REF);
-    res->value.localRef = direction == 'b' ? -(int32_t)value : value;
+    t_token res = createToken(lex, TOK_LOCAL_REF);
+    res.value.localRef = direction == 'b' ? -(int32_t)value : value;
     return res;
   }
 
-  t_token *res = createToken(lex, TOK_NUMBER);
-  res->value.number = negative ? -(int32_t)value : value;
+  t_token res = createToken(lex, TOK_NUMBER);
+  res.value.number = negative ? -(int32_t)value : value;
   return res;
 }
 
 
-static t_token *lexExpectCharacterOrString(t_lexer *lex)
+static t_token lexExpectCharacterOrString(t_lexer *lex)
 {
   char delimiter = lexAcceptSet(lex, "'\"");
   if (!delimiter)
@@ -354,14 +443,15 @@ static t_token *lexExpectCharacterOrString(t_lexer *lex)
     emitError(lex->nextTokenLoc, "string not properly terminated");
     return lexExpectUnrecognized(lex);
   }
-  t_token *res =
+  t_token res =
       createToken(lex, delimiter == '\'' ? TOK_CHARACTER : TOK_STRING);
-  res->value.string = lexRangeToString(res->begin + 1, res->end - 1);
+  res.value.string = arenaStrndup(
+      lex->arena, res.begin + 1, (size_t)(res.end - res.begin - 2));
   return res;
 }
 
 
-static t_token *lexExpectDirective(t_lexer *lex)
+static t_token lexExpectDirective(t_lexer *lex)
 {
   if (!lexAcceptChar(lex, '.'))
     return lexExpectUnrecognized(lex);
@@ -387,12 +477,16 @@ static t_token *lexExpectDirective(t_lexer *lex)
     return createToken(lex, TOK_BALIGN);
   if (lexIdentEquals(lex, ".global"))
     return createToken(lex, TOK_GLOBAL);
+  if (lexIdentEquals(lex, ".file"))
+    return createToken(lex, TOK_FILE);
+  if (lexIdentEquals(lex, ".loc"))
+    return createToken(lex, TOK_LOC);
 
   return lexExpectUnrecognized(lex);
 }
 
 
-static t_token *lexExpectAddressing(t_lexer *lex)
+static t_token lexExpectAddressing(t_lexer *lex)
 {
   if (!lexAcceptChar(lex, '%'))
     return lexExpectUnrecognized(lex);
@@ -417,160 +511,261 @@ typedef struct t_keywordData {
   int32_t info;
 } t_keywordData;
 
-static t_token *lexExpectIdentifierOrKeyword(t_lexer *lex)
+static const t_keywordData lexKeywords[] = {
+    {        "x0",     TOK_REGISTER,                    0},
+    {        "x1",     TOK_REGISTER,                    1},
+    {        "x2",     TOK_REGISTER,                    2},
+    {        "x3",     TOK_REGISTER,                    3},
+    {        "x4",     TOK_REGISTER,                    4},
+    {        "x5",     TOK_REGISTER,                    5},
+    {        "x6",     TOK_REGISTER,                    6},
+    {        "x7",     TOK_REGISTER,                    7},
+    {        "x8",     TOK_REGISTER,                    8},
+    {        "x9",     TOK_REGISTER,                    9},
+    {       "x10",     TOK_REGISTER,                   10},
+    {       "x11",     TOK_REGISTER,                   11},
+    {       "x12",     TOK_REGISTER,                   12},
+    {       "x13",     TOK_REGISTER,                   13},
+    {       "x14",     TOK_REGISTER,                   14},
+    {       "x15",     TOK_REGISTER,                   15},
+    {       "x16",     TOK_REGISTER,                   16},
+    {       "x17",     TOK_REGISTER,                   17},
+    {       "x18",     TOK_REGISTER,                   18},
+    {       "x19",     TOK_REGISTER,                   19},
+    {       "x20",     TOK_REGISTER,                   20},
+    {       "x21",     TOK_REGISTER,                   21},
+    {       "x22",     TOK_REGISTER,                   22},
+    {       "x23",     TOK_REGISTER,                   23},
+    {       "x24",     TOK_REGISTER,                   24},
+    {       "x25",     TOK_REGISTER,                   25},
+    {       "x26",     TOK_REGISTER,                   26},
+    {       "x27",     TOK_REGISTER,                   27},
+    {       "x28",     TOK_REGISTER,                   28},
+    {       "x29",     TOK_REGISTER,                   29},
+    {       "x30",     TOK_REGISTER,                   30},
+    {       "x31",     TOK_REGISTER,                   31},
+    {      "zero",     TOK_REGISTER,                    0},
+    {        "ra",     TOK_REGISTER,                    1},
+    {        "sp",     TOK_REGISTER,                    2},
+    {        "gp",     TOK_REGISTER,                    3},
+    {        "tp",     TOK_REGISTER,                    4},
+    {        "t0",     TOK_REGISTER,                    5},
+    {        "t1",     TOK_REGISTER,                    6},
+    {        "t2",     TOK_REGISTER,                    7},
+    {        "s0",     TOK_REGISTER,                    8},
+    {        "fp",     TOK_REGISTER,                    8},
+    {        "s1",     TOK_REGISTER,                    9},
+    {        "a0",     TOK_REGISTER,                   10},
+    {        "a1",     TOK_REGISTER,                   11},
+    {        "a2",     TOK_REGISTER,                   12},
+    {        "a3",     TOK_REGISTER,                   13},
+    {        "a4",     TOK_REGISTER,                   14},
+    {        "a5",     TOK_REGISTER,                   15},
+    {        "a6",     TOK_REGISTER,                   16},
+    {        "a7",     TOK_REGISTER,                   17},
+    {        "s2",     TOK_REGISTER,                   18},
+    {        "s3",     TOK_REGISTER,                   19},
+    {        "s4",     TOK_REGISTER,                   20},
+    {        "s5",     TOK_REGISTER,                   21},
+    {        "s6",     TOK_REGISTER,                   22},
+    {        "s7",     TOK_REGISTER,                   23},
+    {        "s8",     TOK_REGISTER,                   24},
+    {        "s9",     TOK_REGISTER,                   25},
+    {       "s10",     TOK_REGISTER,                   26},
+    {       "s11",     TOK_REGISTER,                   27},
+    {        "t3",     TOK_REGISTER,                   28},
+    {        "t4",     TOK_REGISTER,                   29},
+    {        "t5",     TOK_REGISTER,                   30},
+    {        "t6",     TOK_REGISTER,                   31},
+    {       "add",     TOK_MNEMONIC,        INSTR_OPC_ADD},
+    {       "sub",     TOK_MNEMONIC,        INSTR_OPC_SUB},
+    {       "xor",     TOK_MNEMONIC,        INSTR_OPC_XOR},
+    {        "or",     TOK_MNEMONIC,         INSTR_OPC_OR},
+    {       "and",     TOK_MNEMONIC,        INSTR_OPC_AND},
+    {       "sll",     TOK_MNEMONIC,        INSTR_OPC_SLL},
+    {       "srl",     TOK_MNEMONIC,        INSTR_OPC_SRL},
+    {       "sra",     TOK_MNEMONIC,        INSTR_OPC_SRA},
+    {       "slt",     TOK_MNEMONIC,        INSTR_OPC_SLT},
+    {      "sltu",     TOK_MNEMONIC,       INSTR_OPC_SLTU},
+    {       "mul",     TOK_MNEMONIC,        INSTR_OPC_MUL},
+    {      "mulh",     TOK_MNEMONIC,       INSTR_OPC_MULH},
+    {    "mulhsu",     TOK_MNEMONIC,     INSTR_OPC_MULHSU},
+    {     "mulhu",     TOK_MNEMONIC,      INSTR_OPC_MULHU},
+    {       "div",     TOK_MNEMONIC,        INSTR_OPC_DIV},
+    {      "divu",     TOK_MNEMONIC,       INSTR_OPC_DIVU},
+    {       "rem",     TOK_MNEMONIC,        INSTR_OPC_REM},
+    {      "remu",     TOK_MNEMONIC,       INSTR_OPC_REMU},
+    {      "addi",     TOK_MNEMONIC,       INSTR_OPC_ADDI},
+    {      "xori",     TOK_MNEMONIC,       INSTR_OPC_XORI},
+    {       "ori",     TOK_MNEMONIC,        INSTR_OPC_ORI},
+    {      "andi",     TOK_MNEMONIC,       INSTR_OPC_ANDI},
+    {      "slli",     TOK_MNEMONIC,       INSTR_OPC_SLLI},
+    {      "srli",     TOK_MNEMONIC,       INSTR_OPC_SRLI},
+    {      "srai",     TOK_MNEMONIC,       INSTR_OPC_SRAI},
+    {      "slti",     TOK_MNEMONIC,       INSTR_OPC_SLTI},
+    {     "sltiu",     TOK_MNEMONIC,      INSTR_OPC_SLTIU},
+    {        "lb",     TOK_MNEMONIC,         INSTR_OPC_LB},
+    {        "lh",     TOK_MNEMONIC,         INSTR_OPC_LH},
+    {        "lw",     TOK_MNEMONIC,         INSTR_OPC_LW},
+    {       "lbu",     TOK_MNEMONIC,        INSTR_OPC_LBU},
+    {       "lhu",     TOK_MNEMONIC,        INSTR_OPC_LHU},
+    {        "sb",     TOK_MNEMONIC,         INSTR_OPC_SB},
+    {        "sh",     TOK_MNEMONIC,         INSTR_OPC_SH},
+    {        "sw",     TOK_MNEMONIC,         INSTR_OPC_SW},
+    {       "nop",     TOK_MNEMONIC,        INSTR_OPC_NOP},
+    {     "ecall",     TOK_MNEMONIC,      INSTR_OPC_ECALL},
+    {    "ebreak",     TOK_MNEMONIC,     INSTR_OPC_EBREAK},
+    {       "lui",     TOK_MNEMONIC,        INSTR_OPC_LUI},
+    {     "auipc",     TOK_MNEMONIC,      INSTR_OPC_AUIPC},
+    {       "jal",     TOK_MNEMONIC,        INSTR_OPC_JAL},
+    {      "jalr",     TOK_MNEMONIC,       INSTR_OPC_JALR},
+    {       "beq",     TOK_MNEMONIC,        INSTR_OPC_BEQ},
+    {       "bne",     TOK_MNEMONIC,        INSTR_OPC_BNE},
+    {       "blt",     TOK_MNEMONIC,        INSTR_OPC_BLT},
+    {       "bge",     TOK_MNEMONIC,        INSTR_OPC_BGE},
+    {      "bltu",     TOK_MNEMONIC,       INSTR_OPC_BLTU},
+    {      "bgeu",     TOK_MNEMONIC,       INSTR_OPC_BGEU},
+    {        "li",     TOK_MNEMONIC,         INSTR_OPC_LI},
+    {        "la",     TOK_MNEMONIC,         INSTR_OPC_LA},
+    {         "j",     TOK_MNEMONIC,          INSTR_OPC_J},
+    {       "bgt",     TOK_MNEMONIC,        INSTR_OPC_BGT},
+    {       "ble",     TOK_MNEMONIC,        INSTR_OPC_BLE},
+    {      "bgtu",     TOK_MNEMONIC,       INSTR_OPC_BGTU},
+    {      "bleu",     TOK_MNEMONIC,       INSTR_OPC_BLEU},
+    {      "beqz",     TOK_MNEMONIC,       INSTR_OPC_BEQZ},
+    {      "bnez",     TOK_MNEMONIC,       INSTR_OPC_BNEZ},
+    {      "blez",     TOK_MNEMONIC,       INSTR_OPC_BLEZ},
+    {      "bgez",     TOK_MNEMONIC,       INSTR_OPC_BGEZ},
+    {      "bltz",     TOK_MNEMONIC,       INSTR_OPC_BLTZ},
+    {      "bgtz",     TOK_MNEMONIC,       INSTR_OPC_BGTZ},
+    {     "csrrw",     TOK_MNEMONIC,      INSTR_OPC_CSRRW},
+    {     "csrrs",     TOK_MNEMONIC,      INSTR_OPC_CSRRS},
+    {     "csrrc",     TOK_MNEMONIC,      INSTR_OPC_CSRRC},
+    {    "csrrwi",     TOK_MNEMONIC,     INSTR_OPC_CSRRWI},
+    {    "csrrsi",     TOK_MNEMONIC,     INSTR_OPC_CSRRSI},
+    {    "csrrci",     TOK_MNEMONIC,     INSTR_OPC_CSRRCI},
+    {      "csrr",     TOK_MNEMONIC,       INSTR_OPC_CSRR},
+    {   "rdcycle",     TOK_MNEMONIC,    INSTR_OPC_RDCYCLE},
+    {  "rdcycleh",     TOK_MNEMONIC,   INSTR_OPC_RDCYCLEH},
+    {    "rdtime",     TOK_MNEMONIC,     INSTR_OPC_RDTIME},
+    {   "rdtimeh",     TOK_MNEMONIC,    INSTR_OPC_RDTIMEH},
+    { "rdinstret",     TOK_MNEMONIC,  INSTR_OPC_RDINSTRET},
+    {"rdinstreth",     TOK_MNEMONIC, INSTR_OPC_RDINSTRETH},
+    {      "lr.w",     TOK_MNEMONIC,       INSTR_OPC_LR_W},
+    {      "sc.w",     TOK_MNEMONIC,       INSTR_OPC_SC_W},
+    { "amoswap.w",     TOK_MNEMONIC,  INSTR_OPC_AMOSWAP_W},
+    {  "amoadd.w",     TOK_MNEMONIC,   INSTR_OPC_AMOADD_W},
+    {  "amoxor.w",     TOK_MNEMONIC,   INSTR_OPC_AMOXOR_W},
+    {  "amoand.w",     TOK_MNEMONIC,   INSTR_OPC_AMOAND_W},
+    {   "amoor.w",     TOK_MNEMONIC,    INSTR_OPC_AMOOR_W},
+    {  "amomin.w",     TOK_MNEMONIC,   INSTR_OPC_AMOMIN_W},
+    {  "amomax.w",     TOK_MNEMONIC,   INSTR_OPC_AMOMAX_W},
+    { "amominu.w",     TOK_MNEMONIC,  INSTR_OPC_AMOMINU_W},
+    { "amomaxu.w",     TOK_MNEMONIC,  INSTR_OPC_AMOMAXU_W},
+    {        NULL, TOK_UNRECOGNIZED,                    0}
+};
+
+/* Keywords are found through an open addressing hash table, built on first
+ * use. With less than a keyword every four slots, most lookups hash the
+ * identifier and compare it with a single keyword. */
+#define LEX_KEYWORD_SLOTS 1024
+
+static uint32_t lexHashRange(const char *begin, const char *end)
+{
+  // FNV-1a, case insensitive like the keywords
+  uint32_t hash = 2166136261U;
+  for (; begin != end; begin++)
+    hash = (hash ^ (uint8_t)tolower(*begin)) * 16777619U;
+  return hash;
+}
+
+static int lexFindKeyword(t_lexer *lex)
+{
+  // Index of the keyword in each slot plus one, zero if the slot is empty
+  static int16_t slots[LEX_KEYWORD_SLOTS];
+  static uint8_t lengths[LEX_KEYWORD_SLOTS];
+  static bool built = false;
+
+  if (!built) {
+    for (int i = 0; lexKeywords[i].text != NULL; i++) {
+      const char *text = lexKeywords[i].text;
+      size_t len = strlen(text);
+      uint32_t h = lexHashRange(text, text + len) % LEX_KEYWORD_SLOTS;
+      while (slots[h] != 0)
+        h = (h + 1) % LEX_KEYWORD_SLOTS;
+      slots[h] = (int16_t)(i + 1);
+      lengths[h] = (uint8_t)len;
+    }
+    built = true;
+  }
+
+  size_t len = (size_t)(lex->lookahead - lex->nextTokenPtr);
+  uint32_t h = lexHashRange(lex->nextTokenPtr, lex->lookahead);
+  for (h %= LEX_KEYWORD_SLOTS; slots[h] != 0; h = (h + 1) % LEX_KEYWORD_SLOTS) {
+    int i = slots[h] - 1;
+    if (lengths[h] == len && lexIdentEquals(lex, lexKeywords[i].text))
+      return i;
+  }
+  return -1;
+}
+
+static t_token lexExpectIdentifierOrKeyword(t_lexer *lex)
 {
-  static const t_keywordData kwdata[] = {
-      {    "x0",     TOK_REGISTER,                0},
-      {    "x1",     TOK_REGISTER,                1},
-      {    "x2",     TOK_REGISTER,                2},
-      {    "x3",     TOK_REGISTER,                3},
-      {    "x4",     TOK_REGISTER,                4},
-      {    "x5",     TOK_REGISTER,                5},
-      {    "x6",     TOK_REGISTER,                6},
-      {    "x7",     TOK_REGISTER,                7},
-      {    "x8",     TOK_REGISTER,                8},
-      {    "x8",     TOK_REGISTER,                8},
-      {    "x9",     TOK_REGISTER,                9},
-      {   "x10",     TOK_REGISTER,               10},
-      {   "x11",     TOK_REGISTER,               11},
-      {   "x12",     TOK_REGISTER,               12},
-      {   "x13",     TOK_REGISTER,               13},
-      {   "x14",     TOK_REGISTER,               14},
-      {   "x15",     TOK_REGISTER,               15},
-      {   "x16",     TOK_REGISTER,               16},
-      {   "x17",     TOK_REGISTER,               17},
-      {   "x18",     TOK_REGISTER,               18},
-      {   "x19",     TOK_REGISTER,               19},
-      {   "x20",     TOK_REGISTER,               20},
-      {   "x21",     TOK_REGISTER,               21},
-      {   "x22",     TOK_REGISTER,               22},
-      {   "x23",     TOK_REGISTER,               23},
-      {   "x24",     TOK_REGISTER,               24},
-      {   "x25",     TOK_REGISTER,               25},
-      {   "x26",     TOK_REGISTER,               26},
-      {   "x27",     TOK_REGISTER,               27},
-      {   "x28",     TOK_REGISTER,               28},
-      {   "x29",     TOK_REGISTER,               29},
-      {   "x30",     TOK_REGISTER,               30},
-      {   "x31",     TOK_REGISTER,               31},
-      {  "zero",     TOK_REGISTER,                0},
-      {    "ra",     TOK_REGISTER,                1},
-      {    "sp",     TOK_REGISTER,                2},
-      {    "gp",     TOK_REGISTER,                3},
-      {    "tp",     TOK_REGISTER,                4},
-      {    "t0",     TOK_REGISTER,                5},
-      {    "t1",     TOK_REGISTER,                6},
-      {    "t2",     TOK_REGISTER,                7},
-      {    "s0",     TOK_REGISTER,                8},
-      {    "fp",     TOK_REGISTER,                8},
-      {    "s1",     TOK_REGISTER,                9},
-      {    "a0",     TOK_REGISTER,               10},
-      {    "a1",     TOK_REGISTER,               11},
-      {    "a2",     TOK_REGISTER,               12},
-      {    "a3",     TOK_REGISTER,               13},
-      {    "a4",     TOK_REGISTER,               14},
-      {    "a5",     TOK_REGISTER,               15},
-      {    "a6",     TOK_REGISTER,               16},
-      {    "a7",     TOK_REGISTER,               17},
-      {    "s2",     TOK_REGISTER,               18},
-      {    "s3",     TOK_REGISTER,               19},
-      {    "s4",     TOK_REGISTER,               20},
-      {    "s5",     TOK_REGISTER,               21},
-      {    "s6",     TOK_REGISTER,               22},
-      {    "s7",     TOK_REGISTER,               23},
-      {    "s8",     TOK_REGISTER,               24},
-      {    "s9",     TOK_REGISTER,               25},
-      {   "s10",     TOK_REGISTER,               26},
-      {   "s11",     TOK_REGISTER,               27},
-      {    "t3",     TOK_REGISTER,               28},
-      {    "t4",     TOK_REGISTER,               29},
-      {    "t5",     TOK_REGISTER,               30},
-      {    "t6",     TOK_REGISTER,               31},
-      {   "add",     TOK_MNEMONIC,    INSTR_OPC_ADD},
-      {   "sub",     TOK_MNEMONIC,    INSTR_OPC_SUB},
-      {   "xor",     TOK_MNEMONIC,    INSTR_OPC_XOR},
-      {    "or",     TOK_MNEMONIC,     INSTR_OPC_OR},
-      {   "and",     TOK_MNEMONIC,    INSTR_OPC_AND},
-      {   "sll",     TOK_MNEMONIC,    INSTR_OPC_SLL},
-      {   "srl",     TOK_MNEMONIC,    INSTR_OPC_SRL},
-      {   "sra",     TOK_MNEMONIC,    INSTR_OPC_SRA},
-      {   "slt",     TOK_MNEMONIC,    INSTR_OPC_SLT},
-      {  "sltu",     TOK_MNEMONIC,   INSTR_OPC_SLTU},
-      {   "mul",     TOK_MNEMONIC,    INSTR_OPC_MUL},
-      {  "mulh",     TOK_MNEMONIC,   INSTR_OPC_MULH},
-      {"mulhsu",     TOK_MNEMONIC, INSTR_OPC_MULHSU},
-      { "mulhu",     TOK_MNEMONIC,  INSTR_OPC_MULHU},
-      {   "div",     TOK_MNEMONIC,    INSTR_OPC_DIV},
-      {  "divu",     TOK_MNEMONIC,   INSTR_OPC_DIVU},
-      {   "rem",     TOK_MNEMONIC,    INSTR_OPC_REM},
-      {  "remu",     TOK_MNEMONIC,   INSTR_OPC_REMU},
-      {  "addi",     TOK_MNEMONIC,   INSTR_OPC_ADDI},
-      {  "xori",     TOK_MNEMONIC,   INSTR_OPC_XORI},
-      {   "ori",     TOK_MNEMONIC,    INSTR_OPC_ORI},
-      {  "andi",     TOK_MNEMONIC,   INSTR_OPC_ANDI},
-      {  "slli",     TOK_MNEMONIC,   INSTR_OPC_SLLI},
-      {  "srli",     TOK_MNEMONIC,   INSTR_OPC_SRLI},
-      {  "srai",     TOK_MNEMONIC,   INSTR_OPC_SRAI},
-      {  "slti",     TOK_MNEMONIC,   INSTR_OPC_SLTI},
-      { "sltiu",     TOK_MNEMONIC,  INSTR_OPC_SLTIU},
-      {    "lb",     TOK_MNEMONIC,     INSTR_OPC_LB},
-      {    "lh",     TOK_MNEMONIC,     INSTR_OPC_LH},
-      {    "lw",     TOK_MNEMONIC,     INSTR_OPC_LW},
-      {   "lbu",     TOK_MNEMONIC,    INSTR_OPC_LBU},
-      {   "lhu",     TOK_MNEMONIC,    INSTR_OPC_LHU},
-      {    "sb",     TOK_MNEMONIC,     INSTR_OPC_SB},
-      {    "sh",     TOK_MNEMONIC,     INSTR_OPC_SH},
-      {    "sw",     TOK_MNEMONIC,     INSTR_OPC_SW},
-      {   "nop",     TOK_MNEMONIC,    INSTR_OPC_NOP},
-      { "ecall",     TOK_MNEMONIC,  INSTR_OPC_ECALL},
-      {"ebreak",     TOK_MNEMONIC, INSTR_OPC_EBREAK},
-      {   "lui",     TOK_MNEMONIC,    INSTR_OPC_LUI},
-      { "auipc",     TOK_MNEMONIC,  INSTR_OPC_AUIPC},
-      {   "jal",     TOK_MNEMONIC,    INSTR_OPC_JAL},
-      {  "jalr",     TOK_MNEMONIC,   INSTR_OPC_JALR},
-      {   "beq",     TOK_MNEMONIC,    INSTR_OPC_BEQ},
-      {   "bne",     TOK_MNEMONIC,    INSTR_OPC_BNE},
-      {   "blt",     TOK_MNEMONIC,    INSTR_OPC_BLT},
-      {   "bge",     TOK_MNEMONIC,    INSTR_OPC_BGE},
-      {  "bltu",     TOK_MNEMONIC,   INSTR_OPC_BLTU},
-      {  "bgeu",     TOK_MNEMONIC,   INSTR_OPC_BGEU},
-      {    "li",     TOK_MNEMONIC,     INSTR_OPC_LI},
-      {    "la",     TOK_MNEMONIC,     INSTR_OPC_LA},
-      {     "j",     TOK_MNEMONIC,      INSTR_OPC_J},
-      {   "bgt",     TOK_MNEMONIC,    INSTR_OPC_BGT},
-      {   "ble",     TOK_MNEMONIC,    INSTR_OPC_BLE},
-      {  "bgtu",     TOK_MNEMONIC,   INSTR_OPC_BGTU},
-      {  "bleu",     TOK_MNEMONIC,   INSTR_OPC_BLEU},
-      {  "beqz",     TOK_MNEMONIC,   INSTR_OPC_BEQZ},
-      {  "bnez",     TOK_MNEMONIC,   INSTR_OPC_BNEZ},
-      {  "blez",     TOK_MNEMONIC,   INSTR_OPC_BLEZ},
-      {  "bgez",     TOK_MNEMONIC,   INSTR_OPC_BGEZ},
-      {  "bltz",     TOK_MNEMONIC,   INSTR_OPC_BLTZ},
-      {  "bgtz",     TOK_MNEMONIC,   INSTR_OPC_BGTZ},
-      {    NULL, TOK_UNRECOGNIZED,                0}
+  // Memory ordering suffixes of the A extension, matched longest first
+  static const struct {
+    const char *text;
+    int32_t ordering;
+  } ordSuffixes[] = {
+      {".aqrl", INSTR_ORDERING_AQ | INSTR_ORDERING_RL},
+      {  ".aq",                     INSTR_ORDERING_AQ},
+      {  ".rl",                     INSTR_ORDERING_RL},
+      {   NULL,                                     0}
   };
 
   lexAcceptIdentifier(lex);
-  for (int i = 0; kwdata[i].text != NULL; i++) {
-    if (lexIdentEquals(lex, kwdata[i].text)) {
-      t_token *res = createToken(lex, kwdata[i].id);
-      if (kwdata[i].id == TOK_REGISTER)
-        res->value.reg = kwdata[i].info;
-      else if (kwdata[i].id == TOK_MNEMONIC)
-        res->value.mnemonic = kwdata[i].info;
-      else
-        assert(0 && "bad keyword data table");
-      return res;
-    }
+  // Some mnemonics contain dots (e.g. "amoadd.w.aq")
+  while (lex->lookahead[0] == '.' && isalpha(lex->lookahead[1])) {
+    lex->lookahead++;
+    lexAcceptIdentifier(lex);
+  }
+
+  int32_t ordering = 0;
+  int i = lexFindKeyword(lex);
+  for (int j = 0; i < 0 && ordSuffixes[j].text != NULL; j++) {
+    if (!lexIdentEndsWith(lex, ordSuffixes[j].text))
+      continue;
+    char *end = lex->lookahead;
+    lex->lookahead -= strlen(ordSuffixes[j].text);
+    i = lexFindKeyword(lex);
+    lex->lookahead = end;
+    if (i >= 0 && lexKeywords[i].id == TOK_MNEMONIC &&
+        lexKeywords[i].info >= INSTR_OPC_LR_W &&
+        lexKeywords[i].info <= INSTR_OPC_AMOMAXU_W)
+      ordering = ordSuffixes[j].ordering;
+    else
+      i = -1;
+  }
+
+  if (i >= 0) {
+    t_token res = createToken(lex, lexKeywords[i].id);
+    if (lexKeywords[i].id == TOK_REGISTER) {
+      res.value.reg = lexKeywords[i].info;
+    } else if (lexKeywords[i].id == TOK_MNEMONIC) {
+      res.value.mnemonic.opcode = lexKeywords[i].info;
+      res.value.mnemonic.ordering = ordering;
+    } else
+      assert(0 && "bad keyword data table");
+    return res;
   }
 
-  t_token *res = createToken(lex, TOK_ID);
-  res->value.id = lexRangeToString(res->begin, res->end);
+  t_token res = createToken(lex, TOK_ID);
+  res.value.id =
+      arenaStrndup(lex->arena, res.begin, (size_t)(res.end - res.begin));
   return res;
 }
 
 
-t_token *lexNextToken(t_lexer *lex)
+t_token lexNextToken(t_lexer *lex)
 {
   lexSkipWhitespaceAndComments(lex);
 
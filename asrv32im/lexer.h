@@ -30,6 +30,8 @@ enum {
   TOK_ALIGN,
   TOK_BALIGN,
   TOK_GLOBAL,
+  TOK_FILE,
+  TOK_LOC,
   TOK_HI,
   TOK_LO,
   TOK_PCREL_HI,
@@ -48,17 +50,24 @@ typedef struct {
     int32_t number;
     char *string;
     t_instrRegID reg;
-    t_instrOpcode mnemonic;
+    struct {
+      t_instrOpcode opcode;
+      int32_t ordering;
+    } mnemonic;
   } value;
 } t_token;
 
 typedef struct t_lexer t_lexer;
 
 
+/* Regular input files are mapped in memory, while the standard input (named
+ * "-") and pipes are read in chunks of whole lines as the lexing goes on. */
 t_lexer *newLexer(const char *fn);
 void deleteLexer(t_lexer *lex);
 
-t_token *lexNextToken(t_lexer *lex);
-void deleteToken(t_token *tok);
+/* Tokens are returned by value. The strings of identifiers and string
+ * literals belong to the lexer, and are freed by deleteLexer. The `begin'
+ * and `end' pointers are only valid until the next token is read. */
+t_token lexNextToken(t_lexer *lex);
 
 #endif
@@ -4,15 +4,24 @@
 #include "errors.h"
 #include "object.h"
 #include "encode.h"
+#include "arena.h"
+
+// Labels are kept in a hash table with chaining, resized to keep at most
+// one label per bucket on average.
+#define OBJ_LABEL_MIN_BUCKETS 256
 
 struct t_objLabel {
   struct t_objLabel *next;
-  char *name;
+  struct t_objLabel *nextInBucket;
+  uint32_t hash;
   t_objSecItem *pointer;
+  t_objSectionID section;
+  char name[]; // allocated together with the label
 };
 
 struct t_objSection {
   t_objSectionID id;
+  t_arena *arena; // of the object
   t_objSecItem *items;
   t_objSecItem *lastItem;
   uint32_t start;
@@ -20,20 +29,26 @@ struct t_objSection {
 };
 
 struct t_object {
+  // Sections, items and labels are allocated from the arena
+  t_arena *arena;
   t_objSection *data;
   t_objSection *text;
   t_objLabel *labelList;
+  t_objLabel **labelBuckets;
+  size_t numBuckets;
+  size_t numLabels;
+  bool compress;
+  char *srcFiles[OBJ_MAX_SOURCE_FILE + 1];
 };
 
 
-static t_objSection *newSection(t_objSectionID id)
+static t_objSection *newSection(t_arena *arena, t_objSectionID id)
 {
   t_objSection *sec;
 
-  sec = malloc(sizeof(t_objSection));
-  if (!sec)
-    fatalError("out of memory");
+  sec = arenaAlloc(arena, sizeof(t_objSection));
   sec->id = id;
+  sec->arena = arena;
   sec->items = NULL;
   sec->lastItem = NULL;
   sec->start = 0;
@@ -42,22 +57,6 @@ static t_objSection *newSection(t_objSectionID id)
 }
 
 
-static void deleteSection(t_objSection *sec)
-{
-  t_objSecItem *item, *nextItm;
-
-  if (!sec)
-    return;
-
-  for (item = sec->items; item != NULL; item = nextItm) {
-    nextItm = item->next;
-    free(item);
-  }
-
-  free(sec);
-}
-
-
 t_object *newObject(void)
 {
   t_object *obj;
@@ -65,62 +64,114 @@ t_object *newObject(void)
   obj = malloc(sizeof(t_object));
   if (!obj)
     fatalError("out of memory");
-  obj->data = newSection(OBJ_SECTION_DATA);
-  obj->text = newSection(OBJ_SECTION_TEXT);
+  obj->arena = newArena();
+  obj->data = newSection(obj->arena, OBJ_SECTION_DATA);
+  obj->text = newSection(obj->arena, OBJ_SECTION_TEXT);
   obj->labelList = NULL;
+  obj->numBuckets = OBJ_LABEL_MIN_BUCKETS;
+  obj->numLabels = 0;
+  obj->labelBuckets = calloc(obj->numBuckets, sizeof(t_objLabel *));
+  if (!obj->labelBuckets)
+    fatalError("out of memory");
+  obj->compress = false;
+  for (int i = 0; i <= OBJ_MAX_SOURCE_FILE; i++)
+    obj->srcFiles[i] = NULL;
   return obj;
 }
 
 
 void deleteObject(t_object *obj)
 {
-  t_objLabel *lbl, *nextLbl;
-
   if (!obj)
     return;
 
-  deleteSection(obj->data);
-  deleteSection(obj->text);
-
-  for (lbl = obj->labelList; lbl != NULL; lbl = nextLbl) {
-    nextLbl = lbl->next;
-    free(lbl->name);
-    free(lbl);
-  }
+  deleteArena(obj->arena);
+  free(obj->labelBuckets);
+  for (int i = 0; i <= OBJ_MAX_SOURCE_FILE; i++)
+    free(obj->srcFiles[i]);
 
   free(obj);
 }
 
 
-t_objLabel *objFindLabel(t_object *obj, const char *name)
+static uint32_t objHashName(const char *name)
 {
-  t_objLabel *lbl;
-  for (lbl = obj->labelList; lbl != NULL; lbl = lbl->next) {
-    if (strcmp(lbl->name, name) == 0)
+  // FNV-1a
+  uint32_t hash = 2166136261U;
+  for (; *name != '\0'; name++)
+    hash = (hash ^ (uint8_t)*name) * 16777619U;
+  return hash;
+}
+
+static void objGrowLabelBuckets(t_object *obj)
+{
+  size_t newNumBuckets = obj->numBuckets * 2;
+  t_objLabel **newBuckets = calloc(newNumBuckets, sizeof(t_objLabel *));
+  if (!newBuckets)
+    fatalError("out of memory");
+  for (t_objLabel *lbl = obj->labelList; lbl != NULL; lbl = lbl->next) {
+    size_t i = lbl->hash & (newNumBuckets - 1);
+    lbl->nextInBucket = newBuckets[i];
+    newBuckets[i] = lbl;
+  }
+  free(obj->labelBuckets);
+  obj->labelBuckets = newBuckets;
+  obj->numBuckets = newNumBuckets;
+}
+
+static t_objLabel *objFindLabelWithHash(
+    t_object *obj, const char *name, uint32_t hash)
+{
+  t_objLabel *lbl = obj->labelBuckets[hash & (obj->numBuckets - 1)];
+  for (; lbl != NULL; lbl = lbl->nextInBucket) {
+    if (lbl->hash == hash && strcmp(lbl->name, name) == 0)
       break;
   }
   return lbl;
 }
 
+t_objLabel *objFindLabel(t_object *obj, const char *name)
+{
+  return objFindLabelWithHash(obj, name, objHashName(name));
+}
+
 t_objLabel *objGetLabel(t_object *obj, const char *name)
 {
-  t_objLabel *lbl = objFindLabel(obj, name);
+  uint32_t hash = objHashName(name);
+  t_objLabel *lbl = objFindLabelWithHash(obj, name, hash);
   if (lbl)
     return lbl;
 
-  lbl = malloc(sizeof(t_objLabel));
-  if (!lbl)
-    fatalError("out of memory");
-  lbl->name = strdup(name);
-  if (!lbl->name)
-    fatalError("out of memory");
+  size_t nameSize = strlen(name) + 1;
+  lbl = arenaAlloc(obj->arena, sizeof(t_objLabel) + nameSize);
+  memcpy(lbl->name, name, nameSize);
+  lbl->hash = hash;
   lbl->next = obj->labelList;
   lbl->pointer = NULL;
   obj->labelList = lbl;
+
+  if (++obj->numLabels > obj->numBuckets) {
+    objGrowLabelBuckets(obj);
+  } else {
+    size_t i = hash & (obj->numBuckets - 1);
+    lbl->nextInBucket = obj->labelBuckets[i];
+    obj->labelBuckets[i] = lbl;
+  }
   return lbl;
 }
 
 
+t_objLabel *objGetLabelList(t_object *obj)
+{
+  return obj->labelList;
+}
+
+t_objLabel *objLabelGetNext(t_objLabel *lbl)
+{
+  return lbl->next;
+}
+
+
 t_objSection *objGetSection(t_object *obj, t_objSectionID id)
 {
   if (id == OBJ_SECTION_TEXT)
@@ -154,6 +205,10 @@ static void objSecInsertAfter(
     sec->lastItem = item;
 }
 
+/* Items only take the space of the variant of the body they use */
+#define OBJ_ITEM_SIZE(variant) \
+  (offsetof(t_objSecItem, body) + sizeof(((t_objSecItem *)0)->body.variant))
+
 static void objSecAppend(t_objSection *sec, t_objSecItem *item)
 {
   objSecInsertAfter(sec, item, sec->lastItem);
@@ -164,9 +219,7 @@ void objSecAppendData(t_objSection *sec, t_data data)
 {
   t_objSecItem *itm;
 
-  itm = malloc(sizeof(t_objSecItem));
-  if (!itm)
-    fatalError("out of memory");
+  itm = arenaAlloc(sec->arena, OBJ_ITEM_SIZE(data));
   itm->address = 0;
   itm->class = OBJ_SEC_ITM_CLASS_DATA;
   itm->body.data = data;
@@ -177,9 +230,7 @@ void objSecAppendAlignmentData(t_objSection *sec, t_alignData align)
 {
   t_objSecItem *itm;
 
-  itm = malloc(sizeof(t_objSecItem));
-  if (!itm)
-    fatalError("out of memory");
+  itm = arenaAlloc(sec->arena, OBJ_ITEM_SIZE(alignData));
   itm->address = 0;
   itm->class = OBJ_SEC_ITM_CLASS_ALIGN_DATA;
   itm->body.alignData = align;
@@ -191,9 +242,11 @@ t_objSecItem *objSecInsertInstructionAfter(
 {
   t_objSecItem *itm;
 
-  itm = malloc(sizeof(t_objSecItem));
-  if (!itm)
-    fatalError("out of memory");
+  // Instructions are replaced by their encoding when materialized
+  size_t size = OBJ_ITEM_SIZE(instr);
+  if (size < OBJ_ITEM_SIZE(data))
+    size = OBJ_ITEM_SIZE(data);
+  itm = arenaAlloc(sec->arena, size);
   itm->address = 0;
   itm->class = OBJ_SEC_ITM_CLASS_INSTR;
   itm->body.instr = instr;
@@ -213,14 +266,13 @@ bool objSecDeclareLabel(t_objSection *sec, t_objLabel *label)
   if (label->pointer)
     return false;
 
-  itm = malloc(sizeof(t_objSecItem));
-  if (!itm)
-    fatalError("out of memory");
+  itm = arenaAlloc(sec->arena, offsetof(t_objSecItem, body));
   itm->address = 0;
   itm->class = OBJ_SEC_ITM_CLASS_VOID;
   objSecAppend(sec, itm);
 
   label->pointer = itm;
+  label->section = sec->id;
   return true;
 }
 
@@ -261,6 +313,16 @@ uint32_t objLabelGetPointer(t_objLabel *lbl)
   return lbl->pointer->address;
 }
 
+bool objLabelIsDeclared(t_objLabel *lbl)
+{
+  return lbl->pointer != NULL;
+}
+
+t_objSectionID objLabelGetSectionID(t_objLabel *lbl)
+{
+  return lbl->section;
+}
+
 
 static bool objSecExpandPseudoInstructions(t_objSection *sec)
 {
@@ -283,6 +345,30 @@ static bool objSecExpandPseudoInstructions(t_objSection *sec)
   return true;
 }
 
+void objSetCompression(t_object *obj, bool enable)
+{
+  obj->compress = enable;
+}
+
+bool objGetCompression(t_object *obj)
+{
+  return obj->compress;
+}
+
+void objSetSourceFile(t_object *obj, int num, const char *name)
+{
+  free(obj->srcFiles[num]);
+  obj->srcFiles[num] = strdup(name);
+  if (!obj->srcFiles[num])
+    fatalError("out of memory");
+}
+
+const char *objGetSourceFile(t_object *obj, int num)
+{
+  return obj->srcFiles[num];
+}
+
+
 static bool objSecMaterializeAddresses(t_objSection *sec, uint32_t *curAddr)
 {
   size_t alignAmt;
@@ -307,16 +393,6 @@ static bool objSecMaterializeAddresses(t_objSection *sec, uint32_t *curAddr)
         else
           thisSize = alignAmt - (*curAddr % alignAmt);
         itm->body.alignData.effectiveSize = thisSize;
-        if (objSecGetID(sec) == OBJ_SECTION_TEXT) {
-          if (itm->body.alignData.nopFill &&
-              (thisSize % 4 != 0 || itm->address % 4 != 0)) {
-            emitWarning(loc,
-                "implicit nop-fill alignment in .text not aligned to "
-                "a multiple of 4 bytes, using zero-fill instead");
-            itm->body.alignData.nopFill = false;
-            itm->body.alignData.fillByte = 0;
-          }
-        }
         break;
       case OBJ_SEC_ITM_CLASS_INSTR:
         loc = itm->body.instr.location;
@@ -335,6 +411,51 @@ static bool objSecMaterializeAddresses(t_objSection *sec, uint32_t *curAddr)
   return true;
 }
 
+static void objSecCheckNopFill(t_objSection *sec, bool compress)
+{
+  size_t nopSize = compress ? 2 : 4;
+
+  if (objSecGetID(sec) != OBJ_SECTION_TEXT)
+    return;
+  for (t_objSecItem *itm = sec->items; itm != NULL; itm = itm->next) {
+    if (itm->class != OBJ_SEC_ITM_CLASS_ALIGN_DATA)
+      continue;
+    t_alignData *align = &itm->body.alignData;
+    if (align->nopFill && (align->effectiveSize % nopSize != 0 ||
+                              itm->address % nopSize != 0)) {
+      emitWarning(align->location,
+          "implicit nop-fill alignment in .text not aligned to a multiple of "
+          "%d bytes, using zero-fill instead",
+          (int)nopSize);
+      align->nopFill = false;
+      align->fillByte = 0;
+    }
+  }
+}
+
+static void objSecSetCompressed(t_objSection *sec, bool compress)
+{
+  for (t_objSecItem *itm = sec->items; itm != NULL; itm = itm->next) {
+    if (itm->class == OBJ_SEC_ITM_CLASS_INSTR)
+      itm->body.instr.compressed = compress;
+  }
+}
+
+static bool objSecRelaxCompressed(t_objSection *sec)
+{
+  bool changed = false;
+
+  for (t_objSecItem *itm = sec->items; itm != NULL; itm = itm->next) {
+    if (itm->class != OBJ_SEC_ITM_CLASS_INSTR || !itm->body.instr.compressed)
+      continue;
+    if (!encCanCompress(itm->body.instr, itm->address)) {
+      itm->body.instr.compressed = false;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
 static bool objSecResolveImmediates(t_objSection *sec)
 {
   t_objSecItem *itm;
@@ -360,6 +481,8 @@ static bool objSecMaterializeInstructions(t_objSection *sec)
 
     if (!encPhysicalInstruction(itm->body.instr, itm->address, &tmp))
       return false;
+    tmp.srcFile = itm->body.instr.srcFile;
+    tmp.srcLine = itm->body.instr.srcLine;
     itm->class = OBJ_SEC_ITM_CLASS_DATA;
     itm->body.data = tmp;
   }
@@ -374,12 +497,23 @@ bool objMaterialize(t_object *obj)
   if (!objSecExpandPseudoInstructions(obj->data))
     return false;
 
-  // Assign an address to every item in the object
-  uint32_t curAddr = 0x1000;
-  if (!objSecMaterializeAddresses(obj->text, &curAddr))
-    return false;
-  if (!objSecMaterializeAddresses(obj->data, &curAddr))
-    return false;
+  // Assign an address to every item in the object. When compression is
+  // enabled all instructions start out as compressed, and the ones that do
+  // not fit are expanded until the layout stops changing. Instructions are
+  // never compressed back, so this always terminates.
+  objSecSetCompressed(obj->text, obj->compress);
+  objSecSetCompressed(obj->data, obj->compress);
+  bool changed;
+  do {
+    uint32_t curAddr = 0x1000;
+    if (!objSecMaterializeAddresses(obj->text, &curAddr))
+      return false;
+    if (!objSecMaterializeAddresses(obj->data, &curAddr))
+      return false;
+    changed = objSecRelaxCompressed(obj->text);
+    changed = objSecRelaxCompressed(obj->data) || changed;
+  } while (changed);
+  objSecCheckNopFill(obj->text, obj->compress);
 
   // Transform label references into constants
   if (!objSecResolveImmediates(obj->text))
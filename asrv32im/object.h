@@ -16,6 +16,11 @@ typedef struct t_object t_object;
 typedef struct t_objLabel t_objLabel;
 typedef struct t_objSection t_objSection;
 
+/* Source files are numbered by .file directives, and instructions are mapped
+ * to their lines by .loc directives */
+#define OBJ_MAX_SOURCE_FILE 255
+#define OBJ_MAX_SOURCE_LINE 0xFFFFFF
+
 typedef int t_instrRegID;
 typedef int t_instrOpcode;
 enum {
@@ -67,6 +72,23 @@ enum {
   INSTR_OPC_BGE,
   INSTR_OPC_BLTU,
   INSTR_OPC_BGEU,
+  INSTR_OPC_CSRRW,
+  INSTR_OPC_CSRRS,
+  INSTR_OPC_CSRRC,
+  INSTR_OPC_CSRRWI,
+  INSTR_OPC_CSRRSI,
+  INSTR_OPC_CSRRCI,
+  INSTR_OPC_LR_W, // keep LR_W first and AMOMAXU_W last
+  INSTR_OPC_SC_W,
+  INSTR_OPC_AMOSWAP_W,
+  INSTR_OPC_AMOADD_W,
+  INSTR_OPC_AMOXOR_W,
+  INSTR_OPC_AMOAND_W,
+  INSTR_OPC_AMOOR_W,
+  INSTR_OPC_AMOMIN_W,
+  INSTR_OPC_AMOMAX_W,
+  INSTR_OPC_AMOMINU_W,
+  INSTR_OPC_AMOMAXU_W,
   /* pseudo-instructions */
   INSTR_OPC_NOP,
   INSTR_OPC_LI,
@@ -89,7 +111,20 @@ enum {
   INSTR_OPC_BLEZ,
   INSTR_OPC_BGEZ,
   INSTR_OPC_BLTZ,
-  INSTR_OPC_BGTZ
+  INSTR_OPC_BGTZ,
+  INSTR_OPC_CSRR,
+  INSTR_OPC_RDCYCLE,
+  INSTR_OPC_RDCYCLEH,
+  INSTR_OPC_RDTIME,
+  INSTR_OPC_RDTIMEH,
+  INSTR_OPC_RDINSTRET,
+  INSTR_OPC_RDINSTRETH
+};
+
+/* Memory ordering bits of atomic instructions, stored in the constant */
+enum {
+  INSTR_ORDERING_RL = 1,
+  INSTR_ORDERING_AQ = 2
 };
 
 typedef int t_instrImmMode;
@@ -111,7 +146,10 @@ typedef struct t_instruction {
   t_instrImmMode immMode;
   int32_t constant;
   t_objLabel *label;
+  bool compressed;
   t_fileLocation location;
+  int srcFile;
+  int32_t srcLine; // zero if unknown
 } t_instruction;
 
 #define DATA_MAX 16
@@ -120,6 +158,8 @@ typedef struct t_data {
   bool initialized;
   uint8_t data[DATA_MAX];
   t_fileLocation location;
+  int srcFile;     // source line of the instruction encoded in the data,
+  int32_t srcLine; // zero if unknown
 } t_data;
 
 typedef struct t_alignData {
@@ -155,7 +195,12 @@ void deleteObject(t_object *obj);
 
 t_objLabel *objFindLabel(t_object *obj, const char *name);
 t_objLabel *objGetLabel(t_object *obj, const char *name);
+t_objLabel *objGetLabelList(t_object *obj);
 void objDump(t_object *obj);
+void objSetCompression(t_object *obj, bool enable);
+bool objGetCompression(t_object *obj);
+void objSetSourceFile(t_object *obj, int num, const char *name);
+const char *objGetSourceFile(t_object *obj, int num);
 
 t_objSection *objGetSection(t_object *obj, t_objSectionID id);
 t_objSectionID objSecGetID(t_objSection *sec);
@@ -171,6 +216,9 @@ uint32_t objSecGetSize(t_objSection *sec);
 t_objSecItem *objLabelGetPointedItem(t_objLabel *lbl);
 const char *objLabelGetName(t_objLabel *lbl);
 uint32_t objLabelGetPointer(t_objLabel *lbl);
+bool objLabelIsDeclared(t_objLabel *lbl);
+t_objSectionID objLabelGetSectionID(t_objLabel *lbl);
+t_objLabel *objLabelGetNext(t_objLabel *lbl);
 
 bool objMaterialize(t_object *obj);
 
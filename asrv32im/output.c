@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -35,6 +36,8 @@ typedef uint32_t Elf32_Word;
 #define EM_NONE      0     // No machine
 #define EM_RISCV     0xF3  // RISC-V
 
+#define EF_RISCV_RVC 0x1   // Uses compressed instructions
+
 typedef struct __attribute__((packed)) Elf32_Ehdr {
   unsigned char e_ident[EI_NIDENT];
   Elf32_Half e_type;
@@ -75,6 +78,7 @@ typedef struct __attribute__((packed)) Elf32_Phdr {
 
 #define SHT_NULL      0         // null section
 #define SHT_PROGBITS  1         // section loaded with the program
+#define SHT_SYMTAB    2         // symbol table
 #define SHT_STRTAB    3         // string table
 
 #define SHF_WRITE     (1 << 0)  // section writable flag
@@ -95,6 +99,20 @@ typedef struct __attribute__((packed)) Elf32_Shdr {
   Elf32_Word sh_entsize;
 } Elf32_Shdr;
 
+#define STB_LOCAL     0         // local symbol binding
+#define STT_NOTYPE    0         // symbol with unspecified type
+
+#define ELF32_ST_INFO(b, t) (((b) << 4) + ((t) & 0xF))
+
+typedef struct __attribute__((packed)) Elf32_Sym {
+  Elf32_Word st_name;
+  Elf32_Addr st_value;
+  Elf32_Word st_size;
+  unsigned char st_info;
+  unsigned char st_other;
+  Elf32_Half st_shndx;
+} Elf32_Sym;
+
 
 static uint32_t toLE32(uint32_t v)
 {
@@ -142,12 +160,13 @@ void deinitOutStrTbl(t_outStrTbl *tbl)
   free(tbl->buf);
 }
 
-void outStrTblAddString(t_outStrTbl *tbl, char *str, Elf32_Word *outIdx)
+void outStrTblAddString(
+    t_outStrTbl *tbl, const char *str, Elf32_Word *outIdx)
 {
   size_t strSz = strlen(str) + 1;
   if (tbl->bufSz - tbl->tail < strSz) {
     size_t newBufSz = tbl->bufSz * 2 + strSz;
-    char *newBuf = realloc(tbl->buf, tbl->bufSz);
+    char *newBuf = realloc(tbl->buf, newBufSz);
     if (!newBuf)
       fatalError("out of memory");
     tbl->buf = newBuf;
@@ -188,6 +207,220 @@ t_outError outputStrTabContentToFile(FILE *fp, long whence, t_outStrTbl *tbl)
 }
 
 
+enum {
+  PRG_ID_TEXT = 0,
+  PRG_ID_DATA,
+  PRG_NUM
+};
+
+enum {
+  SEC_ID_NULL = SHN_UNDEF,
+  SEC_ID_TEXT,
+  SEC_ID_DATA,
+  SEC_ID_STRTAB,
+  SEC_ID_SYMTAB,
+  SEC_ID_SRCLINES, // only present if the source has .loc directives
+  SEC_NUM
+};
+
+typedef struct t_outSymTbl {
+  Elf32_Sym *syms;
+  size_t count;
+} t_outSymTbl;
+
+static int outCompareSyms(const void *a, const void *b)
+{
+  const Elf32_Sym *x = (const Elf32_Sym *)a, *y = (const Elf32_Sym *)b;
+  if (x->st_value != y->st_value)
+    return x->st_value < y->st_value ? -1 : 1;
+  return x->st_name < y->st_name ? -1 : (x->st_name > y->st_name);
+}
+
+/* Adds a symbol for every label declared in the source code, local labels
+ * excluded. Symbol names are added to the given string table. */
+void initOutSymTbl(t_outSymTbl *tbl, t_object *obj, t_outStrTbl *strTbl)
+{
+  size_t n = 1;
+  t_objLabel *lbl;
+  for (lbl = objGetLabelList(obj); lbl; lbl = objLabelGetNext(lbl))
+    n++;
+  tbl->syms = calloc(n, sizeof(Elf32_Sym));
+  if (!tbl->syms)
+    fatalError("out of memory");
+
+  // The first symbol is always the null symbol
+  tbl->count = 1;
+  for (lbl = objGetLabelList(obj); lbl; lbl = objLabelGetNext(lbl)) {
+    const char *name = objLabelGetName(lbl);
+    if (!objLabelIsDeclared(lbl) || name[0] == '.')
+      continue;
+    Elf32_Sym *sym = &tbl->syms[tbl->count++];
+    Elf32_Word strIdx;
+    outStrTblAddString(strTbl, name, &strIdx);
+    sym->st_name = strIdx;
+    sym->st_value = objLabelGetPointer(lbl);
+    sym->st_info = ELF32_ST_INFO(STB_LOCAL, STT_NOTYPE);
+    if (objLabelGetSectionID(lbl) == OBJ_SECTION_TEXT)
+      sym->st_shndx = SEC_ID_TEXT;
+    else
+      sym->st_shndx = SEC_ID_DATA;
+  }
+  qsort(tbl->syms + 1, tbl->count - 1, sizeof(Elf32_Sym), outCompareSyms);
+  for (size_t i = 1; i < tbl->count; i++) {
+    tbl->syms[i].st_name = toLE32(tbl->syms[i].st_name);
+    tbl->syms[i].st_value = toLE32(tbl->syms[i].st_value);
+    tbl->syms[i].st_shndx = toLE16(tbl->syms[i].st_shndx);
+  }
+}
+
+void deinitOutSymTbl(t_outSymTbl *tbl)
+{
+  free(tbl->syms);
+}
+
+Elf32_Shdr outputSymTabToELFSHdr(
+    t_outSymTbl *tbl, Elf32_Addr fileOffset, Elf32_Word name)
+{
+  Elf32_Shdr shdr = {0};
+
+  shdr.sh_name = toLE32(name);
+  shdr.sh_type = toLE32(SHT_SYMTAB);
+  shdr.sh_flags = toLE32(0);
+  shdr.sh_addr = toLE32(0);
+  shdr.sh_offset = toLE32(fileOffset);
+  shdr.sh_size = toLE32((Elf32_Word)(tbl->count * sizeof(Elf32_Sym)));
+  // symbol names are in the same string table as section names
+  shdr.sh_link = toLE32(SEC_ID_STRTAB);
+  // all symbols are local
+  shdr.sh_info = toLE32((Elf32_Word)tbl->count);
+  shdr.sh_addralign = toLE32(4);
+  shdr.sh_entsize = toLE32(sizeof(Elf32_Sym));
+
+  return shdr;
+}
+
+t_outError outputSymTabContentToFile(FILE *fp, long whence, t_outSymTbl *tbl)
+{
+  if (fseek(fp, whence, SEEK_SET) < 0)
+    return OUT_FILE_ERROR;
+  if (fwrite(tbl->syms, sizeof(Elf32_Sym), tbl->count, fp) < tbl->count)
+    return OUT_FILE_ERROR;
+  return OUT_NO_ERROR;
+}
+
+
+/* The line table maps the addresses of the .text section to source lines.
+ * It starts with the number N of source file slots, followed by N offsets of
+ * the file names in the string table (zero for unused file numbers). Then
+ * come (address, file << 24 | line) pairs in increasing address order, each
+ * valid up to the address of the next one. Line zero marks code without a
+ * source line. */
+typedef struct t_outLineTbl {
+  Elf32_Word *words;
+  size_t count;
+  size_t size;
+} t_outLineTbl;
+
+static void outLineTblAppend(t_outLineTbl *tbl, Elf32_Word word)
+{
+  if (tbl->count == tbl->size) {
+    size_t newSize = tbl->size ? tbl->size * 2 : 64;
+    Elf32_Word *newWords = realloc(tbl->words, newSize * sizeof(Elf32_Word));
+    if (!newWords)
+      fatalError("out of memory");
+    tbl->words = newWords;
+    tbl->size = newSize;
+  }
+  tbl->words[tbl->count++] = toLE32(word);
+}
+
+/* Leaves the table empty if no instruction has a source line. File names
+ * are added to the given string table. */
+void initOutLineTbl(t_outLineTbl *tbl, t_object *obj, t_outStrTbl *strTbl)
+{
+  tbl->words = NULL;
+  tbl->count = 0;
+  tbl->size = 0;
+
+  t_objSection *text = objGetSection(obj, OBJ_SECTION_TEXT);
+  t_objSecItem *itm;
+  for (itm = objSecGetItemList(text); itm != NULL; itm = itm->next) {
+    if (itm->class == OBJ_SEC_ITM_CLASS_DATA && itm->body.data.srcLine > 0)
+      break;
+  }
+  if (!itm)
+    return;
+
+  int numFiles = 0;
+  for (int i = 1; i <= OBJ_MAX_SOURCE_FILE; i++) {
+    if (objGetSourceFile(obj, i))
+      numFiles = i + 1;
+  }
+  outLineTblAppend(tbl, (Elf32_Word)numFiles);
+  for (int i = 0; i < numFiles; i++) {
+    const char *name = objGetSourceFile(obj, i);
+    Elf32_Word strIdx = 0;
+    if (i > 0 && name)
+      outStrTblAddString(strTbl, name, &strIdx);
+    outLineTblAppend(tbl, strIdx);
+  }
+
+  Elf32_Word last = 0;
+  for (itm = objSecGetItemList(text); itm != NULL; itm = itm->next) {
+    if (itm->class != OBJ_SEC_ITM_CLASS_DATA)
+      continue;
+    t_data *data = &itm->body.data;
+    Elf32_Word cur = 0;
+    if (data->srcLine > 0)
+      cur = (Elf32_Word)data->srcFile << 24 | (Elf32_Word)data->srcLine;
+    if (cur == last)
+      continue;
+    outLineTblAppend(tbl, itm->address);
+    outLineTblAppend(tbl, cur);
+    last = cur;
+  }
+  if (last != 0) {
+    outLineTblAppend(tbl, objSecGetStart(text) + objSecGetSize(text));
+    outLineTblAppend(tbl, 0);
+  }
+}
+
+void deinitOutLineTbl(t_outLineTbl *tbl)
+{
+  free(tbl->words);
+}
+
+Elf32_Shdr outputLineTabToELFSHdr(
+    t_outLineTbl *tbl, Elf32_Addr fileOffset, Elf32_Word name)
+{
+  Elf32_Shdr shdr = {0};
+
+  shdr.sh_name = toLE32(name);
+  shdr.sh_type = toLE32(SHT_PROGBITS);
+  shdr.sh_flags = toLE32(0);
+  shdr.sh_addr = toLE32(0);
+  shdr.sh_offset = toLE32(fileOffset);
+  shdr.sh_size = toLE32((Elf32_Word)(tbl->count * sizeof(Elf32_Word)));
+  // file names are in the same string table as section names
+  shdr.sh_link = toLE32(SEC_ID_STRTAB);
+  shdr.sh_info = toLE32(0);
+  shdr.sh_addralign = toLE32(4);
+  shdr.sh_entsize = toLE32(0);
+
+  return shdr;
+}
+
+t_outError outputLineTabContentToFile(
+    FILE *fp, long whence, t_outLineTbl *tbl)
+{
+  if (fseek(fp, whence, SEEK_SET) < 0)
+    return OUT_FILE_ERROR;
+  if (fwrite(tbl->words, sizeof(Elf32_Word), tbl->count, fp) < tbl->count)
+    return OUT_FILE_ERROR;
+  return OUT_NO_ERROR;
+}
+
+
 Elf32_Phdr outputSecToELFPHdr(
     t_objSection *sec, Elf32_Addr fileOffset, Elf32_Word flags)
 {
@@ -224,60 +457,106 @@ Elf32_Shdr outputSecToELFSHdr(
   return shdr;
 }
 
+/* Zero bytes are not written immediately, but accumulated, so that long runs
+ * of them (as from .space) become holes in the file. The next section always
+ * follows in the file, so a hole is never at its end. */
+#define OUT_HOLE_MIN_SIZE 4096
+#define OUT_BUFFER_SIZE 65536
+#define OUT_FILL_SIZE 4096
+
+typedef struct {
+  FILE *fp;
+  size_t zeros;
+} t_outSecWriter;
+
+static const uint8_t outZeros[OUT_HOLE_MIN_SIZE];
+
+static t_outError outSecFlushZeros(t_outSecWriter *w)
+{
+  if (w->zeros >= OUT_HOLE_MIN_SIZE) {
+    if (fseek(w->fp, (long)w->zeros, SEEK_CUR) < 0)
+      return OUT_FILE_ERROR;
+  } else if (w->zeros > 0) {
+    if (fwrite(outZeros, w->zeros, 1, w->fp) < 1)
+      return OUT_FILE_ERROR;
+  }
+  w->zeros = 0;
+  return OUT_NO_ERROR;
+}
+
+static t_outError outSecWrite(t_outSecWriter *w, const void *buf, size_t size)
+{
+  if (size <= sizeof(outZeros) && memcmp(buf, outZeros, size) == 0) {
+    w->zeros += size;
+    return OUT_NO_ERROR;
+  }
+  if (outSecFlushZeros(w) != OUT_NO_ERROR)
+    return OUT_FILE_ERROR;
+  if (fwrite(buf, size, 1, w->fp) < 1)
+    return OUT_FILE_ERROR;
+  return OUT_NO_ERROR;
+}
+
+/* Writes `size' bytes repeating the little-endian word `pattern' */
+static t_outError outSecFill(t_outSecWriter *w, uint32_t pattern, size_t size)
+{
+  if (pattern == 0) {
+    w->zeros += size;
+    return OUT_NO_ERROR;
+  }
+  uint32_t block[OUT_FILL_SIZE / sizeof(uint32_t)];
+  size_t blockSize = size < OUT_FILL_SIZE ? size : OUT_FILL_SIZE;
+  for (size_t i = 0; i < (blockSize + 3) / 4; i++)
+    block[i] = toLE32(pattern);
+  while (size > 0) {
+    size_t n = size < blockSize ? size : blockSize;
+    if (outSecWrite(w, block, n) != OUT_NO_ERROR)
+      return OUT_FILE_ERROR;
+    size -= n;
+  }
+  return OUT_NO_ERROR;
+}
+
 t_outError outputSecContentToFile(FILE *fp, long whence, t_objSection *sec)
 {
   if (fseek(fp, whence, SEEK_SET) < 0)
     return OUT_FILE_ERROR;
 
+  t_outSecWriter w = {fp, 0};
+  t_outError res = OUT_NO_ERROR;
   t_objSecItem *itm = objSecGetItemList(sec);
-  for (; itm != NULL; itm = itm->next) {
+  for (; itm != NULL && res == OUT_NO_ERROR; itm = itm->next) {
     if (itm->class == OBJ_SEC_ITM_CLASS_VOID) {
       continue;
     } else if (itm->class == OBJ_SEC_ITM_CLASS_DATA) {
-      if (itm->body.data.initialized) {
-        if (fwrite(itm->body.data.data, itm->body.data.dataSize, 1, fp) < 1)
-          return OUT_FILE_ERROR;
-      } else {
-        uint8_t tmp = 0;
-        for (int i = 0; i < itm->body.data.dataSize; i++)
-          if (fwrite(&tmp, sizeof(uint8_t), 1, fp) < 1)
-            return OUT_FILE_ERROR;
-      }
+      if (itm->body.data.initialized)
+        res = outSecWrite(&w, itm->body.data.data, itm->body.data.dataSize);
+      else
+        res = outSecFill(&w, 0, itm->body.data.dataSize);
     } else if (itm->class == OBJ_SEC_ITM_CLASS_ALIGN_DATA) {
+      size_t size = itm->body.alignData.effectiveSize;
       if (itm->body.alignData.nopFill) {
-        uint32_t tmp = toLE32(0x00000013); // nop = addi x0, x0, 0
-        assert((itm->body.alignData.effectiveSize % 4) == 0);
-        for (int i = 0; i < itm->body.alignData.effectiveSize; i += 4)
-          if (fwrite(&tmp, sizeof(uint32_t), 1, fp) < 1)
-            return OUT_FILE_ERROR;
+        assert((size % 2) == 0);
+        if (size % 4 != 0) {
+          uint16_t ctmp = toLE16(0x0001); // c.nop
+          res = outSecWrite(&w, &ctmp, sizeof(uint16_t));
+          size -= 2;
+        }
+        if (res == OUT_NO_ERROR)
+          res = outSecFill(&w, 0x00000013, size); // nop = addi x0, x0, 0
       } else {
-        uint8_t tmp = itm->body.alignData.fillByte;
-        for (int i = 0; i < itm->body.alignData.effectiveSize; i++)
-          if (fwrite(&tmp, sizeof(uint8_t), 1, fp) < 1)
-            return OUT_FILE_ERROR;
+        res = outSecFill(&w, itm->body.alignData.fillByte * 0x01010101U, size);
       }
     } else {
       assert(0 && "bug, unexpected item type in section");
     }
   }
-  return OUT_NO_ERROR;
+  if (res != OUT_NO_ERROR)
+    return res;
+  return outSecFlushZeros(&w);
 }
 
 
-enum {
-  PRG_ID_TEXT = 0,
-  PRG_ID_DATA,
-  PRG_NUM
-};
-
-enum {
-  SEC_ID_NULL = SHN_UNDEF,
-  SEC_ID_TEXT,
-  SEC_ID_DATA,
-  SEC_ID_SYMTAB,
-  SEC_NUM
-};
-
 typedef struct __attribute__((packed)) t_outputELFHead {
   Elf32_Ehdr e;
   Elf32_Phdr p[PRG_NUM];
@@ -302,15 +581,14 @@ t_outError outputToELF(t_object *obj, const char *fname)
   head.e.e_type = toLE16(ET_EXEC);
   head.e.e_machine = toLE16(EM_RISCV);
   head.e.e_version = toLE32(1);
-  head.e.e_phoff = toLE32((Elf32_Off)((intptr_t)head.p - (intptr_t)&head.e));
-  head.e.e_shoff = toLE32((Elf32_Off)((intptr_t)head.s - (intptr_t)&head.e));
-  head.e.e_flags = toLE32(0);
+  head.e.e_phoff = toLE32((Elf32_Off)offsetof(t_outputELFHead, p));
+  head.e.e_shoff = toLE32((Elf32_Off)offsetof(t_outputELFHead, s));
+  head.e.e_flags = toLE32(objGetCompression(obj) ? EF_RISCV_RVC : 0);
   head.e.e_ehsize = toLE16(sizeof(Elf32_Ehdr));
   head.e.e_phentsize = toLE16(sizeof(Elf32_Phdr));
   head.e.e_phnum = toLE16(PRG_NUM);
   head.e.e_shentsize = toLE16(sizeof(Elf32_Shdr));
-  head.e.e_shnum = toLE16(SEC_NUM);
-  head.e.e_shstrndx = toLE16(SEC_ID_SYMTAB);
+  head.e.e_shstrndx = toLE16(SEC_ID_STRTAB);
 
   t_objLabel *l_entry = objFindLabel(obj, "_start");
   if (!l_entry) {
@@ -321,16 +599,33 @@ t_outError outputToELF(t_object *obj, const char *fname)
     head.e.e_entry = toLE32(objLabelGetPointer(l_entry));
   }
 
-  Elf32_Addr textAddr = sizeof(t_outputELFHead);
-  Elf32_Addr dataAddr = textAddr + objSecGetSize(text);
-  Elf32_Addr strtabAddr = dataAddr + objSecGetSize(data);
-
   t_outStrTbl strTbl;
   initOutStrTbl(&strTbl);
-  Elf32_Word textSecName, dataSecName, strtabSecName;
+  Elf32_Word textSecName, dataSecName, strtabSecName, symtabSecName;
   outStrTblAddString(&strTbl, ".text", &textSecName);
   outStrTblAddString(&strTbl, ".data", &dataSecName);
   outStrTblAddString(&strTbl, ".strtab", &strtabSecName);
+  outStrTblAddString(&strTbl, ".symtab", &symtabSecName);
+  t_outSymTbl symTbl;
+  initOutSymTbl(&symTbl, obj, &strTbl);
+  t_outLineTbl lineTbl;
+  initOutLineTbl(&lineTbl, obj, &strTbl);
+  Elf32_Word srclinesSecName = 0;
+  if (lineTbl.count > 0)
+    outStrTblAddString(&strTbl, ".srclines", &srclinesSecName);
+
+  // The headers of sections which are not present are not written
+  int numSecs = lineTbl.count > 0 ? SEC_NUM : SEC_ID_SRCLINES;
+  size_t headSize =
+      offsetof(t_outputELFHead, s) + (size_t)numSecs * sizeof(Elf32_Shdr);
+  head.e.e_shnum = toLE16((Elf32_Half)numSecs);
+
+  Elf32_Addr textAddr = (Elf32_Addr)headSize;
+  Elf32_Addr dataAddr = textAddr + objSecGetSize(text);
+  Elf32_Addr strtabAddr = dataAddr + objSecGetSize(data);
+  Elf32_Addr symtabAddr = (strtabAddr + (Elf32_Addr)strTbl.tail + 3) & ~3U;
+  Elf32_Addr srclinesAddr =
+      symtabAddr + (Elf32_Addr)(symTbl.count * sizeof(Elf32_Sym));
 
   head.p[PRG_ID_TEXT] = outputSecToELFPHdr(text, textAddr, PF_R + PF_X);
   head.p[PRG_ID_DATA] = outputSecToELFPHdr(data, dataAddr, PF_R + PF_W);
@@ -339,15 +634,21 @@ t_outError outputToELF(t_object *obj, const char *fname)
       text, textAddr, textSecName, SHF_ALLOC + SHF_EXECINSTR);
   head.s[SEC_ID_DATA] =
       outputSecToELFSHdr(data, dataAddr, dataSecName, SHF_ALLOC + SHF_WRITE);
-  head.s[SEC_ID_SYMTAB] =
+  head.s[SEC_ID_STRTAB] =
       outputStrTabToELFSHdr(&strTbl, strtabAddr, strtabSecName);
+  head.s[SEC_ID_SYMTAB] =
+      outputSymTabToELFSHdr(&symTbl, symtabAddr, symtabSecName);
+  if (lineTbl.count > 0)
+    head.s[SEC_ID_SRCLINES] =
+        outputLineTabToELFSHdr(&lineTbl, srclinesAddr, srclinesSecName);
 
   FILE *fp = fopen(fname, "wb");
   if (fp == NULL) {
     res = OUT_FILE_ERROR;
     goto exit;
   }
-  if (fwrite(&head, sizeof(t_outputELFHead), 1, fp) < 1) {
+  setvbuf(fp, NULL, _IOFBF, OUT_BUFFER_SIZE);
+  if (fwrite(&head, headSize, 1, fp) < 1) {
     res = OUT_FILE_ERROR;
     goto exit;
   }
@@ -360,8 +661,16 @@ t_outError outputToELF(t_object *obj, const char *fname)
   res = outputStrTabContentToFile(fp, strtabAddr, &strTbl);
   if (res != OUT_NO_ERROR)
     goto exit;
+  res = outputSymTabContentToFile(fp, symtabAddr, &symTbl);
+  if (res != OUT_NO_ERROR)
+    goto exit;
+  res = outputLineTabContentToFile(fp, srclinesAddr, &lineTbl);
+  if (res != OUT_NO_ERROR)
+    goto exit;
 
 exit:
+  deinitOutLineTbl(&lineTbl);
+  deinitOutSymTbl(&symTbl);
   deinitOutStrTbl(&strTbl);
   if (fp)
     fclose(fp);
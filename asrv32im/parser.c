@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <ctype.h>
+#include <string.h>
 #include "parser.h"
 #include "errors.h"
 
@@ -14,80 +15,79 @@ enum {
   P_SYN_ERROR = -1
 };
 
+/* Numeric local labels can be declared many times. A back reference points
+ * to the last declaration, and a forward reference to the next one. */
+#define PARSER_LOCAL_BUCKETS 256
+
 typedef struct t_localLabel {
-  struct t_localLabel *next;
+  struct t_localLabel *next; // next label in the same bucket
   int identifier;
-  t_objLabel *label;
+  t_objLabel *back;
+  t_objLabel *forward;
 } t_localLabel;
 
 typedef struct t_parserState {
   t_lexer *lex;
-  t_token *curToken;
-  t_token *lookaheadToken;
+  t_token curToken;
+  t_token lookaheadToken;
   t_object *object;
   t_objSection *curSection;
   int numErrors;
-  t_localLabel *backLabels;
-  t_localLabel *forwardLabels;
+  t_localLabel *localLabels[PARSER_LOCAL_BUCKETS];
+  int srcFile;
+  int32_t srcLine;
 } t_parserState;
 
 
-static t_localLabel *parserGetLocalLabel(
-    t_parserState *state, int identifier, bool back)
+static t_localLabel *parserGetLocalLabel(t_parserState *state, int identifier)
 {
+  t_localLabel **bucket =
+      &state->localLabels[(unsigned)identifier % PARSER_LOCAL_BUCKETS];
   t_localLabel *cur;
-  if (back)
-    cur = state->backLabels;
-  else
-    cur = state->forwardLabels;
-  while (cur) {
+  for (cur = *bucket; cur != NULL; cur = cur->next) {
     if (cur->identifier == identifier)
-      break;
-    cur = cur->next;
+      return cur;
   }
-  if (cur)
-    return cur;
-  if (back)
-    return NULL;
 
   cur = calloc(1, sizeof(t_localLabel));
   if (!cur)
     fatalError("out of memory");
   cur->identifier = identifier;
+  cur->next = *bucket;
+  *bucket = cur;
+  return cur;
+}
+
+static t_objLabel *parserGetForwardLabel(
+    t_parserState *state, t_localLabel *label)
+{
+  if (label->forward)
+    return label->forward;
   char realLblName[50];
   static int progressive = 0;
-  snprintf(realLblName, 50, ".local_%d_%d", identifier, progressive++);
-  cur->label = objGetLabel(state->object, realLblName);
-  cur->next = state->forwardLabels;
-  state->forwardLabels = cur;
-  return cur;
+  snprintf(
+      realLblName, 50, ".local_%d_%d", label->identifier, progressive++);
+  label->forward = objGetLabel(state->object, realLblName);
+  return label->forward;
 }
 
 static void parserDeclareLocalLabel(t_parserState *state, t_localLabel *label)
 {
-  t_localLabel *prev = NULL, *cur = state->forwardLabels;
-  while (cur && cur != label) {
-    prev = cur;
-    cur = cur->next;
-  }
-  assert(cur != NULL && "attempted to declare a label which was never created");
-  if (prev == NULL) {
-    state->forwardLabels = label->next;
-  } else {
-    prev->next = label->next;
-  }
-  label->next = state->backLabels;
-  state->backLabels = label;
-  objSecDeclareLabel(state->curSection, label->label);
+  label->back = parserGetForwardLabel(state, label);
+  label->forward = NULL;
+  objSecDeclareLabel(state->curSection, label->back);
 }
 
-static void deleteLocalLabelList(t_localLabel *head)
+static void deleteLocalLabels(t_parserState *state)
 {
   t_localLabel *next;
-  while (head) {
-    next = head->next;
-    free(head);
-    head = next;
+  for (int i = 0; i < PARSER_LOCAL_BUCKETS; i++) {
+    t_localLabel *head = state->localLabels[i];
+    while (head) {
+      next = head->next;
+      free(head);
+      head = next;
+    }
   }
 }
 
@@ -96,22 +96,21 @@ static void parserEmitError(t_parserState *state, const char *msg)
 {
   if (!msg)
     msg = "unexpected token";
-  emitError(state->lookaheadToken->location, "%s", msg);
+  emitError(state->lookaheadToken.location, "%s", msg);
   state->numErrors++;
 }
 
 
 static void parserNextToken(t_parserState *state)
 {
-  assert(!(state->curToken && state->curToken->id == TOK_EOF));
-  deleteToken(state->curToken);
+  assert(state->curToken.id != TOK_EOF);
   state->curToken = state->lookaheadToken;
   state->lookaheadToken = lexNextToken(state->lex);
 }
 
 static t_parserError parserAccept(t_parserState *state, t_tokenID tok)
 {
-  if (state->lookaheadToken->id == tok) {
+  if (state->lookaheadToken.id == tok) {
     parserNextToken(state);
     return P_ACCEPT;
   }
@@ -134,7 +133,7 @@ static t_parserError expectRegister(
 {
   if (parserExpect(state, TOK_REGISTER, "expected a register") != P_ACCEPT)
     return P_SYN_ERROR;
-  *res = state->curToken->value.reg;
+  *res = state->curToken.value.reg;
   if (!last &&
       parserExpect(state, TOK_COMMA,
           "register name must be followed by a comma") != P_ACCEPT)
@@ -145,8 +144,8 @@ static t_parserError expectRegister(
 static t_parserError expectNumber(
     t_parserState *state, int32_t *res, int32_t min, int32_t max)
 {
-  if (state->lookaheadToken->id == TOK_NUMBER) {
-    int32_t value = state->lookaheadToken->value.number;
+  if (state->lookaheadToken.id == TOK_NUMBER) {
+    int32_t value = state->lookaheadToken.value.number;
     if (min <= value && value <= max) {
       parserNextToken(state);
       *res = value;
@@ -162,17 +161,22 @@ static t_parserError expectNumber(
 
 static t_parserError acceptLabel(t_parserState *state, t_instruction *instr)
 {
-  if (parserAccept(state, TOK_LOCAL_REF) == P_ACCEPT) {
-    int n = state->curToken->value.localRef;
+  if (state->lookaheadToken.id == TOK_LOCAL_REF) {
+    int n = state->lookaheadToken.value.localRef;
     bool back = n < 0;
     if (back)
       n = -n;
-    t_localLabel *ll = parserGetLocalLabel(state, n, back);
-    instr->label = ll->label;
+    t_localLabel *ll = parserGetLocalLabel(state, n);
+    if (back && !ll->back) {
+      parserEmitError(state, "local label referenced before its declaration");
+      return P_SYN_ERROR;
+    }
+    parserNextToken(state);
+    instr->label = back ? ll->back : parserGetForwardLabel(state, ll);
     return P_ACCEPT;
 
   } else if (parserAccept(state, TOK_ID) == P_ACCEPT) {
-    instr->label = objGetLabel(state->object, state->curToken->value.id);
+    instr->label = objGetLabel(state->object, state->curToken.value.id);
     return P_ACCEPT;
   }
 
@@ -181,10 +185,72 @@ static t_parserError acceptLabel(t_parserState *state, t_instruction *instr)
 
 static t_parserError expectLabel(t_parserState *state, t_instruction *instr)
 {
-  if (acceptLabel(state, instr) != P_ACCEPT) {
+  t_parserError res = acceptLabel(state, instr);
+  if (res == P_REJECT) {
     parserEmitError(state, "expected a label identifier");
     return P_SYN_ERROR;
   }
+  return res;
+}
+
+static t_parserError expectCSR(t_parserState *state, int32_t *res, bool last)
+{
+  static const struct {
+    const char *name;
+    int32_t number;
+  } csrNames[] = {
+      {   "cycle", 0xC00},
+      {    "time", 0xC01},
+      { "instret", 0xC02},
+      {  "cycleh", 0xC80},
+      {   "timeh", 0xC81},
+      {"instreth", 0xC82},
+      { "mhartid", 0xF14},
+      {      NULL,     0}
+  };
+
+  if (state->lookaheadToken.id == TOK_ID) {
+    int i;
+    for (i = 0; csrNames[i].name != NULL; i++) {
+      if (strcmp(csrNames[i].name, state->lookaheadToken.value.id) == 0)
+        break;
+    }
+    if (csrNames[i].name == NULL) {
+      parserEmitError(state, "unknown CSR name");
+      return P_SYN_ERROR;
+    }
+    parserNextToken(state);
+    *res = csrNames[i].number;
+  } else if (state->lookaheadToken.id == TOK_NUMBER) {
+    if (expectNumber(state, res, 0, 0xFFF) != P_ACCEPT)
+      return P_SYN_ERROR;
+  } else {
+    parserEmitError(state, "expected a CSR name or number");
+    return P_SYN_ERROR;
+  }
+
+  if (!last &&
+      parserExpect(state, TOK_COMMA, "CSR must be followed by a comma") !=
+          P_ACCEPT)
+    return P_SYN_ERROR;
+  return P_ACCEPT;
+}
+
+static t_parserError expectAtomicAddress(
+    t_parserState *state, t_instrRegID *res)
+{
+  // atomic instructions have no offset, but "0(reg)" is accepted as well
+  if (state->lookaheadToken.id == TOK_NUMBER) {
+    int32_t zero;
+    if (expectNumber(state, &zero, 0, 0) != P_ACCEPT)
+      return P_SYN_ERROR;
+  }
+  if (parserExpect(state, TOK_LPAR, "expected parenthesis") != P_ACCEPT)
+    return P_SYN_ERROR;
+  if (expectRegister(state, res, true) != P_ACCEPT)
+    return P_SYN_ERROR;
+  if (parserExpect(state, TOK_RPAR, "expected parenthesis") != P_ACCEPT)
+    return P_SYN_ERROR;
   return P_ACCEPT;
 }
 
@@ -198,7 +264,7 @@ enum {
 static t_parserError expectImmediate(
     t_parserState *state, t_instruction *instr, t_immSizeClass size)
 {
-  if (state->lookaheadToken->id == TOK_NUMBER) {
+  if (state->lookaheadToken.id == TOK_NUMBER) {
     instr->immMode = INSTR_IMM_CONST;
     int32_t min, max;
     if (size == IMM_SIZE_5) {
@@ -216,13 +282,13 @@ static t_parserError expectImmediate(
     return expectNumber(state, &instr->constant, min, max);
   }
 
-  if (state->lookaheadToken->id == TOK_LO) {
+  if (state->lookaheadToken.id == TOK_LO) {
     instr->immMode = INSTR_IMM_LBL_LO12;
-  } else if (state->lookaheadToken->id == TOK_HI) {
+  } else if (state->lookaheadToken.id == TOK_HI) {
     instr->immMode = INSTR_IMM_LBL_HI20;
-  } else if (state->lookaheadToken->id == TOK_PCREL_LO) {
+  } else if (state->lookaheadToken.id == TOK_PCREL_LO) {
     instr->immMode = INSTR_IMM_LBL_PCREL_LO12;
-  } else if (state->lookaheadToken->id == TOK_PCREL_HI) {
+  } else if (state->lookaheadToken.id == TOK_PCREL_HI) {
     instr->immMode = INSTR_IMM_LBL_PCREL_HI20;
   } else {
     parserEmitError(state, "expected valid immediate");
@@ -266,7 +332,13 @@ enum {
   FORMAT_BRANCH,   // mnemonic rs1, rs2, label
   FORMAT_BRANCH_Z, // mnemonic rs1, label
   FORMAT_JUMP,     // mnemonic label
-  FORMAT_SYSTEM    // mnemonic
+  FORMAT_SYSTEM,   // mnemonic
+  FORMAT_CSR,      // mnemonic rd, csr, rs1
+  FORMAT_CSRI,     // mnemonic rd, csr, imm
+  FORMAT_CSRR,     // mnemonic rd, csr
+  FORMAT_RDCNT,    // mnemonic rd
+  FORMAT_LR,       // mnemonic rd, (rs1)
+  FORMAT_AMO       // mnemonic rd, rs2, (rs1)
 };
 
 static t_instrFormat instrOpcodeToFormat(t_instrOpcode opcode)
@@ -346,6 +418,36 @@ static t_instrFormat instrOpcodeToFormat(t_instrOpcode opcode)
     case INSTR_OPC_ECALL:
     case INSTR_OPC_EBREAK:
       return FORMAT_SYSTEM;
+    case INSTR_OPC_CSRRW:
+    case INSTR_OPC_CSRRS:
+    case INSTR_OPC_CSRRC:
+      return FORMAT_CSR;
+    case INSTR_OPC_CSRRWI:
+    case INSTR_OPC_CSRRSI:
+    case INSTR_OPC_CSRRCI:
+      return FORMAT_CSRI;
+    case INSTR_OPC_CSRR:
+      return FORMAT_CSRR;
+    case INSTR_OPC_RDCYCLE:
+    case INSTR_OPC_RDCYCLEH:
+    case INSTR_OPC_RDTIME:
+    case INSTR_OPC_RDTIMEH:
+    case INSTR_OPC_RDINSTRET:
+    case INSTR_OPC_RDINSTRETH:
+      return FORMAT_RDCNT;
+    case INSTR_OPC_LR_W:
+      return FORMAT_LR;
+    case INSTR_OPC_SC_W:
+    case INSTR_OPC_AMOSWAP_W:
+    case INSTR_OPC_AMOADD_W:
+    case INSTR_OPC_AMOXOR_W:
+    case INSTR_OPC_AMOAND_W:
+    case INSTR_OPC_AMOOR_W:
+    case INSTR_OPC_AMOMIN_W:
+    case INSTR_OPC_AMOMAX_W:
+    case INSTR_OPC_AMOMINU_W:
+    case INSTR_OPC_AMOMAXU_W:
+      return FORMAT_AMO;
   }
   return -1;
 }
@@ -354,11 +456,15 @@ static t_instrFormat instrOpcodeToFormat(t_instrOpcode opcode)
 static t_parserError expectInstruction(t_parserState *state)
 {
   t_immSizeClass immSize;
+  t_parserError res;
   t_instruction instr = {0};
-  instr.location = state->lookaheadToken->location;
+  instr.location = state->lookaheadToken.location;
+  instr.srcFile = state->srcFile;
+  instr.srcLine = state->srcLine;
 
   parserExpect(state, TOK_MNEMONIC, NULL);
-  instr.opcode = state->curToken->value.mnemonic;
+  instr.opcode = state->curToken.value.mnemonic.opcode;
+  int32_t ordering = state->curToken.value.mnemonic.ordering;
 
   t_instrFormat format = instrOpcodeToFormat(instr.opcode);
   switch (format) {
@@ -389,7 +495,10 @@ static t_parserError expectInstruction(t_parserState *state)
     case FORMAT_LOAD:
       if (expectRegister(state, &instr.dest, false) != P_ACCEPT)
         return P_SYN_ERROR;
-      if (acceptLabel(state, &instr) == P_ACCEPT) {
+      res = acceptLabel(state, &instr);
+      if (res == P_SYN_ERROR)
+        return P_SYN_ERROR;
+      if (res == P_ACCEPT) {
         instr.opcode = instr.opcode - INSTR_OPC_LB + INSTR_OPC_LB_G;
         instr.immMode = INSTR_IMM_LBL;
       } else {
@@ -407,7 +516,10 @@ static t_parserError expectInstruction(t_parserState *state)
     case FORMAT_STORE:
       if (expectRegister(state, &instr.src2, false) != P_ACCEPT)
         return P_SYN_ERROR;
-      if (acceptLabel(state, &instr) == P_ACCEPT) {
+      res = acceptLabel(state, &instr);
+      if (res == P_SYN_ERROR)
+        return P_SYN_ERROR;
+      if (res == P_ACCEPT) {
         if (parserExpect(state, TOK_COMMA, "expected comma") != P_ACCEPT)
           return P_SYN_ERROR;
         if (expectRegister(state, &instr.dest, true) != P_ACCEPT)
@@ -446,7 +558,7 @@ static t_parserError expectInstruction(t_parserState *state)
       if (parserAccept(state, TOK_REGISTER) != P_ACCEPT) {
         instr.dest = 1; // RA (X1) register
       } else {
-        instr.dest = state->curToken->value.reg;
+        instr.dest = state->curToken.value.reg;
         if (parserExpect(state, TOK_COMMA,
                 "register name must be followed by a comma") != P_ACCEPT)
           return P_SYN_ERROR;
@@ -460,7 +572,7 @@ static t_parserError expectInstruction(t_parserState *state)
       if (expectRegister(state, &instr.dest, false) != P_ACCEPT)
         return P_SYN_ERROR;
       if (parserAccept(state, TOK_REGISTER) == P_ACCEPT) {
-        instr.src1 = state->curToken->value.reg;
+        instr.src1 = state->curToken.value.reg;
         if (parserExpect(state, TOK_COMMA,
                 "register name must be followed by a comma") != P_ACCEPT)
           return P_SYN_ERROR;
@@ -505,6 +617,50 @@ static t_parserError expectInstruction(t_parserState *state)
     case FORMAT_SYSTEM:
       break;
 
+    case FORMAT_CSR:
+      if (expectRegister(state, &instr.dest, false) != P_ACCEPT)
+        return P_SYN_ERROR;
+      if (expectCSR(state, &instr.constant, false) != P_ACCEPT)
+        return P_SYN_ERROR;
+      if (expectRegister(state, &instr.src1, true) != P_ACCEPT)
+        return P_SYN_ERROR;
+      break;
+
+    case FORMAT_CSRI:
+      if (expectRegister(state, &instr.dest, false) != P_ACCEPT)
+        return P_SYN_ERROR;
+      if (expectCSR(state, &instr.constant, false) != P_ACCEPT)
+        return P_SYN_ERROR;
+      // the 5-bit unsigned immediate is encoded in place of rs1
+      if (expectNumber(state, &instr.src1, 0, 31) != P_ACCEPT)
+        return P_SYN_ERROR;
+      break;
+
+    case FORMAT_CSRR:
+      if (expectRegister(state, &instr.dest, false) != P_ACCEPT)
+        return P_SYN_ERROR;
+      if (expectCSR(state, &instr.constant, true) != P_ACCEPT)
+        return P_SYN_ERROR;
+      break;
+
+    case FORMAT_RDCNT:
+      if (expectRegister(state, &instr.dest, true) != P_ACCEPT)
+        return P_SYN_ERROR;
+      break;
+
+    case FORMAT_LR:
+    case FORMAT_AMO:
+      if (expectRegister(state, &instr.dest, false) != P_ACCEPT)
+        return P_SYN_ERROR;
+      if (format == FORMAT_AMO &&
+          expectRegister(state, &instr.src2, false) != P_ACCEPT)
+        return P_SYN_ERROR;
+      if (expectAtomicAddress(state, &instr.src1) != P_ACCEPT)
+        return P_SYN_ERROR;
+      instr.immMode = INSTR_IMM_CONST;
+      instr.constant = ordering;
+      break;
+
     default:
       return P_SYN_ERROR;
   }
@@ -559,6 +715,8 @@ static char *performStringEscapes(t_fileLocation loc, char *begin)
             *out++ = '\013';
             break;
           case '\\':
+            *out++ = '\\';
+            break;
           case 'x':
           case 'X':
             c = (char)strtol(in, &in, 16);
@@ -594,27 +752,27 @@ static char *performStringEscapes(t_fileLocation loc, char *begin)
 static t_parserError expectData(t_parserState *state)
 {
   t_data data = {0};
-  data.location = state->lookaheadToken->location;
+  data.location = state->lookaheadToken.location;
 
   if (parserAccept(state, TOK_SPACE)) {
     if (parserExpect(state, TOK_NUMBER,
             "arguments to \".space\" must be numbers") != P_ACCEPT)
       return P_SYN_ERROR;
-    data.dataSize = (uint32_t)state->curToken->value.number;
+    data.dataSize = (uint32_t)state->curToken.value.number;
     data.initialized = false;
     objSecAppendData(state->curSection, data);
     return P_ACCEPT;
   }
 
   if (parserAccept(state, TOK_WORD) || parserAccept(state, TOK_HALF)) {
-    size_t dataSize = state->curToken->id == TOK_WORD ? 4 : 2;
+    size_t dataSize = state->curToken.id == TOK_WORD ? 4 : 2;
     do {
-      if (state->lookaheadToken->id != TOK_NUMBER) {
+      if (state->lookaheadToken.id != TOK_NUMBER) {
         parserEmitError(
             state, "arguments to \".word\" or \".half\" must be numbers");
         return P_SYN_ERROR;
       }
-      int32_t value = state->lookaheadToken->value.number;
+      int32_t value = state->lookaheadToken.value.number;
       if ((dataSize == 2) && (value < -0x8000 || value > 0xFFFF)) {
         parserEmitError(state,
             "arguments to \".half\" must be numbers between -32768 and 65536");
@@ -638,8 +796,8 @@ static t_parserError expectData(t_parserState *state)
     do {
       data.dataSize = sizeof(uint8_t);
       data.initialized = true;
-      if (state->lookaheadToken->id == TOK_NUMBER) {
-        int32_t value = state->lookaheadToken->value.number;
+      if (state->lookaheadToken.id == TOK_NUMBER) {
+        int32_t value = state->lookaheadToken.value.number;
         if (value < -128 || value > 255) {
           parserEmitError(state,
               "numeric arguments to \".byte\" must be between -128 and 255");
@@ -647,9 +805,9 @@ static t_parserError expectData(t_parserState *state)
         }
         data.data[0] = (uint8_t)value;
         parserNextToken(state);
-      } else if (state->lookaheadToken->id == TOK_CHARACTER) {
-        t_fileLocation loc = state->lookaheadToken->location;
-        char *bufBegin = state->lookaheadToken->value.string;
+      } else if (state->lookaheadToken.id == TOK_CHARACTER) {
+        t_fileLocation loc = state->lookaheadToken.location;
+        char *bufBegin = state->lookaheadToken.value.string;
         char *bufEnd = performStringEscapes(loc, bufBegin);
         if (bufEnd - bufBegin != 1) {
           parserEmitError(state,
@@ -674,8 +832,8 @@ static t_parserError expectData(t_parserState *state)
       if (parserExpect(state, TOK_STRING,
               "arguments to \".ascii\" must be strings") != P_ACCEPT)
         return P_SYN_ERROR;
-      t_fileLocation loc = state->curToken->location;
-      char *bufBegin = state->curToken->value.string;
+      t_fileLocation loc = state->curToken.location;
+      char *bufBegin = state->curToken.value.string;
       char *bufEnd = performStringEscapes(loc, bufBegin);
       data.dataSize = sizeof(char);
       data.initialized = true;
@@ -694,7 +852,7 @@ static t_parserError expectData(t_parserState *state)
 static t_parserError expectAlign(t_parserState *state)
 {
   t_alignData align = {0};
-  align.location = state->lookaheadToken->location;
+  align.location = state->lookaheadToken.location;
 
   t_tokenID alignType;
   if (parserAccept(state, TOK_ALIGN))
@@ -704,11 +862,11 @@ static t_parserError expectAlign(t_parserState *state)
   else
     return P_SYN_ERROR;
 
-  if (state->lookaheadToken->id != TOK_NUMBER) {
+  if (state->lookaheadToken.id != TOK_NUMBER) {
     parserEmitError(state, "expected alignment amount");
     return P_SYN_ERROR;
   }
-  int32_t amt = state->lookaheadToken->value.number;
+  int32_t amt = state->lookaheadToken.value.number;
   if (amt <= 0) {
     parserEmitError(
         state, "alignment amount must be a positive non-zero integer");
@@ -733,9 +891,11 @@ static t_parserError expectAlign(t_parserState *state)
     align.fillByte = (uint8_t)pad;
   } else {
     if (objSecGetID(state->curSection) == OBJ_SECTION_TEXT) {
-      if ((align.alignModulo % 4) != 0)
-        emitWarning(state->curToken->location,
-            "alignment in .text with an amount which is not a multiple of 4");
+      size_t nopSize = objGetCompression(state->object) ? 2 : 4;
+      if ((align.alignModulo % nopSize) != 0)
+        emitWarning(state->curToken.location,
+            "alignment in .text with an amount which is not a multiple of %d",
+            (int)nopSize);
       align.nopFill = true;
     } else {
       align.nopFill = false;
@@ -750,22 +910,57 @@ static t_parserError expectAlign(t_parserState *state)
 
 static t_parserError expectLineContent(t_parserState *state)
 {
-  if (state->lookaheadToken->id == TOK_MNEMONIC)
+  if (state->lookaheadToken.id == TOK_MNEMONIC)
     return expectInstruction(state);
-  if (state->lookaheadToken->id == TOK_SPACE ||
-      state->lookaheadToken->id == TOK_WORD ||
-      state->lookaheadToken->id == TOK_HALF ||
-      state->lookaheadToken->id == TOK_BYTE ||
-      state->lookaheadToken->id == TOK_ASCII)
+  if (state->lookaheadToken.id == TOK_SPACE ||
+      state->lookaheadToken.id == TOK_WORD ||
+      state->lookaheadToken.id == TOK_HALF ||
+      state->lookaheadToken.id == TOK_BYTE ||
+      state->lookaheadToken.id == TOK_ASCII)
     return expectData(state);
-  if (state->lookaheadToken->id == TOK_ALIGN ||
-      state->lookaheadToken->id == TOK_BALIGN)
+  if (state->lookaheadToken.id == TOK_ALIGN ||
+      state->lookaheadToken.id == TOK_BALIGN)
     return expectAlign(state);
   parserEmitError(state, "expected a data directive or an instruction");
   return P_SYN_ERROR;
 }
 
 
+static t_parserError expectFile(t_parserState *state)
+{
+  int32_t num;
+  if (expectNumber(state, &num, 1, OBJ_MAX_SOURCE_FILE) != P_ACCEPT)
+    return P_SYN_ERROR;
+  if (parserExpect(state, TOK_STRING, ".file needs a file name") != P_ACCEPT)
+    return P_SYN_ERROR;
+  char *name = state->curToken.value.string;
+  *performStringEscapes(state->curToken.location, name) = '\0';
+  objSetSourceFile(state->object, num, name);
+  return parserExpect(state, TOK_NEWLINE, "expected end of the line");
+}
+
+static t_parserError expectLoc(t_parserState *state)
+{
+  int32_t num, line, column;
+  if (expectNumber(state, &num, 1, OBJ_MAX_SOURCE_FILE) != P_ACCEPT)
+    return P_SYN_ERROR;
+  if (!objGetSourceFile(state->object, num)) {
+    parserEmitError(state, "file number not declared with .file");
+    return P_SYN_ERROR;
+  }
+  // Line zero marks the following instructions as not from the source
+  if (expectNumber(state, &line, 0, OBJ_MAX_SOURCE_LINE) != P_ACCEPT)
+    return P_SYN_ERROR;
+  // The column is accepted for compatibility, but not recorded
+  if (state->lookaheadToken.id == TOK_NUMBER &&
+      expectNumber(state, &column, 0, INT32_MAX) != P_ACCEPT)
+    return P_SYN_ERROR;
+  state->srcFile = num;
+  state->srcLine = line;
+  return parserExpect(state, TOK_NEWLINE, "expected end of the line");
+}
+
+
 static t_parserError expectLine(t_parserState *state)
 {
   if (parserAccept(state, TOK_NEWLINE) == P_ACCEPT)
@@ -787,8 +982,13 @@ static t_parserError expectLine(t_parserState *state)
         state, TOK_NEWLINE, ".global cannot have more than one argument");
   }
 
-  if (state->lookaheadToken->id == TOK_NUMBER) {
-    int n = state->lookaheadToken->value.number;
+  if (parserAccept(state, TOK_FILE) == P_ACCEPT)
+    return expectFile(state);
+  if (parserAccept(state, TOK_LOC) == P_ACCEPT)
+    return expectLoc(state);
+
+  if (state->lookaheadToken.id == TOK_NUMBER) {
+    int n = state->lookaheadToken.value.number;
     if (n < 0) {
       parserEmitError(state, "local labels must be positive numbers");
       return P_SYN_ERROR;
@@ -797,10 +997,10 @@ static t_parserError expectLine(t_parserState *state)
     if (parserExpect(state, TOK_COLON,
             "expected colon after number to define a local label") != P_ACCEPT)
       return P_SYN_ERROR;
-    t_localLabel *ll = parserGetLocalLabel(state, n, 0);
+    t_localLabel *ll = parserGetLocalLabel(state, n);
     parserDeclareLocalLabel(state, ll);
   } else if (parserAccept(state, TOK_ID) == P_ACCEPT) {
-    char *id = state->curToken->value.id;
+    char *id = state->curToken.value.id;
     t_objLabel *label = objGetLabel(state->object, id);
     if (parserExpect(state, TOK_COLON,
             "label declaration without trailing comma") != P_ACCEPT)
@@ -817,17 +1017,21 @@ static t_parserError expectLine(t_parserState *state)
 }
 
 
-t_object *parseObject(t_lexer *lex)
+t_object *parseObject(t_lexer *lex, bool compress)
 {
   t_parserState state;
   state.lex = lex;
   state.object = newObject();
+  objSetCompression(state.object, compress);
   state.curSection = objGetSection(state.object, OBJ_SECTION_TEXT);
   state.numErrors = 0;
-  state.curToken = NULL;
+  // No token was consumed yet
+  state.curToken = (t_token){.id = TOK_UNRECOGNIZED};
   state.lookaheadToken = lexNextToken(lex);
-  state.backLabels = NULL;
-  state.forwardLabels = NULL;
+  for (int i = 0; i < PARSER_LOCAL_BUCKETS; i++)
+    state.localLabels[i] = NULL;
+  state.srcFile = 0;
+  state.srcLine = 0;
 
   while (parserAccept(&state, TOK_EOF) != P_ACCEPT) {
     t_parserError err = expectLine(&state);
@@ -837,17 +1041,14 @@ t_object *parseObject(t_lexer *lex)
         break;
       }
       // try to ignore the error and advance to the next line
-      while (state.lookaheadToken->id != TOK_NEWLINE &&
-          state.lookaheadToken->id != TOK_EOF) {
+      while (state.lookaheadToken.id != TOK_NEWLINE &&
+          state.lookaheadToken.id != TOK_EOF) {
         parserNextToken(&state);
       }
     }
   }
 
-  deleteToken(state.curToken);
-  deleteToken(state.lookaheadToken);
-  deleteLocalLabelList(state.backLabels);
-  deleteLocalLabelList(state.forwardLabels);
+  deleteLocalLabels(&state);
 
   if (state.numErrors > 0) {
     fprintf(stderr, "%d error(s) generated.\n", state.numErrors);
@@ -4,6 +4,6 @@
 #include "lexer.h"
 #include "object.h"
 
-t_object *parseObject(t_lexer *lex);
+t_object *parseObject(t_lexer *lex, bool compress);
 
 #endif
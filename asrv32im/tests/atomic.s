@@ -0,0 +1,16 @@
+        .text
+
+_start: lr.w a0, (a1)
+        lr.w.aq t0, 0(sp)
+        sc.w a0, a2, (a1)
+        sc.w.rl a0, a2, (a1)
+        amoswap.w a0, a1, (a2)
+        amoadd.w.aqrl a0, a1, (a2)
+        amoxor.w a0, a1, (a2)
+        amoand.w a0, a1, (a2)
+        amoor.w a0, a1, (a2)
+        amomin.w a0, a1, (a2)
+        amomax.w a0, a1, (a2)
+        amominu.w a0, a1, (a2)
+        AMOMAXU.W.AQ a0, a1, (a2)
+        csrr a0, mhartid
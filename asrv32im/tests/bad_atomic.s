@@ -0,0 +1,7 @@
+        .text
+
+_start: lr.w a0, 4(a1)
+        amoadd.w a0, (a1)
+        add.aq a0, a1, a2
+        amoadd.w.rlaq a0, a1, (a2)
+        sc.w a0, a1, a2
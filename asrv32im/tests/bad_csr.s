@@ -0,0 +1,9 @@
+        .text
+
+_start: csrr x1, badcsr
+        csrr x1, 4096
+        csrr x1, -1
+        csrrwi x1, cycle, 32
+        csrrs x1, x2, x3
+        rdcycle x1, x2
+        csrr x1
@@ -0,0 +1,7 @@
+_start:
+1: j 1f
+  j 2b
+  lw a0, 3b
+  sw a0, 1b, t0
+1: j 1b
+1: beq a0, a1, 1b
@@ -0,0 +1,8 @@
+  .file 0 "zero.src"
+  .file 256 "big.src"
+  .file 1
+  .file 1 "a.src" 2
+  .loc 2 1
+  .loc 1 -1
+  .loc 1 16777216
+  .loc 1 3 4 5
@@ -0,0 +1,19 @@
+        .text
+
+_start: csrrw x1, cycle, x2
+        csrrs x1, time, x0
+        csrrc x31, instret, x5
+        csrrwi x1, cycleh, 0
+        csrrsi x1, timeh, 31
+        csrrci x1, instreth, 7
+        csrrs x1, 0xC00, x0
+        csrrs x1, 4095, x0
+
+        csrr x1, cycle
+        csrr x2, 0xC02
+        rdcycle x3
+        rdcycleh x4
+        rdtime x5
+        rdtimeh x6
+        rdinstret x7
+        rdinstreth x8
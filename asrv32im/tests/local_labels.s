@@ -0,0 +1,21 @@
+.text
+_start:
+1:
+  j 1f
+2:
+  beqz a0, 1f
+1:
+  bnez a1, 1b
+  jal ra, 2b
+1:
+  la a2, 1f
+  la a3, 1b
+  j 2f
+2:
+  lw a4, 1f
+  j 2b
+.data
+1:
+  .word 1
+2:
+  .word 2
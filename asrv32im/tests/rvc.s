@@ -0,0 +1,44 @@
+_start:
+  c0: addi s0, sp, 1020
+  lw a0, 124(a5)
+  sw a5, 0(a0)
+  nop
+  addi t1, t1, -32
+  jal ra, c1
+  li a0, 31
+  addi sp, sp, 496
+  lui t0, 0xFFFFF
+  srli a4, a4, 31
+  srai a4, a4, 1
+  andi s1, s1, 31
+  sub s0, s0, a5
+  xor s0, a5, s0
+  or s1, s1, a0
+  and a2, a2, a3
+  j c0
+  beqz a5, c0
+  bnez s0, c2
+  slli t6, t6, 31
+  lw ra, 252(sp)
+  jalr zero, 0(ra)
+  add ra, zero, a0
+  ebreak
+  jalr ra, 0(t0)
+  add a0, a0, a1
+  sw t6, 0(sp)
+  .balign 2
+c1:
+  # no compressed encoding fits these
+  addi s0, sp, 1024
+  lw a0, 128(a5)
+  addi a0, a1, 1
+  lui zero, 1
+  sub t0, t0, t1
+  jalr ra, 4(t0)
+  beq a0, a1, c1
+  beqz a0, far
+c2:
+  .align 3
+  .space 2048
+far:
+  jal zero, c1
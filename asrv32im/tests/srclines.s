@@ -0,0 +1,19 @@
+  .file 1 "main.src"
+  .file 3 "lib\\util \"v2\".src"
+.text
+_start:
+  .loc 1 10
+  li a0, 0x12345
+  addi a0, a0, 1
+  .loc 3 2 5
+  la a1, value
+  .loc 1 10
+  nop
+  .loc 1 0
+  nop
+  .loc 1 11
+  ecall
+.data
+  .loc 1 12
+value:
+  .word 42
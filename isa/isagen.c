@@ -0,0 +1,440 @@
+/* Generates the instruction tables of asrv32im and simrv32im from the
+ * description of the instruction set in rv32im.isa.
+ *
+ * The simulator gets an enumeration of the instructions and a two level
+ * decoder: the major opcode and funct3 of an instruction index a table of
+ * short lists of candidates, and the first candidate whose fixed bits match
+ * is the instruction. The assembler gets the fixed bits of each instruction,
+ * indexed by its opcode in the assembler. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <getopt.h>
+
+#define GEN_MAX_OPCODES 32
+#define GEN_MAX_INSTS 255
+#define GEN_NAME_LEN 16
+#define GEN_NUM_BUCKETS 1024
+#define GEN_DECODE_LIST 0x8000
+#define GEN_MAX_LIST 4096
+#define GEN_MAX_LINE 256
+
+typedef int t_genFormat;
+enum {
+  GEN_FMT_R = 0,
+  GEN_FMT_I,
+  GEN_FMT_SH,
+  GEN_FMT_L,
+  GEN_FMT_S,
+  GEN_FMT_B,
+  GEN_FMT_U,
+  GEN_FMT_J,
+  GEN_FMT_SYS,
+  GEN_FMT_CSR,
+  GEN_FMT_CSRI,
+  GEN_FMT_AMO,
+  GEN_FMT_LR,
+  GEN_NUM_FORMATS
+};
+
+typedef struct t_genFormatInfo {
+  const char *name;
+  uint32_t mask;
+  // position of the additional fixed field, or -1 if there is none
+  int fieldShift;
+  bool hasFunct3;
+  // instruction type used by the encoder of the assembler
+  char encType;
+} t_genFormatInfo;
+
+// In the same order as t_genFormat
+static const t_genFormatInfo genFormats[GEN_NUM_FORMATS] = {
+    {   "R", 0xFE00707F, 25,  true, 'R'},
+    {   "I", 0x0000707F, -1,  true, 'I'},
+    {  "SH", 0xFE00707F, 25,  true, 'I'},
+    {   "L", 0x0000707F, -1,  true, 'I'},
+    {   "S", 0x0000707F, -1,  true, 'S'},
+    {   "B", 0x0000707F, -1,  true, 'B'},
+    {   "U", 0x0000007F, -1, false, 'U'},
+    {   "J", 0x0000007F, -1, false, 'J'},
+    { "SYS", 0xFFF0707F, 20,  true, 'I'},
+    { "CSR", 0x0000707F, -1,  true, 'I'},
+    {"CSRI", 0x0000707F, -1,  true, 'I'},
+    { "AMO", 0xF800707F, 27,  true, 'A'},
+    {  "LR", 0xF9F0707F, 27,  true, 'A'},
+};
+
+typedef struct t_genOpcode {
+  char name[GEN_NAME_LEN];
+  uint32_t value;
+} t_genOpcode;
+
+typedef struct t_genInst {
+  char mnemonic[GEN_NAME_LEN];
+  // mnemonic usable in C identifiers
+  char ident[GEN_NAME_LEN];
+  t_genFormat format;
+  uint32_t match;
+  uint32_t mask;
+} t_genInst;
+
+t_genOpcode genOpcodes[GEN_MAX_OPCODES];
+int genNumOpcodes = 0;
+t_genInst genInsts[GEN_MAX_INSTS];
+int genNumInsts = 0;
+
+
+void usage(const char *name)
+{
+  puts("Instruction table generator for asrv32im and simrv32im");
+  printf("usage: %s [options] file\n\n", name);
+  puts("Options:");
+  puts("  -c, --decoder         Generates the decoder tables of the simulator");
+  puts("  -e, --encoder         Generates the encoder tables of the assembler");
+  puts("  -h, --header          Generates the declarations of the simulator");
+  puts("  -o, --output=FILE     Writes the output to FILE (default stdout)");
+  puts("      --help            Displays available options");
+}
+
+
+static bool genParseNumber(const char *str, uint32_t max, uint32_t *out)
+{
+  char *end;
+  unsigned long value = strtoul(str, &end, 0);
+  if (end == str || *end != '\0' || value > max)
+    return false;
+  *out = (uint32_t)value;
+  return true;
+}
+
+static bool genParseLine(char *line, const char *file, int lineNum)
+{
+  char *tokens[6];
+  int n = 0;
+  char *comment = strchr(line, '#');
+  if (comment)
+    *comment = '\0';
+  const char *sep = " \t\r\n";
+  for (char *tok = strtok(line, sep); tok && n < 6; tok = strtok(NULL, sep))
+    tokens[n++] = tok;
+  if (n == 0)
+    return true;
+
+  if (strcmp(tokens[0], "opcode") == 0) {
+    if (n != 3 || strlen(tokens[1]) >= GEN_NAME_LEN) {
+      fprintf(stderr, "%s:%d: expected \"opcode NAME VALUE\"\n", file, lineNum);
+      return false;
+    }
+    if (genNumOpcodes == GEN_MAX_OPCODES) {
+      fprintf(stderr, "%s:%d: too many opcodes\n", file, lineNum);
+      return false;
+    }
+    t_genOpcode *opc = &genOpcodes[genNumOpcodes];
+    if (!genParseNumber(tokens[2], 0x7F, &opc->value) ||
+        (opc->value & 3) != 3) {
+      fprintf(stderr, "%s:%d: invalid opcode %s\n", file, lineNum, tokens[2]);
+      return false;
+    }
+    strcpy(opc->name, tokens[1]);
+    genNumOpcodes++;
+    return true;
+  }
+
+  if (n < 4 || n > 5 || strlen(tokens[0]) >= GEN_NAME_LEN) {
+    fprintf(stderr, "%s:%d: expected \"MNEMONIC FORMAT OPCODE FUNCT3 "
+        "[FIELD]\"\n", file, lineNum);
+    return false;
+  }
+  if (genNumInsts == GEN_MAX_INSTS) {
+    fprintf(stderr, "%s:%d: too many instructions\n", file, lineNum);
+    return false;
+  }
+  t_genInst *inst = &genInsts[genNumInsts];
+  strcpy(inst->mnemonic, tokens[0]);
+  for (int i = 0; tokens[0][i]; i++)
+    inst->ident[i] = tokens[0][i] == '.' ? '_' : tokens[0][i];
+
+  for (inst->format = 0; inst->format < GEN_NUM_FORMATS; inst->format++) {
+    if (strcmp(tokens[1], genFormats[inst->format].name) == 0)
+      break;
+  }
+  if (inst->format == GEN_NUM_FORMATS) {
+    fprintf(stderr, "%s:%d: unknown format %s\n", file, lineNum, tokens[1]);
+    return false;
+  }
+  const t_genFormatInfo *fmt = &genFormats[inst->format];
+
+  int opc;
+  for (opc = 0; opc < genNumOpcodes; opc++) {
+    if (strcmp(tokens[2], genOpcodes[opc].name) == 0)
+      break;
+  }
+  if (opc == genNumOpcodes) {
+    fprintf(stderr, "%s:%d: unknown opcode %s\n", file, lineNum, tokens[2]);
+    return false;
+  }
+  inst->match = genOpcodes[opc].value;
+  inst->mask = fmt->mask;
+
+  uint32_t funct3;
+  if (!fmt->hasFunct3) {
+    if (strcmp(tokens[3], "-") != 0) {
+      fprintf(stderr, "%s:%d: format %s has no funct3\n", file, lineNum,
+          fmt->name);
+      return false;
+    }
+  } else if (!genParseNumber(tokens[3], 7, &funct3)) {
+    fprintf(stderr, "%s:%d: invalid funct3 %s\n", file, lineNum, tokens[3]);
+    return false;
+  } else {
+    inst->match |= funct3 << 12;
+  }
+
+  if ((fmt->fieldShift < 0) != (n == 4)) {
+    fprintf(stderr, "%s:%d: format %s %s a fixed field\n", file, lineNum,
+        fmt->name, fmt->fieldShift < 0 ? "does not have" : "requires");
+    return false;
+  }
+  if (fmt->fieldShift >= 0) {
+    uint32_t field;
+    uint32_t max = fmt->mask >> fmt->fieldShift;
+    if (!genParseNumber(tokens[4], max, &field)) {
+      fprintf(stderr, "%s:%d: invalid field %s\n", file, lineNum, tokens[4]);
+      return false;
+    }
+    inst->match |= field << fmt->fieldShift;
+  }
+
+  for (int i = 0; i < genNumInsts; i++) {
+    const t_genInst *other = &genInsts[i];
+    if (strcmp(other->mnemonic, inst->mnemonic) == 0) {
+      fprintf(stderr, "%s:%d: duplicate instruction %s\n", file, lineNum,
+          inst->mnemonic);
+      return false;
+    }
+    // Two encodings overlap if they agree on all the bits fixed by both
+    if (((other->match ^ inst->match) & other->mask & inst->mask) == 0) {
+      fprintf(stderr, "%s:%d: encoding of %s overlaps with %s\n", file,
+          lineNum, inst->mnemonic, other->mnemonic);
+      return false;
+    }
+  }
+  genNumInsts++;
+  return true;
+}
+
+static bool genParseFile(const char *file)
+{
+  FILE *fp = fopen(file, "r");
+  if (!fp) {
+    fprintf(stderr, "Could not open %s\n", file);
+    return false;
+  }
+  char line[GEN_MAX_LINE];
+  bool ok = true;
+  for (int lineNum = 1; ok && fgets(line, GEN_MAX_LINE, fp); lineNum++)
+    ok = genParseLine(line, file, lineNum);
+  fclose(fp);
+  return ok;
+}
+
+
+static void genPrintHeader(FILE *out, const char *file)
+{
+  const char *base = strrchr(file, '/');
+  if (base)
+    file = base + 1;
+  fprintf(out, "/* Generated by isagen from %s, do not edit */\n\n", file);
+}
+
+static void genPrintDeclarations(FILE *out)
+{
+  fputs("#ifndef ISA_GEN_H\n#define ISA_GEN_H\n\n#include <stdint.h>\n\n", out);
+  for (int i = 0; i < genNumOpcodes; i++)
+    fprintf(out, "#define ISA_INST_OPCODE_%s 0x%02" PRIX32 "\n",
+        genOpcodes[i].name, genOpcodes[i].value);
+
+  fputs("\ntypedef int t_isaFormat;\nenum {\n", out);
+  for (int i = 0; i < GEN_NUM_FORMATS; i++)
+    fprintf(out, "  ISA_FMT_%s%s,\n", genFormats[i].name, i == 0 ? " = 0" : "");
+  fputs("  ISA_NUM_FORMATS\n};\n", out);
+
+  fputs("\ntypedef int t_isaInstID;\nenum {\n  ISA_ID_ILLEGAL = 0,\n", out);
+  for (int i = 0; i < genNumInsts; i++)
+    fprintf(out, "  ISA_ID_%s,\n", genInsts[i].ident);
+  fputs("  ISA_NUM_IDS\n};\n", out);
+
+  fputs("\n/* X(ID, FORMAT) for each instruction, in the order of the IDs */\n"
+        "#define ISA_INST_LIST(X) \\\n", out);
+  for (int i = 0; i < genNumInsts; i++)
+    fprintf(out, "  X(%s, %s)%s\n", genInsts[i].ident,
+        genFormats[genInsts[i].format].name,
+        i + 1 < genNumInsts ? " \\" : "");
+
+  fprintf(out, "\n/* Marks the entries of isaDecodeIndex which point to a "
+      "list of candidates\n * in isaDecodeList, instead of being an ID */\n"
+      "#define ISA_DECODE_LIST 0x%04X\n", GEN_DECODE_LIST);
+  fputs("\nextern const uint16_t isaDecodeIndex[1024];\n"
+        "extern const uint8_t isaDecodeList[];\n"
+        "extern const uint32_t isaDecodeMatch[ISA_NUM_IDS];\n"
+        "extern const uint32_t isaDecodeMask[ISA_NUM_IDS];\n"
+        "extern const uint8_t isaFormat[ISA_NUM_IDS];\n"
+        "extern const char *const isaMnemonic[ISA_NUM_IDS];\n"
+        "\n#endif\n", out);
+}
+
+static void genPrintDecoder(FILE *out)
+{
+  // The candidates of the buckets which are not decided by the major opcode
+  // and funct3 alone, terminated by ISA_ID_ILLEGAL. Buckets with the same
+  // candidates share the list.
+  uint8_t list[GEN_MAX_LIST];
+  uint16_t index[GEN_NUM_BUCKETS];
+  int listLen = 0;
+
+  for (int b = 0; b < GEN_NUM_BUCKETS; b++) {
+    uint32_t bits = (uint32_t)(b & 0x7F) | (uint32_t)(b >> 7) << 12;
+    uint8_t cand[GEN_MAX_INSTS + 1];
+    int n = 0;
+    // Candidates which fix more bits come first
+    for (int fixed = 32; fixed >= 0; fixed--) {
+      for (int i = 0; i < genNumInsts; i++) {
+        const t_genInst *inst = &genInsts[i];
+        uint32_t bucketMask = inst->mask & 0x707F;
+        if (__builtin_popcount(inst->mask) == fixed &&
+            (bits & bucketMask) == (inst->match & bucketMask))
+          cand[n++] = (uint8_t)(i + 1);
+      }
+    }
+    if (n == 0 || (n == 1 && (genInsts[cand[0] - 1].mask & ~0x707F) == 0)) {
+      index[b] = n == 0 ? 0 : cand[0];
+      continue;
+    }
+    cand[n++] = 0;
+
+    int start;
+    for (start = 0; start + n <= listLen; start++) {
+      if (memcmp(&list[start], cand, (size_t)n) == 0)
+        break;
+    }
+    if (start + n > listLen) {
+      if (listLen + n > (int)sizeof(list)) {
+        fprintf(stderr, "The decoder tables are too large\n");
+        exit(1);
+      }
+      memcpy(&list[listLen], cand, (size_t)n);
+      start = listLen;
+      listLen += n;
+    }
+    index[b] = (uint16_t)(GEN_DECODE_LIST | start);
+  }
+
+  fputs("#include <stddef.h>\n#include \"isa_gen.h\"\n\n", out);
+  fputs("/* Indexed by the major opcode followed by funct3 */\n"
+        "const uint16_t isaDecodeIndex[1024] = {", out);
+  for (int b = 0; b < GEN_NUM_BUCKETS; b++)
+    fprintf(out, "%s0x%04" PRIX16 ",", b % 8 ? " " : "\n    ", index[b]);
+  fputs("\n};\n\nconst uint8_t isaDecodeList[] = {", out);
+  for (int i = 0; i < listLen; i++)
+    fprintf(out, "%s%3d,", i % 12 ? " " : "\n    ", list[i]);
+
+  fputs("\n};\n\nconst uint32_t isaDecodeMatch[ISA_NUM_IDS] = {\n"
+        "    [ISA_ID_ILLEGAL] = 0xFFFFFFFF,\n", out);
+  for (int i = 0; i < genNumInsts; i++)
+    fprintf(out, "    [ISA_ID_%s] = 0x%08" PRIX32 ",\n", genInsts[i].ident,
+        genInsts[i].match);
+  fputs("};\n\nconst uint32_t isaDecodeMask[ISA_NUM_IDS] = {\n"
+        "    [ISA_ID_ILLEGAL] = 0x00000000,\n", out);
+  for (int i = 0; i < genNumInsts; i++)
+    fprintf(out, "    [ISA_ID_%s] = 0x%08" PRIX32 ",\n", genInsts[i].ident,
+        genInsts[i].mask);
+  fputs("};\n\nconst uint8_t isaFormat[ISA_NUM_IDS] = {\n", out);
+  for (int i = 0; i < genNumInsts; i++)
+    fprintf(out, "    [ISA_ID_%s] = ISA_FMT_%s,\n", genInsts[i].ident,
+        genFormats[genInsts[i].format].name);
+  fputs("};\n\nconst char *const isaMnemonic[ISA_NUM_IDS] = {\n"
+        "    [ISA_ID_ILLEGAL] = NULL,\n", out);
+  for (int i = 0; i < genNumInsts; i++)
+    fprintf(out, "    [ISA_ID_%s] = \"%s\",\n", genInsts[i].ident,
+        genInsts[i].mnemonic);
+  fputs("};\n", out);
+}
+
+static void genPrintEncoder(FILE *out)
+{
+  fputs("static const t_encInstrData encInstrData[] = {\n", out);
+  for (int i = 0; i < genNumInsts; i++)
+    fprintf(out, "    [INSTR_OPC_%s] = {'%c', 0x%08" PRIX32 "},\n",
+        genInsts[i].ident, genFormats[genInsts[i].format].encType,
+        genInsts[i].match);
+  fputs("};\n", out);
+}
+
+
+int main(int argc, char *argv[])
+{
+  int ch;
+  static const struct option options[] = {
+      {"decoder",       no_argument, NULL, 'c'},
+      {"encoder",       no_argument, NULL, 'e'},
+      { "header",       no_argument, NULL, 'h'},
+      { "output", required_argument, NULL, 'o'},
+      {   "help",       no_argument, NULL, 'H'},
+      {     NULL,                 0, NULL,   0},
+  };
+
+  char *name = argv[0];
+  char *outFile = NULL;
+  int mode = 0;
+
+  while ((ch = getopt_long(argc, argv, "ceho:", options, NULL)) != -1) {
+    switch (ch) {
+      case 'c':
+      case 'e':
+      case 'h':
+        mode = ch;
+        break;
+      case 'o':
+        outFile = optarg;
+        break;
+      case 'H':
+        usage(name);
+        return 0;
+      default:
+        usage(name);
+        return 1;
+    }
+  }
+  argc -= optind;
+  argv += optind;
+
+  if (argc != 1 || mode == 0) {
+    usage(name);
+    return 1;
+  }
+  if (!genParseFile(argv[0]))
+    return 1;
+
+  FILE *out = stdout;
+  if (outFile && !(out = fopen(outFile, "w"))) {
+    fprintf(stderr, "Could not open %s\n", outFile);
+    return 1;
+  }
+  genPrintHeader(out, argv[0]);
+  if (mode == 'h')
+    genPrintDeclarations(out);
+  else if (mode == 'c')
+    genPrintDecoder(out);
+  else
+    genPrintEncoder(out);
+  if (out != stdout && fclose(out) != 0) {
+    fprintf(stderr, "Could not write %s\n", outFile);
+    remove(outFile);
+    return 1;
+  }
+  return 0;
+}
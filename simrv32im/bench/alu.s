@@ -0,0 +1,19 @@
+# Integer ALU operations with a loop-carried dependency chain
+.text
+_start: li t0,2000000
+        li a0,0x12345678
+        li a1,0x9abcdef0
+1:      add a2,a0,a1
+        xor a0,a2,a1
+        slli a3,a0,3
+        srli a4,a0,5
+        or a1,a3,a4
+        and a5,a1,a2
+        sub a0,a0,a5
+        sltu a6,a0,a1
+        add a1,a1,a6
+        addi t0,t0,-1
+        bnez t0,1b
+        li a0,0
+        li a7,93
+        ecall
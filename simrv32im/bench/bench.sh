@@ -0,0 +1,80 @@
+#!/bin/sh
+# Measures the speed of the simulator in MIPS on a set of programs.
+#
+# usage: bench.sh [-w] BASELINE PROGRAM...
+#
+# Every program runs RUNS times, and the mean and standard deviation of the
+# speeds reported by 'simrv32im -s' are printed. With -w the means are saved
+# to BASELINE, otherwise they are compared to the ones in BASELINE (if it
+# exists), and the script fails when any program became slower by more than
+# TOLERANCE percent and by more than twice the standard deviation.
+
+SIM=${SIM:-../../bin/simrv32im}
+RUNS=${RUNS:-5}
+TOLERANCE=${TOLERANCE:-5}
+
+write=0
+if [ "$1" = "-w" ]; then
+  write=1
+  shift
+fi
+baseline=$1
+shift
+
+if [ $write -eq 1 ]; then
+  : > "$baseline"
+elif [ ! -f "$baseline" ]; then
+  echo "info: no baseline found, run 'make baseline' to save one"
+fi
+
+printf '%-24s %10s %8s %10s %8s\n' PROGRAM MIPS STDDEV BASELINE DELTA
+failed=0
+for prg in "$@"; do
+  name=$(basename "$prg" .o)
+  speeds=''
+  i=0
+  while [ $i -lt "$RUNS" ]; do
+    speed=$("$SIM" -s "$prg" < /dev/null 2>&1 > /dev/null |
+        sed -n 's/^Simulation speed: \([0-9.]*\) MIPS$/\1/p')
+    if [ -z "$speed" ]; then
+      echo "error: no statistics from $prg" >&2
+      exit 1
+    fi
+    speeds="$speeds $speed"
+    i=$((i + 1))
+  done
+  base=''
+  if [ $write -eq 0 ] && [ -f "$baseline" ]; then
+    base=$(awk -v n="$name" '$1 == n { print $2 }' "$baseline")
+  fi
+  result=$(echo "$speeds" | awk -v n="$name" -v base="$base" \
+      -v tol="$TOLERANCE" '{
+    for (i = 1; i <= NF; i++)
+      sum += $i
+    mean = sum / NF
+    for (i = 1; i <= NF; i++)
+      sq += ($i - mean) * ($i - mean)
+    stddev = NF > 1 ? sqrt(sq / (NF - 1)) : 0
+    if (base == "") {
+      printf "%-24s %10.3f %8.3f %10s %8s\n", n, mean, stddev, "-", "-"
+      exit 0
+    }
+    delta = (mean - base) / base * 100
+    printf "%-24s %10.3f %8.3f %10.3f %+7.1f%%", n, mean, stddev, base, delta
+    # slowdowns within the noise of the measurements are tolerated
+    if (delta < -tol && base - mean > 2 * stddev) {
+      printf " SLOWER\n"
+      exit 1
+    }
+    printf "\n"
+  }') || failed=1
+  echo "$result"
+  if [ $write -eq 1 ]; then
+    echo "$result" | awk '{ print $1, $2 }' >> "$baseline"
+  fi
+done
+
+if [ $failed -eq 1 ]; then
+  echo "Performance regression against $baseline"
+  exit 1
+fi
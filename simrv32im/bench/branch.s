@@ -0,0 +1,24 @@
+# Data-dependent branches driven by a linear congruential generator
+.text
+_start: li t0,1500000
+        li a0,12345
+        li a1,1103515245
+        li a2,0
+1:      mul a0,a0,a1
+        addi a0,a0,1013
+        srli a3,a0,16
+        andi a4,a3,1
+        beqz a4,2f
+        addi a2,a2,1
+2:      andi a4,a3,6
+        li a5,4
+        blt a4,a5,3f
+        addi a2,a2,-1
+        j 4f
+3:      bgeu a3,a0,4f
+        xori a2,a2,1
+4:      addi t0,t0,-1
+        bnez t0,1b
+        li a0,0
+        li a7,93
+        ecall
@@ -0,0 +1,23 @@
+# Sequential word, halfword and byte streams over a 64 KiB array
+.data
+.align 2
+array:  .space 65536
+.text
+_start: li s0,120
+1:      la a0,array
+        li a1,16384
+        li a2,0
+2:      lw a3,0(a0)
+        add a2,a2,a3
+        addi a3,a3,1
+        sw a3,0(a0)
+        lhu a4,2(a0)
+        sb a4,1(a0)
+        addi a0,a0,4
+        addi a1,a1,-1
+        bnez a1,2b
+        addi s0,s0,-1
+        bnez s0,1b
+        li a0,0
+        li a7,93
+        ecall
@@ -0,0 +1,20 @@
+# Multiplications and divisions, including the corner cases
+.text
+_start: li t0,1500000
+        li a0,7
+        li a1,-3
+1:      mul a2,a0,a1
+        mulh a3,a0,a1
+        mulhu a4,a0,a2
+        mulhsu a5,a2,a0
+        div a3,a2,a1
+        divu a4,a2,a0
+        rem a5,a2,a1
+        remu a6,a2,a0
+        div a6,a0,zero
+        add a0,a0,a5
+        addi t0,t0,-1
+        bnez t0,1b
+        li a0,0
+        li a7,93
+        ecall
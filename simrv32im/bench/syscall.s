@@ -0,0 +1,17 @@
+# Output through the print character and print integer system calls
+.text
+_start: li t0,1000000
+1:      li a0,65
+        li a7,11
+        ecall
+        addi a0,t0,0
+        li a7,1
+        ecall
+        li a0,10
+        li a7,11
+        ecall
+        addi t0,t0,-1
+        bnez t0,1b
+        li a0,0
+        li a7,93
+        ecall
@@ -0,0 +1,414 @@
+/* Generated by isagen from rv32im.isa, do not edit */
+
+#include <stddef.h>
+#include "isa_gen.h"
+
+/* Indexed by the major opcode followed by funct3 */
+const uint16_t isaDecodeIndex[1024] = {
+    0x0000, 0x0000, 0x0000, 0x000B, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0013, 0x0000, 0x0000, 0x0000, 0x0002,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0010, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x8000, 0x0000, 0x0000, 0x0000, 0x0001,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0005, 0x0000, 0x0000, 0x0000, 0x0004,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0003,
+    0x0000, 0x0000, 0x0000, 0x8004, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x000C, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x8007, 0x0000, 0x0000, 0x0000, 0x0002,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0011, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x8009, 0x0000, 0x0000, 0x0000, 0x0001,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0006, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0003,
+    0x0000, 0x0000, 0x0000, 0x0028, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x000D, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0014, 0x0000, 0x0000, 0x0000, 0x0002,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0012, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x800C,
+    0x0000, 0x0000, 0x0000, 0x8018, 0x0000, 0x0000, 0x0000, 0x0001,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0003,
+    0x0000, 0x0000, 0x0000, 0x0029, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0015, 0x0000, 0x0000, 0x0000, 0x0002,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x801B, 0x0000, 0x0000, 0x0000, 0x0001,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0003,
+    0x0000, 0x0000, 0x0000, 0x002A, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x000E, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0016, 0x0000, 0x0000, 0x0000, 0x0002,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x801E, 0x0000, 0x0000, 0x0000, 0x0001,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0007, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0003,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x000F, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x8021, 0x0000, 0x0000, 0x0000, 0x0002,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x8024, 0x0000, 0x0000, 0x0000, 0x0001,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0008, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0003,
+    0x0000, 0x0000, 0x0000, 0x002B, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0017, 0x0000, 0x0000, 0x0000, 0x0002,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x8028, 0x0000, 0x0000, 0x0000, 0x0001,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0009, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0003,
+    0x0000, 0x0000, 0x0000, 0x002C, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0018, 0x0000, 0x0000, 0x0000, 0x0002,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x802B, 0x0000, 0x0000, 0x0000, 0x0001,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x000A, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0003,
+    0x0000, 0x0000, 0x0000, 0x002D, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+};
+
+const uint8_t isaDecodeList[] = {
+     28,  29,  46,   0,  38,  39,   0,  25,   0,  30,  47,   0,
+     54,  55,  56,  57,  58,  59,  60,  61,  62,  63,  64,   0,
+     31,  48,   0,  32,  49,   0,  33,  50,   0,  26,  27,   0,
+     34,  35,  51,   0,  36,  52,   0,  37,  53,   0,
+};
+
+const uint32_t isaDecodeMatch[ISA_NUM_IDS] = {
+    [ISA_ID_ILLEGAL] = 0xFFFFFFFF,
+    [ISA_ID_LUI] = 0x00000037,
+    [ISA_ID_AUIPC] = 0x00000017,
+    [ISA_ID_JAL] = 0x0000006F,
+    [ISA_ID_JALR] = 0x00000067,
+    [ISA_ID_BEQ] = 0x00000063,
+    [ISA_ID_BNE] = 0x00001063,
+    [ISA_ID_BLT] = 0x00004063,
+    [ISA_ID_BGE] = 0x00005063,
+    [ISA_ID_BLTU] = 0x00006063,
+    [ISA_ID_BGEU] = 0x00007063,
+    [ISA_ID_LB] = 0x00000003,
+    [ISA_ID_LH] = 0x00001003,
+    [ISA_ID_LW] = 0x00002003,
+    [ISA_ID_LBU] = 0x00004003,
+    [ISA_ID_LHU] = 0x00005003,
+    [ISA_ID_SB] = 0x00000023,
+    [ISA_ID_SH] = 0x00001023,
+    [ISA_ID_SW] = 0x00002023,
+    [ISA_ID_ADDI] = 0x00000013,
+    [ISA_ID_SLTI] = 0x00002013,
+    [ISA_ID_SLTIU] = 0x00003013,
+    [ISA_ID_XORI] = 0x00004013,
+    [ISA_ID_ORI] = 0x00006013,
+    [ISA_ID_ANDI] = 0x00007013,
+    [ISA_ID_SLLI] = 0x00001013,
+    [ISA_ID_SRLI] = 0x00005013,
+    [ISA_ID_SRAI] = 0x40005013,
+    [ISA_ID_ADD] = 0x00000033,
+    [ISA_ID_SUB] = 0x40000033,
+    [ISA_ID_SLL] = 0x00001033,
+    [ISA_ID_SLT] = 0x00002033,
+    [ISA_ID_SLTU] = 0x00003033,
+    [ISA_ID_XOR] = 0x00004033,
+    [ISA_ID_SRL] = 0x00005033,
+    [ISA_ID_SRA] = 0x40005033,
+    [ISA_ID_OR] = 0x00006033,
+    [ISA_ID_AND] = 0x00007033,
+    [ISA_ID_ECALL] = 0x00000073,
+    [ISA_ID_EBREAK] = 0x00100073,
+    [ISA_ID_CSRRW] = 0x00001073,
+    [ISA_ID_CSRRS] = 0x00002073,
+    [ISA_ID_CSRRC] = 0x00003073,
+    [ISA_ID_CSRRWI] = 0x00005073,
+    [ISA_ID_CSRRSI] = 0x00006073,
+    [ISA_ID_CSRRCI] = 0x00007073,
+    [ISA_ID_MUL] = 0x02000033,
+    [ISA_ID_MULH] = 0x02001033,
+    [ISA_ID_MULHSU] = 0x02002033,
+    [ISA_ID_MULHU] = 0x02003033,
+    [ISA_ID_DIV] = 0x02004033,
+    [ISA_ID_DIVU] = 0x02005033,
+    [ISA_ID_REM] = 0x02006033,
+    [ISA_ID_REMU] = 0x02007033,
+    [ISA_ID_LR_W] = 0x1000202F,
+    [ISA_ID_SC_W] = 0x1800202F,
+    [ISA_ID_AMOSWAP_W] = 0x0800202F,
+    [ISA_ID_AMOADD_W] = 0x0000202F,
+    [ISA_ID_AMOXOR_W] = 0x2000202F,
+    [ISA_ID_AMOAND_W] = 0x6000202F,
+    [ISA_ID_AMOOR_W] = 0x4000202F,
+    [ISA_ID_AMOMIN_W] = 0x8000202F,
+    [ISA_ID_AMOMAX_W] = 0xA000202F,
+    [ISA_ID_AMOMINU_W] = 0xC000202F,
+    [ISA_ID_AMOMAXU_W] = 0xE000202F,
+};
+
+const uint32_t isaDecodeMask[ISA_NUM_IDS] = {
+    [ISA_ID_ILLEGAL] = 0x00000000,
+    [ISA_ID_LUI] = 0x0000007F,
+    [ISA_ID_AUIPC] = 0x0000007F,
+    [ISA_ID_JAL] = 0x0000007F,
+    [ISA_ID_JALR] = 0x0000707F,
+    [ISA_ID_BEQ] = 0x0000707F,
+    [ISA_ID_BNE] = 0x0000707F,
+    [ISA_ID_BLT] = 0x0000707F,
+    [ISA_ID_BGE] = 0x0000707F,
+    [ISA_ID_BLTU] = 0x0000707F,
+    [ISA_ID_BGEU] = 0x0000707F,
+    [ISA_ID_LB] = 0x0000707F,
+    [ISA_ID_LH] = 0x0000707F,
+    [ISA_ID_LW] = 0x0000707F,
+    [ISA_ID_LBU] = 0x0000707F,
+    [ISA_ID_LHU] = 0x0000707F,
+    [ISA_ID_SB] = 0x0000707F,
+    [ISA_ID_SH] = 0x0000707F,
+    [ISA_ID_SW] = 0x0000707F,
+    [ISA_ID_ADDI] = 0x0000707F,
+    [ISA_ID_SLTI] = 0x0000707F,
+    [ISA_ID_SLTIU] = 0x0000707F,
+    [ISA_ID_XORI] = 0x0000707F,
+    [ISA_ID_ORI] = 0x0000707F,
+    [ISA_ID_ANDI] = 0x0000707F,
+    [ISA_ID_SLLI] = 0xFE00707F,
+    [ISA_ID_SRLI] = 0xFE00707F,
+    [ISA_ID_SRAI] = 0xFE00707F,
+    [ISA_ID_ADD] = 0xFE00707F,
+    [ISA_ID_SUB] = 0xFE00707F,
+    [ISA_ID_SLL] = 0xFE00707F,
+    [ISA_ID_SLT] = 0xFE00707F,
+    [ISA_ID_SLTU] = 0xFE00707F,
+    [ISA_ID_XOR] = 0xFE00707F,
+    [ISA_ID_SRL] = 0xFE00707F,
+    [ISA_ID_SRA] = 0xFE00707F,
+    [ISA_ID_OR] = 0xFE00707F,
+    [ISA_ID_AND] = 0xFE00707F,
+    [ISA_ID_ECALL] = 0xFFF0707F,
+    [ISA_ID_EBREAK] = 0xFFF0707F,
+    [ISA_ID_CSRRW] = 0x0000707F,
+    [ISA_ID_CSRRS] = 0x0000707F,
+    [ISA_ID_CSRRC] = 0x0000707F,
+    [ISA_ID_CSRRWI] = 0x0000707F,
+    [ISA_ID_CSRRSI] = 0x0000707F,
+    [ISA_ID_CSRRCI] = 0x0000707F,
+    [ISA_ID_MUL] = 0xFE00707F,
+    [ISA_ID_MULH] = 0xFE00707F,
+    [ISA_ID_MULHSU] = 0xFE00707F,
+    [ISA_ID_MULHU] = 0xFE00707F,
+    [ISA_ID_DIV] = 0xFE00707F,
+    [ISA_ID_DIVU] = 0xFE00707F,
+    [ISA_ID_REM] = 0xFE00707F,
+    [ISA_ID_REMU] = 0xFE00707F,
+    [ISA_ID_LR_W] = 0xF9F0707F,
+    [ISA_ID_SC_W] = 0xF800707F,
+    [ISA_ID_AMOSWAP_W] = 0xF800707F,
+    [ISA_ID_AMOADD_W] = 0xF800707F,
+    [ISA_ID_AMOXOR_W] = 0xF800707F,
+    [ISA_ID_AMOAND_W] = 0xF800707F,
+    [ISA_ID_AMOOR_W] = 0xF800707F,
+    [ISA_ID_AMOMIN_W] = 0xF800707F,
+    [ISA_ID_AMOMAX_W] = 0xF800707F,
+    [ISA_ID_AMOMINU_W] = 0xF800707F,
+    [ISA_ID_AMOMAXU_W] = 0xF800707F,
+};
+
+const uint8_t isaFormat[ISA_NUM_IDS] = {
+    [ISA_ID_LUI] = ISA_FMT_U,
+    [ISA_ID_AUIPC] = ISA_FMT_U,
+    [ISA_ID_JAL] = ISA_FMT_J,
+    [ISA_ID_JALR] = ISA_FMT_L,
+    [ISA_ID_BEQ] = ISA_FMT_B,
+    [ISA_ID_BNE] = ISA_FMT_B,
+    [ISA_ID_BLT] = ISA_FMT_B,
+    [ISA_ID_BGE] = ISA_FMT_B,
+    [ISA_ID_BLTU] = ISA_FMT_B,
+    [ISA_ID_BGEU] = ISA_FMT_B,
+    [ISA_ID_LB] = ISA_FMT_L,
+    [ISA_ID_LH] = ISA_FMT_L,
+    [ISA_ID_LW] = ISA_FMT_L,
+    [ISA_ID_LBU] = ISA_FMT_L,
+    [ISA_ID_LHU] = ISA_FMT_L,
+    [ISA_ID_SB] = ISA_FMT_S,
+    [ISA_ID_SH] = ISA_FMT_S,
+    [ISA_ID_SW] = ISA_FMT_S,
+    [ISA_ID_ADDI] = ISA_FMT_I,
+    [ISA_ID_SLTI] = ISA_FMT_I,
+    [ISA_ID_SLTIU] = ISA_FMT_I,
+    [ISA_ID_XORI] = ISA_FMT_I,
+    [ISA_ID_ORI] = ISA_FMT_I,
+    [ISA_ID_ANDI] = ISA_FMT_I,
+    [ISA_ID_SLLI] = ISA_FMT_SH,
+    [ISA_ID_SRLI] = ISA_FMT_SH,
+    [ISA_ID_SRAI] = ISA_FMT_SH,
+    [ISA_ID_ADD] = ISA_FMT_R,
+    [ISA_ID_SUB] = ISA_FMT_R,
+    [ISA_ID_SLL] = ISA_FMT_R,
+    [ISA_ID_SLT] = ISA_FMT_R,
+    [ISA_ID_SLTU] = ISA_FMT_R,
+    [ISA_ID_XOR] = ISA_FMT_R,
+    [ISA_ID_SRL] = ISA_FMT_R,
+    [ISA_ID_SRA] = ISA_FMT_R,
+    [ISA_ID_OR] = ISA_FMT_R,
+    [ISA_ID_AND] = ISA_FMT_R,
+    [ISA_ID_ECALL] = ISA_FMT_SYS,
+    [ISA_ID_EBREAK] = ISA_FMT_SYS,
+    [ISA_ID_CSRRW] = ISA_FMT_CSR,
+    [ISA_ID_CSRRS] = ISA_FMT_CSR,
+    [ISA_ID_CSRRC] = ISA_FMT_CSR,
+    [ISA_ID_CSRRWI] = ISA_FMT_CSRI,
+    [ISA_ID_CSRRSI] = ISA_FMT_CSRI,
+    [ISA_ID_CSRRCI] = ISA_FMT_CSRI,
+    [ISA_ID_MUL] = ISA_FMT_R,
+    [ISA_ID_MULH] = ISA_FMT_R,
+    [ISA_ID_MULHSU] = ISA_FMT_R,
+    [ISA_ID_MULHU] = ISA_FMT_R,
+    [ISA_ID_DIV] = ISA_FMT_R,
+    [ISA_ID_DIVU] = ISA_FMT_R,
+    [ISA_ID_REM] = ISA_FMT_R,
+    [ISA_ID_REMU] = ISA_FMT_R,
+    [ISA_ID_LR_W] = ISA_FMT_LR,
+    [ISA_ID_SC_W] = ISA_FMT_AMO,
+    [ISA_ID_AMOSWAP_W] = ISA_FMT_AMO,
+    [ISA_ID_AMOADD_W] = ISA_FMT_AMO,
+    [ISA_ID_AMOXOR_W] = ISA_FMT_AMO,
+    [ISA_ID_AMOAND_W] = ISA_FMT_AMO,
+    [ISA_ID_AMOOR_W] = ISA_FMT_AMO,
+    [ISA_ID_AMOMIN_W] = ISA_FMT_AMO,
+    [ISA_ID_AMOMAX_W] = ISA_FMT_AMO,
+    [ISA_ID_AMOMINU_W] = ISA_FMT_AMO,
+    [ISA_ID_AMOMAXU_W] = ISA_FMT_AMO,
+};
+
+const char *const isaMnemonic[ISA_NUM_IDS] = {
+    [ISA_ID_ILLEGAL] = NULL,
+    [ISA_ID_LUI] = "LUI",
+    [ISA_ID_AUIPC] = "AUIPC",
+    [ISA_ID_JAL] = "JAL",
+    [ISA_ID_JALR] = "JALR",
+    [ISA_ID_BEQ] = "BEQ",
+    [ISA_ID_BNE] = "BNE",
+    [ISA_ID_BLT] = "BLT",
+    [ISA_ID_BGE] = "BGE",
+    [ISA_ID_BLTU] = "BLTU",
+    [ISA_ID_BGEU] = "BGEU",
+    [ISA_ID_LB] = "LB",
+    [ISA_ID_LH] = "LH",
+    [ISA_ID_LW] = "LW",
+    [ISA_ID_LBU] = "LBU",
+    [ISA_ID_LHU] = "LHU",
+    [ISA_ID_SB] = "SB",
+    [ISA_ID_SH] = "SH",
+    [ISA_ID_SW] = "SW",
+    [ISA_ID_ADDI] = "ADDI",
+    [ISA_ID_SLTI] = "SLTI",
+    [ISA_ID_SLTIU] = "SLTIU",
+    [ISA_ID_XORI] = "XORI",
+    [ISA_ID_ORI] = "ORI",
+    [ISA_ID_ANDI] = "ANDI",
+    [ISA_ID_SLLI] = "SLLI",
+    [ISA_ID_SRLI] = "SRLI",
+    [ISA_ID_SRAI] = "SRAI",
+    [ISA_ID_ADD] = "ADD",
+    [ISA_ID_SUB] = "SUB",
+    [ISA_ID_SLL] = "SLL",
+    [ISA_ID_SLT] = "SLT",
+    [ISA_ID_SLTU] = "SLTU",
+    [ISA_ID_XOR] = "XOR",
+    [ISA_ID_SRL] = "SRL",
+    [ISA_ID_SRA] = "SRA",
+    [ISA_ID_OR] = "OR",
+    [ISA_ID_AND] = "AND",
+    [ISA_ID_ECALL] = "ECALL",
+    [ISA_ID_EBREAK] = "EBREAK",
+    [ISA_ID_CSRRW] = "CSRRW",
+    [ISA_ID_CSRRS] = "CSRRS",
+    [ISA_ID_CSRRC] = "CSRRC",
+    [ISA_ID_CSRRWI] = "CSRRWI",
+    [ISA_ID_CSRRSI] = "CSRRSI",
+    [ISA_ID_CSRRCI] = "CSRRCI",
+    [ISA_ID_MUL] = "MUL",
+    [ISA_ID_MULH] = "MULH",
+    [ISA_ID_MULHSU] = "MULHSU",
+    [ISA_ID_MULHU] = "MULHU",
+    [ISA_ID_DIV] = "DIV",
+    [ISA_ID_DIVU] = "DIVU",
+    [ISA_ID_REM] = "REM",
+    [ISA_ID_REMU] = "REMU",
+    [ISA_ID_LR_W] = "LR.W",
+    [ISA_ID_SC_W] = "SC.W",
+    [ISA_ID_AMOSWAP_W] = "AMOSWAP.W",
+    [ISA_ID_AMOADD_W] = "AMOADD.W",
+    [ISA_ID_AMOXOR_W] = "AMOXOR.W",
+    [ISA_ID_AMOAND_W] = "AMOAND.W",
+    [ISA_ID_AMOOR_W] = "AMOOR.W",
+    [ISA_ID_AMOMIN_W] = "AMOMIN.W",
+    [ISA_ID_AMOMAX_W] = "AMOMAX.W",
+    [ISA_ID_AMOMINU_W] = "AMOMINU.W",
+    [ISA_ID_AMOMAXU_W] = "AMOMAXU.W",
+};
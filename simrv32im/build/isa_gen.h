@@ -0,0 +1,186 @@
+/* Generated by isagen from rv32im.isa, do not edit */
+
+#ifndef ISA_GEN_H
+#define ISA_GEN_H
+
+#include <stdint.h>
+
+#define ISA_INST_OPCODE_LOAD 0x03
+#define ISA_INST_OPCODE_OPIMM 0x13
+#define ISA_INST_OPCODE_AUIPC 0x17
+#define ISA_INST_OPCODE_STORE 0x23
+#define ISA_INST_OPCODE_AMO 0x2F
+#define ISA_INST_OPCODE_OP 0x33
+#define ISA_INST_OPCODE_LUI 0x37
+#define ISA_INST_OPCODE_BRANCH 0x63
+#define ISA_INST_OPCODE_JALR 0x67
+#define ISA_INST_OPCODE_JAL 0x6F
+#define ISA_INST_OPCODE_SYSTEM 0x73
+
+typedef int t_isaFormat;
+enum {
+  ISA_FMT_R = 0,
+  ISA_FMT_I,
+  ISA_FMT_SH,
+  ISA_FMT_L,
+  ISA_FMT_S,
+  ISA_FMT_B,
+  ISA_FMT_U,
+  ISA_FMT_J,
+  ISA_FMT_SYS,
+  ISA_FMT_CSR,
+  ISA_FMT_CSRI,
+  ISA_FMT_AMO,
+  ISA_FMT_LR,
+  ISA_NUM_FORMATS
+};
+
+typedef int t_isaInstID;
+enum {
+  ISA_ID_ILLEGAL = 0,
+  ISA_ID_LUI,
+  ISA_ID_AUIPC,
+  ISA_ID_JAL,
+  ISA_ID_JALR,
+  ISA_ID_BEQ,
+  ISA_ID_BNE,
+  ISA_ID_BLT,
+  ISA_ID_BGE,
+  ISA_ID_BLTU,
+  ISA_ID_BGEU,
+  ISA_ID_LB,
+  ISA_ID_LH,
+  ISA_ID_LW,
+  ISA_ID_LBU,
+  ISA_ID_LHU,
+  ISA_ID_SB,
+  ISA_ID_SH,
+  ISA_ID_SW,
+  ISA_ID_ADDI,
+  ISA_ID_SLTI,
+  ISA_ID_SLTIU,
+  ISA_ID_XORI,
+  ISA_ID_ORI,
+  ISA_ID_ANDI,
+  ISA_ID_SLLI,
+  ISA_ID_SRLI,
+  ISA_ID_SRAI,
+  ISA_ID_ADD,
+  ISA_ID_SUB,
+  ISA_ID_SLL,
+  ISA_ID_SLT,
+  ISA_ID_SLTU,
+  ISA_ID_XOR,
+  ISA_ID_SRL,
+  ISA_ID_SRA,
+  ISA_ID_OR,
+  ISA_ID_AND,
+  ISA_ID_ECALL,
+  ISA_ID_EBREAK,
+  ISA_ID_CSRRW,
+  ISA_ID_CSRRS,
+  ISA_ID_CSRRC,
+  ISA_ID_CSRRWI,
+  ISA_ID_CSRRSI,
+  ISA_ID_CSRRCI,
+  ISA_ID_MUL,
+  ISA_ID_MULH,
+  ISA_ID_MULHSU,
+  ISA_ID_MULHU,
+  ISA_ID_DIV,
+  ISA_ID_DIVU,
+  ISA_ID_REM,
+  ISA_ID_REMU,
+  ISA_ID_LR_W,
+  ISA_ID_SC_W,
+  ISA_ID_AMOSWAP_W,
+  ISA_ID_AMOADD_W,
+  ISA_ID_AMOXOR_W,
+  ISA_ID_AMOAND_W,
+  ISA_ID_AMOOR_W,
+  ISA_ID_AMOMIN_W,
+  ISA_ID_AMOMAX_W,
+  ISA_ID_AMOMINU_W,
+  ISA_ID_AMOMAXU_W,
+  ISA_NUM_IDS
+};
+
+/* X(ID, FORMAT) for each instruction, in the order of the IDs */
+#define ISA_INST_LIST(X) \
+  X(LUI, U) \
+  X(AUIPC, U) \
+  X(JAL, J) \
+  X(JALR, L) \
+  X(BEQ, B) \
+  X(BNE, B) \
+  X(BLT, B) \
+  X(BGE, B) \
+  X(BLTU, B) \
+  X(BGEU, B) \
+  X(LB, L) \
+  X(LH, L) \
+  X(LW, L) \
+  X(LBU, L) \
+  X(LHU, L) \
+  X(SB, S) \
+  X(SH, S) \
+  X(SW, S) \
+  X(ADDI, I) \
+  X(SLTI, I) \
+  X(SLTIU, I) \
+  X(XORI, I) \
+  X(ORI, I) \
+  X(ANDI, I) \
+  X(SLLI, SH) \
+  X(SRLI, SH) \
+  X(SRAI, SH) \
+  X(ADD, R) \
+  X(SUB, R) \
+  X(SLL, R) \
+  X(SLT, R) \
+  X(SLTU, R) \
+  X(XOR, R) \
+  X(SRL, R) \
+  X(SRA, R) \
+  X(OR, R) \
+  X(AND, R) \
+  X(ECALL, SYS) \
+  X(EBREAK, SYS) \
+  X(CSRRW, CSR) \
+  X(CSRRS, CSR) \
+  X(CSRRC, CSR) \
+  X(CSRRWI, CSRI) \
+  X(CSRRSI, CSRI) \
+  X(CSRRCI, CSRI) \
+  X(MUL, R) \
+  X(MULH, R) \
+  X(MULHSU, R) \
+  X(MULHU, R) \
+  X(DIV, R) \
+  X(DIVU, R) \
+  X(REM, R) \
+  X(REMU, R) \
+  X(LR_W, LR) \
+  X(SC_W, AMO) \
+  X(AMOSWAP_W, AMO) \
+  X(AMOADD_W, AMO) \
+  X(AMOXOR_W, AMO) \
+  X(AMOAND_W, AMO) \
+  X(AMOOR_W, AMO) \
+  X(AMOMIN_W, AMO) \
+  X(AMOMAX_W, AMO) \
+  X(AMOMINU_W, AMO) \
+  X(AMOMAXU_W, AMO)
+
+/* Marks the entries of isaDecodeIndex which point to a list of candidates
+ * in isaDecodeList, instead of being an ID */
+#define ISA_DECODE_LIST 0x8000
+
+extern const uint16_t isaDecodeIndex[1024];
+extern const uint8_t isaDecodeList[];
+extern const uint32_t isaDecodeMatch[ISA_NUM_IDS];
+extern const uint32_t isaDecodeMask[ISA_NUM_IDS];
+extern const uint8_t isaFormat[ISA_NUM_IDS];
+extern const char *const isaMnemonic[ISA_NUM_IDS];
+
+#endif
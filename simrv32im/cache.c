@@ -0,0 +1,197 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "cache.h"
+#include "trace.h"
+
+#define CACHE_INVALID_LINE UINT32_MAX
+
+typedef struct cache {
+  unsigned int lineShift;
+  uint32_t setMask;
+  t_memSize ways;
+  // For each set, the lines it contains from the most to the least recently
+  // used one
+  uint32_t *lines;
+} t_cache;
+
+typedef struct cacheSweep {
+  const t_cacheConfig *configs;
+  t_cacheStats *stats;
+  int numConfigs;
+  int nextConfig;
+} t_cacheSweep;
+
+
+static bool cacheIsPowerOfTwo(t_memSize x)
+{
+  return x != 0 && (x & (x - 1)) == 0;
+}
+
+static bool cacheParseSize(const char *str, char **end, t_memSize *out)
+{
+  unsigned long value = strtoul(str, end, 0);
+  if (*end == str)
+    return false;
+  if (**end == 'k' || **end == 'K') {
+    value *= 1024;
+    (*end)++;
+  } else if (**end == 'm' || **end == 'M') {
+    value *= 1024 * 1024;
+    (*end)++;
+  }
+  *out = (t_memSize)value;
+  return value != 0 && value == (unsigned long)*out;
+}
+
+bool cacheParseConfig(const char *spec, t_cacheConfig *out)
+{
+  char *end;
+  if (!cacheParseSize(spec, &end, &out->size) || *end != ':')
+    return false;
+  if (!cacheParseSize(end + 1, &end, &out->lineSize) || *end != ':')
+    return false;
+  if (!cacheParseSize(end + 1, &end, &out->ways) || *end != '\0')
+    return false;
+
+  if (!cacheIsPowerOfTwo(out->size) || !cacheIsPowerOfTwo(out->lineSize) ||
+      !cacheIsPowerOfTwo(out->ways))
+    return false;
+  if (out->lineSize < 4 || out->lineSize * out->ways > out->size)
+    return false;
+  return true;
+}
+
+
+static bool cacheInit(t_cache *cache, const t_cacheConfig *config)
+{
+  t_memSize sets = config->size / config->lineSize / config->ways;
+  cache->lineShift = 0;
+  while (((t_memSize)1 << cache->lineShift) < config->lineSize)
+    cache->lineShift++;
+  cache->setMask = sets - 1;
+  cache->ways = config->ways;
+  cache->lines = malloc((size_t)sets * config->ways * sizeof(uint32_t));
+  if (!cache->lines)
+    return false;
+  for (size_t i = 0; i < (size_t)sets * config->ways; i++)
+    cache->lines[i] = CACHE_INVALID_LINE;
+  return true;
+}
+
+static void cacheDeinit(t_cache *cache)
+{
+  free(cache->lines);
+}
+
+static bool cacheAccess(t_cache *cache, t_memAddress addr)
+{
+  uint32_t line = addr >> cache->lineShift;
+  uint32_t *set = cache->lines + (size_t)(line & cache->setMask) * cache->ways;
+  t_memSize way;
+  for (way = 0; way < cache->ways; way++) {
+    if (set[way] == line)
+      break;
+  }
+  bool hit = way < cache->ways;
+  if (!hit)
+    way = cache->ways - 1;
+  memmove(set + 1, set, way * sizeof(uint32_t));
+  set[0] = line;
+  return hit;
+}
+
+
+static void *cacheWorker(void *arg)
+{
+  t_cacheSweep *sweep = (t_cacheSweep *)arg;
+  int i;
+  while ((i = __atomic_fetch_add(&sweep->nextConfig, 1, __ATOMIC_RELAXED)) <
+      sweep->numConfigs) {
+    t_cacheStats *stats = &sweep->stats[i];
+    t_cache icache, dcache;
+    memset(stats, 0, sizeof(t_cacheStats));
+    if (!cacheInit(&icache, &sweep->configs[i]))
+      continue;
+    if (!cacheInit(&dcache, &sweep->configs[i])) {
+      cacheDeinit(&icache);
+      continue;
+    }
+
+    t_trcCursor cursor;
+    t_trcKind kind;
+    t_memAddress addr;
+    trcRewind(&cursor);
+    while (trcNext(&cursor, &kind, &addr)) {
+      if (kind == TRC_FETCH) {
+        stats->instAccesses++;
+        if (!cacheAccess(&icache, addr))
+          stats->instMisses++;
+      } else {
+        stats->dataAccesses++;
+        if (!cacheAccess(&dcache, addr))
+          stats->dataMisses++;
+      }
+    }
+    cacheDeinit(&icache);
+    cacheDeinit(&dcache);
+  }
+  return NULL;
+}
+
+void cacheSimulate(
+    const t_cacheConfig *configs, t_cacheStats *outStats, int numConfigs)
+{
+  t_cacheSweep sweep = {configs, outStats, numConfigs, 0};
+
+  // Every configuration replays the whole trace independently, so they are
+  // spread over one thread per host processor, including this one
+  long numThreads = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+  numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if (numThreads > numConfigs)
+    numThreads = numConfigs;
+  if (numThreads < 1)
+    numThreads = 1;
+
+  pthread_t *threads = malloc((size_t)numThreads * sizeof(pthread_t));
+  long started = 0;
+  if (threads) {
+    for (; started < numThreads - 1; started++) {
+      if (pthread_create(&threads[started], NULL, cacheWorker, &sweep) != 0)
+        break;
+    }
+  }
+  cacheWorker(&sweep);
+  for (long i = 0; i < started; i++)
+    pthread_join(threads[i], NULL);
+  free(threads);
+}
+
+
+static double cacheMissRate(uint64_t misses, uint64_t accesses)
+{
+  if (accesses == 0)
+    return 0;
+  return (double)misses / (double)accesses * 100.0;
+}
+
+void cachePrintTable(FILE *fp, const t_cacheConfig *configs,
+    const t_cacheStats *stats, int numConfigs)
+{
+  fprintf(fp, "%10s %6s %5s %14s %8s %14s %8s\n", "SIZE", "LINE", "WAYS",
+      "I-ACCESSES", "I-MISS%", "D-ACCESSES", "D-MISS%");
+  for (int i = 0; i < numConfigs; i++) {
+    fprintf(fp,
+        "%10" PRIu32 " %6" PRIu32 " %5" PRIu32 " %14" PRIu64 " %8.3f %14" PRIu64
+        " %8.3f\n",
+        configs[i].size, configs[i].lineSize, configs[i].ways,
+        stats[i].instAccesses,
+        cacheMissRate(stats[i].instMisses, stats[i].instAccesses),
+        stats[i].dataAccesses,
+        cacheMissRate(stats[i].dataMisses, stats[i].dataAccesses));
+  }
+}
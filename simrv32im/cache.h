@@ -0,0 +1,33 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "memory.h"
+
+/* Replays the memory reference trace through split instruction and data
+ * caches with LRU replacement. */
+
+#define CACHE_MAX_CONFIGS 256
+
+typedef struct cacheConfig {
+  t_memSize size;
+  t_memSize lineSize;
+  t_memSize ways;
+} t_cacheConfig;
+
+typedef struct cacheStats {
+  uint64_t instAccesses;
+  uint64_t instMisses;
+  uint64_t dataAccesses;
+  uint64_t dataMisses;
+} t_cacheStats;
+
+bool cacheParseConfig(const char *spec, t_cacheConfig *out);
+void cacheSimulate(const t_cacheConfig *configs, t_cacheStats *outStats,
+    int numConfigs);
+void cachePrintTable(FILE *fp, const t_cacheConfig *configs,
+    const t_cacheStats *stats, int numConfigs);
+
+#endif
@@ -1,430 +1,966 @@
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
 #include "cpu.h"
 #include "memory.h"
+#include "plugin.h"
 
 #define CPU_N_REGS 32
 
-t_cpuURegValue cpuRegs[CPU_N_REGS];
-t_cpuURegValue cpuPC;
-t_cpuStatus lastStatus;
+struct cpuHart {
+  t_cpuURegValue regs[CPU_N_REGS];
+  t_cpuURegValue pc;
+  t_cpuStatus lastStatus;
+  t_cpuURegValue instLength;
+  uint64_t instRet;
+  t_cpuURegValue hartId;
+  // LR.W reservation
+  bool reserved;
+  t_memAddress reservedAddr;
+  uint32_t reservedValue;
+};
+
+t_cpuHart cpuMainHart = {.instLength = 4};
+// Each host thread simulates one hart, the main thread runs hart zero
+__thread t_cpuHart *cpuCurHart = &cpuMainHart;
+uint64_t cpuTimeBase;
+bool cpuFusion = true;
+
+
+t_cpuHart *cpuNewHart(t_cpuURegValue hartId, t_cpuURegValue pcValue)
+{
+  t_cpuHart *hart = calloc(1, sizeof(t_cpuHart));
+  if (!hart)
+    return NULL;
+  hart->hartId = hartId;
+  hart->instLength = 4;
+  hart->pc = pcValue;
+  return hart;
+}
+
+
+void cpuDeleteHart(t_cpuHart *hart)
+{
+  if (hart != &cpuMainHart)
+    free(hart);
+}
+
+
+void cpuSetCurrentHart(t_cpuHart *hart)
+{
+  cpuCurHart = hart;
+}
+
+
+void cpuSetFusion(bool enable)
+{
+  cpuFusion = enable;
+}
 
 
 t_cpuURegValue cpuGetRegister(t_cpuRegID reg)
 {
+  t_cpuHart *hart = cpuCurHart;
   if (reg == CPU_REG_X0)
     return 0;
   if (reg == CPU_REG_PC)
-    return cpuPC;
-  return cpuRegs[reg];
+    return hart->pc;
+  return hart->regs[reg];
 }
 
 
 void cpuSetRegister(t_cpuRegID reg, t_cpuURegValue value)
 {
+  t_cpuHart *hart = cpuCurHart;
   if (reg == CPU_REG_PC)
-    cpuPC = value;
+    hart->pc = value;
   if (reg != CPU_REG_ZERO)
-    cpuRegs[reg] = value;
+    hart->regs[reg] = value;
+}
+
+
+static uint64_t cpuHostTimeMicros(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
 }
 
 
 void cpuReset(t_cpuURegValue pcValue)
 {
-  lastStatus = CPU_STATUS_OK;
-  cpuPC = pcValue;
+  t_cpuHart *hart = cpuCurHart;
+  hart->lastStatus = CPU_STATUS_OK;
+  hart->instLength = 4;
+  hart->instRet = 0;
+  hart->reserved = false;
+  cpuTimeBase = cpuHostTimeMicros();
+  hart->pc = pcValue;
   for (int i = 0; i < CPU_N_REGS; i++) {
-    cpuRegs[i] = 0;
+    hart->regs[i] = 0;
   }
 }
 
 
+uint64_t cpuGetInstRetCount(void)
+{
+  return cpuCurHart->instRet;
+}
+
+uint64_t cpuGetMainInstRetCount(void)
+{
+  return __atomic_load_n(&cpuMainHart.instRet, __ATOMIC_RELAXED);
+}
+
+
 t_cpuStatus cpuClearLastFault(void)
 {
-  if (lastStatus == CPU_STATUS_ILL_INST_FAULT ||
-      lastStatus == CPU_STATUS_EBREAK_TRAP ||
-      lastStatus == CPU_STATUS_ECALL_TRAP)
-    cpuPC += 4;
-  lastStatus = CPU_STATUS_OK;
-  return lastStatus;
+  t_cpuHart *hart = cpuCurHart;
+  if (hart->lastStatus == CPU_STATUS_ILL_INST_FAULT ||
+      hart->lastStatus == CPU_STATUS_EBREAK_TRAP ||
+      hart->lastStatus == CPU_STATUS_ECALL_TRAP)
+    hart->pc += hart->instLength;
+  // Environment calls and breakpoints complete once the trap is handled
+  if (hart->lastStatus == CPU_STATUS_EBREAK_TRAP ||
+      hart->lastStatus == CPU_STATUS_ECALL_TRAP)
+    hart->instRet++;
+  hart->lastStatus = CPU_STATUS_OK;
+  return hart->lastStatus;
+}
+
+
+/* Makes the current instruction fail with a memory fault, when the fault was
+ * caught by the host MMU while the instruction was executing. Loads and
+ * stores fault before changing the state of the hart. */
+t_cpuStatus cpuRaiseMemoryFault(void)
+{
+  t_cpuHart *hart = cpuCurHart;
+  hart->lastStatus = CPU_STATUS_MEMORY_FAULT;
+  return hart->lastStatus;
 }
 
 
-t_cpuStatus cpuExecuteLOAD(uint32_t instr);
-t_cpuStatus cpuExecuteOPIMM(uint32_t instr);
-t_cpuStatus cpuExecuteAUIPC(uint32_t instr);
-t_cpuStatus cpuExecuteSTORE(uint32_t instr);
-t_cpuStatus cpuExecuteOP(uint32_t instr);
-t_cpuStatus cpuExecuteLUI(uint32_t instr);
-t_cpuStatus cpuExecuteBRANCH(uint32_t instr);
-t_cpuStatus cpuExecuteJALR(uint32_t instr);
-t_cpuStatus cpuExecuteJAL(uint32_t instr);
-t_cpuStatus cpuExecuteSYSTEM(uint32_t instr);
+// One handler for each instruction in isa/rv32im.isa
+static t_cpuStatus cpuExecuteILLEGAL(t_cpuHart *hart, uint32_t instr);
+#define X(id, format) \
+  static t_cpuStatus cpuExecute##id(t_cpuHart *hart, uint32_t instr);
+ISA_INST_LIST(X)
+#undef X
 
-t_cpuStatus cpuTick(void)
+/* Dispatches with a switch rather than a table of pointers, so that the
+ * compiler can inline the handlers into a single jump table. */
+static t_cpuStatus cpuExecute(t_cpuHart *hart, uint32_t instr)
 {
-  if (lastStatus != CPU_STATUS_OK)
-    return lastStatus;
+  switch (isaDecode(instr)) {
+#define X(id, format) \
+  case ISA_ID_##id: \
+    return cpuExecute##id(hart, instr);
+    ISA_INST_LIST(X)
+#undef X
+  }
+  return cpuExecuteILLEGAL(hart, instr);
+}
 
-  uint32_t nextInst;
-  t_memError fetchErr = memRead32(cpuPC, &nextInst);
-  if (fetchErr != MEM_NO_ERROR) {
-    lastStatus = CPU_STATUS_MEMORY_FAULT;
-    return lastStatus;
+static bool cpuDecode(const uint8_t *code, t_memSize avail, uint32_t *inst,
+    t_cpuURegValue *length)
+{
+  if (avail < 2)
+    return false;
+  uint32_t parcel = (uint32_t)code[0] | ((uint32_t)code[1] << 8);
+  if (ISA_INST_IS_COMPRESSED(parcel)) {
+    *inst = isaExpandCompressed((uint16_t)parcel);
+    *length = 2;
+    return true;
   }
+  if (avail < 4)
+    return false;
+  *inst = parcel | ((uint32_t)code[2] << 16) | ((uint32_t)code[3] << 24);
+  *length = 4;
+  return true;
+}
 
-  switch (ISA_INST_OPCODE(nextInst)) {
-    case ISA_INST_OPCODE_LOAD:
-      lastStatus = cpuExecuteLOAD(nextInst);
-      break;
-    case ISA_INST_OPCODE_OPIMM:
-      lastStatus = cpuExecuteOPIMM(nextInst);
-      break;
-    case ISA_INST_OPCODE_AUIPC:
-      lastStatus = cpuExecuteAUIPC(nextInst);
-      break;
-    case ISA_INST_OPCODE_STORE:
-      lastStatus = cpuExecuteSTORE(nextInst);
-      break;
-    case ISA_INST_OPCODE_OP:
-      lastStatus = cpuExecuteOP(nextInst);
-      break;
-    case ISA_INST_OPCODE_LUI:
-      lastStatus = cpuExecuteLUI(nextInst);
-      break;
-    case ISA_INST_OPCODE_BRANCH:
-      lastStatus = cpuExecuteBRANCH(nextInst);
-      break;
-    case ISA_INST_OPCODE_JALR:
-      lastStatus = cpuExecuteJALR(nextInst);
-      break;
-    case ISA_INST_OPCODE_JAL:
-      lastStatus = cpuExecuteJAL(nextInst);
-      break;
-    case ISA_INST_OPCODE_SYSTEM:
-      lastStatus = cpuExecuteSYSTEM(nextInst);
+
+typedef int t_cpuFusionKind;
+enum {
+  CPU_FUSION_NONE = 0,
+  CPU_FUSION_ADDI,     // LUI/AUIPC rd + ADDI rd, rd, imm (li, la)
+  CPU_FUSION_MEM,      // AUIPC rd + load/store at imm(rd) (lw/sw label)
+  CPU_FUSION_BRANCH_Z, // OP/OPIMM rd + BEQ/BNE rd, x0 (compare and branch)
+  CPU_FUSION_SET_Z     // SUB rd + SLTIU rd, rd, 1 / SLTU rd, x0, rd (seq/sne)
+};
+
+static t_cpuFusionKind cpuGetFusionKind(uint32_t first, uint32_t second)
+{
+  t_cpuRegID rd = ISA_INST_RD(first);
+  uint32_t op1 = ISA_INST_OPCODE(first);
+  uint32_t op2 = ISA_INST_OPCODE(second);
+
+  // All idioms pass their intermediate result through rd
+  if (rd == CPU_REG_ZERO)
+    return CPU_FUSION_NONE;
+
+  if (op1 == ISA_INST_OPCODE_LUI || op1 == ISA_INST_OPCODE_AUIPC) {
+    if (op2 == ISA_INST_OPCODE_OPIMM && ISA_INST_FUNCT3(second) == 0 &&
+        ISA_INST_RD(second) == rd && ISA_INST_RS1(second) == rd)
+      return CPU_FUSION_ADDI;
+    if (op1 == ISA_INST_OPCODE_AUIPC &&
+        (op2 == ISA_INST_OPCODE_LOAD || op2 == ISA_INST_OPCODE_STORE) &&
+        ISA_INST_RS1(second) == rd)
+      return CPU_FUSION_MEM;
+    return CPU_FUSION_NONE;
+  }
+
+  if (op1 != ISA_INST_OPCODE_OP && op1 != ISA_INST_OPCODE_OPIMM)
+    return CPU_FUSION_NONE;
+  if (op2 == ISA_INST_OPCODE_BRANCH && ISA_INST_FUNCT3(second) <= 1 &&
+      ((ISA_INST_RS1(second) == rd && ISA_INST_RS2(second) == 0) ||
+          (ISA_INST_RS1(second) == 0 && ISA_INST_RS2(second) == rd)))
+    return CPU_FUSION_BRANCH_Z;
+  if (op1 == ISA_INST_OPCODE_OP && ISA_INST_FUNCT3(first) == 0 &&
+      ISA_INST_FUNCT7(first) == 0x20 && ISA_INST_RD(second) == rd) {
+    if (op2 == ISA_INST_OPCODE_OPIMM && ISA_INST_FUNCT3(second) == 3 &&
+        ISA_INST_RS1(second) == rd && ISA_INST_I_IMM12(second) == 1)
+      return CPU_FUSION_SET_Z;
+    if (op2 == ISA_INST_OPCODE_OP && ISA_INST_FUNCT3(second) == 3 &&
+        ISA_INST_FUNCT7(second) == 0 && ISA_INST_RS1(second) == 0 &&
+        ISA_INST_RS2(second) == rd)
+      return CPU_FUSION_SET_Z;
+  }
+  return CPU_FUSION_NONE;
+}
+
+/* Executes a pair of adjacent instructions decoded at once. The first one
+ * always retires on its own before the second starts, so that a fault in the
+ * second one leaves the hart in the same state as if the pair was not fused.
+ * Returns false if the pair is not a known idiom. */
+static bool cpuExecuteFused(t_cpuHart *hart, uint32_t first, uint32_t second,
+    t_cpuURegValue secondLength)
+{
+  t_cpuFusionKind kind = cpuGetFusionKind(first, second);
+  if (kind == CPU_FUSION_NONE)
+    return false;
+
+  t_cpuRegID rd = ISA_INST_RD(first);
+  t_cpuStatus status = cpuExecute(hart, first);
+  if (status != CPU_STATUS_OK) {
+    hart->lastStatus = status;
+    return true;
+  }
+  hart->instRet++;
+  hart->instLength = secondLength;
+
+  bool taken;
+  switch (kind) {
+    case CPU_FUSION_ADDI:
+      hart->regs[rd] += ISA_INST_I_IMM12_SEXT(second);
+      hart->pc += secondLength;
+      break;
+    case CPU_FUSION_MEM:
+      status = cpuExecute(hart, second);
+      break;
+    case CPU_FUSION_BRANCH_Z:
+      // BEQ has funct3 0, BNE has funct3 1
+      taken = (hart->regs[rd] == 0) == (ISA_INST_FUNCT3(second) == 0);
+      hart->pc += taken ? ISA_INST_B_IMM13_SEXT(second) : secondLength;
+      break;
+    case CPU_FUSION_SET_Z:
+      if (ISA_INST_OPCODE(second) == ISA_INST_OPCODE_OPIMM)
+        hart->regs[rd] = hart->regs[rd] == 0;
+      else
+        hart->regs[rd] = hart->regs[rd] != 0;
+      hart->pc += secondLength;
       break;
-    default:
-      lastStatus = CPU_STATUS_ILL_INST_FAULT;
   }
-  cpuRegs[CPU_REG_ZERO] = 0;
-  return lastStatus;
+  hart->lastStatus = status;
+  return true;
 }
 
-t_cpuStatus cpuExecuteLOAD(uint32_t instr)
+
+t_cpuStatus cpuTick(void)
 {
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  t_memAddress addr = cpuRegs[rs1] + ISA_INST_I_IMM12_SEXT(instr);
+  t_cpuHart *hart = cpuCurHart;
+  if (hart->lastStatus != CPU_STATUS_OK)
+    return hart->lastStatus;
+  t_cpuURegValue pc = hart->pc;
+
+  // Fetch straight from the host buffer, together with the following
+  // instruction to detect fusable pairs. Instructions which straddle two
+  // memory areas are fetched in 16-bit parcels instead.
+  uint32_t nextInst, fusedInst;
+  t_cpuURegValue fusedLength = 0;
+  uint8_t *code;
+  t_memSize avail;
+  if (memGetHostBuffer(hart->pc, 8, &code, &avail) == MEM_NO_ERROR &&
+      cpuDecode(code, avail, &nextInst, &hart->instLength)) {
+    // Only look ahead when the instruction can start a fusable pair
+    uint32_t op = ISA_INST_OPCODE(nextInst);
+    if (cpuFusion && ISA_INST_RD(nextInst) != CPU_REG_ZERO &&
+        (op == ISA_INST_OPCODE_OP || op == ISA_INST_OPCODE_OPIMM ||
+            op == ISA_INST_OPCODE_LUI || op == ISA_INST_OPCODE_AUIPC))
+      cpuDecode(code + hart->instLength, avail - hart->instLength, &fusedInst,
+          &fusedLength);
+  } else {
+    uint16_t parcel;
+    t_memError fetchErr = memRead16(hart->pc, &parcel);
+    if (fetchErr == MEM_NO_ERROR) {
+      if (ISA_INST_IS_COMPRESSED(parcel)) {
+        nextInst = isaExpandCompressed(parcel);
+        hart->instLength = 2;
+      } else {
+        nextInst = parcel;
+        fetchErr = memRead16(hart->pc + 2, &parcel);
+        nextInst |= (uint32_t)parcel << 16;
+        hart->instLength = 4;
+      }
+    }
+    if (fetchErr != MEM_NO_ERROR) {
+      hart->lastStatus = CPU_STATUS_MEMORY_FAULT;
+      return hart->lastStatus;
+    }
+  }
 
-  uint8_t tmp8;
-  uint16_t tmp16;
-  uint32_t tmp32;
-  t_memError memStatus;
-  switch (ISA_INST_FUNCT3(instr)) {
-    case 0: /* LB */
-      memStatus = memRead8(addr, &tmp8);
-      if (memStatus != MEM_NO_ERROR)
-        return CPU_STATUS_MEMORY_FAULT;
-      cpuRegs[rd] = (t_cpuURegValue)((t_cpuSRegValue)((int8_t)tmp8));
-      break;
-    case 1: /* LH */
-      memStatus = memRead16(addr, &tmp16);
-      if (memStatus != MEM_NO_ERROR)
-        return CPU_STATUS_MEMORY_FAULT;
-      cpuRegs[rd] = (t_cpuURegValue)((t_cpuSRegValue)((int16_t)tmp16));
-      break;
-    case 2: /* LW */
-      memStatus = memRead32(addr, &tmp32);
-      if (memStatus != MEM_NO_ERROR)
-        return CPU_STATUS_MEMORY_FAULT;
-      cpuRegs[rd] = tmp32;
-      break;
-    case 4: /* LBU */
-      memStatus = memRead8(addr, &tmp8);
-      if (memStatus != MEM_NO_ERROR)
-        return CPU_STATUS_MEMORY_FAULT;
-      cpuRegs[rd] = (t_cpuURegValue)tmp8;
-      break;
-    case 5: /* LHU */
-      memStatus = memRead16(addr, &tmp16);
-      if (memStatus != MEM_NO_ERROR)
-        return CPU_STATUS_MEMORY_FAULT;
-      cpuRegs[rd] = (t_cpuURegValue)tmp16;
-      break;
-    default:
-      return CPU_STATUS_ILL_INST_FAULT;
+  if (fusedLength != 0 &&
+      cpuExecuteFused(hart, nextInst, fusedInst, fusedLength)) {
+    hart->regs[CPU_REG_ZERO] = 0;
+    if (hart->lastStatus == CPU_STATUS_OK)
+      hart->instRet++;
+    return hart->lastStatus;
   }
 
-  cpuPC += 4;
-  return CPU_STATUS_OK;
+  hart->lastStatus = cpuExecute(hart, nextInst);
+  hart->regs[CPU_REG_ZERO] = 0;
+  if (hart->lastStatus == CPU_STATUS_OK)
+    hart->instRet++;
+  // Traps are reported too, as the instruction completes after handling them
+  if ((plgEvents & PLG_EVENT_INST_RETIRED) &&
+      hart->lastStatus != CPU_STATUS_MEMORY_FAULT &&
+      hart->lastStatus != CPU_STATUS_ILL_INST_FAULT)
+    plgNotifyInstRetired(hart->hartId, pc, nextInst);
+  return hart->lastStatus;
 }
 
-t_cpuStatus cpuExecuteOPIMM(uint32_t instr)
+static t_cpuStatus cpuExecuteILLEGAL(t_cpuHart *hart, uint32_t instr)
 {
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
+  return CPU_STATUS_ILL_INST_FAULT;
+}
 
-  switch (ISA_INST_FUNCT3(instr)) {
-    case 0: /* ADDI */
-      cpuRegs[rd] = cpuRegs[rs1] + ISA_INST_I_IMM12_SEXT(instr);
-      break;
-    case 1: /* SLLI */
-      if (ISA_INST_FUNCT7(instr) == 0x00)
-        cpuRegs[rd] = cpuRegs[rs1] << (ISA_INST_I_IMM12(instr) & 0x1F);
-      else
-        return CPU_STATUS_ILL_INST_FAULT;
-      break;
-    case 2: /* SLTI */
-      cpuRegs[rd] = ((t_cpuSRegValue)cpuRegs[rs1]) <
-          ((t_cpuSRegValue)ISA_INST_I_IMM12_SEXT(instr));
-      break;
-    case 3: /* SLTIU */
-      cpuRegs[rd] = cpuRegs[rs1] < ISA_INST_I_IMM12(instr);
-      break;
-    case 4: /* XORI */
-      cpuRegs[rd] = cpuRegs[rs1] ^ ISA_INST_I_IMM12_SEXT(instr);
-      break;
-    case 5: /* SRLI / SRAI */
-      if (ISA_INST_FUNCT7(instr) == 0x00)
-        cpuRegs[rd] = cpuRegs[rs1] >> (ISA_INST_I_IMM12(instr) & 0x1F);
-      else if (ISA_INST_FUNCT7(instr) == 0x20)
-        cpuRegs[rd] = SRA(cpuRegs[rs1], (ISA_INST_I_IMM12(instr) & 0x1F));
-      else
-        return CPU_STATUS_ILL_INST_FAULT;
-      break;
-    case 6: /* ORI */
-      cpuRegs[rd] = cpuRegs[rs1] | ISA_INST_I_IMM12_SEXT(instr);
-      break;
-    case 7: /* ANDI */
-      cpuRegs[rd] = cpuRegs[rs1] & ISA_INST_I_IMM12_SEXT(instr);
-      break;
-  }
 
-  cpuPC += 4;
+static t_cpuStatus cpuExecuteLUI(t_cpuHart *hart, uint32_t instr)
+{
+  hart->regs[ISA_INST_RD(instr)] = ISA_INST_U_IMM20(instr) << 12;
+  hart->pc += hart->instLength;
   return CPU_STATUS_OK;
 }
 
-t_cpuStatus cpuExecuteAUIPC(uint32_t instr)
+static t_cpuStatus cpuExecuteAUIPC(t_cpuHart *hart, uint32_t instr)
 {
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  cpuRegs[rd] = cpuPC + (ISA_INST_U_IMM20(instr) << 12);
-  cpuPC += 4;
+  hart->regs[ISA_INST_RD(instr)] = hart->pc + (ISA_INST_U_IMM20(instr) << 12);
+  hart->pc += hart->instLength;
   return CPU_STATUS_OK;
 }
 
-t_cpuStatus cpuExecuteSTORE(uint32_t instr)
+
+static t_cpuStatus cpuExecuteJAL(t_cpuHart *hart, uint32_t instr)
 {
+  t_cpuSRegValue offs = (t_cpuSRegValue)ISA_INST_J_IMM21_SEXT(instr);
+  t_cpuURegValue pc = hart->pc;
+  hart->regs[ISA_INST_RD(instr)] = hart->pc + hart->instLength;
+  hart->pc += (t_cpuURegValue)offs;
+  if (plgEvents & PLG_EVENT_BRANCH)
+    plgNotifyBranch(hart->hartId, pc, instr, hart->pc, true);
+  return CPU_STATUS_OK;
+}
+
+static t_cpuStatus cpuExecuteJALR(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuSRegValue offs = (t_cpuSRegValue)ISA_INST_I_IMM12_SEXT(instr);
   t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  t_cpuRegID rs2 = ISA_INST_RS2(instr);
-  t_memAddress addr = cpuRegs[rs1] + ISA_INST_S_IMM12_SEXT(instr);
-
-  t_memError memStatus;
-  switch (ISA_INST_FUNCT3(instr)) {
-    case 0: /* SB */
-      memStatus = memWrite8(addr, cpuRegs[rs2] & 0xFF);
-      if (memStatus != MEM_NO_ERROR)
-        return CPU_STATUS_MEMORY_FAULT;
-      break;
-    case 1: /* SH */
-      memStatus = memWrite16(addr, cpuRegs[rs2] & 0xFFFF);
-      if (memStatus != MEM_NO_ERROR)
-        return CPU_STATUS_MEMORY_FAULT;
-      break;
-    case 2: /* SW */
-      memStatus = memWrite32(addr, cpuRegs[rs2]);
-      if (memStatus != MEM_NO_ERROR)
-        return CPU_STATUS_MEMORY_FAULT;
-      break;
-    default:
-      return CPU_STATUS_ILL_INST_FAULT;
-  }
+  // clear bit zero as suggested by the spec
+  t_cpuURegValue target =
+      (hart->regs[rs1] + (t_cpuURegValue)offs) & ~(t_cpuURegValue)1;
+  t_cpuURegValue pc = hart->pc;
+  hart->regs[ISA_INST_RD(instr)] = hart->pc + hart->instLength;
+  hart->pc = target;
+  if (plgEvents & PLG_EVENT_BRANCH)
+    plgNotifyBranch(hart->hartId, pc, instr, target, true);
+  return CPU_STATUS_OK;
+}
+
 
-  cpuPC += 4;
+static t_cpuStatus cpuBranch(t_cpuHart *hart, uint32_t instr, bool taken)
+{
+  t_cpuSRegValue offs = (t_cpuSRegValue)ISA_INST_B_IMM13_SEXT(instr);
+  t_cpuURegValue pc = hart->pc;
+  hart->pc += taken ? (t_cpuURegValue)offs : hart->instLength;
+  if (plgEvents & PLG_EVENT_BRANCH)
+    plgNotifyBranch(hart->hartId, pc, instr, hart->pc, taken);
   return CPU_STATUS_OK;
 }
 
-t_cpuStatus cpuExecuteOP(uint32_t instr)
+static t_cpuStatus cpuExecuteBEQ(t_cpuHart *hart, uint32_t instr)
 {
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  t_cpuRegID rs2 = ISA_INST_RS2(instr);
-
-  if (ISA_INST_FUNCT7(instr) == 0x00) {
-    switch (ISA_INST_FUNCT3(instr)) {
-      case 0: /* ADD */
-        cpuRegs[rd] = cpuRegs[rs1] + cpuRegs[rs2];
-        break;
-      case 1: /* SLL */
-        cpuRegs[rd] = cpuRegs[rs1] << (cpuRegs[rs2] & 0x1F);
-        break;
-      case 2: /* SLT */
-        cpuRegs[rd] =
-            ((t_cpuSRegValue)cpuRegs[rs1]) < ((t_cpuSRegValue)cpuRegs[rs2]);
-        break;
-      case 3: /* SLTU */
-        cpuRegs[rd] = cpuRegs[rs1] < cpuRegs[rs2];
-        break;
-      case 4: /* XOR */
-        cpuRegs[rd] = cpuRegs[rs1] ^ cpuRegs[rs2];
-        break;
-      case 5: /* SRL */
-        cpuRegs[rd] = cpuRegs[rs1] >> (cpuRegs[rs2] & 0x1F);
-        break;
-      case 6: /* OR */
-        cpuRegs[rd] = cpuRegs[rs1] | cpuRegs[rs2];
-        break;
-      case 7: /* AND */
-        cpuRegs[rd] = cpuRegs[rs1] & cpuRegs[rs2];
-        break;
-    }
-  } else if (ISA_INST_FUNCT7(instr) == 0x20) {
-    switch (ISA_INST_FUNCT3(instr)) {
-      case 0: /* SUB */
-        cpuRegs[rd] = cpuRegs[rs1] - cpuRegs[rs2];
-        break;
-      case 1:
-      case 2:
-      case 3:
-      case 4:
-        return CPU_STATUS_ILL_INST_FAULT;
-      case 5: /* SRA */
-        cpuRegs[rd] = SRA(cpuRegs[rs1], (cpuRegs[rs2] & 0x1F));
-        break;
-      case 6:
-      case 7:
-        return CPU_STATUS_ILL_INST_FAULT;
-    }
-  } else if (ISA_INST_FUNCT7(instr) == 0x01) {
-    switch (ISA_INST_FUNCT3(instr)) {
-      case 0: /* MUL */
-        cpuRegs[rd] = cpuRegs[rs1] * cpuRegs[rs2];
-        break;
-      case 1: /* MULH */
-        cpuRegs[rd] = (uint32_t)(((int64_t)((int32_t)cpuRegs[rs1]) *
-                                     (int64_t)((int32_t)cpuRegs[rs2])) >>
-            32);
-        break;
-      case 2: /* MULHSU */
-        cpuRegs[rd] = (uint32_t)(((int64_t)((int32_t)cpuRegs[rs1]) *
-                                     (int64_t)(cpuRegs[rs2])) >>
-            32);
-        break;
-      case 3: /* MULHU */
-        cpuRegs[rd] = (t_cpuURegValue)(((uint64_t)(cpuRegs[rs1]) *
-                                           (uint64_t)(cpuRegs[rs2])) >>
-            32);
-        break;
-      case 4: /* DIV */
-        if (cpuRegs[rs2] == 0)
-          cpuRegs[rd] = 0xFFFFFFFF;
-        else if (cpuRegs[rs1] == 0x80000000 && cpuRegs[rs2] == 0xFFFFFFFF)
-          cpuRegs[rd] = 0x80000000;
-        else
-          cpuRegs[rd] = (t_cpuURegValue)((t_cpuSRegValue)cpuRegs[rs1] /
-              (t_cpuSRegValue)cpuRegs[rs2]);
-        break;
-      case 5: /* DIVU */
-        if (cpuRegs[rs2] == 0)
-          cpuRegs[rd] = 0xFFFFFFFF;
-        else
-          cpuRegs[rd] = cpuRegs[rs1] / cpuRegs[rs2];
-        break;
-      case 6: /* REM */
-        if (cpuRegs[rs2] == 0)
-          cpuRegs[rd] = cpuRegs[rs1];
-        else if (cpuRegs[rs1] == 0x80000000 && cpuRegs[rs2] == 0xFFFFFFFF)
-          cpuRegs[rd] = 0;
-        else
-          cpuRegs[rd] = (t_cpuURegValue)((t_cpuSRegValue)cpuRegs[rs1] %
-              (t_cpuSRegValue)cpuRegs[rs2]);
-        break;
-      case 7: /* REMU */
-        if (cpuRegs[rs2] == 0)
-          cpuRegs[rd] = cpuRegs[rs1];
-        else
-          cpuRegs[rd] = cpuRegs[rs1] % cpuRegs[rs2];
-        break;
-    }
-  } else {
-    return CPU_STATUS_ILL_INST_FAULT;
-  }
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuBranch(hart, instr, a == b);
+}
+
+static t_cpuStatus cpuExecuteBNE(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuBranch(hart, instr, a != b);
+}
 
-  cpuPC += 4;
+static t_cpuStatus cpuExecuteBLT(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuBranch(hart, instr, (t_cpuSRegValue)a < (t_cpuSRegValue)b);
+}
+
+static t_cpuStatus cpuExecuteBGE(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuBranch(hart, instr, (t_cpuSRegValue)a >= (t_cpuSRegValue)b);
+}
+
+static t_cpuStatus cpuExecuteBLTU(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuBranch(hart, instr, a < b);
+}
+
+static t_cpuStatus cpuExecuteBGEU(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuBranch(hart, instr, a >= b);
+}
+
+
+static t_memAddress cpuLoadAddress(t_cpuHart *hart, uint32_t instr)
+{
+  return hart->regs[ISA_INST_RS1(instr)] + ISA_INST_I_IMM12_SEXT(instr);
+}
+
+static t_cpuStatus cpuFinishLoad(t_cpuHart *hart, uint32_t instr,
+    t_memAddress addr, t_memSize size, t_cpuURegValue value)
+{
+  hart->regs[ISA_INST_RD(instr)] = value;
+  if (plgEvents & PLG_EVENT_MEM_ACCESS)
+    plgNotifyMemAccess(hart->hartId, hart->pc, addr, size, PLG_MEM_READ);
+  hart->pc += hart->instLength;
   return CPU_STATUS_OK;
 }
 
-t_cpuStatus cpuExecuteLUI(uint32_t instr)
+static t_cpuStatus cpuExecuteLB(t_cpuHart *hart, uint32_t instr)
+{
+  t_memAddress addr = cpuLoadAddress(hart, instr);
+  uint8_t tmp8;
+  if (memRead8(addr, &tmp8) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  return cpuFinishLoad(hart, instr, addr, 1,
+      (t_cpuURegValue)((t_cpuSRegValue)((int8_t)tmp8)));
+}
+
+static t_cpuStatus cpuExecuteLH(t_cpuHart *hart, uint32_t instr)
+{
+  t_memAddress addr = cpuLoadAddress(hart, instr);
+  uint16_t tmp16;
+  if (memRead16(addr, &tmp16) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  return cpuFinishLoad(hart, instr, addr, 2,
+      (t_cpuURegValue)((t_cpuSRegValue)((int16_t)tmp16)));
+}
+
+static t_cpuStatus cpuExecuteLW(t_cpuHart *hart, uint32_t instr)
+{
+  t_memAddress addr = cpuLoadAddress(hart, instr);
+  uint32_t tmp32;
+  if (memRead32(addr, &tmp32) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  return cpuFinishLoad(hart, instr, addr, 4, tmp32);
+}
+
+static t_cpuStatus cpuExecuteLBU(t_cpuHart *hart, uint32_t instr)
+{
+  t_memAddress addr = cpuLoadAddress(hart, instr);
+  uint8_t tmp8;
+  if (memRead8(addr, &tmp8) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  return cpuFinishLoad(hart, instr, addr, 1, (t_cpuURegValue)tmp8);
+}
+
+static t_cpuStatus cpuExecuteLHU(t_cpuHart *hart, uint32_t instr)
+{
+  t_memAddress addr = cpuLoadAddress(hart, instr);
+  uint16_t tmp16;
+  if (memRead16(addr, &tmp16) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  return cpuFinishLoad(hart, instr, addr, 2, (t_cpuURegValue)tmp16);
+}
+
+
+static t_memAddress cpuStoreAddress(t_cpuHart *hart, uint32_t instr)
+{
+  return hart->regs[ISA_INST_RS1(instr)] + ISA_INST_S_IMM12_SEXT(instr);
+}
+
+static t_cpuStatus cpuFinishStore(
+    t_cpuHart *hart, t_memAddress addr, t_memSize size)
 {
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  cpuRegs[rd] = ISA_INST_U_IMM20(instr) << 12;
-  cpuPC += 4;
+  if (plgEvents & PLG_EVENT_MEM_ACCESS)
+    plgNotifyMemAccess(hart->hartId, hart->pc, addr, size, PLG_MEM_WRITE);
+  hart->pc += hart->instLength;
   return CPU_STATUS_OK;
 }
 
-t_cpuStatus cpuExecuteBRANCH(uint32_t instr)
+static t_cpuStatus cpuExecuteSB(t_cpuHart *hart, uint32_t instr)
 {
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  t_cpuRegID rs2 = ISA_INST_RS2(instr);
-  t_cpuSRegValue offs = (t_cpuSRegValue)ISA_INST_B_IMM13_SEXT(instr);
-  bool taken = 0;
+  t_memAddress addr = cpuStoreAddress(hart, instr);
+  if (memWrite8(addr, hart->regs[ISA_INST_RS2(instr)] & 0xFF) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  return cpuFinishStore(hart, addr, 1);
+}
 
-  switch (ISA_INST_FUNCT3(instr)) {
-    case 0: /* BEQ */
-      taken = cpuRegs[rs1] == cpuRegs[rs2];
-      break;
-    case 1: /* BNE */
-      taken = cpuRegs[rs1] != cpuRegs[rs2];
-      break;
-    case 4: /* BLT */
-      taken = (t_cpuSRegValue)cpuRegs[rs1] < (t_cpuSRegValue)cpuRegs[rs2];
-      break;
-    case 5: /* BGE */
-      taken = (t_cpuSRegValue)cpuRegs[rs1] >= (t_cpuSRegValue)cpuRegs[rs2];
-      break;
-    case 6: /* BLTU */
-      taken = cpuRegs[rs1] < cpuRegs[rs2];
-      break;
-    case 7: /* BGEU */
-      taken = cpuRegs[rs1] >= cpuRegs[rs2];
-      break;
-    default:
-      return CPU_STATUS_ILL_INST_FAULT;
-  }
+static t_cpuStatus cpuExecuteSH(t_cpuHart *hart, uint32_t instr)
+{
+  t_memAddress addr = cpuStoreAddress(hart, instr);
+  if (memWrite16(addr, hart->regs[ISA_INST_RS2(instr)] & 0xFFFF) !=
+      MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  return cpuFinishStore(hart, addr, 2);
+}
+
+static t_cpuStatus cpuExecuteSW(t_cpuHart *hart, uint32_t instr)
+{
+  t_memAddress addr = cpuStoreAddress(hart, instr);
+  if (memWrite32(addr, hart->regs[ISA_INST_RS2(instr)]) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  return cpuFinishStore(hart, addr, 4);
+}
 
-  cpuPC += taken ? (t_cpuURegValue)offs : 4;
+
+/* Completes an instruction with a register or immediate operand */
+static t_cpuStatus cpuFinishALU(
+    t_cpuHart *hart, uint32_t instr, t_cpuURegValue value)
+{
+  hart->regs[ISA_INST_RD(instr)] = value;
+  hart->pc += hart->instLength;
   return CPU_STATUS_OK;
 }
 
-t_cpuStatus cpuExecuteJALR(uint32_t instr)
+static t_cpuStatus cpuExecuteADDI(t_cpuHart *hart, uint32_t instr)
 {
-  t_cpuSRegValue offs = (t_cpuSRegValue)ISA_INST_I_IMM12_SEXT(instr);
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  if (ISA_INST_FUNCT3(instr) != 0)
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  return cpuFinishALU(hart, instr, a + ISA_INST_I_IMM12_SEXT(instr));
+}
+
+static t_cpuStatus cpuExecuteSLTI(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuSRegValue a = (t_cpuSRegValue)hart->regs[ISA_INST_RS1(instr)];
+  return cpuFinishALU(
+      hart, instr, a < (t_cpuSRegValue)ISA_INST_I_IMM12_SEXT(instr));
+}
+
+static t_cpuStatus cpuExecuteSLTIU(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  // the immediate is sign-extended, then compared as unsigned
+  return cpuFinishALU(hart, instr, a < ISA_INST_I_IMM12_SEXT(instr));
+}
+
+static t_cpuStatus cpuExecuteXORI(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  return cpuFinishALU(hart, instr, a ^ ISA_INST_I_IMM12_SEXT(instr));
+}
+
+static t_cpuStatus cpuExecuteORI(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  return cpuFinishALU(hart, instr, a | ISA_INST_I_IMM12_SEXT(instr));
+}
+
+static t_cpuStatus cpuExecuteANDI(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  return cpuFinishALU(hart, instr, a & ISA_INST_I_IMM12_SEXT(instr));
+}
+
+static t_cpuStatus cpuExecuteSLLI(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  return cpuFinishALU(hart, instr, a << (ISA_INST_I_IMM12(instr) & 0x1F));
+}
+
+static t_cpuStatus cpuExecuteSRLI(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  return cpuFinishALU(hart, instr, a >> (ISA_INST_I_IMM12(instr) & 0x1F));
+}
+
+static t_cpuStatus cpuExecuteSRAI(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  return cpuFinishALU(hart, instr, SRA(a, ISA_INST_I_IMM12(instr) & 0x1F));
+}
+
+
+static t_cpuStatus cpuExecuteADD(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, a + b);
+}
+
+static t_cpuStatus cpuExecuteSUB(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, a - b);
+}
+
+static t_cpuStatus cpuExecuteSLL(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, a << (b & 0x1F));
+}
+
+static t_cpuStatus cpuExecuteSLT(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, (t_cpuSRegValue)a < (t_cpuSRegValue)b);
+}
+
+static t_cpuStatus cpuExecuteSLTU(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, a < b);
+}
+
+static t_cpuStatus cpuExecuteXOR(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, a ^ b);
+}
+
+static t_cpuStatus cpuExecuteSRL(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, a >> (b & 0x1F));
+}
+
+static t_cpuStatus cpuExecuteSRA(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, SRA(a, b & 0x1F));
+}
+
+static t_cpuStatus cpuExecuteOR(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, a | b);
+}
+
+static t_cpuStatus cpuExecuteAND(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, a & b);
+}
+
+
+static t_cpuStatus cpuExecuteMUL(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, a * b);
+}
+
+static t_cpuStatus cpuExecuteMULH(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr,
+      (uint32_t)(((int64_t)((int32_t)a) * (int64_t)((int32_t)b)) >> 32));
+}
+
+static t_cpuStatus cpuExecuteMULHSU(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(
+      hart, instr, (uint32_t)(((int64_t)((int32_t)a) * (int64_t)(b)) >> 32));
+}
+
+static t_cpuStatus cpuExecuteMULHU(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr,
+      (t_cpuURegValue)(((uint64_t)(a) * (uint64_t)(b)) >> 32));
+}
+
+static t_cpuStatus cpuExecuteDIV(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  if (b == 0)
+    return cpuFinishALU(hart, instr, 0xFFFFFFFF);
+  if (a == 0x80000000 && b == 0xFFFFFFFF)
+    return cpuFinishALU(hart, instr, 0x80000000);
+  return cpuFinishALU(hart, instr,
+      (t_cpuURegValue)((t_cpuSRegValue)a / (t_cpuSRegValue)b));
+}
+
+static t_cpuStatus cpuExecuteDIVU(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, b == 0 ? 0xFFFFFFFF : a / b);
+}
+
+static t_cpuStatus cpuExecuteREM(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  if (b == 0)
+    return cpuFinishALU(hart, instr, a);
+  if (a == 0x80000000 && b == 0xFFFFFFFF)
+    return cpuFinishALU(hart, instr, 0);
+  return cpuFinishALU(hart, instr,
+      (t_cpuURegValue)((t_cpuSRegValue)a % (t_cpuSRegValue)b));
+}
+
+static t_cpuStatus cpuExecuteREMU(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue a = hart->regs[ISA_INST_RS1(instr)];
+  t_cpuURegValue b = hart->regs[ISA_INST_RS2(instr)];
+  return cpuFinishALU(hart, instr, b == 0 ? a : a % b);
+}
+
+
+static t_cpuStatus cpuExecuteECALL(t_cpuHart *hart, uint32_t instr)
+{
+  return CPU_STATUS_ECALL_TRAP;
+}
+
+static t_cpuStatus cpuExecuteEBREAK(t_cpuHart *hart, uint32_t instr)
+{
+  return CPU_STATUS_EBREAK_TRAP;
+}
+
+static bool cpuReadCSR(
+    t_cpuHart *hart, unsigned int csr, t_cpuURegValue *out)
+{
+  // There is no timing model, every instruction takes exactly one cycle
+  switch (csr) {
+    case ISA_CSR_CYCLE:
+    case ISA_CSR_INSTRET:
+      *out = (t_cpuURegValue)hart->instRet;
+      return true;
+    case ISA_CSR_CYCLEH:
+    case ISA_CSR_INSTRETH:
+      *out = (t_cpuURegValue)(hart->instRet >> 32);
+      return true;
+    case ISA_CSR_TIME:
+      *out = (t_cpuURegValue)(cpuHostTimeMicros() - cpuTimeBase);
+      return true;
+    case ISA_CSR_TIMEH:
+      *out = (t_cpuURegValue)((cpuHostTimeMicros() - cpuTimeBase) >> 32);
+      return true;
+    case ISA_CSR_MHARTID:
+      *out = hart->hartId;
+      return true;
+  }
+  return false;
+}
+
+/* All implemented CSRs are read-only, so only the set and clear variants
+ * with no bits to change (rs1 or the immediate is zero) are valid */
+static t_cpuStatus cpuExecuteCSRRead(t_cpuHart *hart, uint32_t instr)
+{
+  t_cpuURegValue value;
+  if (ISA_INST_RS1(instr) != 0 ||
+      !cpuReadCSR(hart, ISA_INST_CSR(instr), &value))
     return CPU_STATUS_ILL_INST_FAULT;
-  cpuRegs[rd] = cpuPC + 4;
-  // clear bit zero as suggested by the spec
-  cpuPC = (cpuRegs[rs1] + (t_cpuURegValue)offs) & ~(t_cpuURegValue)1;
+  hart->regs[ISA_INST_RD(instr)] = value;
+  hart->pc += hart->instLength;
   return CPU_STATUS_OK;
 }
 
-t_cpuStatus cpuExecuteJAL(uint32_t instr)
+static t_cpuStatus cpuExecuteCSRRW(t_cpuHart *hart, uint32_t instr)
 {
-  t_cpuSRegValue offs = (t_cpuSRegValue)ISA_INST_J_IMM21_SEXT(instr);
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  cpuRegs[rd] = cpuPC + 4;
-  cpuPC += (t_cpuURegValue)offs;
-  return CPU_STATUS_OK;
+  return CPU_STATUS_ILL_INST_FAULT;
 }
 
-t_cpuStatus cpuExecuteSYSTEM(uint32_t instr)
+static t_cpuStatus cpuExecuteCSRRS(t_cpuHart *hart, uint32_t instr)
+{
+  return cpuExecuteCSRRead(hart, instr);
+}
+
+static t_cpuStatus cpuExecuteCSRRC(t_cpuHart *hart, uint32_t instr)
+{
+  return cpuExecuteCSRRead(hart, instr);
+}
+
+static t_cpuStatus cpuExecuteCSRRWI(t_cpuHart *hart, uint32_t instr)
 {
-  if (ISA_INST_FUNCT3(instr) != 0)
-    return CPU_STATUS_ILL_INST_FAULT;
-  if (ISA_INST_I_IMM12(instr) == 0)
-    return CPU_STATUS_ECALL_TRAP;
-  if (ISA_INST_I_IMM12(instr) == 1)
-    return CPU_STATUS_EBREAK_TRAP;
   return CPU_STATUS_ILL_INST_FAULT;
 }
+
+static t_cpuStatus cpuExecuteCSRRSI(t_cpuHart *hart, uint32_t instr)
+{
+  return cpuExecuteCSRRead(hart, instr);
+}
+
+static t_cpuStatus cpuExecuteCSRRCI(t_cpuHart *hart, uint32_t instr)
+{
+  return cpuExecuteCSRRead(hart, instr);
+}
+
+
+/* Guest memory is little-endian like the host, so the atomic instructions
+ * map directly to host atomics. The aq/rl bits are ignored because every
+ * access is sequentially consistent. */
+static t_cpuStatus cpuFinishAMO(
+    t_cpuHart *hart, uint32_t instr, uint32_t old, int flags)
+{
+  if ((plgEvents & PLG_EVENT_MEM_ACCESS) && flags)
+    plgNotifyMemAccess(
+        hart->hartId, hart->pc, hart->regs[ISA_INST_RS1(instr)], 4, flags);
+  hart->regs[ISA_INST_RD(instr)] = old;
+  hart->pc += hart->instLength;
+  return CPU_STATUS_OK;
+}
+
+static t_cpuStatus cpuExecuteLR_W(t_cpuHart *hart, uint32_t instr)
+{
+  t_memAddress addr = hart->regs[ISA_INST_RS1(instr)];
+  uint32_t *ptr;
+  if (memGetHostWord(addr, &ptr) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  uint32_t old = __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+  hart->reserved = true;
+  hart->reservedAddr = addr;
+  hart->reservedValue = old;
+  return cpuFinishAMO(hart, instr, old, PLG_MEM_READ);
+}
+
+static t_cpuStatus cpuExecuteSC_W(t_cpuHart *hart, uint32_t instr)
+{
+  t_memAddress addr = hart->regs[ISA_INST_RS1(instr)];
+  uint32_t *ptr;
+  if (memGetHostWord(addr, &ptr) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  // The reservation holds as long as memory still contains the value
+  // observed by LR.W, stores of other harts are not tracked
+  uint32_t expected = hart->reservedValue;
+  bool success = hart->reserved && hart->reservedAddr == addr &&
+      __atomic_compare_exchange_n(ptr, &expected,
+          hart->regs[ISA_INST_RS2(instr)], false, __ATOMIC_SEQ_CST,
+          __ATOMIC_SEQ_CST);
+  hart->reserved = false;
+  return cpuFinishAMO(
+      hart, instr, success ? 0 : 1, success ? PLG_MEM_WRITE : 0);
+}
+
+static t_cpuStatus cpuExecuteAMOSWAP_W(t_cpuHart *hart, uint32_t instr)
+{
+  uint32_t *ptr;
+  if (memGetHostWord(hart->regs[ISA_INST_RS1(instr)], &ptr) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  uint32_t old = __atomic_exchange_n(
+      ptr, hart->regs[ISA_INST_RS2(instr)], __ATOMIC_SEQ_CST);
+  return cpuFinishAMO(hart, instr, old, PLG_MEM_READ | PLG_MEM_WRITE);
+}
+
+static t_cpuStatus cpuExecuteAMOADD_W(t_cpuHart *hart, uint32_t instr)
+{
+  uint32_t *ptr;
+  if (memGetHostWord(hart->regs[ISA_INST_RS1(instr)], &ptr) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  uint32_t old = __atomic_fetch_add(
+      ptr, hart->regs[ISA_INST_RS2(instr)], __ATOMIC_SEQ_CST);
+  return cpuFinishAMO(hart, instr, old, PLG_MEM_READ | PLG_MEM_WRITE);
+}
+
+static t_cpuStatus cpuExecuteAMOXOR_W(t_cpuHart *hart, uint32_t instr)
+{
+  uint32_t *ptr;
+  if (memGetHostWord(hart->regs[ISA_INST_RS1(instr)], &ptr) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  uint32_t old = __atomic_fetch_xor(
+      ptr, hart->regs[ISA_INST_RS2(instr)], __ATOMIC_SEQ_CST);
+  return cpuFinishAMO(hart, instr, old, PLG_MEM_READ | PLG_MEM_WRITE);
+}
+
+static t_cpuStatus cpuExecuteAMOAND_W(t_cpuHart *hart, uint32_t instr)
+{
+  uint32_t *ptr;
+  if (memGetHostWord(hart->regs[ISA_INST_RS1(instr)], &ptr) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  uint32_t old = __atomic_fetch_and(
+      ptr, hart->regs[ISA_INST_RS2(instr)], __ATOMIC_SEQ_CST);
+  return cpuFinishAMO(hart, instr, old, PLG_MEM_READ | PLG_MEM_WRITE);
+}
+
+static t_cpuStatus cpuExecuteAMOOR_W(t_cpuHart *hart, uint32_t instr)
+{
+  uint32_t *ptr;
+  if (memGetHostWord(hart->regs[ISA_INST_RS1(instr)], &ptr) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  uint32_t old = __atomic_fetch_or(
+      ptr, hart->regs[ISA_INST_RS2(instr)], __ATOMIC_SEQ_CST);
+  return cpuFinishAMO(hart, instr, old, PLG_MEM_READ | PLG_MEM_WRITE);
+}
+
+static t_cpuStatus cpuAtomicMinMax(
+    t_cpuHart *hart, uint32_t instr, bool max, bool sign)
+{
+  uint32_t *ptr;
+  if (memGetHostWord(hart->regs[ISA_INST_RS1(instr)], &ptr) != MEM_NO_ERROR)
+    return CPU_STATUS_MEMORY_FAULT;
+  uint32_t value = hart->regs[ISA_INST_RS2(instr)];
+  // Flipping the sign bit maps signed order to unsigned order
+  uint32_t flip = sign ? 0x80000000 : 0;
+  uint32_t old = __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+  uint32_t new;
+  do {
+    bool less = (old ^ flip) < (value ^ flip);
+    new = less != max ? old : value;
+  } while (!__atomic_compare_exchange_n(
+      ptr, &old, new, true, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+  return cpuFinishAMO(hart, instr, old, PLG_MEM_READ | PLG_MEM_WRITE);
+}
+
+static t_cpuStatus cpuExecuteAMOMIN_W(t_cpuHart *hart, uint32_t instr)
+{
+  return cpuAtomicMinMax(hart, instr, false, true);
+}
+
+static t_cpuStatus cpuExecuteAMOMAX_W(t_cpuHart *hart, uint32_t instr)
+{
+  return cpuAtomicMinMax(hart, instr, true, true);
+}
+
+static t_cpuStatus cpuExecuteAMOMINU_W(t_cpuHart *hart, uint32_t instr)
+{
+  return cpuAtomicMinMax(hart, instr, false, false);
+}
+
+static t_cpuStatus cpuExecuteAMOMAXU_W(t_cpuHart *hart, uint32_t instr)
+{
+  return cpuAtomicMinMax(hart, instr, true, false);
+}
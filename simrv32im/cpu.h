@@ -1,6 +1,8 @@
 #ifndef CPU_H
 #define CPU_H
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "isa.h"
 
 typedef int t_cpuStatus;
@@ -12,11 +14,22 @@ enum {
   CPU_STATUS_EBREAK_TRAP = -4
 };
 
+typedef struct cpuHart t_cpuHart;
+
+t_cpuHart *cpuNewHart(t_cpuURegValue hartId, t_cpuURegValue pcValue);
+void cpuDeleteHart(t_cpuHart *hart);
+void cpuSetCurrentHart(t_cpuHart *hart);
+void cpuSetFusion(bool enable);
+
 t_cpuURegValue cpuGetRegister(t_cpuRegID reg);
 void cpuSetRegister(t_cpuRegID reg, t_cpuURegValue value);
 
 void cpuReset(t_cpuURegValue pcValue);
 t_cpuStatus cpuTick(void);
 t_cpuStatus cpuClearLastFault(void);
+t_cpuStatus cpuRaiseMemoryFault(void);
+uint64_t cpuGetInstRetCount(void);
+/* Instructions retired by hart zero, from any hart */
+uint64_t cpuGetMainInstRetCount(void);
 
 #endif
@@ -329,7 +329,10 @@ void dbgCmdPrintCpuStatus(void)
   t_cpuURegValue pc = cpuGetRegister(CPU_REG_PC);
   uint32_t inst = memDebugRead32(pc, NULL);
   isaDisassemble(inst, buffer, 80);
-  fprintf(stderr, "PC : %08x: %08x %s\n", pc, inst, buffer);
+  if (isaGetInstrLength(inst) == 2)
+    fprintf(stderr, "PC : %08x:     %04x %s\n", pc, inst & 0xFFFF, buffer);
+  else
+    fprintf(stderr, "PC : %08x: %08x %s\n", pc, inst, buffer);
 
   for (t_cpuRegID r = CPU_REG_X0; r <= CPU_REG_X31; r++) {
     fprintf(stderr, "X%-2d: %08x", r, cpuGetRegister(r));
@@ -357,12 +360,17 @@ void dbgCmdDisassemble(char *args)
     return;
   }
 
+  t_memAddress curaddr = (t_memAddress)addr;
   for (int i = 0; i < len; i++) {
-    t_memAddress curaddr = (t_memAddress)addr + (t_memAddress)(4 * i);
     uint32_t instr = memDebugRead32(curaddr, NULL);
     isaDisassemble(instr, buffer, 80);
-    fprintf(
-        stderr, "%08" PRIx32 ":  %08" PRIx32 "  %s\n", curaddr, instr, buffer);
+    if (isaGetInstrLength(instr) == 2)
+      fprintf(stderr, "%08" PRIx32 ":      %04" PRIx32 "  %s\n", curaddr,
+          instr & 0xFFFF, buffer);
+    else
+      fprintf(stderr, "%08" PRIx32 ":  %08" PRIx32 "  %s\n", curaddr, instr,
+          buffer);
+    curaddr += (t_memAddress)isaGetInstrLength(instr);
   }
 
   return;
@@ -2,168 +2,230 @@
 #include <inttypes.h>
 #include "isa.h"
 
-int isaDisassembleIllegal(uint32_t instr, char *out, size_t bufsz);
-int isaDisassembleOP(uint32_t instr, char *out, size_t bufsz);
-int isaDisassembleOPIMM(uint32_t instr, char *out, size_t bufsz);
-int isaDisassembleLOAD(uint32_t instr, char *out, size_t bufsz);
-int isaDisassembleSTORE(uint32_t instr, char *out, size_t bufsz);
-int isaDisassembleBRANCH(uint32_t instr, char *out, size_t bufsz);
-int isaDisassembleSYSTEM(uint32_t instr, char *out, size_t bufsz);
-
-
-int isaDisassemble(uint32_t instr, char *out, size_t bufsz)
+static uint32_t isaPackI(
+    uint32_t opcode, uint32_t funct3, uint32_t rd, uint32_t rs1, uint32_t imm)
 {
-  t_cpuRegID rd, rs1;
-  int32_t imm;
-
-  switch (ISA_INST_OPCODE(instr)) {
-    case ISA_INST_OPCODE_OP:
-      return isaDisassembleOP(instr, out, bufsz);
-    case ISA_INST_OPCODE_OPIMM:
-      return isaDisassembleOPIMM(instr, out, bufsz);
-    case ISA_INST_OPCODE_LOAD:
-      return isaDisassembleLOAD(instr, out, bufsz);
-    case ISA_INST_OPCODE_STORE:
-      return isaDisassembleSTORE(instr, out, bufsz);
-    case ISA_INST_OPCODE_BRANCH:
-      return isaDisassembleBRANCH(instr, out, bufsz);
-    case ISA_INST_OPCODE_JAL:
-      rd = ISA_INST_RD(instr);
-      imm = (int32_t)ISA_INST_J_IMM21_SEXT(instr);
-      return snprintf(out, bufsz, "JAL x%d, *%+" PRId32, rd, imm);
-    case ISA_INST_OPCODE_JALR:
-      if (ISA_INST_FUNCT3(instr) != 0)
-        return isaDisassembleIllegal(instr, out, bufsz);
-      rd = ISA_INST_RD(instr);
-      rs1 = ISA_INST_RS1(instr);
-      imm = (int32_t)ISA_INST_I_IMM12_SEXT(instr);
-      return snprintf(out, bufsz, "JALR x%d, %" PRId32 "(x%d)", rd, imm, rs1);
-    case ISA_INST_OPCODE_LUI:
-      rd = ISA_INST_RD(instr);
-      imm = (int32_t)ISA_INST_U_IMM20(instr);
-      return snprintf(out, bufsz, "LUI x%d, 0x%05" PRIx32, rd, imm);
-    case ISA_INST_OPCODE_AUIPC:
-      rd = ISA_INST_RD(instr);
-      imm = (int32_t)ISA_INST_U_IMM20(instr);
-      return snprintf(out, bufsz, "AUIPC x%d, 0x%05" PRIx32, rd, imm);
-    case ISA_INST_OPCODE_SYSTEM:
-      return isaDisassembleSYSTEM(instr, out, bufsz);
-  }
-
-  return isaDisassembleIllegal(instr, out, bufsz);
+  return opcode | (rd << 7) | (funct3 << 12) | (rs1 << 15) |
+      ((imm & 0xFFF) << 20);
 }
 
-int isaDisassembleIllegal(uint32_t instr, char *out, size_t bufsz)
+static uint32_t isaPackR(uint32_t opcode, uint32_t funct3, uint32_t funct7,
+    uint32_t rd, uint32_t rs1, uint32_t rs2)
 {
-  return snprintf(out, bufsz, "<illegal>");
+  return opcode | (rd << 7) | (funct3 << 12) | (rs1 << 15) | (rs2 << 20) |
+      (funct7 << 25);
 }
 
-int isaDisassembleOP(uint32_t instr, char *out, size_t bufsz)
+static uint32_t isaPackS(
+    uint32_t funct3, uint32_t rs1, uint32_t rs2, uint32_t imm)
 {
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  t_cpuRegID rs2 = ISA_INST_RS2(instr);
-  static const char *mnems00[] = {
-      "ADD", "SLL", "SLT", "SLTU", "XOR", "SRL", "OR", "AND"};
-  static const char *mnems20[] = {
-      "SUB", NULL, NULL, NULL, NULL, "SRA", NULL, NULL};
-  static const char *mnems01[] = {
-      "MUL", "MULH", "MULHSU", "MULHU", "DIV", "DIVU", "REM", "REMU"};
-
-  static const char *mnem;
-  if (ISA_INST_FUNCT7(instr) == 0x00) {
-    mnem = mnems00[ISA_INST_FUNCT3(instr)];
-  } else if (ISA_INST_FUNCT7(instr) == 0x20) {
-    mnem = mnems20[ISA_INST_FUNCT3(instr)];
-  } else if (ISA_INST_FUNCT7(instr) == 0x01) {
-    mnem = mnems01[ISA_INST_FUNCT3(instr)];
-  } else {
-    return isaDisassembleIllegal(instr, out, bufsz);
-  }
-
-  if (mnem != NULL)
-    return snprintf(out, bufsz, "%s x%d, x%d, x%d", mnem, rd, rs1, rs2);
-  return isaDisassembleIllegal(instr, out, bufsz);
+  return ISA_INST_OPCODE_STORE | ((imm & 0x1F) << 7) | (funct3 << 12) |
+      (rs1 << 15) | (rs2 << 20) | (BITS(imm, 5, 12) << 25);
 }
 
-int isaDisassembleOPIMM(uint32_t instr, char *out, size_t bufsz)
+static uint32_t isaPackB(
+    uint32_t funct3, uint32_t rs1, uint32_t rs2, uint32_t imm)
 {
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  int32_t imm = (int32_t)ISA_INST_I_IMM12_SEXT(instr);
-  static const char *mnems[] = {
-      "ADDI", "SLLI", "SLTI", "SLTIU", "XORI", "SRLI", "ORI", "ANDI"};
-
-  const char *mnem = mnems[ISA_INST_FUNCT3(instr)];
-
-  if (ISA_INST_FUNCT3(instr) == 3) {
-    imm &= 0x7FF;
-  } else if (ISA_INST_FUNCT3(instr) == 1) {
-    if (ISA_INST_FUNCT7(instr) != 0)
-      return isaDisassembleIllegal(instr, out, bufsz);
-  } else if (ISA_INST_FUNCT3(instr) == 5) {
-    if (ISA_INST_FUNCT7(instr) == 0x20) {
-      mnem = "SRAI";
-      imm &= 0x1F;
-    } else if (ISA_INST_FUNCT7(instr) != 0)
-      return isaDisassembleIllegal(instr, out, bufsz);
-  }
-
-  return snprintf(out, bufsz, "%s x%d, x%d, %" PRId32, mnem, rd, rs1, imm);
+  return ISA_INST_OPCODE_BRANCH | (BITS(imm, 11, 12) << 7) |
+      (BITS(imm, 1, 5) << 8) | (funct3 << 12) | (rs1 << 15) | (rs2 << 20) |
+      (BITS(imm, 5, 11) << 25) | (BITS(imm, 12, 13) << 31);
 }
 
-int isaDisassembleLOAD(uint32_t instr, char *out, size_t bufsz)
+static uint32_t isaPackJ(uint32_t rd, uint32_t imm)
 {
-  t_cpuRegID rd = ISA_INST_RD(instr);
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  int32_t imm = (int32_t)ISA_INST_I_IMM12_SEXT(instr);
-  static const char *mnems[] = {
-      "LB", "LH", "LW", NULL, "LBU", "LHU", NULL, NULL};
-
-  const char *mnem = mnems[ISA_INST_FUNCT3(instr)];
-  if (mnem == NULL)
-    return isaDisassembleIllegal(instr, out, bufsz);
-
-  return snprintf(out, bufsz, "%s x%d, %" PRId32 "(x%d)", mnem, rd, imm, rs1);
+  return ISA_INST_OPCODE_JAL | (rd << 7) | (BITS(imm, 12, 20) << 12) |
+      (BITS(imm, 11, 12) << 20) | (BITS(imm, 1, 11) << 21) |
+      (BITS(imm, 20, 21) << 31);
 }
 
-int isaDisassembleSTORE(uint32_t instr, char *out, size_t bufsz)
+/* Expands a 16-bit RV32C instruction to the equivalent 32-bit one. Reserved
+ * and unsupported encodings expand to zero, which is an illegal instruction. */
+uint32_t isaExpandCompressed(uint16_t instr)
 {
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  t_cpuRegID rs2 = ISA_INST_RS2(instr);
-  int32_t imm = (int32_t)ISA_INST_S_IMM12_SEXT(instr);
-  static const char *mnems[] = {
-      "SB", "SH", "SW", NULL, NULL, NULL, NULL, NULL};
-
-  const char *mnem = mnems[ISA_INST_FUNCT3(instr)];
-  if (mnem == NULL)
-    return isaDisassembleIllegal(instr, out, bufsz);
-
-  return snprintf(out, bufsz, "%s x%d, %" PRId32 "(x%d)", mnem, rs2, imm, rs1);
+  uint32_t funct3 = BITS(instr, 13, 16);
+  uint32_t rd = BITS(instr, 7, 12);
+  uint32_t rs2 = BITS(instr, 2, 7);
+  uint32_t rdc = BITS(instr, 2, 5) + 8;
+  uint32_t rs1c = BITS(instr, 7, 10) + 8;
+  uint32_t imm6 = SEXT(BITS(instr, 2, 7) | (BITS(instr, 12, 13) << 5), 6);
+  uint32_t imm;
+
+  switch (BITS(instr, 0, 2)) {
+    case 0:
+      imm = (BITS(instr, 6, 7) << 2) | (BITS(instr, 10, 13) << 3) |
+          (BITS(instr, 5, 6) << 6);
+      if (funct3 == 0) { // c.addi4spn
+        imm = (BITS(instr, 6, 7) << 2) | (BITS(instr, 5, 6) << 3) |
+            (BITS(instr, 11, 13) << 4) | (BITS(instr, 7, 11) << 6);
+        if (imm == 0)
+          return 0;
+        return isaPackI(ISA_INST_OPCODE_OPIMM, 0, rdc, CPU_REG_SP, imm);
+      } else if (funct3 == 2) { // c.lw
+        return isaPackI(ISA_INST_OPCODE_LOAD, 2, rdc, rs1c, imm);
+      } else if (funct3 == 6) { // c.sw
+        return isaPackS(2, rs1c, rdc, imm);
+      }
+      return 0;
+
+    case 1:
+      switch (funct3) {
+        case 0: // c.addi, c.nop
+          return isaPackI(ISA_INST_OPCODE_OPIMM, 0, rd, rd, imm6);
+        case 1: // c.jal
+        case 5: // c.j
+          imm = (BITS(instr, 3, 6) << 1) | (BITS(instr, 11, 12) << 4) |
+              (BITS(instr, 2, 3) << 5) | (BITS(instr, 7, 8) << 6) |
+              (BITS(instr, 6, 7) << 7) | (BITS(instr, 9, 11) << 8) |
+              (BITS(instr, 8, 9) << 10) | (BITS(instr, 12, 13) << 11);
+          return isaPackJ(funct3 == 1 ? CPU_REG_RA : CPU_REG_ZERO,
+              SEXT(imm, 12));
+        case 2: // c.li
+          return isaPackI(ISA_INST_OPCODE_OPIMM, 0, rd, CPU_REG_ZERO, imm6);
+        case 3:
+          if (rd == CPU_REG_SP) { // c.addi16sp
+            imm = (BITS(instr, 6, 7) << 4) | (BITS(instr, 2, 3) << 5) |
+                (BITS(instr, 5, 6) << 6) | (BITS(instr, 3, 5) << 7) |
+                (BITS(instr, 12, 13) << 9);
+            if (imm == 0)
+              return 0;
+            return isaPackI(ISA_INST_OPCODE_OPIMM, 0, rd, rd, SEXT(imm, 10));
+          }
+          if (imm6 == 0) // c.lui
+            return 0;
+          return ISA_INST_OPCODE_LUI | (rd << 7) | (imm6 << 12);
+        case 4:
+          if (BITS(instr, 10, 12) == 0 || BITS(instr, 10, 12) == 1) {
+            if (BITS(instr, 12, 13)) // shamt[5] must be zero on RV32
+              return 0;
+            return isaPackI(ISA_INST_OPCODE_OPIMM, 5, rs1c, rs1c,
+                rs2 | (BITS(instr, 10, 11) << 10)); // c.srli, c.srai
+          } else if (BITS(instr, 10, 12) == 2) { // c.andi
+            return isaPackI(ISA_INST_OPCODE_OPIMM, 7, rs1c, rs1c, imm6);
+          } else if (BITS(instr, 12, 13) == 0) {
+            static const uint32_t f3[] = {0, 4, 6, 7};
+            uint32_t op = BITS(instr, 5, 7);
+            return isaPackR(ISA_INST_OPCODE_OP, f3[op], op == 0 ? 0x20 : 0,
+                rs1c, rs1c, rdc); // c.sub, c.xor, c.or, c.and
+          }
+          return 0;
+        case 6: // c.beqz
+        case 7: // c.bnez
+          imm = (BITS(instr, 3, 5) << 1) | (BITS(instr, 10, 12) << 3) |
+              (BITS(instr, 2, 3) << 5) | (BITS(instr, 5, 7) << 6) |
+              (BITS(instr, 12, 13) << 8);
+          return isaPackB(funct3 - 6, rs1c, CPU_REG_ZERO, SEXT(imm, 9));
+      }
+      return 0;
+
+    case 2:
+      if (funct3 == 0) { // c.slli
+        if (BITS(instr, 12, 13))
+          return 0;
+        return isaPackI(ISA_INST_OPCODE_OPIMM, 1, rd, rd, rs2);
+      } else if (funct3 == 2) { // c.lwsp
+        imm = (BITS(instr, 4, 7) << 2) | (BITS(instr, 12, 13) << 5) |
+            (BITS(instr, 2, 4) << 6);
+        if (rd == 0)
+          return 0;
+        return isaPackI(ISA_INST_OPCODE_LOAD, 2, rd, CPU_REG_SP, imm);
+      } else if (funct3 == 4) {
+        if (BITS(instr, 12, 13) == 0) {
+          if (rs2 == 0) { // c.jr
+            if (rd == 0)
+              return 0;
+            return isaPackI(ISA_INST_OPCODE_JALR, 0, CPU_REG_ZERO, rd, 0);
+          } // c.mv
+          return isaPackR(ISA_INST_OPCODE_OP, 0, 0, rd, CPU_REG_ZERO, rs2);
+        }
+        if (rs2 == 0) {
+          if (rd == 0) // c.ebreak
+            return isaPackI(ISA_INST_OPCODE_SYSTEM, 0, 0, 0, 1);
+          return isaPackI(ISA_INST_OPCODE_JALR, 0, CPU_REG_RA, rd, 0);
+        } // c.add
+        return isaPackR(ISA_INST_OPCODE_OP, 0, 0, rd, rd, rs2);
+      } else if (funct3 == 6) { // c.swsp
+        imm = (BITS(instr, 9, 13) << 2) | (BITS(instr, 7, 9) << 6);
+        return isaPackS(2, CPU_REG_SP, rs2, imm);
+      }
+      return 0;
+  }
+  return 0;
 }
 
-int isaDisassembleBRANCH(uint32_t instr, char *out, size_t bufsz)
+size_t isaGetInstrLength(uint32_t instr)
 {
-  t_cpuRegID rs1 = ISA_INST_RS1(instr);
-  t_cpuRegID rs2 = ISA_INST_RS2(instr);
-  int32_t imm = (int32_t)ISA_INST_B_IMM13_SEXT(instr);
-  static const char *mnems[] = {
-      "BEQ", "BNE", NULL, NULL, "BLT", "BGE", "BLTU", "BGEU"};
+  return ISA_INST_IS_COMPRESSED(instr) ? 2 : 4;
+}
 
-  const char *mnem = mnems[ISA_INST_FUNCT3(instr)];
-  if (mnem == NULL)
-    return isaDisassembleIllegal(instr, out, bufsz);
 
-  return snprintf(out, bufsz, "%s x%d, x%d, *%+" PRId32, mnem, rs1, rs2, imm);
+static int isaDisassembleIllegal(uint32_t instr, char *out, size_t bufsz)
+{
+  return snprintf(out, bufsz, "<illegal>");
 }
 
-int isaDisassembleSYSTEM(uint32_t instr, char *out, size_t bufsz)
+int isaDisassemble(uint32_t instr, char *out, size_t bufsz)
 {
-  if (ISA_INST_FUNCT3(instr) != 0)
+  if (ISA_INST_IS_COMPRESSED(instr)) {
+    uint32_t expanded = isaExpandCompressed((uint16_t)instr);
+    if (expanded == 0)
+      return isaDisassembleIllegal(instr, out, bufsz);
+    int n = snprintf(out, bufsz, "C.");
+    if (n < 0 || (size_t)n >= bufsz)
+      return n;
+    return n + isaDisassemble(expanded, out + n, bufsz - (size_t)n);
+  }
+
+  t_isaInstID id = isaDecode(instr);
+  if (id == ISA_ID_ILLEGAL)
     return isaDisassembleIllegal(instr, out, bufsz);
-  if (ISA_INST_I_IMM12(instr) == 0)
-    return snprintf(out, bufsz, "ECALL");
-  if (ISA_INST_I_IMM12(instr) == 1)
-    return snprintf(out, bufsz, "EBREAK");
+  const char *mnem = isaMnemonic[id];
+  t_cpuRegID rd = ISA_INST_RD(instr);
+  t_cpuRegID rs1 = ISA_INST_RS1(instr);
+  t_cpuRegID rs2 = ISA_INST_RS2(instr);
+  int32_t imm = (int32_t)ISA_INST_I_IMM12_SEXT(instr);
+  uint32_t csr = ISA_INST_CSR(instr);
+  static const char *orderings[] = {"", ".RL", ".AQ", ".AQRL"};
+  const char *ord =
+      orderings[ISA_INST_AMO_AQ(instr) << 1 | ISA_INST_AMO_RL(instr)];
+
+  switch (isaFormat[id]) {
+    case ISA_FMT_R:
+      return snprintf(out, bufsz, "%s x%d, x%d, x%d", mnem, rd, rs1, rs2);
+    case ISA_FMT_I:
+      return snprintf(out, bufsz, "%s x%d, x%d, %" PRId32, mnem, rd, rs1, imm);
+    case ISA_FMT_SH:
+      return snprintf(
+          out, bufsz, "%s x%d, x%d, %" PRId32, mnem, rd, rs1, imm & 0x1F);
+    case ISA_FMT_L:
+      return snprintf(
+          out, bufsz, "%s x%d, %" PRId32 "(x%d)", mnem, rd, imm, rs1);
+    case ISA_FMT_S:
+      imm = (int32_t)ISA_INST_S_IMM12_SEXT(instr);
+      return snprintf(
+          out, bufsz, "%s x%d, %" PRId32 "(x%d)", mnem, rs2, imm, rs1);
+    case ISA_FMT_B:
+      imm = (int32_t)ISA_INST_B_IMM13_SEXT(instr);
+      return snprintf(
+          out, bufsz, "%s x%d, x%d, *%+" PRId32, mnem, rs1, rs2, imm);
+    case ISA_FMT_U:
+      imm = (int32_t)ISA_INST_U_IMM20(instr);
+      return snprintf(out, bufsz, "%s x%d, 0x%05" PRIx32, mnem, rd, imm);
+    case ISA_FMT_J:
+      imm = (int32_t)ISA_INST_J_IMM21_SEXT(instr);
+      return snprintf(out, bufsz, "%s x%d, *%+" PRId32, mnem, rd, imm);
+    case ISA_FMT_SYS:
+      return snprintf(out, bufsz, "%s", mnem);
+    case ISA_FMT_CSR:
+      return snprintf(
+          out, bufsz, "%s x%d, 0x%03" PRIx32 ", x%d", mnem, rd, csr, rs1);
+    case ISA_FMT_CSRI:
+      return snprintf(
+          out, bufsz, "%s x%d, 0x%03" PRIx32 ", %d", mnem, rd, csr, rs1);
+    case ISA_FMT_AMO:
+      return snprintf(
+          out, bufsz, "%s%s x%d, x%d, (x%d)", mnem, ord, rd, rs2, rs1);
+    case ISA_FMT_LR:
+      return snprintf(out, bufsz, "%s%s x%d, (x%d)", mnem, ord, rd, rs1);
+  }
   return isaDisassembleIllegal(instr, out, bufsz);
 }
@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "isa_gen.h"
 
 #define ISA_XSIZE (32)
 typedef int32_t t_isaSXSize;
@@ -114,6 +115,7 @@ static inline uint32_t bits32(uint32_t x, int a, int b)
 #define SEXT(x, s) (sext32(x, s))
 #define BITS(x, a, b) (bits32(x, a, b))
 
+#define ISA_INST_IS_COMPRESSED(x) (BITS(x, 0, 2) != 3)
 #define ISA_INST_OPCODE(x) BITS(x, 0, 7)
 #define ISA_INST_RD(x) BITS(x, 7, 12)
 #define ISA_INST_FUNCT3(x) BITS(x, 12, 15)
@@ -134,20 +136,38 @@ static inline uint32_t bits32(uint32_t x, int a, int b)
   ((BITS(x, 12, 20) << 12) | (BITS(x, 20, 21) << 11) | \
       (BITS(x, 21, 31) << 1) | (BITS(x, 31, 32) << 20))
 #define ISA_INST_J_IMM21_SEXT(x) SEXT(ISA_INST_J_IMM21(x), 21)
+#define ISA_INST_CSR(x) BITS(x, 20, 32)
+#define ISA_INST_AMO_FUNCT5(x) BITS(x, 27, 32)
+#define ISA_INST_AMO_AQ(x) BITS(x, 26, 27)
+#define ISA_INST_AMO_RL(x) BITS(x, 25, 26)
 
-#define ISA_INST_OPCODE_CODE(x) (((x) << 2) | 3)
-#define ISA_INST_OPCODE_LOAD ISA_INST_OPCODE_CODE(0x00)
-#define ISA_INST_OPCODE_OPIMM ISA_INST_OPCODE_CODE(0x04)
-#define ISA_INST_OPCODE_AUIPC ISA_INST_OPCODE_CODE(0x05)
-#define ISA_INST_OPCODE_STORE ISA_INST_OPCODE_CODE(0x08)
-#define ISA_INST_OPCODE_OP ISA_INST_OPCODE_CODE(0x0C)
-#define ISA_INST_OPCODE_LUI ISA_INST_OPCODE_CODE(0x0D)
-#define ISA_INST_OPCODE_BRANCH ISA_INST_OPCODE_CODE(0x18)
-#define ISA_INST_OPCODE_JALR ISA_INST_OPCODE_CODE(0x19)
-#define ISA_INST_OPCODE_JAL ISA_INST_OPCODE_CODE(0x1B)
-#define ISA_INST_OPCODE_SYSTEM ISA_INST_OPCODE_CODE(0x1C)
+#define ISA_CSR_CYCLE 0xC00
+#define ISA_CSR_TIME 0xC01
+#define ISA_CSR_INSTRET 0xC02
+#define ISA_CSR_CYCLEH 0xC80
+#define ISA_CSR_TIMEH 0xC81
+#define ISA_CSR_INSTRETH 0xC82
+#define ISA_CSR_MHARTID 0xF14
 
 
+/* Returns the instruction encoded by a 32-bit word, or ISA_ID_ILLEGAL.
+ * The tables are generated by isagen from isa/rv32im.isa. */
+static inline t_isaInstID isaDecode(uint32_t instr)
+{
+  uint16_t entry =
+      isaDecodeIndex[ISA_INST_OPCODE(instr) | ISA_INST_FUNCT3(instr) << 7];
+  if (!(entry & ISA_DECODE_LIST))
+    return entry;
+  const uint8_t *cand = &isaDecodeList[entry & ~ISA_DECODE_LIST];
+  for (; *cand != ISA_ID_ILLEGAL; cand++) {
+    if ((instr & isaDecodeMask[*cand]) == isaDecodeMatch[*cand])
+      return *cand;
+  }
+  return ISA_ID_ILLEGAL;
+}
+
+uint32_t isaExpandCompressed(uint16_t instr);
+size_t isaGetInstrLength(uint32_t instr);
 int isaDisassemble(uint32_t instr, char *out, size_t bufsz);
 
 #endif
@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "lines.h"
+#include "plugin.h"
+
+#define LIN_REPORT_ITEMS 32
+#define LIN_NAME_SIZE 96
+#define LIN_REPORT_WIDTH 78
+
+typedef struct linRange {
+  t_memAddress addr;
+  int file;
+  int line;
+} t_linRange;
+
+typedef struct linLine {
+  int file;
+  int line;
+  uint64_t count;
+} t_linLine;
+
+char *linFiles[LIN_MAX_FILES];
+t_linRange *linRanges = NULL;
+size_t linNumRanges = 0;
+size_t linMaxRanges = 0;
+
+// Instructions retired at each halfword between the first and the last range
+uint64_t *linCounts = NULL;
+t_memAddress linBase = 0;
+t_memAddress linEnd = 0;
+uint64_t linOutside = 0;
+
+
+bool linAddFile(int num, const char *name)
+{
+  if (num < 0 || num >= LIN_MAX_FILES)
+    return false;
+  free(linFiles[num]);
+  linFiles[num] = strdup(name);
+  return linFiles[num] != NULL;
+}
+
+bool linAddRange(t_memAddress addr, int file, int line)
+{
+  if (linNumRanges > 0 && addr <= linRanges[linNumRanges - 1].addr)
+    return false;
+  if (file < 0 || file >= LIN_MAX_FILES || (line != 0 && !linFiles[file]))
+    return false;
+  if (linNumRanges == linMaxRanges) {
+    size_t newMax = linMaxRanges ? linMaxRanges * 2 : 64;
+    t_linRange *newRanges = realloc(linRanges, newMax * sizeof(t_linRange));
+    if (!newRanges)
+      return false;
+    linRanges = newRanges;
+    linMaxRanges = newMax;
+  }
+  t_linRange *range = &linRanges[linNumRanges++];
+  range->addr = addr;
+  range->file = file;
+  range->line = line;
+  return true;
+}
+
+bool linAvailable(void)
+{
+  return linNumRanges > 1;
+}
+
+
+static void linInstRetired(
+    void *data, uint32_t hart, uint32_t pc, uint32_t inst)
+{
+  if (pc - linBase < linEnd - linBase)
+    __atomic_fetch_add(&linCounts[(pc - linBase) >> 1], 1, __ATOMIC_RELAXED);
+  else
+    __atomic_fetch_add(&linOutside, 1, __ATOMIC_RELAXED);
+}
+
+bool linStart(void)
+{
+  linBase = linRanges[0].addr;
+  linEnd = linRanges[linNumRanges - 1].addr;
+  linCounts = calloc((linEnd - linBase + 1) / 2, sizeof(uint64_t));
+  if (!linCounts)
+    return false;
+  t_plgHooks hooks = {0};
+  hooks.instRetired = linInstRetired;
+  return plgRegister(&hooks) == PLG_NO_ERROR;
+}
+
+
+static int linCompareLines(const void *a, const void *b)
+{
+  const t_linLine *x = (const t_linLine *)a, *y = (const t_linLine *)b;
+  if (x->file != y->file)
+    return x->file < y->file ? -1 : 1;
+  return x->line < y->line ? -1 : (x->line > y->line);
+}
+
+static int linCompareCounts(const void *a, const void *b)
+{
+  const t_linLine *x = *(const t_linLine **)a, *y = *(const t_linLine **)b;
+  if (x->count != y->count)
+    return x->count > y->count ? -1 : 1;
+  return linCompareLines(x, y);
+}
+
+/* Prints the lines of a file which never executed as a list of ranges */
+static void linPrintUnexecuted(FILE *fp, t_linLine *lines, int n)
+{
+  int col = fprintf(fp, "  not executed:");
+  for (int i = 0; i < n;) {
+    if (lines[i].count > 0) {
+      i++;
+      continue;
+    }
+    int j = i;
+    while (j + 1 < n && lines[j + 1].count == 0 &&
+        lines[j + 1].line == lines[j].line + 1)
+      j++;
+    char buf[32];
+    if (i == j)
+      snprintf(buf, sizeof(buf), " %d", lines[i].line);
+    else
+      snprintf(buf, sizeof(buf), " %d-%d", lines[i].line, lines[j].line);
+    if (col + (int)strlen(buf) > LIN_REPORT_WIDTH)
+      col = fprintf(fp, "\n               ");
+    col += fprintf(fp, "%s", buf);
+    i = j + 1;
+  }
+  fprintf(fp, "\n");
+}
+
+void linPrintReport(FILE *fp)
+{
+  if (!linCounts)
+    return;
+
+  // Lines may be split in more than one range, which are merged
+  t_linLine *lines = calloc(linNumRanges, sizeof(t_linLine));
+  t_linLine **sorted = calloc(linNumRanges, sizeof(t_linLine *));
+  if (!lines || !sorted) {
+    free(lines);
+    free(sorted);
+    return;
+  }
+  uint64_t total = linOutside, unknown = linOutside;
+  int numLines = 0;
+  for (size_t i = 0; i + 1 < linNumRanges; i++) {
+    t_linRange *range = &linRanges[i];
+    uint64_t count = 0;
+    for (t_memAddress pc = range->addr; pc < linRanges[i + 1].addr; pc += 2)
+      count += linCounts[(pc - linBase) >> 1];
+    total += count;
+    if (range->line == 0) {
+      unknown += count;
+      continue;
+    }
+    lines[numLines].file = range->file;
+    lines[numLines].line = range->line;
+    lines[numLines++].count = count;
+  }
+  qsort(lines, (size_t)numLines, sizeof(t_linLine), linCompareLines);
+  int n = 0;
+  for (int i = 0; i < numLines; i++) {
+    if (n > 0 && linCompareLines(&lines[n - 1], &lines[i]) == 0)
+      lines[n - 1].count += lines[i].count;
+    else
+      lines[n++] = lines[i];
+  }
+  numLines = n;
+  for (int i = 0; i < numLines; i++)
+    sorted[i] = &lines[i];
+  qsort(sorted, (size_t)numLines, sizeof(t_linLine *), linCompareCounts);
+
+  fprintf(fp, "\nSource lines (%" PRIu64 " instructions, %" PRIu64
+              " without a source line)\n", total, unknown);
+  fprintf(fp, "%-40s %12s %6s\n", "LINE", "INSTRUCTIONS", "%");
+  char name[LIN_NAME_SIZE];
+  for (int i = 0; i < numLines && i < LIN_REPORT_ITEMS; i++) {
+    if (sorted[i]->count == 0)
+      break;
+    snprintf(name, LIN_NAME_SIZE, "%s:%d", linFiles[sorted[i]->file],
+        sorted[i]->line);
+    fprintf(fp, "%-40s %12" PRIu64 " %6.1f\n", name, sorted[i]->count,
+        total ? (double)sorted[i]->count / (double)total * 100.0 : 0.0);
+  }
+  if (numLines > LIN_REPORT_ITEMS && sorted[LIN_REPORT_ITEMS]->count > 0)
+    fprintf(fp, "(more lines not shown)\n");
+
+  fprintf(fp, "\nLine coverage\n");
+  for (int i = 0; i < numLines;) {
+    int j = i, executed = 0;
+    for (; j < numLines && lines[j].file == lines[i].file; j++)
+      executed += lines[j].count > 0;
+    fprintf(fp, "%s: %d of %d lines executed (%.1f%%)\n",
+        linFiles[lines[i].file], executed, j - i,
+        (double)executed / (double)(j - i) * 100.0);
+    if (executed < j - i)
+      linPrintUnexecuted(fp, lines + i, j - i);
+    i = j;
+  }
+
+  free(lines);
+  free(sorted);
+}
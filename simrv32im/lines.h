@@ -0,0 +1,25 @@
+#ifndef LINES_H
+#define LINES_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "memory.h"
+
+/* Source lines of the program, loaded from the line table which asrv32im
+ * writes when the assembly source has .loc directives (see acse -g). When
+ * profiling, the instructions executed by each source line are counted,
+ * and the lines which never executed are listed. */
+
+#define LIN_MAX_FILES 256
+
+bool linAddFile(int num, const char *name);
+/* The code from `addr' up to the address of the next range belongs to
+ * `line' of `file', or to no line if `line' is zero. Ranges are added in
+ * increasing address order. */
+bool linAddRange(t_memAddress addr, int file, int line);
+bool linAvailable(void);
+
+bool linStart(void);
+void linPrintReport(FILE *fp);
+
+#endif
@@ -1,45 +1,129 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "cpu.h"
 #include "loader.h"
 #include "debugger.h"
+#include "symbols.h"
+#include "lines.h"
 
+// Raw binaries larger than this are rejected
+#define LDR_MAX_BINARY_SIZE 0x8000000
 
-t_ldrError ldrLoadBinary(
-    const char *path, t_memAddress baseAddr, t_memAddress entry)
-{
-  dbgPrintf("Loading raw binary file \"%s\" at address %" PRIu32 "\n", path);
+t_memAddress ldrImageEnd = 0;
+
+// The executable opened by ldrOpen. Its headers are read from a read-only
+// mapping of the whole file, while its segments are mapped separately from
+// the file descriptor into the memory of the program.
+const char *ldrPath = NULL;
+int ldrFd = -1;
+const uint8_t *ldrData = NULL;
+size_t ldrSize = 0;
 
-  FILE *fp = fopen(path, "rb");
-  if (fp == NULL)
-    return LDR_FILE_ERROR;
 
-  if (fseek(fp, 0, SEEK_END) < 0)
+t_ldrError ldrOpen(const char *path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
     return LDR_FILE_ERROR;
-  long fpos = ftell(fp);
-  if (fpos < 0 || fpos > 0x8000000L) {
-    fclose(fp);
+  struct stat info;
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+    close(fd);
     return LDR_FILE_ERROR;
   }
-  t_memSize size = (t_memSize)fpos;
-  if (fseek(fp, 0, SEEK_SET) < 0) {
-    fclose(fp);
-    return LDR_FILE_ERROR;
+  void *data = NULL;
+  if (info.st_size > 0) {
+    data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return LDR_FILE_ERROR;
+    }
   }
+  ldrPath = path;
+  ldrFd = fd;
+  ldrData = data;
+  ldrSize = (size_t)info.st_size;
+  return LDR_NO_ERROR;
+}
 
-  uint8_t *buf;
-  if (memMapArea(baseAddr, size, &buf) != MEM_NO_ERROR) {
-    fclose(fp);
-    return LDR_MEMORY_ERROR;
+void ldrClose(void)
+{
+  if (ldrData)
+    munmap((void *)ldrData, ldrSize);
+  if (ldrFd >= 0)
+    close(ldrFd);
+  ldrPath = NULL;
+  ldrFd = -1;
+  ldrData = NULL;
+  ldrSize = 0;
+}
+
+/* Copies `size' bytes at `offset' in the executable, if they are all inside
+ * the file */
+static bool ldrRead(void *out, uint64_t offset, size_t size)
+{
+  if (offset > ldrSize || size > ldrSize - offset)
+    return false;
+  memcpy(out, ldrData + offset, size);
+  return true;
+}
+
+/* Maps the bytes of the page at `page' which are not part of any area yet,
+ * so that the first and last pages of a segment are accessible as a whole,
+ * like with the host MMU, whose protection is page-granular */
+static bool ldrFillPage(t_memAddress page)
+{
+  uint64_t addr = page, end = (uint64_t)page + MEM_PAGE_SIZE;
+  while (addr < end) {
+    int mapped;
+    memDebugRead8((t_memAddress)addr, &mapped);
+    if (mapped) {
+      addr++;
+      continue;
+    }
+    uint64_t runEnd = addr + 1;
+    for (; runEnd < end; runEnd++) {
+      memDebugRead8((t_memAddress)runEnd, &mapped);
+      if (mapped)
+        break;
+    }
+    if (memMapArea((t_memAddress)addr, (t_memSize)(runEnd - addr), NULL) !=
+        MEM_NO_ERROR)
+      return false;
+    addr = runEnd;
   }
-  if (fread(buf, size, 1, fp) < 1) {
-    fclose(fp);
+  return true;
+}
+
+/* Extends the segment at `base' (not empty) to whole pages */
+static bool ldrFillSegment(t_memAddress base, t_memSize size)
+{
+  t_memAddress last = base + (size - 1);
+  return ldrFillPage(base & ~(t_memAddress)(MEM_PAGE_SIZE - 1)) &&
+      ldrFillPage(last & ~(t_memAddress)(MEM_PAGE_SIZE - 1));
+}
+
+
+t_ldrError ldrLoadBinary(t_memAddress baseAddr, t_memAddress entry)
+{
+  dbgPrintf("Loading raw binary file \"%s\" at address 0x%08" PRIx32 "\n",
+      ldrPath, baseAddr);
+
+  if (ldrFd < 0 || ldrSize > LDR_MAX_BINARY_SIZE)
     return LDR_FILE_ERROR;
-  }
+  t_memSize size = (t_memSize)ldrSize;
+  if (memMapFile(baseAddr, size, ldrFd, 0, size) != MEM_NO_ERROR)
+    return LDR_MEMORY_ERROR;
+  if (size > 0 && !ldrFillSegment(baseAddr, size))
+    return LDR_MEMORY_ERROR;
+  ldrImageEnd = baseAddr + size;
 
   cpuReset(entry);
-
-  fclose(fp);
   return LDR_NO_ERROR;
 }
 
@@ -107,6 +191,40 @@ typedef struct __attribute__((packed)) Elf32_Phdr {
   Elf32_Word p_align;
 } Elf32_Phdr;
 
+#define SHN_UNDEF 0          /* Undefined section */
+#define SHN_LORESERVE 0xff00 /* Start of reserved indices */
+
+#define SHT_PROGBITS 1 /* Program data */
+#define SHT_SYMTAB 2   /* Symbol table */
+
+typedef struct __attribute__((packed)) Elf32_Shdr {
+  Elf32_Word sh_name;
+  Elf32_Word sh_type;
+  Elf32_Word sh_flags;
+  Elf32_Addr sh_addr;
+  Elf32_Off sh_offset;
+  Elf32_Word sh_size;
+  Elf32_Word sh_link;
+  Elf32_Word sh_info;
+  Elf32_Word sh_addralign;
+  Elf32_Word sh_entsize;
+} Elf32_Shdr;
+
+#define STT_NOTYPE 0 /* Symbol type is unspecified */
+#define STT_OBJECT 1 /* Symbol is a data object */
+#define STT_FUNC 2   /* Symbol is a code object */
+
+#define ELF32_ST_TYPE(i) ((i) & 0xf)
+
+typedef struct __attribute__((packed)) Elf32_Sym {
+  Elf32_Word st_name;
+  Elf32_Addr st_value;
+  Elf32_Word st_size;
+  unsigned char st_info;
+  unsigned char st_other;
+  Elf32_Half st_shndx;
+} Elf32_Sym;
+
 static uint32_t fromLE32(uint32_t v)
 {
   uint32_t res;
@@ -135,43 +253,174 @@ static uint16_t fromLE16(uint16_t v)
   return res;
 }
 
-t_ldrError ldrLoadELF(const char *path)
+static bool ldrReadSectionHeader(
+    Elf32_Ehdr *header, Elf32_Word index, Elf32_Shdr *out)
+{
+  uint64_t shoff = fromLE32(header->e_shoff);
+  uint64_t shentsize = fromLE16(header->e_shentsize);
+  if (index >= fromLE16(header->e_shnum))
+    return false;
+  return ldrRead(out, shoff + index * shentsize, sizeof(Elf32_Shdr));
+}
+
+/* Returns the contents of a string table, terminated by an additional NUL
+ * character, or NULL on error. */
+static char *ldrReadStrings(Elf32_Shdr *strtab, Elf32_Word *outSize)
+{
+  Elf32_Word strSize = fromLE32(strtab->sh_size);
+  char *strings = malloc((size_t)strSize + 1);
+  if (!strings)
+    return NULL;
+  if (!ldrRead(strings, fromLE32(strtab->sh_offset), strSize)) {
+    free(strings);
+    return NULL;
+  }
+  strings[strSize] = '\0';
+  *outSize = strSize;
+  return strings;
+}
+
+/* Symbols are only used for printing reports, so a missing or malformed
+ * symbol table does not prevent loading the executable. */
+static void ldrLoadSymbols(Elf32_Ehdr *header)
 {
-  t_ldrError res = LDR_NO_ERROR;
+  Elf32_Half shnum = fromLE16(header->e_shnum);
+  if (fromLE16(header->e_shentsize) < sizeof(Elf32_Shdr))
+    return;
+
+  for (Elf32_Word shi = 0; shi < shnum; shi++) {
+    Elf32_Shdr symtab, strtab;
+    if (!ldrReadSectionHeader(header, shi, &symtab))
+      return;
+    if (fromLE32(symtab.sh_type) != SHT_SYMTAB)
+      continue;
+    if (!ldrReadSectionHeader(header, fromLE32(symtab.sh_link), &strtab))
+      continue;
 
-  dbgPrintf("Loading ELF file \"%s\"\n", path);
+    Elf32_Word strSize;
+    char *strings = ldrReadStrings(&strtab, &strSize);
+    if (!strings)
+      continue;
 
-  FILE *fp = fopen(path, "rb");
-  if (fp == NULL)
-    return LDR_FILE_ERROR;
+    Elf32_Word entSize = fromLE32(symtab.sh_entsize);
+    if (entSize < sizeof(Elf32_Sym)) {
+      free(strings);
+      continue;
+    }
+    Elf32_Word numSyms = fromLE32(symtab.sh_size) / entSize;
+    for (Elf32_Word i = 1; i < numSyms; i++) {
+      Elf32_Sym sym;
+      uint64_t offset = fromLE32(symtab.sh_offset) + (uint64_t)i * entSize;
+      if (!ldrRead(&sym, offset, sizeof(Elf32_Sym)))
+        break;
+      int type = ELF32_ST_TYPE(sym.st_info);
+      Elf32_Half shndx = fromLE16(sym.st_shndx);
+      Elf32_Word name = fromLE32(sym.st_name);
+      if (type != STT_NOTYPE && type != STT_FUNC && type != STT_OBJECT)
+        continue;
+      if (shndx == SHN_UNDEF || shndx >= SHN_LORESERVE || name == 0 ||
+          name >= strSize)
+        continue;
+      symAdd(strings + name, fromLE32(sym.st_value));
+    }
+    free(strings);
+  }
+}
+
+/* Reads the .srclines section written by asrv32im: the number of file
+ * slots, the offsets of the file names in the linked string table, and
+ * (address, file << 24 | line) pairs in increasing address order. Like the
+ * symbols, the line table is optional. */
+static void ldrLoadLines(Elf32_Ehdr *header)
+{
+  Elf32_Half shnum = fromLE16(header->e_shnum);
+  Elf32_Shdr shstrtab, lines, strtab;
+  if (fromLE16(header->e_shentsize) < sizeof(Elf32_Shdr))
+    return;
+  if (!ldrReadSectionHeader(header, fromLE16(header->e_shstrndx), &shstrtab))
+    return;
+  Elf32_Word secNamesSize;
+  char *secNames = ldrReadStrings(&shstrtab, &secNamesSize);
+  if (!secNames)
+    return;
+  Elf32_Word shi;
+  for (shi = 0; shi < shnum; shi++) {
+    if (!ldrReadSectionHeader(header, shi, &lines)) {
+      free(secNames);
+      return;
+    }
+    Elf32_Word name = fromLE32(lines.sh_name);
+    if (fromLE32(lines.sh_type) == SHT_PROGBITS && name < secNamesSize &&
+        strcmp(secNames + name, ".srclines") == 0)
+      break;
+  }
+  free(secNames);
+  if (shi >= shnum)
+    return;
+  if (!ldrReadSectionHeader(header, fromLE32(lines.sh_link), &strtab))
+    return;
+
+  Elf32_Word strSize;
+  char *strings = ldrReadStrings(&strtab, &strSize);
+  if (!strings)
+    return;
+  uint64_t offset = fromLE32(lines.sh_offset);
+  uint64_t end = offset + fromLE32(lines.sh_size);
+  Elf32_Word numFiles, word[2];
+  if (!ldrRead(&numFiles, offset, sizeof(Elf32_Word)))
+    goto exit;
+  offset += sizeof(Elf32_Word);
+  numFiles = fromLE32(numFiles);
+  for (Elf32_Word i = 0; i < numFiles && i < LIN_MAX_FILES; i++) {
+    if (!ldrRead(word, offset + i * sizeof(Elf32_Word), sizeof(Elf32_Word)))
+      goto exit;
+    Elf32_Word name = fromLE32(word[0]);
+    if (i > 0 && name != 0 && name < strSize)
+      linAddFile((int)i, strings + name);
+  }
+  offset += (uint64_t)numFiles * sizeof(Elf32_Word);
+  for (; offset + sizeof(word) <= end; offset += sizeof(word)) {
+    if (!ldrRead(word, offset, sizeof(word)))
+      break;
+    Elf32_Word fileLine = fromLE32(word[1]);
+    if (!linAddRange(fromLE32(word[0]), (int)(fileLine >> 24),
+            (int)(fileLine & 0xFFFFFF)))
+      break;
+  }
+exit:
+  free(strings);
+}
+
+t_ldrError ldrLoadELF(void)
+{
+  dbgPrintf("Loading ELF file \"%s\"\n", ldrPath);
 
   Elf32_Ehdr header;
-  if (fread(&header, sizeof(Elf32_Ehdr), 1, fp) < 1)
-    goto read_error;
+  if (!ldrRead(&header, 0, sizeof(Elf32_Ehdr)))
+    return LDR_FILE_ERROR;
   if (header.e_ident[EI_MAG0] != 0x7f || header.e_ident[EI_MAG1] != 'E' ||
       header.e_ident[EI_MAG2] != 'L' || header.e_ident[EI_MAG3] != 'F' ||
       header.e_ident[EI_CLASS] != ELFCLASS32 ||
       header.e_ident[EI_DATA] != ELFDATA2LSB || header.e_ident[EI_VERSION] != 1)
-    goto invalid_file;
+    return LDR_INVALID_FORMAT;
   if (fromLE16(header.e_type) != ET_EXEC || fromLE32(header.e_version) != 1)
-    goto invalid_file;
+    return LDR_INVALID_FORMAT;
   if (fromLE16(header.e_machine) != EM_RISCV)
-    goto invalid_arch;
+    return LDR_INVALID_ARCH;
 
-  long phnum = fromLE16(header.e_phnum);
-  long phoff = fromLE32(header.e_phoff);
-  long phentsize = fromLE16(header.e_phentsize);
-  for (long phi = 0; phi < phnum; phi++) {
+  uint64_t phnum = fromLE16(header.e_phnum);
+  uint64_t phoff = fromLE32(header.e_phoff);
+  uint64_t phentsize = fromLE16(header.e_phentsize);
+  for (uint64_t phi = 0; phi < phnum; phi++) {
     Elf32_Phdr segment;
-    fseek(fp, (long)(phoff + phi * phentsize), SEEK_SET);
-    if (fread(&segment, sizeof(Elf32_Phdr), 1, fp) < 1)
-      goto read_error;
+    if (!ldrRead(&segment, phoff + phi * phentsize, sizeof(Elf32_Phdr)))
+      return LDR_FILE_ERROR;
 
     Elf32_Word ptype = fromLE32(segment.p_type);
     if (ptype == PT_NULL || ptype == PT_NOTE)
       continue;
     if (ptype != PT_LOAD)
-      goto invalid_file;
+      return LDR_INVALID_FORMAT;
 
     Elf32_Off poffset = fromLE32(segment.p_offset);
     Elf32_Word pfilesz = fromLE32(segment.p_filesz);
@@ -181,61 +430,52 @@ t_ldrError ldrLoadELF(const char *path)
               ") to 0x%08" PRIx32 " (size=0x%08" PRIx32 ")\n",
         poffset, pfilesz, pvaddr, pmemsz);
     if (pmemsz > 0) {
-      uint8_t *buf;
-      if (memMapArea(pvaddr, pmemsz, &buf) != MEM_NO_ERROR)
-        goto mem_error;
-      if (pfilesz > 0) {
-        fseek(fp, (long)poffset, SEEK_SET);
-        size_t readsz = MIN(pmemsz, pfilesz);
-        if (fread(buf, readsz, 1, fp) < 1)
-          goto read_error;
-      }
+      // The contents are mapped straight from the file, and only read when
+      // the program touches them
+      Elf32_Word readsz = MIN(pmemsz, pfilesz);
+      if (poffset > ldrSize || readsz > ldrSize - poffset)
+        return LDR_FILE_ERROR;
+      if (memMapFile(pvaddr, pmemsz, ldrFd, (off_t)poffset, readsz) !=
+          MEM_NO_ERROR)
+        return LDR_MEMORY_ERROR;
+      if (pvaddr + pmemsz > ldrImageEnd)
+        ldrImageEnd = pvaddr + pmemsz;
     }
   }
+  // Segments are extended to whole pages once they are all mapped, so that
+  // the padding of a segment never takes the place of the next one
+  for (uint64_t phi = 0; phi < phnum; phi++) {
+    Elf32_Phdr segment;
+    ldrRead(&segment, phoff + phi * phentsize, sizeof(Elf32_Phdr));
+    Elf32_Word pmemsz = fromLE32(segment.p_memsz);
+    if (fromLE32(segment.p_type) == PT_LOAD && pmemsz > 0 &&
+        !ldrFillSegment(fromLE32(segment.p_vaddr), pmemsz))
+      return LDR_MEMORY_ERROR;
+  }
+
+  ldrLoadSymbols(&header);
+  ldrLoadLines(&header);
 
   Elf32_Addr entry = fromLE32(header.e_entry);
   dbgPrintf("Setting the entry point to 0x%" PRIx32 "\n", entry);
   cpuReset(entry);
-
-  goto cleanup;
-mem_error:
-  res = LDR_MEMORY_ERROR;
-  goto cleanup;
-read_error:
-  res = LDR_FILE_ERROR;
-  goto cleanup;
-invalid_file:
-  res = LDR_INVALID_FORMAT;
-  goto cleanup;
-invalid_arch:
-  res = LDR_INVALID_ARCH;
-cleanup:
-  fclose(fp);
-  return res;
+  return LDR_NO_ERROR;
 }
 
 
-t_ldrFileType ldrDetectExecType(const char *path)
+t_ldrFileType ldrDetectExecType(void)
 {
-  FILE *fp = fopen(path, "rb");
-  if (fp == NULL)
+  uint8_t buf[4];
+  if (!ldrRead(buf, 0, 4))
     return LDR_FORMAT_DETECT_ERROR;
-
-  char buf[4];
-  if (fread(buf, 4, 1, fp) < 1)
-    goto file_error;
-
-  t_ldrFileType res;
   if (buf[EI_MAG0] == 0x7f && buf[EI_MAG1] == 'E' && buf[EI_MAG2] == 'L' &&
       buf[EI_MAG3] == 'F')
-    res = LDR_FORMAT_ELF;
-  else
-    res = LDR_FORMAT_BINARY;
-
-  goto cleanup;
-file_error:
-  res = LDR_FORMAT_DETECT_ERROR;
-cleanup:
-  fclose(fp);
-  return res;
+    return LDR_FORMAT_ELF;
+  return LDR_FORMAT_BINARY;
+}
+
+
+t_memAddress ldrGetImageEnd(void)
+{
+  return ldrImageEnd;
 }
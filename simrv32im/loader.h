@@ -20,10 +20,16 @@ enum {
 };
 
 
-t_ldrError ldrLoadBinary(
-    const char *path, t_memAddress baseAddr, t_memAddress entry);
-t_ldrError ldrLoadELF(const char *path);
+/* Opens and maps the executable, which the other functions then work on.
+ * The segments of the program remain mapped after ldrClose. */
+t_ldrError ldrOpen(const char *path);
+void ldrClose(void);
 
-t_ldrFileType ldrDetectExecType(const char *path);
+t_ldrError ldrLoadBinary(t_memAddress baseAddr, t_memAddress entry);
+t_ldrError ldrLoadELF(void);
+
+t_ldrFileType ldrDetectExecType(void);
+
+t_memAddress ldrGetImageEnd(void);
 
 #endif
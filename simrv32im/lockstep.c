@@ -0,0 +1,983 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <time.h>
+#include "lockstep.h"
+#include "isa.h"
+#include "supervisor.h"
+
+#define LCK_PAGE_SIZE 4096
+#define LCK_TABLE_SIZE 1024
+#define LCK_DIR_SIZE 1024
+// PC of the lanes which stopped, which is never the address of an instruction
+#define LCK_PC_DONE 0xFFFFFFFF
+
+// Vectors only need the alignment of their elements, so that they can be
+// allocated with calloc
+typedef uint32_t t_lckVec
+    __attribute__((vector_size(LCK_VEC_LANES * 4), aligned(4)));
+typedef int32_t t_lckSVec
+    __attribute__((vector_size(LCK_VEC_LANES * 4), aligned(4)));
+
+#define LCK_LANE(vecs, l) ((vecs)[(l) / LCK_VEC_LANES][(l) % LCK_VEC_LANES])
+#define LCK_BLEND(m, new, old) (((new) & (m)) | ((old) & ~(m)))
+
+typedef struct lckLane {
+  // Private pages, by page number
+  uint8_t **pages[LCK_DIR_SIZE];
+  t_memAddress heapBreak;
+  t_memAddress stackBottom;
+  // LR.W reservation
+  bool reserved;
+  t_memAddress reservedAddr;
+  uint32_t reservedValue;
+  t_lckLaneStatus status;
+  int32_t exitCode;
+  t_memAddress faultAddr;
+  t_memAddress faultPC;
+  const char *input;
+  size_t inputLen;
+  size_t inputPos;
+  char *output;
+  size_t outputLen;
+  size_t outputSize;
+} t_lckLane;
+
+typedef int t_lckAluOp;
+enum {
+  LCK_ALU_ADD,
+  LCK_ALU_SUB,
+  LCK_ALU_SLL,
+  LCK_ALU_SLT,
+  LCK_ALU_SLTU,
+  LCK_ALU_XOR,
+  LCK_ALU_SRL,
+  LCK_ALU_SRA,
+  LCK_ALU_OR,
+  LCK_ALU_AND,
+  LCK_ALU_MUL,
+  LCK_ALU_MULH,
+  LCK_ALU_MULHSU,
+  LCK_ALU_MULHU,
+  LCK_ALU_DIV,
+  LCK_ALU_DIVU,
+  LCK_ALU_REM,
+  LCK_ALU_REMU
+};
+
+char *lckInputs = NULL;
+t_lckLane *lckLanes = NULL;
+uint32_t lckNumLanes = 0;
+uint32_t lckNumVecs = 0;
+uint32_t lckNumRunning = 0;
+t_memAddress lckHeapStart;
+
+t_lckVec *lckRegs[32];
+// Destination of the writes to x0
+t_lckVec *lckSink;
+t_lckVec *lckPC;
+// All ones in the lanes which execute the current step
+t_lckVec *lckMask;
+t_memAddress lckCurPC;
+uint32_t lckNumActive;
+// The PC of all the active lanes after the current step, unless they
+// diverged and must be scheduled again
+t_memAddress lckNextPC;
+bool lckDiverged = true;
+
+uint64_t lckSteps = 0;
+uint64_t lckInstRet = 0;
+uint64_t lckTimeBase;
+uint8_t lckZeroPage[LCK_PAGE_SIZE];
+
+
+static uint64_t lckHostTimeMicros(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+bool lckStart(const char *inputs, t_memAddress entry, t_memAddress imageEnd)
+{
+  FILE *fp = fopen(inputs, "rb");
+  if (!fp)
+    return false;
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  lckInputs = size >= 0 ? malloc((size_t)size + 1) : NULL;
+  if (!lckInputs || fread(lckInputs, 1, (size_t)size, fp) != (size_t)size) {
+    fclose(fp);
+    return false;
+  }
+  fclose(fp);
+
+  for (long i = 0; i < size; i++) {
+    if (lckInputs[i] == '\n' || i == size - 1)
+      lckNumLanes++;
+  }
+  if (lckNumLanes == 0 || lckNumLanes > LCK_MAX_LANES)
+    return false;
+  lckNumVecs = (lckNumLanes + LCK_VEC_LANES - 1) / LCK_VEC_LANES;
+  lckLanes = calloc(lckNumLanes, sizeof(t_lckLane));
+  for (int r = 0; r < 32; r++)
+    lckRegs[r] = calloc(lckNumVecs, sizeof(t_lckVec));
+  lckSink = calloc(lckNumVecs, sizeof(t_lckVec));
+  lckPC = calloc(lckNumVecs, sizeof(t_lckVec));
+  lckMask = calloc(lckNumVecs, sizeof(t_lckVec));
+  if (!lckLanes || !lckSink || !lckPC || !lckMask)
+    return false;
+  for (int r = 0; r < 32; r++) {
+    if (!lckRegs[r])
+      return false;
+  }
+
+  // Each lane reads its line, including the newline
+  lckHeapStart = (imageEnd + SV_HEAP_PAGE_SIZE - 1) &
+      ~(t_memAddress)(SV_HEAP_PAGE_SIZE - 1);
+  const char *line = lckInputs;
+  for (uint32_t l = 0; l < lckNumVecs * LCK_VEC_LANES; l++) {
+    if (l >= lckNumLanes) {
+      LCK_LANE(lckPC, l) = LCK_PC_DONE;
+      continue;
+    }
+    t_lckLane *lane = &lckLanes[l];
+    const char *end = memchr(line, '\n', (size_t)(lckInputs + size - line));
+    end = end ? end + 1 : lckInputs + size;
+    lane->input = line;
+    lane->inputLen = (size_t)(end - line);
+    line = end;
+    lane->heapBreak = lckHeapStart;
+    lane->stackBottom = SV_STACK_TOP - svGetStackSize();
+    LCK_LANE(lckPC, l) = entry;
+    LCK_LANE(lckRegs[CPU_REG_SP], l) = SV_STACK_TOP - 4;
+  }
+  lckNumRunning = lckNumLanes;
+  lckTimeBase = lckHostTimeMicros();
+  return true;
+}
+
+
+static void lckStopLane(uint32_t l, t_lckLaneStatus status)
+{
+  t_lckLane *lane = &lckLanes[l];
+  lane->status = status;
+  lane->faultPC = lckCurPC;
+  LCK_LANE(lckPC, l) = LCK_PC_DONE;
+  lckNumRunning--;
+  // The instruction was counted when the step started
+  lckInstRet--;
+  lckDiverged = true;
+}
+
+static void lckStopActiveLanes(t_lckLaneStatus status, t_memAddress addr)
+{
+  for (uint32_t l = 0; l < lckNumLanes; l++) {
+    if (LCK_LANE(lckMask, l)) {
+      lckLanes[l].faultAddr = addr;
+      lckStopLane(l, status);
+    }
+  }
+}
+
+
+/* Same rules as in svHandleMemoryFault: the heap is mapped in blocks of
+ * SV_HEAP_PAGE_SIZE bytes, and the stack grows one page at a time past the
+ * reserved part. */
+static bool lckIsStackOrHeap(t_lckLane *lane, t_memAddress addr)
+{
+  t_memAddress heapEnd = (lane->heapBreak + SV_HEAP_PAGE_SIZE - 1) &
+      ~(t_memAddress)(SV_HEAP_PAGE_SIZE - 1);
+  if (addr >= lckHeapStart && addr < heapEnd)
+    return true;
+  if (addr >= lane->stackBottom && addr < SV_STACK_TOP)
+    return true;
+  if (addr < lane->stackBottom &&
+      addr >= lane->stackBottom - SV_STACK_PAGE_SIZE &&
+      addr >= lane->heapBreak) {
+    lane->stackBottom -= SV_STACK_PAGE_SIZE;
+    return true;
+  }
+  return false;
+}
+
+static uint8_t *lckNewPage(t_lckLane *lane, t_memAddress page)
+{
+  uint8_t ***table = &lane->pages[page / LCK_PAGE_SIZE / LCK_TABLE_SIZE];
+  if (!*table) {
+    *table = calloc(LCK_TABLE_SIZE, sizeof(uint8_t *));
+    if (!*table)
+      return NULL;
+  }
+  uint8_t *buf = calloc(1, LCK_PAGE_SIZE);
+  if (!buf)
+    return NULL;
+  // Only the pages below the heap can be part of the shared image
+  for (t_memSize offs = 0; page < lckHeapStart && offs < LCK_PAGE_SIZE;) {
+    uint8_t *src;
+    t_memSize avail;
+    if (memGetHostBuffer(page + offs, LCK_PAGE_SIZE - offs, &src, &avail) ==
+        MEM_NO_ERROR) {
+      memcpy(buf + offs, src, avail);
+      offs += avail;
+    } else
+      offs++;
+  }
+  (*table)[page / LCK_PAGE_SIZE % LCK_TABLE_SIZE] = buf;
+  return buf;
+}
+
+/* Returns the host address of addr in the memory of the lane, and in
+ * `avail' the number of bytes which follow it in the same page. Writes give
+ * the lane a private copy of the page. Returns NULL if the address is not
+ * mapped. Like with the host MMU, bytes of a private page which are outside
+ * of the shared image are not checked. */
+static uint8_t *lckTranslate(
+    t_lckLane *lane, t_memAddress addr, bool write, t_memSize *avail)
+{
+  t_memSize offs = addr % LCK_PAGE_SIZE;
+  *avail = LCK_PAGE_SIZE - offs;
+  uint8_t **table = lane->pages[addr / LCK_PAGE_SIZE / LCK_TABLE_SIZE];
+  if (table && table[addr / LCK_PAGE_SIZE % LCK_TABLE_SIZE])
+    return table[addr / LCK_PAGE_SIZE % LCK_TABLE_SIZE] + offs;
+
+  uint8_t *buf;
+  if (memGetHostBuffer(addr, *avail, &buf, avail) == MEM_NO_ERROR) {
+    if (!write)
+      return buf;
+    *avail = LCK_PAGE_SIZE - offs;
+  } else if (!lckIsStackOrHeap(lane, addr)) {
+    return NULL;
+  } else if (!write) {
+    // Untouched stack and heap pages read as zero
+    return lckZeroPage + offs;
+  }
+  uint8_t *page = lckNewPage(lane, addr - offs);
+  return page ? page + offs : NULL;
+}
+
+static bool lckAccess(t_lckLane *lane, t_memAddress addr, t_memSize size,
+    bool write, uint32_t *value)
+{
+  t_memSize avail;
+  uint8_t *buf = lckTranslate(lane, addr, write, &avail);
+  // Guest memory is little-endian like the host
+  if (buf && avail >= size) {
+    if (write) {
+      memcpy(buf, value, size);
+    } else {
+      *value = 0;
+      memcpy(value, buf, size);
+    }
+    return true;
+  }
+
+  // The access straddles two pages or two areas of the image
+  uint32_t result = 0;
+  for (t_memSize i = 0; i < size; i++) {
+    buf = lckTranslate(lane, addr + i, write, &avail);
+    if (!buf) {
+      lane->faultAddr = addr;
+      return false;
+    }
+    if (write)
+      *buf = (uint8_t)(*value >> (8 * i));
+    else
+      result |= (uint32_t)*buf << (8 * i);
+  }
+  if (!write)
+    *value = result;
+  return true;
+}
+
+
+static void lckAppendOutput(t_lckLane *lane, const char *str, size_t len)
+{
+  if (lane->outputLen + len > lane->outputSize) {
+    size_t size = lane->outputSize ? lane->outputSize * 2 : 64;
+    while (size < lane->outputLen + len)
+      size *= 2;
+    char *output = realloc(lane->output, size);
+    if (!output)
+      return;
+    lane->output = output;
+    lane->outputSize = size;
+  }
+  memcpy(lane->output + lane->outputLen, str, len);
+  lane->outputLen += len;
+}
+
+static int32_t lckReadInt(t_lckLane *lane)
+{
+  const char *in = lane->input;
+  size_t i = lane->inputPos;
+  while (i < lane->inputLen && isspace((unsigned char)in[i]))
+    i++;
+  bool negative = false;
+  if (i < lane->inputLen && (in[i] == '-' || in[i] == '+'))
+    negative = in[i++] == '-';
+  uint32_t value = 0;
+  while (i < lane->inputLen && isdigit((unsigned char)in[i]))
+    value = value * 10 + (uint32_t)(in[i++] - '0');
+  lane->inputPos = i;
+  return (int32_t)(negative ? -value : value);
+}
+
+static int32_t lckSysSbrk(t_lckLane *lane, uint32_t increment, bool absolute)
+{
+  t_memAddress oldBreak = lane->heapBreak;
+  t_memAddress newBreak = absolute ? increment : oldBreak + increment;
+  t_memAddress limit = lane->stackBottom - SV_STACK_PAGE_SIZE;
+  if (absolute) {
+    if (newBreak >= lckHeapStart && newBreak <= limit)
+      lane->heapBreak = newBreak;
+    return (int32_t)lane->heapBreak;
+  }
+  if ((int32_t)increment >= 0) {
+    if (newBreak < oldBreak || newBreak > limit)
+      return -1;
+  } else {
+    if (newBreak > oldBreak || newBreak < lckHeapStart)
+      return -1;
+  }
+  lane->heapBreak = newBreak;
+  return (int32_t)oldBreak;
+}
+
+/* Reads and writes guest memory one byte at a time, which is enough for the
+ * system calls of the programs run in lockstep */
+static bool lckSysMemOp(t_lckLane *lane, uint32_t syscall, t_memAddress a,
+    t_memAddress b, uint32_t size, int32_t *result)
+{
+  // Copies backwards when the destination overlaps the tail of the source
+  bool backwards = syscall != SV_SYSCALL_MEMSET && a > b && a - b < size;
+  *result = 0;
+  for (uint32_t i = 0; i < size && *result == 0; i++) {
+    uint32_t offs = backwards ? size - 1 - i : i;
+    uint32_t x, y = b & 0xFF;
+    if (syscall != SV_SYSCALL_MEMSET &&
+        !lckAccess(lane, b + offs, 1, false, &y))
+      return false;
+    if (syscall == SV_SYSCALL_MEMCMP) {
+      if (!lckAccess(lane, a + offs, 1, false, &x))
+        return false;
+      *result = x < y ? -1 : (x > y ? 1 : 0);
+    } else if (!lckAccess(lane, a + offs, 1, true, &y))
+      return false;
+  }
+  return true;
+}
+
+/* Same system calls as the supervisor, except for files and harts */
+static void lckSyscall(uint32_t l)
+{
+  t_lckLane *lane = &lckLanes[l];
+  uint32_t id = LCK_LANE(lckRegs[CPU_REG_A7], l);
+  uint32_t a0 = LCK_LANE(lckRegs[CPU_REG_A0], l);
+  uint32_t a1 = LCK_LANE(lckRegs[CPU_REG_A1], l);
+  uint32_t a2 = LCK_LANE(lckRegs[CPU_REG_A2], l);
+  int32_t ret = (int32_t)a0;
+  char buf[16];
+  uint32_t value;
+
+  switch (id) {
+    case SV_SYSCALL_PRINT_INT:
+      snprintf(buf, sizeof(buf), "%" PRId32, (int32_t)a0);
+      lckAppendOutput(lane, buf, strlen(buf));
+      break;
+    case SV_SYSCALL_READ_INT:
+      lckAppendOutput(lane, "int value? >", 12);
+      ret = lckReadInt(lane);
+      break;
+    case SV_SYSCALL_PRINT_CHAR:
+      buf[0] = (char)a0;
+      lckAppendOutput(lane, buf, 1);
+      break;
+    case SV_SYSCALL_READ_CHAR:
+      ret = -1;
+      if (lane->inputPos < lane->inputLen)
+        ret = (unsigned char)lane->input[lane->inputPos++];
+      break;
+    case SV_SYSCALL_EXIT_0:
+    case SV_SYSCALL_EXIT:
+    case SV_SYSCALL_HART_EXIT:
+      lane->exitCode = id == SV_SYSCALL_EXIT_0 ? 0 : (int32_t)a0;
+      lckStopLane(l, LCK_LANE_EXITED);
+      // Exiting does not retire the instruction
+      return;
+    case SV_SYSCALL_SBRK:
+    case SV_SYSCALL_BRK:
+      ret = lckSysSbrk(lane, a0, id == SV_SYSCALL_BRK);
+      break;
+    case SV_SYSCALL_READ:
+    case SV_SYSCALL_WRITE:
+      ret = -1;
+      if ((id == SV_SYSCALL_READ && a0 != 0) ||
+          (id == SV_SYSCALL_WRITE && a0 != 1 && a0 != 2))
+        break;
+      for (ret = 0; (uint32_t)ret < a2; ret++) {
+        value = 0;
+        if (id == SV_SYSCALL_READ) {
+          if (lane->inputPos == lane->inputLen)
+            break;
+          value = (unsigned char)lane->input[lane->inputPos++];
+        }
+        if (!lckAccess(lane, a1 + (uint32_t)ret, 1, id == SV_SYSCALL_READ,
+                &value)) {
+          lckStopLane(l, LCK_LANE_MEMORY_FAULT);
+          return;
+        }
+        if (id == SV_SYSCALL_WRITE) {
+          buf[0] = (char)value;
+          lckAppendOutput(lane, buf, 1);
+        }
+      }
+      break;
+    case SV_SYSCALL_OPEN:
+    case SV_SYSCALL_CLOSE:
+    case SV_SYSCALL_LSEEK:
+    case SV_SYSCALL_HART_START:
+    case SV_SYSCALL_HART_JOIN:
+      ret = -1;
+      break;
+    case SV_SYSCALL_MEMCPY:
+    case SV_SYSCALL_MEMMOVE:
+    case SV_SYSCALL_MEMSET:
+    case SV_SYSCALL_MEMCMP:
+      if (!lckSysMemOp(lane, id, a0, a1, a2, &ret)) {
+        lckStopLane(l, LCK_LANE_MEMORY_FAULT);
+        return;
+      }
+      if (id != SV_SYSCALL_MEMCMP)
+        ret = (int32_t)a0;
+      break;
+    case SV_SYSCALL_SIM_CONTROL:
+      // There are no statistics to control in lockstep mode
+      ret = 0;
+      break;
+    default:
+      lckStopLane(l, LCK_LANE_INVALID_SYSCALL);
+      return;
+  }
+  LCK_LANE(lckRegs[CPU_REG_A0], l) = (uint32_t)ret;
+  LCK_LANE(lckPC, l) += 4;
+}
+
+
+static inline t_lckVec lckSplat(uint32_t value)
+{
+  t_lckVec res = {0};
+  return res + value;
+}
+
+static uint32_t lckAluScalar(t_lckAluOp op, uint32_t a, uint32_t b)
+{
+  switch (op) {
+    case LCK_ALU_MULH:
+      return (uint32_t)(((int64_t)(int32_t)a * (int64_t)(int32_t)b) >> 32);
+    case LCK_ALU_MULHSU:
+      return (uint32_t)(((int64_t)(int32_t)a * (int64_t)b) >> 32);
+    case LCK_ALU_MULHU:
+      return (uint32_t)(((uint64_t)a * (uint64_t)b) >> 32);
+    case LCK_ALU_DIV:
+      if (b == 0)
+        return 0xFFFFFFFF;
+      if (a == 0x80000000 && b == 0xFFFFFFFF)
+        return 0x80000000;
+      return (uint32_t)((int32_t)a / (int32_t)b);
+    case LCK_ALU_DIVU:
+      return b == 0 ? 0xFFFFFFFF : a / b;
+    case LCK_ALU_REM:
+      if (b == 0)
+        return a;
+      if (a == 0x80000000 && b == 0xFFFFFFFF)
+        return 0;
+      return (uint32_t)((int32_t)a % (int32_t)b);
+    default: /* LCK_ALU_REMU */
+      return b == 0 ? a : a % b;
+  }
+}
+
+static inline t_lckVec lckAlu(t_lckAluOp op, t_lckVec a, t_lckVec b)
+{
+  t_lckVec res;
+  switch (op) {
+    case LCK_ALU_ADD:
+      return a + b;
+    case LCK_ALU_SUB:
+      return a - b;
+    case LCK_ALU_SLL:
+      return a << (b & 0x1F);
+    case LCK_ALU_SLT:
+      return (t_lckVec)((t_lckSVec)a < (t_lckSVec)b) & 1;
+    case LCK_ALU_SLTU:
+      return (t_lckVec)(a < b) & 1;
+    case LCK_ALU_XOR:
+      return a ^ b;
+    case LCK_ALU_SRL:
+      return a >> (b & 0x1F);
+    case LCK_ALU_SRA:
+      return (t_lckVec)((t_lckSVec)a >> (t_lckSVec)(b & 0x1F));
+    case LCK_ALU_OR:
+      return a | b;
+    case LCK_ALU_AND:
+      return a & b;
+    case LCK_ALU_MUL:
+      return a * b;
+    default:
+      // There are no SIMD instructions for the rest of the M extension
+      for (int i = 0; i < LCK_VEC_LANES; i++)
+        res[i] = lckAluScalar(op, a[i], b[i]);
+      return res;
+  }
+}
+
+static const t_lckAluOp lckAluOps[ISA_NUM_IDS] = {
+    [ISA_ID_ADD] = LCK_ALU_ADD,
+    [ISA_ID_ADDI] = LCK_ALU_ADD,
+    [ISA_ID_SUB] = LCK_ALU_SUB,
+    [ISA_ID_SLL] = LCK_ALU_SLL,
+    [ISA_ID_SLLI] = LCK_ALU_SLL,
+    [ISA_ID_SLT] = LCK_ALU_SLT,
+    [ISA_ID_SLTI] = LCK_ALU_SLT,
+    [ISA_ID_SLTU] = LCK_ALU_SLTU,
+    [ISA_ID_SLTIU] = LCK_ALU_SLTU,
+    [ISA_ID_XOR] = LCK_ALU_XOR,
+    [ISA_ID_XORI] = LCK_ALU_XOR,
+    [ISA_ID_SRL] = LCK_ALU_SRL,
+    [ISA_ID_SRLI] = LCK_ALU_SRL,
+    [ISA_ID_SRA] = LCK_ALU_SRA,
+    [ISA_ID_SRAI] = LCK_ALU_SRA,
+    [ISA_ID_OR] = LCK_ALU_OR,
+    [ISA_ID_ORI] = LCK_ALU_OR,
+    [ISA_ID_AND] = LCK_ALU_AND,
+    [ISA_ID_ANDI] = LCK_ALU_AND,
+    [ISA_ID_MUL] = LCK_ALU_MUL,
+    [ISA_ID_MULH] = LCK_ALU_MULH,
+    [ISA_ID_MULHSU] = LCK_ALU_MULHSU,
+    [ISA_ID_MULHU] = LCK_ALU_MULHU,
+    [ISA_ID_DIV] = LCK_ALU_DIV,
+    [ISA_ID_DIVU] = LCK_ALU_DIVU,
+    [ISA_ID_REM] = LCK_ALU_REM,
+    [ISA_ID_REMU] = LCK_ALU_REMU,
+};
+
+static void lckExecuteALU(
+    t_isaInstID id, uint32_t instr, t_memAddress length)
+{
+  t_lckAluOp op = lckAluOps[id];
+  t_cpuRegID rd = ISA_INST_RD(instr);
+  t_lckVec *a = lckRegs[ISA_INST_RS1(instr)];
+  t_lckVec *b = lckRegs[ISA_INST_RS2(instr)];
+  t_lckVec *d = rd != CPU_REG_ZERO ? lckRegs[rd] : lckSink;
+  bool isImm = ISA_INST_OPCODE(instr) == ISA_INST_OPCODE_OPIMM;
+  t_lckVec imm = lckSplat(ISA_INST_I_IMM12_SEXT(instr));
+
+  for (uint32_t v = 0; v < lckNumVecs; v++) {
+    t_lckVec m = lckMask[v];
+    t_lckVec res = lckAlu(op, a[v], isImm ? imm : b[v]);
+    d[v] = LCK_BLEND(m, res, d[v]);
+    lckPC[v] = LCK_BLEND(m, lckPC[v] + length, lckPC[v]);
+  }
+}
+
+/* LUI, AUIPC and JAL, which give the same result in all the lanes */
+static void lckExecuteUniform(uint32_t instr, t_memAddress length)
+{
+  t_cpuRegID rd = ISA_INST_RD(instr);
+  t_lckVec *d = rd != CPU_REG_ZERO ? lckRegs[rd] : lckSink;
+  uint32_t result;
+  switch (ISA_INST_OPCODE(instr)) {
+    case ISA_INST_OPCODE_LUI:
+      result = ISA_INST_U_IMM20(instr) << 12;
+      break;
+    case ISA_INST_OPCODE_AUIPC:
+      result = lckCurPC + (ISA_INST_U_IMM20(instr) << 12);
+      break;
+    default: /* JAL */
+      result = lckCurPC + length;
+      lckNextPC = lckCurPC + ISA_INST_J_IMM21_SEXT(instr);
+      break;
+  }
+  t_lckVec res = lckSplat(result), next = lckSplat(lckNextPC);
+  for (uint32_t v = 0; v < lckNumVecs; v++) {
+    t_lckVec m = lckMask[v];
+    d[v] = LCK_BLEND(m, res, d[v]);
+    lckPC[v] = LCK_BLEND(m, next, lckPC[v]);
+  }
+}
+
+static void lckExecuteBRANCH(uint32_t instr, t_memAddress length)
+{
+  uint32_t funct3 = ISA_INST_FUNCT3(instr);
+  t_lckVec *a = lckRegs[ISA_INST_RS1(instr)];
+  t_lckVec *b = lckRegs[ISA_INST_RS2(instr)];
+  t_memAddress target = lckCurPC + ISA_INST_B_IMM13_SEXT(instr);
+  t_lckVec takenPC = lckSplat(target), nextPC = lckSplat(lckNextPC);
+  t_lckVec count = {0};
+
+  for (uint32_t v = 0; v < lckNumVecs; v++) {
+    t_lckVec m = lckMask[v], taken;
+    switch (funct3) {
+      case 0: /* BEQ */
+        taken = (t_lckVec)(a[v] == b[v]);
+        break;
+      case 1: /* BNE */
+        taken = (t_lckVec)(a[v] != b[v]);
+        break;
+      case 4: /* BLT */
+        taken = (t_lckVec)((t_lckSVec)a[v] < (t_lckSVec)b[v]);
+        break;
+      case 5: /* BGE */
+        taken = (t_lckVec)((t_lckSVec)a[v] >= (t_lckSVec)b[v]);
+        break;
+      case 6: /* BLTU */
+        taken = (t_lckVec)(a[v] < b[v]);
+        break;
+      default: /* BGEU */
+        taken = (t_lckVec)(a[v] >= b[v]);
+        break;
+    }
+    taken &= m;
+    count -= taken;
+    lckPC[v] = LCK_BLEND(m, LCK_BLEND(taken, takenPC, nextPC), lckPC[v]);
+  }
+
+  uint32_t numTaken = 0;
+  for (int i = 0; i < LCK_VEC_LANES; i++)
+    numTaken += count[i];
+  if (numTaken == lckNumActive)
+    lckNextPC = target;
+  else if (numTaken != 0)
+    lckDiverged = true;
+}
+
+static void lckExecuteJALR(uint32_t instr, t_memAddress length)
+{
+  t_cpuRegID rd = ISA_INST_RD(instr);
+  t_lckVec *a = lckRegs[ISA_INST_RS1(instr)];
+  t_lckVec *d = rd != CPU_REG_ZERO ? lckRegs[rd] : lckSink;
+  uint32_t offs = ISA_INST_I_IMM12_SEXT(instr);
+  t_lckVec link = lckSplat(lckCurPC + length);
+  for (uint32_t v = 0; v < lckNumVecs; v++) {
+    t_lckVec m = lckMask[v];
+    // clear bit zero as suggested by the spec
+    t_lckVec target = (a[v] + offs) & ~(uint32_t)1;
+    d[v] = LCK_BLEND(m, link, d[v]);
+    lckPC[v] = LCK_BLEND(m, target, lckPC[v]);
+  }
+  lckDiverged = true;
+}
+
+/* Loads, stores and atomics access the memory of each lane in turn */
+static void lckExecuteMemory(uint32_t instr, t_memAddress length)
+{
+  uint32_t op = ISA_INST_OPCODE(instr);
+  uint32_t funct3 = ISA_INST_FUNCT3(instr);
+  uint32_t funct5 = ISA_INST_AMO_FUNCT5(instr);
+  t_cpuRegID rd = ISA_INST_RD(instr);
+  t_cpuRegID rs1 = ISA_INST_RS1(instr);
+  t_cpuRegID rs2 = ISA_INST_RS2(instr);
+  t_lckVec *d = rd != CPU_REG_ZERO ? lckRegs[rd] : lckSink;
+  uint32_t offs = 0;
+  t_memSize size = 4;
+
+  if (op == ISA_INST_OPCODE_LOAD) {
+    offs = ISA_INST_I_IMM12_SEXT(instr);
+    size = 1U << (funct3 & 3);
+  } else if (op == ISA_INST_OPCODE_STORE) {
+    offs = ISA_INST_S_IMM12_SEXT(instr);
+    size = 1U << funct3;
+  }
+
+  for (uint32_t l = 0; l < lckNumLanes; l++) {
+    if (!LCK_LANE(lckMask, l))
+      continue;
+    t_lckLane *lane = &lckLanes[l];
+    t_memAddress addr = LCK_LANE(lckRegs[rs1], l) + offs;
+    uint32_t value = LCK_LANE(lckRegs[rs2], l), old = 0;
+
+    if (op == ISA_INST_OPCODE_STORE) {
+      if (!lckAccess(lane, addr, size, true, &value)) {
+        lckStopLane(l, LCK_LANE_MEMORY_FAULT);
+        continue;
+      }
+    } else if (op == ISA_INST_OPCODE_LOAD) {
+      if (!lckAccess(lane, addr, size, false, &old)) {
+        lckStopLane(l, LCK_LANE_MEMORY_FAULT);
+        continue;
+      }
+      if (funct3 == 0)
+        old = (uint32_t)(int32_t)(int8_t)old;
+      else if (funct3 == 1)
+        old = (uint32_t)(int32_t)(int16_t)old;
+    } else {
+      // Atomics require natural alignment, like the host atomics
+      if ((addr & 3) != 0 || !lckAccess(lane, addr, 4, false, &old)) {
+        lane->faultAddr = addr;
+        lckStopLane(l, LCK_LANE_MEMORY_FAULT);
+        continue;
+      }
+      bool write = true;
+      switch (funct5) {
+        case 0x02: /* LR.W */
+          lane->reserved = true;
+          lane->reservedAddr = addr;
+          lane->reservedValue = old;
+          write = false;
+          break;
+        case 0x03: /* SC.W */
+          write = lane->reserved && lane->reservedAddr == addr &&
+              lane->reservedValue == old;
+          lane->reserved = false;
+          old = write ? 0 : 1;
+          break;
+        case 0x01: /* AMOSWAP.W */
+          break;
+        case 0x00: /* AMOADD.W */
+          value += old;
+          break;
+        case 0x04: /* AMOXOR.W */
+          value ^= old;
+          break;
+        case 0x08: /* AMOOR.W */
+          value |= old;
+          break;
+        case 0x0C: /* AMOAND.W */
+          value &= old;
+          break;
+        case 0x10: /* AMOMIN.W */
+          value = (int32_t)old < (int32_t)value ? old : value;
+          break;
+        case 0x14: /* AMOMAX.W */
+          value = (int32_t)old > (int32_t)value ? old : value;
+          break;
+        case 0x18: /* AMOMINU.W */
+          value = old < value ? old : value;
+          break;
+        default: /* AMOMAXU.W */
+          value = old > value ? old : value;
+          break;
+      }
+      // The page is already mapped, so the write cannot fault
+      if (write)
+        lckAccess(lane, addr, 4, true, &value);
+    }
+    if (op != ISA_INST_OPCODE_STORE)
+      LCK_LANE(d, l) = old;
+    LCK_LANE(lckPC, l) += length;
+  }
+}
+
+static void lckExecuteSYSTEM(uint32_t instr, t_memAddress length)
+{
+  uint32_t funct3 = ISA_INST_FUNCT3(instr);
+  t_cpuRegID rd = ISA_INST_RD(instr);
+  t_lckVec *d = rd != CPU_REG_ZERO ? lckRegs[rd] : lckSink;
+
+  if (funct3 == 0 && ISA_INST_I_IMM12(instr) == 0) {
+    for (uint32_t l = 0; l < lckNumLanes; l++) {
+      if (LCK_LANE(lckMask, l))
+        lckSyscall(l);
+    }
+    return;
+  }
+  // There is no debugger, so breakpoints are ignored
+  bool valid = funct3 == 0 && ISA_INST_I_IMM12(instr) == 1;
+  // All implemented CSRs are read-only
+  if (funct3 == 2 || funct3 == 3 || funct3 == 6 || funct3 == 7)
+    valid = ISA_INST_RS1(instr) == 0;
+  uint32_t csr = ISA_INST_CSR(instr);
+  uint64_t time = lckHostTimeMicros() - lckTimeBase;
+  for (uint32_t l = 0; valid && funct3 != 0 && l < lckNumLanes; l++) {
+    if (!LCK_LANE(lckMask, l))
+      continue;
+    // A cycle is a step of the group, whether the lane was active or not
+    switch (csr) {
+      case ISA_CSR_CYCLE:
+      case ISA_CSR_INSTRET:
+        LCK_LANE(d, l) = (uint32_t)lckSteps;
+        break;
+      case ISA_CSR_CYCLEH:
+      case ISA_CSR_INSTRETH:
+        LCK_LANE(d, l) = (uint32_t)(lckSteps >> 32);
+        break;
+      case ISA_CSR_TIME:
+        LCK_LANE(d, l) = (uint32_t)time;
+        break;
+      case ISA_CSR_TIMEH:
+        LCK_LANE(d, l) = (uint32_t)(time >> 32);
+        break;
+      case ISA_CSR_MHARTID:
+        LCK_LANE(d, l) = l;
+        break;
+      default:
+        valid = false;
+        break;
+    }
+  }
+  if (!valid) {
+    lckStopActiveLanes(LCK_LANE_ILL_INST_FAULT, 0);
+    return;
+  }
+  for (uint32_t v = 0; v < lckNumVecs; v++)
+    lckPC[v] = LCK_BLEND(lckMask[v], lckPC[v] + length, lckPC[v]);
+}
+
+
+/* Selects the lanes with the lowest PC, so that the lanes which skipped
+ * some code wait for the others to reach it. Returns false when all the
+ * lanes stopped. */
+static bool lckSchedule(void)
+{
+  if (!lckDiverged && lckNumActive == lckNumRunning) {
+    lckCurPC = lckNextPC;
+    return true;
+  }
+  lckDiverged = false;
+
+  t_lckVec min = lckPC[0];
+  for (uint32_t v = 1; v < lckNumVecs; v++)
+    min = LCK_BLEND((t_lckVec)(lckPC[v] < min), lckPC[v], min);
+  t_memAddress pc = LCK_PC_DONE;
+  for (int i = 0; i < LCK_VEC_LANES; i++)
+    pc = min[i] < pc ? min[i] : pc;
+  if (pc == LCK_PC_DONE)
+    return false;
+
+  t_lckVec count = {0};
+  for (uint32_t v = 0; v < lckNumVecs; v++) {
+    t_lckVec m = (t_lckVec)(lckPC[v] == pc);
+    lckMask[v] = m;
+    count -= m;
+  }
+  lckNumActive = 0;
+  for (int i = 0; i < LCK_VEC_LANES; i++)
+    lckNumActive += count[i];
+  lckCurPC = pc;
+  return true;
+}
+
+static bool lckFetch(uint32_t *inst, t_memAddress *length)
+{
+  int mapped;
+  uint16_t parcel = memDebugRead16(lckCurPC, &mapped);
+  if (!mapped)
+    return false;
+  if (ISA_INST_IS_COMPRESSED(parcel)) {
+    *inst = isaExpandCompressed(parcel);
+    *length = 2;
+    return true;
+  }
+  *inst = parcel | ((uint32_t)memDebugRead16(lckCurPC + 2, &mapped) << 16);
+  *length = 4;
+  return mapped != 0;
+}
+
+void lckRun(void)
+{
+  while (lckSchedule()) {
+    uint32_t inst;
+    t_memAddress length;
+    lckSteps++;
+    lckInstRet += lckNumActive;
+    if (!lckFetch(&inst, &length)) {
+      lckStopActiveLanes(LCK_LANE_MEMORY_FAULT, lckCurPC);
+      continue;
+    }
+    lckNextPC = lckCurPC + length;
+
+    t_isaInstID id = isaDecode(inst);
+    if (id == ISA_ID_ILLEGAL) {
+      lckStopActiveLanes(LCK_LANE_ILL_INST_FAULT, 0);
+      continue;
+    }
+    switch (ISA_INST_OPCODE(inst)) {
+      case ISA_INST_OPCODE_OP:
+      case ISA_INST_OPCODE_OPIMM:
+        lckExecuteALU(id, inst, length);
+        break;
+      case ISA_INST_OPCODE_LUI:
+      case ISA_INST_OPCODE_AUIPC:
+      case ISA_INST_OPCODE_JAL:
+        lckExecuteUniform(inst, length);
+        break;
+      case ISA_INST_OPCODE_BRANCH:
+        lckExecuteBRANCH(inst, length);
+        break;
+      case ISA_INST_OPCODE_JALR:
+        lckExecuteJALR(inst, length);
+        break;
+      case ISA_INST_OPCODE_LOAD:
+      case ISA_INST_OPCODE_STORE:
+      case ISA_INST_OPCODE_AMO:
+        lckExecuteMemory(inst, length);
+        break;
+      case ISA_INST_OPCODE_SYSTEM:
+        lckExecuteSYSTEM(inst, length);
+        break;
+    }
+  }
+}
+
+
+uint64_t lckGetInstRetCount(void)
+{
+  return lckInstRet;
+}
+
+uint64_t lckGetStepCount(void)
+{
+  return lckSteps;
+}
+
+void lckPrintOutput(FILE *out, FILE *err)
+{
+  for (uint32_t l = 0; l < lckNumLanes; l++) {
+    t_lckLane *lane = &lckLanes[l];
+    const char *line = lane->output;
+    size_t left = lane->outputLen;
+    while (left > 0) {
+      const char *nl = memchr(line, '\n', left);
+      size_t len = nl ? (size_t)(nl - line) + 1 : left;
+      fprintf(out, "%" PRIu32 ": ", l);
+      fwrite(line, 1, len, out);
+      if (!nl)
+        fputc('\n', out);
+      line += len;
+      left -= len;
+    }
+    fflush(out);
+    if (lane->status == LCK_LANE_MEMORY_FAULT)
+      fprintf(err,
+          "Lane %" PRIu32 ": memory fault at address 0x%08" PRIx32
+          ", execution stopped.\n",
+          l, lane->faultAddr);
+    else if (lane->status == LCK_LANE_ILL_INST_FAULT)
+      fprintf(err, "Lane %" PRIu32 ": illegal instruction at address 0x%08"
+          PRIx32 "\n", l, lane->faultPC);
+    else if (lane->status == LCK_LANE_INVALID_SYSCALL)
+      fprintf(err, "Lane %" PRIu32 ": invalid system call at address 0x%08"
+          PRIx32 "\n", l, lane->faultPC);
+  }
+}
+
+t_lckLaneStatus lckGetStatus(void)
+{
+  for (uint32_t l = 0; l < lckNumLanes; l++) {
+    if (lckLanes[l].status != LCK_LANE_EXITED)
+      return lckLanes[l].status;
+  }
+  return LCK_LANE_EXITED;
+}
+
+int32_t lckGetExitCode(void)
+{
+  for (uint32_t l = 0; l < lckNumLanes; l++) {
+    if (lckLanes[l].status == LCK_LANE_EXITED && lckLanes[l].exitCode != 0)
+      return lckLanes[l].exitCode;
+  }
+  return 0;
+}
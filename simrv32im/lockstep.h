@@ -0,0 +1,50 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "memory.h"
+
+/* Lockstep execution of many copies of the same program.
+ *
+ * Each lane runs the program with its own line of input. The registers of
+ * all lanes are stored as structure-of-arrays, in host vectors of
+ * LCK_VEC_LANES lanes, so that each instruction executes on all lanes with
+ * host SIMD operations. At each step the lanes with the lowest PC execute
+ * the next instruction together, while the others are masked out. Lanes
+ * diverge at branches, indirect jumps and system calls, and reconverge when
+ * they reach the same PC again.
+ *
+ * The memory image loaded by the loader is shared by all lanes. A lane gets
+ * a private copy of a page when it first writes to it, or when it touches
+ * its stack and heap. Code is always fetched from the shared image. */
+
+#define LCK_MAX_LANES 65536
+// 128-bit vectors, available on all common hosts
+#define LCK_VEC_LANES 4
+
+typedef int t_lckLaneStatus;
+enum {
+  LCK_LANE_RUNNING = 0,
+  LCK_LANE_EXITED,
+  LCK_LANE_MEMORY_FAULT,
+  LCK_LANE_ILL_INST_FAULT,
+  LCK_LANE_INVALID_SYSCALL
+};
+
+/* Creates one lane for each line of the file */
+bool lckStart(const char *inputs, t_memAddress entry, t_memAddress imageEnd);
+void lckRun(void);
+uint64_t lckGetInstRetCount(void);
+/* Number of instructions executed by the group of lanes as a whole */
+uint64_t lckGetStepCount(void);
+/* Prints the output of every lane on `out', each line prefixed with the
+ * number of the lane, and the lanes which did not exit on `err'. */
+void lckPrintOutput(FILE *out, FILE *err);
+/* Status and exit code of the first lane which failed or exited with a
+ * non-zero code, if any */
+t_lckLaneStatus lckGetStatus(void);
+int32_t lckGetExitCode(void);
+
+#endif
@@ -1,6 +1,23 @@
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <signal.h>
+#endif
 #include "memory.h"
 
+// The whole 32-bit address space, plus a guard page for accesses which
+// straddle its end
+#define MEM_HOST_SPACE_SIZE ((size_t)1 << 32)
+#define MEM_HOST_GUARD_SIZE 65536
+// Areas at least this large get their own anonymous host mapping, whose
+// pages are only allocated by the host when they are first touched
+#define MEM_LAZY_MIN_SIZE 65536
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
 typedef struct memArea {
   struct memArea *next;
   t_memAddress baseAddress;
@@ -8,9 +25,21 @@ typedef struct memArea {
   uint8_t *buffer;
 } t_memArea;
 
+// Areas are only ever inserted, under memMapLock. Harts walk the list
+// without locking, so new areas are published with a release store.
 t_memArea *memAreas = NULL;
+uint64_t memMappedSize = 0;
+pthread_mutex_t memMapLock = PTHREAD_MUTEX_INITIALIZER;
+__thread t_memArea *memLastArea = NULL;
+
+__thread t_memAddress memLastFaultAddress = 0;
 
-t_memAddress memLastFaultAddress = 0;
+// Base of the guest address space with the host MMU backend, NULL otherwise
+uint8_t *memHostBase = NULL;
+#ifdef MEM_HOST_MMU_SUPPORTED
+size_t memHostPageSize;
+__thread sigjmp_buf *memFaultRecovery = NULL;
+#endif
 
 
 static t_memAddress memAreaEnd(t_memArea *area)
@@ -21,15 +50,22 @@ static t_memAddress memAreaEnd(t_memArea *area)
 
 static t_memArea *memFindArea(t_memAddress addr, t_memSize extent, int isDbg)
 {
-  t_memArea *curArea = memAreas;
+  // Most accesses hit the same area as the previous one
+  t_memArea *curArea = memLastArea;
+  if (curArea && curArea->baseAddress <= addr &&
+      (addr + extent) <= memAreaEnd(curArea) && addr < (addr + extent))
+    return curArea;
+
+  curArea = __atomic_load_n(&memAreas, __ATOMIC_ACQUIRE);
   while (curArea) {
     if (curArea->baseAddress <= addr && addr < memAreaEnd(curArea)) {
-      if ((addr + extent) <= memAreaEnd(curArea))
+      if ((addr + extent) <= memAreaEnd(curArea)) {
+        memLastArea = curArea;
         return curArea;
-      else
+      } else
         goto fail;
     }
-    curArea = curArea->next;
+    curArea = __atomic_load_n(&curArea->next, __ATOMIC_ACQUIRE);
   }
 
 fail:
@@ -39,14 +75,138 @@ fail:
 }
 
 
-t_memError memMapArea(t_memAddress base, t_memSize extent, uint8_t **outBuffer)
+#ifdef MEM_HOST_MMU_SUPPORTED
+
+static void memHandleFault(int sig, siginfo_t *info, void *context)
+{
+  uint8_t *addr = (uint8_t *)info->si_addr;
+  sigjmp_buf *recovery = memFaultRecovery;
+  if (recovery && addr >= memHostBase &&
+      addr < memHostBase + MEM_HOST_SPACE_SIZE + MEM_HOST_GUARD_SIZE) {
+    memLastFaultAddress = (t_memAddress)(addr - memHostBase);
+    siglongjmp(*recovery, 1);
+  }
+  // Not caused by the guest, crash as usual when the access is restarted
+  signal(sig, SIG_DFL);
+}
+
+t_memError memEnableHostMMU(void)
+{
+  if (memAreas || sizeof(void *) < 8)
+    return MEM_NOT_SUPPORTED;
+  long pageSize = sysconf(_SC_PAGESIZE);
+  if (pageSize <= 0 || pageSize > MEM_PAGE_SIZE)
+    return MEM_NOT_SUPPORTED;
+  memHostPageSize = (size_t)pageSize;
+
+  void *space = mmap(NULL, MEM_HOST_SPACE_SIZE + MEM_HOST_GUARD_SIZE,
+      PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (space == MAP_FAILED)
+    return MEM_OUT_OF_MEMORY;
+
+  // The handler returns to the hart loop without going through sigreturn,
+  // so SIGSEGV must not stay blocked afterwards
+  struct sigaction action;
+  memset(&action, 0, sizeof(struct sigaction));
+  action.sa_sigaction = memHandleFault;
+  action.sa_flags = SA_SIGINFO | SA_NODEFER;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGSEGV, &action, NULL) != 0 ||
+      sigaction(SIGBUS, &action, NULL) != 0) {
+    munmap(space, MEM_HOST_SPACE_SIZE + MEM_HOST_GUARD_SIZE);
+    return MEM_NOT_SUPPORTED;
+  }
+  memHostBase = space;
+  return MEM_NO_ERROR;
+}
+
+void memSetFaultRecovery(sigjmp_buf *recovery)
+{
+  memFaultRecovery = recovery;
+}
+
+static t_memError memHostProtect(t_memAddress base, t_memSize extent)
+{
+  uintptr_t first = (uintptr_t)(memHostBase + base) & ~(memHostPageSize - 1);
+  uintptr_t last = (uintptr_t)(memHostBase + base) + (size_t)extent;
+  if (mprotect((void *)first, last - first, PROT_READ | PROT_WRITE) != 0)
+    return MEM_OUT_OF_MEMORY;
+  return MEM_NO_ERROR;
+}
+
+#else
+
+t_memError memEnableHostMMU(void)
+{
+  return MEM_NOT_SUPPORTED;
+}
+
+static t_memError memHostProtect(t_memAddress base, t_memSize extent)
+{
+  return MEM_NOT_SUPPORTED;
+}
+
+#endif
+
+bool memHostMMUEnabled(void)
+{
+  return memHostBase != NULL;
+}
+
+
+/* Maps a private copy-on-write view of `fileSize' bytes of a file, followed
+ * by zeros up to `extent'. The host pages of the file are shared with the
+ * page cache until they are written. */
+static uint8_t *memMapFileBuffer(
+    t_memSize extent, int fd, off_t offset, t_memSize fileSize)
+{
+  size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+  size_t skew = (size_t)offset % pageSize;
+  uint8_t *map = mmap(NULL, skew + extent, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (map == MAP_FAILED)
+    return NULL;
+  if (fileSize > 0 && mmap(map, skew + fileSize, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_FIXED, fd, offset - (off_t)skew) ==
+          MAP_FAILED) {
+    munmap(map, skew + extent);
+    return NULL;
+  }
+  // The rest of the last page of the file holds whatever follows the area
+  // in the file
+  size_t fileEnd = skew + fileSize;
+  size_t pageEnd = (fileEnd + pageSize - 1) & ~(pageSize - 1);
+  if (extent > fileSize && pageEnd > fileEnd)
+    memset(map + fileEnd, 0, MIN(pageEnd - fileEnd, extent - fileSize));
+  return map + skew;
+}
+
+static bool memReadFile(uint8_t *buf, int fd, off_t offset, t_memSize size)
+{
+  while (size > 0) {
+    ssize_t n = pread(fd, buf, size, offset);
+    if (n <= 0)
+      return false;
+    buf += n;
+    offset += n;
+    size -= (t_memSize)n;
+  }
+  return true;
+}
+
+/* Adds an area filled with `fileSize' bytes of the file `fd' (if not -1) and
+ * with zeros after them. */
+static t_memError memAddArea(t_memAddress base, t_memSize extent, int fd,
+    off_t offset, t_memSize fileSize, uint8_t **outBuffer)
 {
   t_memArea *prevArea = NULL;
-  t_memArea *nextArea = memAreas;
+  t_memArea *nextArea;
 
   if (extent == 0)
     return MEM_NO_ERROR;
 
+  pthread_mutex_lock(&memMapLock);
+  nextArea = memAreas;
   while (nextArea) {
     if ((base + extent) <= nextArea->baseAddress)
       break;
@@ -54,30 +214,89 @@ t_memError memMapArea(t_memAddress base, t_memSize extent, uint8_t **outBuffer)
     nextArea = nextArea->next;
   }
   if (prevArea) {
-    if (!(base >= memAreaEnd(prevArea)))
+    if (!(base >= memAreaEnd(prevArea))) {
+      pthread_mutex_unlock(&memMapLock);
       return MEM_EXTENT_MAPPED;
+    }
   }
 
-  t_memArea *newArea = calloc(1, sizeof(t_memArea) + (size_t)extent);
-  if (!newArea)
+  // With the host MMU the contents are already reserved, and anonymous host
+  // pages read as zero until they are written. Otherwise small areas are
+  // allocated together with their descriptor, and large ones are reserved
+  // with mmap, so that the zero-filled parts which are never touched (the
+  // .bss tail of a segment, the stack) do not take any host memory. Areas
+  // backed by a file are mapped from it, except with the host MMU where
+  // their position is fixed, and they are read instead.
+  bool lazy = !memHostBase && (fd != -1 || extent >= MEM_LAZY_MIN_SIZE);
+  size_t bufSize = memHostBase || lazy ? 0 : (size_t)extent;
+  t_memArea *newArea = calloc(1, sizeof(t_memArea) + bufSize);
+  if (!newArea) {
+    pthread_mutex_unlock(&memMapLock);
     return MEM_OUT_OF_MEMORY;
+  }
+  if (memHostBase) {
+    if (memHostProtect(base, extent) != MEM_NO_ERROR) {
+      free(newArea);
+      pthread_mutex_unlock(&memMapLock);
+      return MEM_OUT_OF_MEMORY;
+    }
+    newArea->buffer = memHostBase + base;
+    if (fd != -1 && !memReadFile(newArea->buffer, fd, offset, fileSize)) {
+      free(newArea);
+      pthread_mutex_unlock(&memMapLock);
+      return MEM_MAPPING_ERROR;
+    }
+  } else if (lazy) {
+    if (fd != -1)
+      newArea->buffer = memMapFileBuffer(extent, fd, offset, fileSize);
+    else {
+      void *buf = mmap(NULL, (size_t)extent, PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      newArea->buffer = buf == MAP_FAILED ? NULL : buf;
+    }
+    if (!newArea->buffer) {
+      free(newArea);
+      pthread_mutex_unlock(&memMapLock);
+      return MEM_OUT_OF_MEMORY;
+    }
+  } else
+    newArea->buffer = (uint8_t *)((void *)newArea) + sizeof(t_memArea);
   newArea->baseAddress = base;
   newArea->extent = extent;
-  newArea->buffer = (uint8_t *)((void *)newArea) + sizeof(t_memArea);
   if (outBuffer)
     *outBuffer = newArea->buffer;
   newArea->next = nextArea;
   if (prevArea)
-    prevArea->next = newArea;
+    __atomic_store_n(&prevArea->next, newArea, __ATOMIC_RELEASE);
   else
-    memAreas = newArea;
+    __atomic_store_n(&memAreas, newArea, __ATOMIC_RELEASE);
+  __atomic_fetch_add(&memMappedSize, extent, __ATOMIC_RELAXED);
 
+  pthread_mutex_unlock(&memMapLock);
   return MEM_NO_ERROR;
 }
 
+t_memError memMapArea(t_memAddress base, t_memSize extent, uint8_t **outBuffer)
+{
+  return memAddArea(base, extent, -1, 0, 0, outBuffer);
+}
+
+t_memError memMapFile(t_memAddress base, t_memSize extent, int fd,
+    off_t offset, t_memSize fileSize)
+{
+  if (fileSize > extent)
+    fileSize = extent;
+  return memAddArea(base, extent, fd, offset, fileSize, NULL);
+}
+
 
 t_memError memRead8(t_memAddress addr, uint8_t *out)
 {
+  // Guest memory is little-endian like the host, faults do not return here
+  if (memHostBase) {
+    memcpy(out, memHostBase + addr, 1);
+    return MEM_NO_ERROR;
+  }
   t_memArea *area = memFindArea(addr, 1, 0);
   if (!area)
     return MEM_MAPPING_ERROR;
@@ -88,6 +307,10 @@ t_memError memRead8(t_memAddress addr, uint8_t *out)
 
 t_memError memRead16(t_memAddress addr, uint16_t *out)
 {
+  if (memHostBase) {
+    memcpy(out, memHostBase + addr, 2);
+    return MEM_NO_ERROR;
+  }
   t_memArea *area = memFindArea(addr, 2, 0);
   if (!area)
     return MEM_MAPPING_ERROR;
@@ -98,6 +321,10 @@ t_memError memRead16(t_memAddress addr, uint16_t *out)
 
 t_memError memRead32(t_memAddress addr, uint32_t *out)
 {
+  if (memHostBase) {
+    memcpy(out, memHostBase + addr, 4);
+    return MEM_NO_ERROR;
+  }
   t_memArea *area = memFindArea(addr, 4, 0);
   if (!area)
     return MEM_MAPPING_ERROR;
@@ -155,6 +382,10 @@ uint32_t memDebugRead32(t_memAddress addr, int *mapped)
 
 t_memError memWrite8(t_memAddress addr, uint8_t in)
 {
+  if (memHostBase) {
+    memcpy(memHostBase + addr, &in, 1);
+    return MEM_NO_ERROR;
+  }
   t_memArea *area = memFindArea(addr, 1, 0);
   if (!area)
     return MEM_MAPPING_ERROR;
@@ -165,6 +396,10 @@ t_memError memWrite8(t_memAddress addr, uint8_t in)
 
 t_memError memWrite16(t_memAddress addr, uint16_t in)
 {
+  if (memHostBase) {
+    memcpy(memHostBase + addr, &in, 2);
+    return MEM_NO_ERROR;
+  }
   t_memArea *area = memFindArea(addr, 2, 0);
   if (!area)
     return MEM_MAPPING_ERROR;
@@ -176,6 +411,10 @@ t_memError memWrite16(t_memAddress addr, uint16_t in)
 
 t_memError memWrite32(t_memAddress addr, uint32_t in)
 {
+  if (memHostBase) {
+    memcpy(memHostBase + addr, &in, 4);
+    return MEM_NO_ERROR;
+  }
   t_memArea *area = memFindArea(addr, 4, 0);
   if (!area)
     return MEM_MAPPING_ERROR;
@@ -188,7 +427,44 @@ t_memError memWrite32(t_memAddress addr, uint32_t in)
 }
 
 
+t_memError memGetHostBuffer(t_memAddress addr, t_memSize size,
+    uint8_t **outBuffer, t_memSize *outSize)
+{
+  t_memArea *area = memFindArea(addr, 1, 0);
+  if (!area)
+    return MEM_MAPPING_ERROR;
+  t_memSize avail = memAreaEnd(area) - addr;
+  if (avail > size)
+    avail = size;
+  *outBuffer = area->buffer + (size_t)(addr - area->baseAddress);
+  *outSize = avail;
+  return MEM_NO_ERROR;
+}
+
+
+t_memError memGetHostWord(t_memAddress addr, uint32_t **outPtr)
+{
+  t_memArea *area = memFindArea(addr, 4, 0);
+  if (!area)
+    return MEM_MAPPING_ERROR;
+  uint8_t *bufBasePtr = area->buffer + (size_t)(addr - area->baseAddress);
+  // Host atomics require natural alignment
+  if ((addr & 3) != 0 || ((uintptr_t)bufBasePtr & 3) != 0) {
+    memLastFaultAddress = addr;
+    return MEM_MAPPING_ERROR;
+  }
+  *outPtr = (uint32_t *)((void *)bufBasePtr);
+  return MEM_NO_ERROR;
+}
+
+
 t_memAddress memGetLastFaultAddress(void)
 {
   return memLastFaultAddress;
 }
+
+
+uint64_t memGetMappedSize(void)
+{
+  return __atomic_load_n(&memMappedSize, __ATOMIC_RELAXED);
+}
@@ -2,20 +2,52 @@
 #define MEMORY_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
 #include "isa.h"
 
+#ifdef __linux__
+#include <setjmp.h>
+#define MEM_HOST_MMU_SUPPORTED
+#endif
+
 typedef t_isaUXSize t_memAddress;
 typedef t_memAddress t_memSize;
 
+/* Granularity of the protection of memory, the same with both backends. The
+ * supervisor maps whole pages, and the loader extends the segments of the
+ * program to whole pages. */
+#define MEM_PAGE_SIZE 4096
+
 typedef int t_memError;
 enum {
   MEM_NO_ERROR = 0,
   MEM_OUT_OF_MEMORY = -1,
   MEM_EXTENT_MAPPED = -2,
   MEM_MAPPING_ERROR = -3,
+  MEM_NOT_SUPPORTED = -4,
 };
 
+/* Switches to the host MMU backend, which must happen before any area is
+ * mapped. The whole guest address space is reserved as a single inaccessible
+ * host mapping, and memMapArea makes parts of it accessible, so that guest
+ * loads and stores are plain host accesses. Accesses to unmapped memory are
+ * caught as SIGSEGV, and resume at the recovery point set by the hart which
+ * caused them with memSetFaultRecovery. The host page must not be larger
+ * than MEM_PAGE_SIZE. */
+t_memError memEnableHostMMU(void);
+bool memHostMMUEnabled(void);
+#ifdef MEM_HOST_MMU_SUPPORTED
+void memSetFaultRecovery(sigjmp_buf *recovery);
+#endif
+
 t_memError memMapArea(t_memAddress base, t_memSize extent, uint8_t **outBuffer);
+/* Maps an area whose first `fileSize' bytes are read from the file `fd' at
+ * `offset', and the others are zero. The file is mapped copy-on-write, so
+ * its pages are loaded when first accessed, and writes by the program are
+ * not visible in the file. The file can be closed afterwards. */
+t_memError memMapFile(t_memAddress base, t_memSize extent, int fd,
+    off_t offset, t_memSize fileSize);
 
 t_memError memRead8(t_memAddress addr, uint8_t *out);
 t_memError memRead16(t_memAddress addr, uint16_t *out);
@@ -29,6 +61,12 @@ t_memError memWrite8(t_memAddress addr, uint8_t in);
 t_memError memWrite16(t_memAddress addr, uint16_t in);
 t_memError memWrite32(t_memAddress addr, uint32_t in);
 
+t_memError memGetHostBuffer(t_memAddress addr, t_memSize size,
+    uint8_t **outBuffer, t_memSize *outSize);
+
+t_memError memGetHostWord(t_memAddress addr, uint32_t **outPtr);
+
 t_memAddress memGetLastFaultAddress(void);
+uint64_t memGetMappedSize(void);
 
 #endif
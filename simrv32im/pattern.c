@@ -0,0 +1,299 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "pattern.h"
+#include "plugin.h"
+
+#define PAT_LINES_HASH_SIZE (1 << 20)
+#define PAT_REPORT_PCS 32
+
+typedef struct patSite {
+  bool used;
+  uint32_t pc;
+  uint64_t reads;
+  uint64_t writes;
+  uint32_t lastAddr;
+  // Most frequent strides, tracked with the space-saving algorithm
+  int32_t strides[PAT_MAX_STRIDES];
+  uint64_t strideCounts[PAT_MAX_STRIDES];
+  uint64_t reuse[PAT_NUM_BUCKETS];
+} t_patSite;
+
+typedef struct patLine {
+  uint32_t line;
+  uint64_t time; // time of the last access plus one, zero if unused
+} t_patLine;
+
+t_patSite patSites[PAT_MAX_PCS];
+uint64_t patUntracked = 0;
+uint64_t patReuse[PAT_NUM_BUCKETS];
+
+// Reuse distances are computed as the number of lines whose last access is
+// more recent than the last access to the current one. The last accesses
+// within the window are marked in a Fenwick tree indexed by time modulo the
+// window size, and the time of the last access of each line is kept in a
+// direct-mapped table. Lines evicted from the table lose their history.
+t_patLine *patLines = NULL;
+int32_t *patTree = NULL;
+uint8_t *patMarks = NULL;
+uint64_t patTime = 0;
+
+uint32_t patIntervals[PAT_MAX_INTERVALS];
+int patNumIntervals = 0;
+uint64_t patIntervalLength = PAT_INTERVAL;
+uint64_t patIntervalStart = 0;
+uint32_t patWorkingSet = 0;
+
+pthread_mutex_t patLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void patTreeAdd(uint32_t slot, int32_t value)
+{
+  for (uint32_t i = slot + 1; i <= PAT_WINDOW; i += i & -i)
+    patTree[i - 1] += value;
+}
+
+static int32_t patTreePrefix(uint32_t slot)
+{
+  int32_t sum = 0;
+  for (uint32_t i = slot + 1; i > 0; i -= i & -i)
+    sum += patTree[i - 1];
+  return sum;
+}
+
+/* Number of marks at times in [first, last], with last - first < window */
+static uint32_t patCountMarks(uint64_t first, uint64_t last)
+{
+  if (first > last)
+    return 0;
+  uint32_t a = (uint32_t)(first % PAT_WINDOW);
+  uint32_t b = (uint32_t)(last % PAT_WINDOW);
+  int32_t before = a > 0 ? patTreePrefix(a - 1) : 0;
+  if (a <= b)
+    return (uint32_t)(patTreePrefix(b) - before);
+  return (uint32_t)(patTreePrefix(PAT_WINDOW - 1) - before + patTreePrefix(b));
+}
+
+static void patSetMark(uint64_t time, bool mark)
+{
+  uint32_t slot = (uint32_t)(time % PAT_WINDOW);
+  if (patMarks[slot] == mark)
+    return;
+  patMarks[slot] = mark;
+  patTreeAdd(slot, mark ? 1 : -1);
+}
+
+static int patBucket(uint64_t distance)
+{
+  int bucket = 0;
+  while (distance > 0) {
+    distance >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+/* Returns the bucket of the reuse distance of the line, and updates the
+ * working set of the current interval. */
+static int patAccessLine(uint32_t line)
+{
+  uint64_t now = patTime++;
+  // The slot of the current time was last used one window ago
+  patSetMark(now, false);
+
+  t_patLine *entry = &patLines[(line * 2654435761U) % PAT_LINES_HASH_SIZE];
+  bool inWindow = entry->time != 0 && now - (entry->time - 1) < PAT_WINDOW;
+  int bucket = PAT_NUM_BUCKETS - 1;
+  if (inWindow) {
+    uint64_t last = entry->time - 1;
+    if (entry->line == line)
+      bucket = patBucket(patCountMarks(last + 1, now - 1));
+    patSetMark(last, false);
+  }
+  if (entry->line != line || entry->time == 0 ||
+      entry->time - 1 < patIntervalStart)
+    patWorkingSet++;
+  entry->line = line;
+  entry->time = now + 1;
+  patSetMark(now, true);
+
+  if (patTime - patIntervalStart == patIntervalLength) {
+    if (patNumIntervals == PAT_MAX_INTERVALS) {
+      // Halve the resolution, approximating the working set of two
+      // intervals with the largest one
+      for (int i = 0; i < PAT_MAX_INTERVALS / 2; i++) {
+        uint32_t a = patIntervals[2 * i], b = patIntervals[2 * i + 1];
+        patIntervals[i] = a > b ? a : b;
+      }
+      patNumIntervals = PAT_MAX_INTERVALS / 2;
+      patIntervalLength *= 2;
+    } else {
+      patIntervals[patNumIntervals++] = patWorkingSet;
+      patIntervalStart = patTime;
+      patWorkingSet = 0;
+    }
+  }
+  return bucket;
+}
+
+static t_patSite *patGetSite(uint32_t pc)
+{
+  uint32_t i = (pc >> 1) % PAT_MAX_PCS;
+  for (int probes = 0; probes < PAT_MAX_PCS; probes++) {
+    t_patSite *site = &patSites[i];
+    if (!site->used) {
+      site->used = true;
+      site->pc = pc;
+      return site;
+    }
+    if (site->pc == pc)
+      return site;
+    i = (i + 1) % PAT_MAX_PCS;
+  }
+  return NULL;
+}
+
+static void patUpdateStride(t_patSite *site, int32_t stride)
+{
+  int min = 0;
+  for (int i = 0; i < PAT_MAX_STRIDES; i++) {
+    if (site->strideCounts[i] != 0 && site->strides[i] == stride) {
+      site->strideCounts[i]++;
+      return;
+    }
+    if (site->strideCounts[i] < site->strideCounts[min])
+      min = i;
+  }
+  site->strides[min] = stride;
+  site->strideCounts[min]++;
+}
+
+static void patMemAccess(void *data, uint32_t hart, uint32_t pc,
+    uint32_t addr, uint32_t size, int flags)
+{
+  pthread_mutex_lock(&patLock);
+  int bucket = patAccessLine(addr / PAT_LINE_SIZE);
+  patReuse[bucket]++;
+
+  t_patSite *site = patGetSite(pc);
+  if (!site) {
+    patUntracked++;
+    pthread_mutex_unlock(&patLock);
+    return;
+  }
+  if (site->reads + site->writes > 0)
+    patUpdateStride(site, (int32_t)(addr - site->lastAddr));
+  site->lastAddr = addr;
+  if (flags & PLG_MEM_WRITE)
+    site->writes++;
+  else
+    site->reads++;
+  site->reuse[bucket]++;
+  pthread_mutex_unlock(&patLock);
+}
+
+bool patStart(void)
+{
+  patLines = calloc(PAT_LINES_HASH_SIZE, sizeof(t_patLine));
+  patTree = calloc(PAT_WINDOW, sizeof(int32_t));
+  patMarks = calloc(PAT_WINDOW, sizeof(uint8_t));
+  if (!patLines || !patTree || !patMarks)
+    return false;
+  t_plgHooks hooks = {0};
+  hooks.memAccess = patMemAccess;
+  return plgRegister(&hooks) == PLG_NO_ERROR;
+}
+
+
+static int patCompareSites(const void *a, const void *b)
+{
+  const t_patSite *x = *(const t_patSite **)a;
+  const t_patSite *y = *(const t_patSite **)b;
+  uint64_t nx = x->reads + x->writes, ny = y->reads + y->writes;
+  if (nx != ny)
+    return nx > ny ? -1 : 1;
+  return x->pc < y->pc ? -1 : (x->pc > y->pc);
+}
+
+/* Percentage of the histogram in buckets [first, last) */
+static double patShare(const uint64_t *hist, int first, int last)
+{
+  uint64_t total = 0, part = 0;
+  for (int i = 0; i < PAT_NUM_BUCKETS; i++) {
+    total += hist[i];
+    if (i >= first && i < last)
+      part += hist[i];
+  }
+  return total ? (double)part / (double)total * 100.0 : 0.0;
+}
+
+void patPrintReport(FILE *fp)
+{
+  static t_patSite *sorted[PAT_MAX_PCS];
+  int n = 0;
+  for (int i = 0; i < PAT_MAX_PCS; i++) {
+    if (patSites[i].used)
+      sorted[n++] = &patSites[i];
+  }
+  qsort(sorted, (size_t)n, sizeof(t_patSite *), patCompareSites);
+
+  fprintf(fp, "Memory access patterns (reuse distances in %d-byte lines)\n",
+      PAT_LINE_SIZE);
+  fprintf(fp, "%8s %12s %6s %8s %7s %6s %6s %6s %6s %6s\n", "PC", "ACCESSES",
+      "READ%", "STRIDE", "STRIDE%", "<16", "<256", "<4K", "<64K", ">=64K");
+  for (int i = 0; i < n && i < PAT_REPORT_PCS; i++) {
+    t_patSite *site = sorted[i];
+    uint64_t accesses = site->reads + site->writes;
+    int top = 0;
+    for (int j = 1; j < PAT_MAX_STRIDES; j++) {
+      if (site->strideCounts[j] > site->strideCounts[top])
+        top = j;
+    }
+    double strideShare = accesses > 1 ?
+        (double)site->strideCounts[top] / (double)(accesses - 1) * 100.0 :
+        0.0;
+    // Bucket i holds distances below 2^i
+    fprintf(fp,
+        "%08" PRIx32 " %12" PRIu64 " %6.1f %8" PRId32
+        " %7.1f %6.1f %6.1f %6.1f %6.1f %6.1f\n",
+        site->pc, accesses,
+        (double)site->reads / (double)accesses * 100.0,
+        site->strides[top], strideShare, patShare(site->reuse, 0, 5),
+        patShare(site->reuse, 5, 9), patShare(site->reuse, 9, 13),
+        patShare(site->reuse, 13, 17),
+        patShare(site->reuse, 17, PAT_NUM_BUCKETS));
+  }
+  if (n > PAT_REPORT_PCS)
+    fprintf(fp, "(%d more instructions not shown)\n", n - PAT_REPORT_PCS);
+  if (patUntracked > 0)
+    fprintf(fp, "(%" PRIu64 " accesses from untracked instructions)\n",
+        patUntracked);
+
+  fprintf(fp, "\nReuse distance histogram (all accesses)\n");
+  uint64_t total = 0;
+  for (int i = 0; i < PAT_NUM_BUCKETS; i++)
+    total += patReuse[i];
+  for (int i = 0; i < PAT_NUM_BUCKETS; i++) {
+    if (patReuse[i] == 0)
+      continue;
+    if (i == 0)
+      fprintf(fp, "%20s", "0");
+    else if (i == PAT_NUM_BUCKETS - 1)
+      fprintf(fp, "%20s", "cold or far");
+    else
+      fprintf(fp, "%9" PRIu32 " - %8" PRIu32, (uint32_t)1 << (i - 1),
+          ((uint32_t)1 << i) - 1);
+    fprintf(fp, " %12" PRIu64 " %6.1f%%\n", patReuse[i],
+        (double)patReuse[i] / (double)total * 100.0);
+  }
+
+  fprintf(fp, "\nWorking set (distinct lines every %" PRIu64 " accesses)\n",
+      patIntervalLength);
+  for (int i = 0; i < patNumIntervals; i++)
+    fprintf(fp, "%12" PRIu64 " %10" PRIu32 "\n",
+        (uint64_t)i * patIntervalLength, patIntervals[i]);
+  if (patTime > patIntervalStart)
+    fprintf(fp, "%12" PRIu64 " %10" PRIu32 " (partial)\n", patIntervalStart,
+        patWorkingSet);
+}
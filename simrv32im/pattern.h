@@ -0,0 +1,26 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/* Memory access pattern analysis. For each load/store instruction, detects
+ * the most frequent strides and computes a histogram of the reuse distances
+ * of the accessed cache lines. The working set size is also tracked over
+ * time. All the state has a fixed size, independent of the program length. */
+
+#define PAT_LINE_SIZE 64
+#define PAT_MAX_PCS 4096
+#define PAT_MAX_STRIDES 4
+// Reuse distances are exact up to this number of references ago
+#define PAT_WINDOW (1 << 20)
+// Buckets 0 to PAT_NUM_BUCKETS - 2 count distances in [2^(i-1), 2^i), the
+// last one counts cold lines and reuses beyond the window
+#define PAT_NUM_BUCKETS 22
+#define PAT_MAX_INTERVALS 64
+#define PAT_INTERVAL 100000
+
+bool patStart(void);
+void patPrintReport(FILE *fp);
+
+#endif
@@ -0,0 +1,126 @@
+#include <stdlib.h>
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+#include "plugin.h"
+
+t_plgHooks plgHooks[PLG_MAX_PLUGINS];
+void *plgHandles[PLG_MAX_PLUGINS];
+int plgCount = 0;
+t_plgEvents plgEvents = 0;
+t_plgEvents plgRegisteredEvents = 0;
+bool plgDetailed = true;
+
+
+static void plgUpdateEvents(void)
+{
+  if (plgDetailed)
+    plgEvents = plgRegisteredEvents;
+  else
+    plgEvents = plgRegisteredEvents & ~PLG_DETAILED_EVENTS;
+}
+
+
+t_plgError plgRegister(const t_plgHooks *hooks)
+{
+  if (plgCount == PLG_MAX_PLUGINS)
+    return PLG_TOO_MANY;
+  plgHooks[plgCount++] = *hooks;
+  if (hooks->instRetired)
+    plgRegisteredEvents |= PLG_EVENT_INST_RETIRED;
+  if (hooks->memAccess)
+    plgRegisteredEvents |= PLG_EVENT_MEM_ACCESS;
+  if (hooks->branch)
+    plgRegisteredEvents |= PLG_EVENT_BRANCH;
+  if (hooks->syscall)
+    plgRegisteredEvents |= PLG_EVENT_SYSCALL;
+  plgUpdateEvents();
+  return PLG_NO_ERROR;
+}
+
+void plgSetDetailed(bool detailed)
+{
+  plgDetailed = detailed;
+  plgUpdateEvents();
+}
+
+
+t_plgError plgLoad(const char *path, const char *args)
+{
+#ifdef _WIN32
+  return PLG_UNSUPPORTED;
+#else
+  if (plgCount == PLG_MAX_PLUGINS)
+    return PLG_TOO_MANY;
+  void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (!handle)
+    return PLG_LOAD_ERROR;
+  t_plgInitFn init;
+  // ISO C does not allow converting a void * to a function pointer
+  *(void **)&init = dlsym(handle, PLG_INIT_SYMBOL);
+  if (!init) {
+    dlclose(handle);
+    return PLG_LOAD_ERROR;
+  }
+
+  t_plgHooks hooks = {0};
+  if (!init(PLG_API_VERSION, args ? args : "", &hooks)) {
+    dlclose(handle);
+    return PLG_INIT_ERROR;
+  }
+  plgHandles[plgCount] = handle;
+  return plgRegister(&hooks);
+#endif
+}
+
+
+void plgNotifyInstRetired(uint32_t hart, uint32_t pc, uint32_t inst)
+{
+  for (int i = 0; i < plgCount; i++) {
+    if (plgHooks[i].instRetired)
+      plgHooks[i].instRetired(plgHooks[i].data, hart, pc, inst);
+  }
+}
+
+void plgNotifyMemAccess(
+    uint32_t hart, uint32_t pc, uint32_t addr, uint32_t size, int flags)
+{
+  for (int i = 0; i < plgCount; i++) {
+    if (plgHooks[i].memAccess)
+      plgHooks[i].memAccess(plgHooks[i].data, hart, pc, addr, size, flags);
+  }
+}
+
+void plgNotifyBranch(
+    uint32_t hart, uint32_t pc, uint32_t inst, uint32_t target, bool taken)
+{
+  for (int i = 0; i < plgCount; i++) {
+    if (plgHooks[i].branch)
+      plgHooks[i].branch(plgHooks[i].data, hart, pc, inst, target, taken);
+  }
+}
+
+void plgNotifySyscall(uint32_t hart, uint32_t pc, uint32_t number)
+{
+  for (int i = 0; i < plgCount; i++) {
+    if (plgHooks[i].syscall)
+      plgHooks[i].syscall(plgHooks[i].data, hart, pc, number);
+  }
+}
+
+void plgNotifyExit(void)
+{
+  for (int i = 0; i < plgCount; i++) {
+    if (plgHooks[i].exit)
+      plgHooks[i].exit(plgHooks[i].data);
+  }
+#ifndef _WIN32
+  for (int i = 0; i < plgCount; i++) {
+    if (plgHandles[i])
+      dlclose(plgHandles[i]);
+  }
+#endif
+  plgCount = 0;
+  plgRegisteredEvents = 0;
+  plgEvents = 0;
+}
@@ -0,0 +1,98 @@
+#ifndef PLUGIN_H
+#define PLUGIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Plugins are shared objects loaded with the -p option. Each plugin exports
+ * a function named PLG_INIT_SYMBOL with the t_plgInitFn signature, which
+ * fills in the hooks it wants to be called for and returns true on success.
+ * Hooks left to NULL cost nothing.
+ *
+ * Hooks run on the host thread of the hart which generated the event, so
+ * they must be thread-safe if the program starts more than one hart.
+ *
+ * With a region of interest or sampling (options -R and -i), the hooks for
+ * instructions, memory accesses and branches are only called in the
+ * detailed parts of the simulation. */
+
+#define PLG_API_VERSION 1
+#define PLG_INIT_SYMBOL "simrv32imPluginInit"
+#define PLG_MAX_PLUGINS 16
+
+/* Flags of a memory access */
+enum {
+  PLG_MEM_READ = 1,
+  PLG_MEM_WRITE = 2
+};
+
+/* Instruction at `pc' completed. Compressed instructions are passed in
+ * their expanded 32-bit form. */
+typedef void (*t_plgInstRetiredHook)(
+    void *data, uint32_t hart, uint32_t pc, uint32_t inst);
+/* Load, store or atomic access of `size' bytes at `addr'. */
+typedef void (*t_plgMemAccessHook)(void *data, uint32_t hart, uint32_t pc,
+    uint32_t addr, uint32_t size, int flags);
+/* Conditional branch or jump at `pc', `target' is the next PC. Jumps are
+ * always taken. */
+typedef void (*t_plgBranchHook)(void *data, uint32_t hart, uint32_t pc,
+    uint32_t inst, uint32_t target, bool taken);
+/* Environment call with number `number', before it is serviced. */
+typedef void (*t_plgSyscallHook)(
+    void *data, uint32_t hart, uint32_t pc, uint32_t number);
+/* The simulation ended. */
+typedef void (*t_plgExitHook)(void *data);
+
+typedef struct plgHooks {
+  void *data; // passed as is to every hook
+  t_plgInstRetiredHook instRetired;
+  t_plgMemAccessHook memAccess;
+  t_plgBranchHook branch;
+  t_plgSyscallHook syscall;
+  t_plgExitHook exit;
+} t_plgHooks;
+
+typedef bool (*t_plgInitFn)(
+    int apiVersion, const char *args, t_plgHooks *hooks);
+
+
+/* Used by the simulator */
+
+typedef int t_plgError;
+enum {
+  PLG_NO_ERROR = 0,
+  PLG_LOAD_ERROR = -1,
+  PLG_INIT_ERROR = -2,
+  PLG_TOO_MANY = -3,
+  PLG_UNSUPPORTED = -4
+};
+
+typedef unsigned int t_plgEvents;
+enum {
+  PLG_EVENT_INST_RETIRED = 1 << 0,
+  PLG_EVENT_MEM_ACCESS = 1 << 1,
+  PLG_EVENT_BRANCH = 1 << 2,
+  PLG_EVENT_SYSCALL = 1 << 3,
+  // Only delivered in detailed mode
+  PLG_DETAILED_EVENTS =
+      PLG_EVENT_INST_RETIRED | PLG_EVENT_MEM_ACCESS | PLG_EVENT_BRANCH
+};
+
+/* Events with at least one hook, checked before calling plgNotify*() */
+extern t_plgEvents plgEvents;
+
+t_plgError plgLoad(const char *path, const char *args);
+t_plgError plgRegister(const t_plgHooks *hooks);
+/* Outside of detailed mode (see sample.h) the hooks for instructions,
+ * memory accesses and branches are not called. */
+void plgSetDetailed(bool detailed);
+
+void plgNotifyInstRetired(uint32_t hart, uint32_t pc, uint32_t inst);
+void plgNotifyMemAccess(
+    uint32_t hart, uint32_t pc, uint32_t addr, uint32_t size, int flags);
+void plgNotifyBranch(
+    uint32_t hart, uint32_t pc, uint32_t inst, uint32_t target, bool taken);
+void plgNotifySyscall(uint32_t hart, uint32_t pc, uint32_t number);
+void plgNotifyExit(void);
+
+#endif
@@ -0,0 +1,90 @@
+/* Example plugin which counts the retired instructions by class.
+ *
+ * usage: simrv32im -p icount.so[,FILE] program
+ *
+ * The counts are printed to FILE, or to the standard error if omitted. */
+
+#include <stdio.h>
+#include <string.h>
+#include "../plugin.h"
+
+typedef struct {
+  uint64_t insts;
+  uint64_t loads;
+  uint64_t stores;
+  uint64_t branches;
+  uint64_t taken;
+  uint64_t syscalls;
+  char path[256];
+} t_icount;
+
+static t_icount icount;
+
+#define COUNT(field) __atomic_fetch_add(&(field), 1, __ATOMIC_RELAXED)
+
+static void icountInstRetired(
+    void *data, uint32_t hart, uint32_t pc, uint32_t inst)
+{
+  t_icount *ic = data;
+  COUNT(ic->insts);
+}
+
+static void icountMemAccess(void *data, uint32_t hart, uint32_t pc,
+    uint32_t addr, uint32_t size, int flags)
+{
+  t_icount *ic = data;
+  if (flags & PLG_MEM_READ)
+    COUNT(ic->loads);
+  if (flags & PLG_MEM_WRITE)
+    COUNT(ic->stores);
+}
+
+static void icountBranch(void *data, uint32_t hart, uint32_t pc, uint32_t inst,
+    uint32_t target, bool taken)
+{
+  t_icount *ic = data;
+  COUNT(ic->branches);
+  if (taken)
+    COUNT(ic->taken);
+}
+
+static void icountSyscall(
+    void *data, uint32_t hart, uint32_t pc, uint32_t number)
+{
+  t_icount *ic = data;
+  COUNT(ic->syscalls);
+}
+
+static void icountExit(void *data)
+{
+  t_icount *ic = data;
+  FILE *fp = stderr;
+  if (ic->path[0] != '\0')
+    fp = fopen(ic->path, "w");
+  if (!fp)
+    return;
+  fprintf(fp, "instructions: %llu\n", (unsigned long long)ic->insts);
+  fprintf(fp, "loads: %llu\n", (unsigned long long)ic->loads);
+  fprintf(fp, "stores: %llu\n", (unsigned long long)ic->stores);
+  fprintf(fp, "branches: %llu (%llu taken)\n",
+      (unsigned long long)ic->branches, (unsigned long long)ic->taken);
+  fprintf(fp, "syscalls: %llu\n", (unsigned long long)ic->syscalls);
+  if (fp != stderr)
+    fclose(fp);
+}
+
+bool simrv32imPluginInit(int apiVersion, const char *args, t_plgHooks *hooks)
+{
+  if (apiVersion != PLG_API_VERSION)
+    return false;
+  if (strlen(args) >= sizeof(icount.path))
+    return false;
+  strcpy(icount.path, args);
+  hooks->data = &icount;
+  hooks->instRetired = icountInstRetired;
+  hooks->memAccess = icountMemAccess;
+  hooks->branch = icountBranch;
+  hooks->syscall = icountSyscall;
+  hooks->exit = icountExit;
+  return true;
+}
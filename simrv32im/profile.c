@@ -0,0 +1,525 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "profile.h"
+#include "plugin.h"
+#include "supervisor.h"
+#include "symbols.h"
+
+#define PRF_REPORT_ITEMS 32
+#define PRF_NAME_SIZE (SYM_MAX_NAME + 16)
+// Return address of the first frame of each hart, which never returns
+#define PRF_NO_RETURN UINT32_MAX
+
+typedef struct prfFunc {
+  bool used;
+  uint32_t addr;
+  uint64_t calls;
+  uint64_t inclusive;
+  uint64_t exclusive;
+  // Open frames on each hart, only the outermost one of a recursion counts
+  // towards the inclusive instructions
+  uint32_t active[SV_MAX_HARTS];
+} t_prfFunc;
+
+typedef struct prfEdge {
+  bool used;
+  uint32_t caller;
+  uint32_t callee;
+  uint64_t calls;
+  uint64_t inclusive;
+  uint32_t active[SV_MAX_HARTS];
+} t_prfEdge;
+
+typedef struct prfLoop {
+  bool used;
+  uint32_t header;
+  uint32_t latch;
+  uint32_t func;
+  struct prfLoop *parent; // innermost enclosing loop, set by the report
+  uint64_t executions;
+  uint64_t iterations;
+  uint64_t inclusive;
+  uint64_t trips[PRF_NUM_BUCKETS];
+  uint32_t active[SV_MAX_HARTS];
+} t_prfLoop;
+
+typedef struct prfFrame {
+  t_prfFunc *func;
+  t_prfEdge *edge;
+  uint32_t returnAddr;
+  uint64_t start;
+  uint64_t children; // instructions executed by the callees
+  int loopBase;      // number of loops opened by the callers
+} t_prfFrame;
+
+typedef struct prfLoopFrame {
+  t_prfLoop *loop;
+  uint32_t latch;
+  uint64_t start;
+  uint64_t backEdges;
+} t_prfLoopFrame;
+
+typedef struct prfHart {
+  uint64_t instCount;
+  t_prfFrame *frames;
+  int numFrames;
+  int maxFrames;
+  t_prfLoopFrame *loops;
+  int numLoops;
+  int maxLoops;
+} t_prfHart;
+
+t_prfFunc prfFuncs[PRF_MAX_FUNCS];
+t_prfEdge prfEdges[PRF_MAX_EDGES];
+t_prfLoop prfLoops[PRF_MAX_LOOPS];
+t_prfHart prfHarts[SV_MAX_HARTS];
+uint64_t prfUntracked = 0;
+
+pthread_mutex_t prfLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static t_prfFunc *prfGetFunc(uint32_t addr)
+{
+  uint32_t i = (addr >> 1) % PRF_MAX_FUNCS;
+  for (int probes = 0; probes < PRF_MAX_FUNCS; probes++) {
+    t_prfFunc *func = &prfFuncs[i];
+    if (!func->used) {
+      func->used = true;
+      func->addr = addr;
+      return func;
+    }
+    if (func->addr == addr)
+      return func;
+    i = (i + 1) % PRF_MAX_FUNCS;
+  }
+  return NULL;
+}
+
+static t_prfEdge *prfGetEdge(uint32_t caller, uint32_t callee)
+{
+  uint32_t i = ((caller * 2654435761U) ^ (callee >> 1)) % PRF_MAX_EDGES;
+  for (int probes = 0; probes < PRF_MAX_EDGES; probes++) {
+    t_prfEdge *edge = &prfEdges[i];
+    if (!edge->used) {
+      edge->used = true;
+      edge->caller = caller;
+      edge->callee = callee;
+      return edge;
+    }
+    if (edge->caller == caller && edge->callee == callee)
+      return edge;
+    i = (i + 1) % PRF_MAX_EDGES;
+  }
+  return NULL;
+}
+
+static t_prfLoop *prfGetLoop(uint32_t header, bool *isNew)
+{
+  uint32_t i = (header >> 1) % PRF_MAX_LOOPS;
+  for (int probes = 0; probes < PRF_MAX_LOOPS; probes++) {
+    t_prfLoop *loop = &prfLoops[i];
+    if (!loop->used) {
+      loop->used = true;
+      loop->header = header;
+      *isNew = true;
+      return loop;
+    }
+    if (loop->header == header) {
+      *isNew = false;
+      return loop;
+    }
+    i = (i + 1) % PRF_MAX_LOOPS;
+  }
+  return NULL;
+}
+
+static int prfBucket(uint64_t trips)
+{
+  int bucket = 0;
+  while (trips > 0 && bucket < PRF_NUM_BUCKETS - 1) {
+    trips >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+
+static void prfPushFrame(t_prfHart *h, uint32_t hart, uint32_t addr,
+    uint32_t returnAddr, uint64_t start)
+{
+  if (h->numFrames == h->maxFrames) {
+    int newMax = h->maxFrames ? h->maxFrames * 2 : 64;
+    t_prfFrame *newFrames =
+        realloc(h->frames, (size_t)newMax * sizeof(t_prfFrame));
+    if (!newFrames) {
+      prfUntracked++;
+      return;
+    }
+    h->frames = newFrames;
+    h->maxFrames = newMax;
+  }
+  t_prfFunc *caller = NULL;
+  if (h->numFrames > 0)
+    caller = h->frames[h->numFrames - 1].func;
+  t_prfFrame *frame = &h->frames[h->numFrames++];
+  frame->func = prfGetFunc(addr);
+  frame->edge = caller && frame->func ? prfGetEdge(caller->addr, addr) : NULL;
+  frame->returnAddr = returnAddr;
+  frame->start = start;
+  frame->children = 0;
+  frame->loopBase = h->numLoops;
+  if (frame->func) {
+    frame->func->calls++;
+    frame->func->active[hart]++;
+  } else {
+    prfUntracked++;
+  }
+  if (frame->edge) {
+    frame->edge->calls++;
+    frame->edge->active[hart]++;
+  }
+}
+
+static void prfPopLoop(t_prfHart *h, uint32_t hart, uint64_t end)
+{
+  t_prfLoopFrame *frame = &h->loops[--h->numLoops];
+  t_prfLoop *loop = frame->loop;
+  uint64_t trips = frame->backEdges + 1;
+  loop->executions++;
+  loop->iterations += trips;
+  loop->trips[prfBucket(trips)]++;
+  if (frame->latch > loop->latch)
+    loop->latch = frame->latch;
+  if (--loop->active[hart] == 0)
+    loop->inclusive += end - frame->start;
+}
+
+static void prfPopFrame(t_prfHart *h, uint32_t hart, uint64_t end)
+{
+  t_prfFrame *frame = &h->frames[h->numFrames - 1];
+  while (h->numLoops > frame->loopBase)
+    prfPopLoop(h, hart, end);
+  uint64_t inclusive = end - frame->start;
+  if (frame->func) {
+    frame->func->exclusive += inclusive - frame->children;
+    if (--frame->func->active[hart] == 0)
+      frame->func->inclusive += inclusive;
+  }
+  if (frame->edge && --frame->edge->active[hart] == 0)
+    frame->edge->inclusive += inclusive;
+  h->numFrames--;
+  if (h->numFrames > 0)
+    h->frames[h->numFrames - 1].children += inclusive;
+}
+
+static void prfReturn(t_prfHart *h, uint32_t hart, uint32_t target)
+{
+  // Frames skipped by the return (for example after a tail call) are closed
+  // together with the one which is returning
+  int i = h->numFrames - 1;
+  while (i >= 0 && h->frames[i].returnAddr != target)
+    i--;
+  if (i < 0)
+    return;
+  while (h->numFrames > i)
+    prfPopFrame(h, hart, h->instCount + 1);
+}
+
+static void prfUpdateLoops(
+    t_prfHart *h, uint32_t hart, uint32_t pc, uint32_t target, bool taken)
+{
+  int base = h->frames[h->numFrames - 1].loopBase;
+
+  // Loops are exited by jumping outside of the range between the header and
+  // the last back edge, or by not taking the last back edge
+  while (h->numLoops > base) {
+    t_prfLoopFrame *top = &h->loops[h->numLoops - 1];
+    if (taken && target >= top->loop->header && target <= top->latch)
+      break;
+    if (!taken && pc != top->latch)
+      break;
+    prfPopLoop(h, hart, h->instCount + 1);
+  }
+
+  if (!taken || target > pc)
+    return;
+  if (h->numLoops > base) {
+    t_prfLoopFrame *top = &h->loops[h->numLoops - 1];
+    if (top->loop->header == target) {
+      top->backEdges++;
+      if (pc > top->latch)
+        top->latch = pc;
+      return;
+    }
+  }
+
+  // A new execution of a loop starts at its first back edge
+  if (h->numLoops == h->maxLoops) {
+    int newMax = h->maxLoops ? h->maxLoops * 2 : 16;
+    t_prfLoopFrame *newLoops =
+        realloc(h->loops, (size_t)newMax * sizeof(t_prfLoopFrame));
+    if (!newLoops) {
+      prfUntracked++;
+      return;
+    }
+    h->loops = newLoops;
+    h->maxLoops = newMax;
+  }
+  bool isNew;
+  t_prfLoop *loop = prfGetLoop(target, &isNew);
+  if (!loop) {
+    prfUntracked++;
+    return;
+  }
+  if (isNew) {
+    t_prfFunc *func = h->frames[h->numFrames - 1].func;
+    loop->func = func ? func->addr : 0;
+    loop->latch = pc;
+  }
+  t_prfLoopFrame *frame = &h->loops[h->numLoops++];
+  frame->loop = loop;
+  frame->latch = pc;
+  frame->start = h->instCount;
+  frame->backEdges = 1;
+  loop->active[hart]++;
+}
+
+static void prfInstRetired(
+    void *data, uint32_t hart, uint32_t pc, uint32_t inst)
+{
+  if (hart >= SV_MAX_HARTS)
+    return;
+  t_prfHart *h = &prfHarts[hart];
+  if (h->numFrames == 0) {
+    pthread_mutex_lock(&prfLock);
+    prfPushFrame(h, hart, pc, PRF_NO_RETURN, 0);
+    pthread_mutex_unlock(&prfLock);
+  }
+  h->instCount++;
+}
+
+static void prfBranch(void *data, uint32_t hart, uint32_t pc, uint32_t inst,
+    uint32_t target, bool taken)
+{
+  if (hart >= SV_MAX_HARTS)
+    return;
+  t_prfHart *h = &prfHarts[hart];
+  pthread_mutex_lock(&prfLock);
+  // The branch is retired after this hook, the first frame may not exist yet
+  if (h->numFrames == 0)
+    prfPushFrame(h, hart, pc, PRF_NO_RETURN, 0);
+  if (h->numFrames == 0) {
+    pthread_mutex_unlock(&prfLock);
+    return;
+  }
+
+  uint32_t opcode = ISA_INST_OPCODE(inst);
+  t_cpuRegID rd = ISA_INST_RD(inst);
+  t_cpuRegID rs1 = ISA_INST_RS1(inst);
+  if ((opcode == ISA_INST_OPCODE_JAL || opcode == ISA_INST_OPCODE_JALR) &&
+      rd == CPU_REG_RA) {
+    // The return address is already in ra, the jump itself belongs to the
+    // caller
+    prfPushFrame(h, hart, target, cpuGetRegister(CPU_REG_RA), h->instCount + 1);
+  } else if (opcode == ISA_INST_OPCODE_JALR && rd == CPU_REG_ZERO &&
+      rs1 == CPU_REG_RA) {
+    prfReturn(h, hart, target);
+  } else {
+    prfUpdateLoops(h, hart, pc, target, taken);
+  }
+  pthread_mutex_unlock(&prfLock);
+}
+
+static void prfExit(void *data)
+{
+  for (uint32_t hart = 0; hart < SV_MAX_HARTS; hart++) {
+    t_prfHart *h = &prfHarts[hart];
+    while (h->numFrames > 0)
+      prfPopFrame(h, hart, h->instCount);
+    free(h->frames);
+    free(h->loops);
+  }
+}
+
+bool prfStart(void)
+{
+  t_plgHooks hooks = {0};
+  hooks.instRetired = prfInstRetired;
+  hooks.branch = prfBranch;
+  hooks.exit = prfExit;
+  return plgRegister(&hooks) == PLG_NO_ERROR;
+}
+
+
+static double prfPercent(uint64_t part, uint64_t total)
+{
+  return total ? (double)part / (double)total * 100.0 : 0.0;
+}
+
+static int prfCompareFuncs(const void *a, const void *b)
+{
+  const t_prfFunc *x = *(const t_prfFunc **)a;
+  const t_prfFunc *y = *(const t_prfFunc **)b;
+  if (x->inclusive != y->inclusive)
+    return x->inclusive > y->inclusive ? -1 : 1;
+  return x->addr < y->addr ? -1 : (x->addr > y->addr);
+}
+
+static int prfCompareEdges(const void *a, const void *b)
+{
+  const t_prfEdge *x = *(const t_prfEdge **)a;
+  const t_prfEdge *y = *(const t_prfEdge **)b;
+  if (x->inclusive != y->inclusive)
+    return x->inclusive > y->inclusive ? -1 : 1;
+  if (x->caller != y->caller)
+    return x->caller < y->caller ? -1 : 1;
+  return x->callee < y->callee ? -1 : (x->callee > y->callee);
+}
+
+static int prfCompareLoops(const void *a, const void *b)
+{
+  const t_prfLoop *x = *(const t_prfLoop **)a;
+  const t_prfLoop *y = *(const t_prfLoop **)b;
+  if (x->inclusive != y->inclusive)
+    return x->inclusive > y->inclusive ? -1 : 1;
+  return x->header < y->header ? -1 : (x->header > y->header);
+}
+
+/* Inner loops usually complete their first execution before the first back
+ * edge of the outer loop, so nesting is derived from the address ranges. */
+static void prfFindLoopParents(t_prfLoop **loops, int n)
+{
+  for (int i = 0; i < n; i++) {
+    t_prfLoop *inner = loops[i];
+    inner->parent = NULL;
+    for (int j = 0; j < n; j++) {
+      t_prfLoop *outer = loops[j];
+      if (outer == inner || outer->func != inner->func)
+        continue;
+      if (outer->header > inner->header || outer->latch < inner->latch ||
+          (outer->header == inner->header && outer->latch == inner->latch))
+        continue;
+      if (!inner->parent || outer->header > inner->parent->header)
+        inner->parent = outer;
+    }
+  }
+}
+
+/* Prints the loops nested in `parent', from the most expensive one */
+static int prfPrintLoopNest(FILE *fp, t_prfLoop **sorted, int n,
+    t_prfLoop *parent, int depth, uint64_t total, t_prfLoop **outOrder,
+    int numOut)
+{
+  char name[PRF_NAME_SIZE], func[PRF_NAME_SIZE];
+  int printed = 0;
+  for (int i = 0; i < n; i++) {
+    t_prfLoop *loop = sorted[i];
+    if (loop->parent != parent)
+      continue;
+    if (!parent && printed == PRF_REPORT_ITEMS) {
+      fprintf(fp, "(more loop nests not shown)\n");
+      break;
+    }
+    printed++;
+    symFormat(name, PRF_NAME_SIZE, loop->header);
+    symFormat(func, PRF_NAME_SIZE, loop->func);
+    fprintf(fp, "%*s%-*s %-20s %8" PRIu64 " %9.1f %12" PRIu64 " %6.1f\n",
+        depth * 2, "", 20 - depth * 2, name, func, loop->executions,
+        (double)loop->iterations / (double)loop->executions, loop->inclusive,
+        prfPercent(loop->inclusive, total));
+    outOrder[numOut++] = loop;
+    numOut = prfPrintLoopNest(
+        fp, sorted, n, loop, depth + 1, total, outOrder, numOut);
+  }
+  return numOut;
+}
+
+void prfPrintReport(FILE *fp)
+{
+  static t_prfFunc *funcs[PRF_MAX_FUNCS];
+  static t_prfEdge *edges[PRF_MAX_EDGES];
+  static t_prfLoop *loops[PRF_MAX_LOOPS];
+  static t_prfLoop *loopOrder[PRF_MAX_LOOPS];
+  char name[PRF_NAME_SIZE], callee[PRF_NAME_SIZE];
+  int numFuncs = 0, numEdges = 0, numLoops = 0;
+
+  uint64_t total = 0;
+  for (int i = 0; i < SV_MAX_HARTS; i++)
+    total += prfHarts[i].instCount;
+  for (int i = 0; i < PRF_MAX_FUNCS; i++) {
+    if (prfFuncs[i].used)
+      funcs[numFuncs++] = &prfFuncs[i];
+  }
+  for (int i = 0; i < PRF_MAX_EDGES; i++) {
+    if (prfEdges[i].used)
+      edges[numEdges++] = &prfEdges[i];
+  }
+  for (int i = 0; i < PRF_MAX_LOOPS; i++) {
+    if (prfLoops[i].used)
+      loops[numLoops++] = &prfLoops[i];
+  }
+  qsort(funcs, (size_t)numFuncs, sizeof(t_prfFunc *), prfCompareFuncs);
+  qsort(edges, (size_t)numEdges, sizeof(t_prfEdge *), prfCompareEdges);
+  qsort(loops, (size_t)numLoops, sizeof(t_prfLoop *), prfCompareLoops);
+
+  fprintf(fp, "Functions (%" PRIu64 " instructions)\n", total);
+  fprintf(fp, "%-24s %10s %12s %6s %12s %6s\n", "FUNCTION", "CALLS",
+      "INCLUSIVE", "%", "EXCLUSIVE", "%");
+  for (int i = 0; i < numFuncs && i < PRF_REPORT_ITEMS; i++) {
+    t_prfFunc *func = funcs[i];
+    symFormat(name, PRF_NAME_SIZE, func->addr);
+    fprintf(fp,
+        "%-24s %10" PRIu64 " %12" PRIu64 " %6.1f %12" PRIu64 " %6.1f\n", name,
+        func->calls, func->inclusive, prfPercent(func->inclusive, total),
+        func->exclusive, prfPercent(func->exclusive, total));
+  }
+  if (numFuncs > PRF_REPORT_ITEMS)
+    fprintf(fp, "(%d more functions not shown)\n", numFuncs - PRF_REPORT_ITEMS);
+
+  fprintf(fp, "\nCall graph\n");
+  fprintf(fp, "%-24s %-24s %10s %12s %6s\n", "CALLER", "CALLEE", "CALLS",
+      "INCLUSIVE", "%");
+  for (int i = 0; i < numEdges && i < PRF_REPORT_ITEMS; i++) {
+    t_prfEdge *edge = edges[i];
+    symFormat(name, PRF_NAME_SIZE, edge->caller);
+    symFormat(callee, PRF_NAME_SIZE, edge->callee);
+    fprintf(fp, "%-24s %-24s %10" PRIu64 " %12" PRIu64 " %6.1f\n", name,
+        callee, edge->calls, edge->inclusive,
+        prfPercent(edge->inclusive, total));
+  }
+  if (numEdges > PRF_REPORT_ITEMS)
+    fprintf(fp, "(%d more edges not shown)\n", numEdges - PRF_REPORT_ITEMS);
+
+  fprintf(fp, "\nLoops (nested loops are indented)\n");
+  fprintf(fp, "%-20s %-20s %8s %9s %12s %6s\n", "LOOP", "FUNCTION", "EXECS",
+      "AVG-TRIPS", "INCLUSIVE", "%");
+  prfFindLoopParents(loops, numLoops);
+  int numOrdered =
+      prfPrintLoopNest(fp, loops, numLoops, NULL, 0, total, loopOrder, 0);
+
+  fprintf(fp, "\nLoop trip counts (executions with [2^(i-1), 2^i) trips)\n");
+  for (int i = 0; i < numOrdered; i++) {
+    t_prfLoop *loop = loopOrder[i];
+    symFormat(name, PRF_NAME_SIZE, loop->header);
+    fprintf(fp, "%-20s", name);
+    for (int b = 1; b < PRF_NUM_BUCKETS; b++) {
+      if (loop->trips[b] == 0)
+        continue;
+      uint64_t lo = (uint64_t)1 << (b - 1), hi = ((uint64_t)1 << b) - 1;
+      if (lo == hi)
+        fprintf(fp, " %" PRIu64 ":%" PRIu64, lo, loop->trips[b]);
+      else if (b == PRF_NUM_BUCKETS - 1)
+        fprintf(fp, " >=%" PRIu64 ":%" PRIu64, lo, loop->trips[b]);
+      else
+        fprintf(fp, " %" PRIu64 "-%" PRIu64 ":%" PRIu64, lo, hi,
+            loop->trips[b]);
+    }
+    fprintf(fp, "\n");
+  }
+
+  if (prfUntracked > 0)
+    fprintf(fp, "(%" PRIu64 " calls or loops not tracked)\n",
+        prfUntracked);
+}
@@ -0,0 +1,23 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/* Dynamic loop and call graph profiling. Taken backward branches and jumps
+ * mark loop headers, and the number of iterations of every execution of a
+ * loop is collected in a histogram. Jumps which write the return address to
+ * ra are calls, and indirect jumps to the address in ra are returns. The
+ * instructions executed by loops, functions and call graph edges are
+ * counted including and excluding their callees. */
+
+#define PRF_MAX_FUNCS 4096
+#define PRF_MAX_LOOPS 4096
+#define PRF_MAX_EDGES 8192
+// Bucket i counts loop executions with [2^(i-1), 2^i) iterations
+#define PRF_NUM_BUCKETS 33
+
+bool prfStart(void);
+void prfPrintReport(FILE *fp);
+
+#endif
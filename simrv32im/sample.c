@@ -0,0 +1,412 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include "sample.h"
+#include "plugin.h"
+#include "cpu.h"
+#include "symbols.h"
+
+#define SMP_REPORT_PCS 16
+#define SMP_Z_95 1.96
+
+enum {
+  SMP_CLASS_ALU,
+  SMP_CLASS_MULDIV,
+  SMP_CLASS_LOAD,
+  SMP_CLASS_STORE,
+  SMP_CLASS_BRANCH,
+  SMP_CLASS_JUMP,
+  SMP_CLASS_ATOMIC,
+  SMP_CLASS_SYSTEM,
+  SMP_CLASS_OTHER,
+  SMP_METRIC_MEM_READS,
+  SMP_METRIC_MEM_WRITES,
+  SMP_NUM_METRICS
+};
+
+static const char *smpMetricNames[SMP_NUM_METRICS] = {"alu", "mul/div",
+    "load", "store", "branch", "jump", "atomic", "system", "other",
+    "memory reads", "memory writes"};
+
+/* Sums over the samples of the count, and of the count per instruction and
+ * its square, which give the confidence intervals. */
+typedef struct smpMetric {
+  uint64_t total;
+  double sum;
+  double sum2;
+} t_smpMetric;
+
+typedef struct smpPC {
+  bool used;
+  uint32_t pc;
+  uint64_t count; // in the current sample
+  t_smpMetric metric;
+} t_smpPC;
+
+bool smpActive = false;
+bool smpStats = false;
+bool smpFusion = true;
+bool smpFused = false;
+bool smpInROI = true;
+bool smpDetailed = true;
+bool smpSampling = false;
+bool smpInSample = false;
+uint64_t smpPeriod = 0;
+uint64_t smpLength = 0;
+uint64_t smpLeft = 0;
+
+// Instructions of hart zero in the region of interest. The commands may come
+// from any hart, but only the counter of hart zero is used.
+uint64_t smpROIInsts = 0;
+uint64_t smpROIStart = 0;
+
+uint64_t smpSampleInsts = 0;
+uint64_t smpSampleCounts[SMP_NUM_METRICS];
+uint64_t smpNumSamples = 0;
+uint64_t smpTotalInsts = 0;
+t_smpMetric smpMetrics[SMP_NUM_METRICS];
+t_smpPC smpPCs[SMP_MAX_PCS];
+int smpTouched[SMP_MAX_PCS];
+int smpNumTouched = 0;
+uint64_t smpUntracked = 0;
+
+pthread_mutex_t smpLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+bool smpParseConfig(const char *spec, uint64_t *period, uint64_t *length)
+{
+  char *end;
+  *period = strtoull(spec, &end, 0);
+  if (end == spec || *end != ':')
+    return false;
+  spec = end + 1;
+  *length = strtoull(spec, &end, 0);
+  if (end == spec || *end != '\0')
+    return false;
+  return *length > 0 && *length < *period;
+}
+
+
+static int smpGetClass(uint32_t inst)
+{
+  switch (ISA_INST_OPCODE(inst)) {
+    case ISA_INST_OPCODE_OP:
+      if (ISA_INST_FUNCT7(inst) == 1)
+        return SMP_CLASS_MULDIV;
+      return SMP_CLASS_ALU;
+    case ISA_INST_OPCODE_OPIMM:
+    case ISA_INST_OPCODE_LUI:
+    case ISA_INST_OPCODE_AUIPC:
+      return SMP_CLASS_ALU;
+    case ISA_INST_OPCODE_LOAD:
+      return SMP_CLASS_LOAD;
+    case ISA_INST_OPCODE_STORE:
+      return SMP_CLASS_STORE;
+    case ISA_INST_OPCODE_BRANCH:
+      return SMP_CLASS_BRANCH;
+    case ISA_INST_OPCODE_JAL:
+    case ISA_INST_OPCODE_JALR:
+      return SMP_CLASS_JUMP;
+    case ISA_INST_OPCODE_AMO:
+      return SMP_CLASS_ATOMIC;
+    case ISA_INST_OPCODE_SYSTEM:
+      return SMP_CLASS_SYSTEM;
+  }
+  return SMP_CLASS_OTHER;
+}
+
+static t_smpPC *smpGetPC(uint32_t pc)
+{
+  uint32_t i = (pc >> 1) % SMP_MAX_PCS;
+  for (int probes = 0; probes < SMP_MAX_PCS; probes++) {
+    t_smpPC *entry = &smpPCs[i];
+    if (!entry->used) {
+      entry->used = true;
+      entry->pc = pc;
+      return entry;
+    }
+    if (entry->pc == pc)
+      return entry;
+    i = (i + 1) % SMP_MAX_PCS;
+  }
+  return NULL;
+}
+
+static void smpInstRetired(
+    void *data, uint32_t hart, uint32_t pc, uint32_t inst)
+{
+  pthread_mutex_lock(&smpLock);
+  smpSampleInsts++;
+  smpSampleCounts[smpGetClass(inst)]++;
+  t_smpPC *entry = smpGetPC(pc);
+  if (entry) {
+    if (entry->count++ == 0)
+      smpTouched[smpNumTouched++] = (int)(entry - smpPCs);
+  } else {
+    smpUntracked++;
+  }
+  pthread_mutex_unlock(&smpLock);
+}
+
+static void smpMemAccess(void *data, uint32_t hart, uint32_t pc,
+    uint32_t addr, uint32_t size, int flags)
+{
+  pthread_mutex_lock(&smpLock);
+  if (flags & PLG_MEM_READ)
+    smpSampleCounts[SMP_METRIC_MEM_READS]++;
+  if (flags & PLG_MEM_WRITE)
+    smpSampleCounts[SMP_METRIC_MEM_WRITES]++;
+  pthread_mutex_unlock(&smpLock);
+}
+
+
+static void smpAddToMetric(t_smpMetric *metric, uint64_t count, double insts)
+{
+  double ratio = (double)count / insts;
+  metric->total += count;
+  metric->sum += ratio;
+  metric->sum2 += ratio * ratio;
+}
+
+/* Adds the counts of the current sample to the totals */
+static void smpCloseSample(void)
+{
+  if (smpSampleInsts == 0)
+    return;
+  double insts = (double)smpSampleInsts;
+  smpNumSamples++;
+  smpTotalInsts += smpSampleInsts;
+  for (int i = 0; i < SMP_NUM_METRICS; i++) {
+    smpAddToMetric(&smpMetrics[i], smpSampleCounts[i], insts);
+    smpSampleCounts[i] = 0;
+  }
+  for (int i = 0; i < smpNumTouched; i++) {
+    t_smpPC *entry = &smpPCs[smpTouched[i]];
+    smpAddToMetric(&entry->metric, entry->count, insts);
+    entry->count = 0;
+  }
+  smpNumTouched = 0;
+  smpSampleInsts = 0;
+}
+
+static void smpUpdateMode(void)
+{
+  bool detailed = smpInROI && (!smpSampling || smpInSample);
+  if (smpDetailed && !detailed)
+    smpCloseSample();
+  smpDetailed = detailed;
+  plgSetDetailed(detailed);
+  smpFused = smpFusion &&
+      !(plgEvents & (PLG_EVENT_INST_RETIRED | PLG_EVENT_BRANCH));
+  cpuSetFusion(smpFused);
+}
+
+bool smpStart(
+    bool stats, bool roi, uint64_t period, uint64_t length, bool fusion)
+{
+  if (stats) {
+    t_plgHooks hooks = {0};
+    hooks.instRetired = smpInstRetired;
+    hooks.memAccess = smpMemAccess;
+    if (plgRegister(&hooks) != PLG_NO_ERROR)
+      return false;
+  }
+  smpActive = true;
+  smpStats = stats;
+  smpFusion = fusion;
+  smpInROI = !roi;
+  smpSampling = period > 0;
+  smpPeriod = period;
+  smpLength = length;
+  // The first sample is taken after fast-forwarding through the
+  // initialization of the program
+  smpInSample = false;
+  smpLeft = period - length;
+  smpUpdateMode();
+  return true;
+}
+
+uint64_t smpGetBatch(void)
+{
+  if (!smpSampling)
+    return UINT64_MAX;
+  // Fused instructions retire two at a time, so the batch is made short
+  // enough not to run past the end of the sample or of the fast-forward
+  if (smpFused)
+    return smpLeft > 1 ? smpLeft / 2 : 1;
+  return smpLeft;
+}
+
+void smpAdvance(uint64_t insts)
+{
+  if (!smpSampling)
+    return;
+  pthread_mutex_lock(&smpLock);
+  smpLeft -= insts < smpLeft ? insts : smpLeft;
+  if (smpLeft == 0) {
+    smpInSample = !smpInSample;
+    smpLeft = smpInSample ? smpLength : smpPeriod - smpLength;
+    smpUpdateMode();
+  }
+  pthread_mutex_unlock(&smpLock);
+}
+
+
+static uint64_t smpGetROIInsts(void)
+{
+  if (smpInROI)
+    return smpROIInsts + (cpuGetMainInstRetCount() - smpROIStart);
+  return smpROIInsts;
+}
+
+/* Extrapolates a metric to the region of interest. The half width of the
+ * confidence interval is negative when there are too few samples. */
+static void smpEstimate(const t_smpMetric *metric, double insts,
+    double *outEstimate, double *outHalfWidth)
+{
+  if (!smpSampling) {
+    *outEstimate = (double)metric->total;
+    *outHalfWidth = 0;
+    return;
+  }
+  *outEstimate = 0;
+  *outHalfWidth = -1;
+  if (smpTotalInsts == 0)
+    return;
+  *outEstimate = (double)metric->total / (double)smpTotalInsts * insts;
+  if (smpNumSamples < 2)
+    return;
+  double n = (double)smpNumSamples;
+  double mean = metric->sum / n;
+  double variance = (metric->sum2 - n * mean * mean) / (n - 1);
+  if (variance < 0)
+    variance = 0;
+  *outHalfWidth = SMP_Z_95 * sqrt(variance / n) * insts;
+}
+
+static void smpPrintRow(FILE *fp, const char *name, double estimate,
+    double halfWidth, double insts)
+{
+  fprintf(fp, "%-20s %16.0f", name, estimate);
+  if (!smpSampling)
+    fprintf(fp, " %16s", "exact");
+  else if (halfWidth < 0)
+    fprintf(fp, " %16s", "n/a");
+  else
+    fprintf(fp, " %16.0f", halfWidth);
+  fprintf(fp, " %7.2f\n", insts > 0 ? estimate / insts * 100.0 : 0.0);
+}
+
+static void smpPrintEstimate(FILE *fp, const char *name,
+    const t_smpMetric *metric, double insts)
+{
+  double estimate, halfWidth;
+  smpEstimate(metric, insts, &estimate, &halfWidth);
+  smpPrintRow(fp, name, estimate, halfWidth, insts);
+}
+
+static int smpComparePCs(const void *a, const void *b)
+{
+  const t_smpPC *x = *(const t_smpPC **)a;
+  const t_smpPC *y = *(const t_smpPC **)b;
+  if (x->metric.total != y->metric.total)
+    return x->metric.total > y->metric.total ? -1 : 1;
+  return x->pc < y->pc ? -1 : (x->pc > y->pc);
+}
+
+static void smpPrintReportLocked(FILE *fp)
+{
+  static t_smpPC *sorted[SMP_MAX_PCS];
+  char name[SYM_MAX_NAME + 16];
+
+  smpCloseSample();
+  double insts = (double)(smpSampling ? smpGetROIInsts() : smpTotalInsts);
+  if (smpSampling)
+    fprintf(fp,
+        "Instruction statistics, %" PRIu64 " samples of %" PRIu64
+        " instructions every %" PRIu64 "\n",
+        smpNumSamples, smpLength, smpPeriod);
+  else
+    fprintf(fp, "Instruction statistics\n");
+  fprintf(fp, "%-20s %16s %16s %7s\n", "", "ESTIMATE", "95% CI (+-)", "%");
+  // The instructions are counted even outside of the samples
+  smpPrintRow(fp, "instructions", insts, 0, insts);
+  for (int i = 0; i < SMP_NUM_METRICS; i++)
+    smpPrintEstimate(fp, smpMetricNames[i], &smpMetrics[i], insts);
+
+  int n = 0;
+  for (int i = 0; i < SMP_MAX_PCS; i++) {
+    if (smpPCs[i].used && smpPCs[i].metric.total > 0)
+      sorted[n++] = &smpPCs[i];
+  }
+  qsort(sorted, (size_t)n, sizeof(t_smpPC *), smpComparePCs);
+  fprintf(fp, "\nMost executed instructions\n");
+  fprintf(fp, "%-20s %16s %16s %7s\n", "PC", "ESTIMATE", "95% CI (+-)", "%");
+  for (int i = 0; i < n && i < SMP_REPORT_PCS; i++) {
+    symFormat(name, sizeof(name), sorted[i]->pc);
+    smpPrintEstimate(fp, name, &sorted[i]->metric, insts);
+  }
+  if (smpUntracked > 0)
+    fprintf(fp, "(%" PRIu64 " instructions at untracked addresses)\n",
+        smpUntracked);
+}
+
+void smpPrintReport(FILE *fp)
+{
+  if (!smpStats)
+    return;
+  pthread_mutex_lock(&smpLock);
+  smpPrintReportLocked(fp);
+  pthread_mutex_unlock(&smpLock);
+}
+
+static void smpResetStats(void)
+{
+  smpSampleInsts = 0;
+  memset(smpSampleCounts, 0, sizeof(smpSampleCounts));
+  smpNumSamples = 0;
+  smpTotalInsts = 0;
+  memset(smpMetrics, 0, sizeof(smpMetrics));
+  memset(smpPCs, 0, sizeof(smpPCs));
+  smpNumTouched = 0;
+  smpUntracked = 0;
+  smpROIInsts = 0;
+  smpROIStart = cpuGetMainInstRetCount();
+}
+
+int smpControl(uint32_t command)
+{
+  if (command > SMP_CTL_STATS_DUMP)
+    return -1;
+  if (!smpActive)
+    return 0;
+
+  pthread_mutex_lock(&smpLock);
+  switch (command) {
+    case SMP_CTL_ROI_BEGIN:
+      if (!smpInROI) {
+        smpInROI = true;
+        smpROIStart = cpuGetMainInstRetCount();
+        smpUpdateMode();
+      }
+      break;
+    case SMP_CTL_ROI_END:
+      if (smpInROI) {
+        smpROIInsts += cpuGetMainInstRetCount() - smpROIStart;
+        smpInROI = false;
+        smpUpdateMode();
+      }
+      break;
+    case SMP_CTL_STATS_RESET:
+      smpResetStats();
+      break;
+    case SMP_CTL_STATS_DUMP:
+      if (smpStats)
+        smpPrintReportLocked(stderr);
+      break;
+  }
+  pthread_mutex_unlock(&smpLock);
+  return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Region of interest and sampled simulation.
+ *
+ * Programs control the simulation with the SIM_CONTROL system call (a7 =
+ * 2080), passing one of the SMP_CTL_* commands in a0. Outside of the region
+ * of interest, and between the samples when sampling is enabled, the
+ * simulator runs in fast-forward mode: instruction, memory access and branch
+ * events are not delivered to the analyses and plugins, so they cost
+ * nothing. In detailed mode the instructions of each class, the memory
+ * accesses and the most executed instructions are counted.
+ *
+ * When sampling, a sample of `length' instructions of hart zero is taken
+ * every `period' instructions, and the counts are extrapolated to the whole
+ * region of interest with 95% confidence intervals. */
+
+enum {
+  SMP_CTL_ROI_BEGIN = 0,
+  SMP_CTL_ROI_END = 1,
+  SMP_CTL_STATS_RESET = 2,
+  SMP_CTL_STATS_DUMP = 3
+};
+
+#define SMP_MAX_PCS 4096
+
+bool smpParseConfig(const char *spec, uint64_t *period, uint64_t *length);
+/* `roi' makes the simulation start outside of the region of interest.
+ * A `period' of zero disables sampling. */
+bool smpStart(
+    bool stats, bool roi, uint64_t period, uint64_t length, bool fusion);
+/* Number of ticks to run before calling smpAdvance() */
+uint64_t smpGetBatch(void);
+/* Counts the instructions retired by hart zero, which may be more than the
+ * ticks run when instructions are fused */
+void smpAdvance(uint64_t insts);
+/* Returns zero on success */
+int smpControl(uint32_t command);
+void smpPrintReport(FILE *fp);
+
+#endif
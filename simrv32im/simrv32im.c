@@ -1,14 +1,26 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <getopt.h>
 #include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
 #include "isa.h"
 #include "cpu.h"
 #include "memory.h"
 #include "loader.h"
 #include "supervisor.h"
 #include "debugger.h"
+#include "plugin.h"
+#include "trace.h"
+#include "cache.h"
+#include "pattern.h"
+#include "profile.h"
+#include "lines.h"
+#include "telemetry.h"
+#include "sample.h"
+#include "lockstep.h"
 
 
 void usage(const char *name)
@@ -16,10 +28,50 @@ void usage(const char *name)
   puts("ACSE RISC-V RV32IM simulator, (c) 2022-24 Politecnico di Milano");
   printf("usage: %s [options] executable\n\n", name);
   puts("Options:");
+  puts("  -c, --cache=SIZE:LINE:WAYS[,...]");
+  puts("                        Records the memory references of the program,");
+  puts("                          and prints the miss rates of instruction");
+  puts("                          and data caches with the given geometries");
   puts("  -d, --debug           Enters debug mode before starting execution");
   puts("  -e, --entry=ADDR      Force the entry point to ADDR");
+  puts("  -f, --fs-root=DIR     Allow the program to access files inside DIR");
+  puts("                          through the file I/O system calls");
+  puts("  -i, --inst-stats[=PERIOD:LENGTH]");
+  puts("                        Prints the number of instructions of each");
+  puts("                          class and the most executed ones. With");
+  puts("                          PERIOD:LENGTH, only samples LENGTH");
+  puts("                          instructions every PERIOD and extrapolates");
+  puts("                          the counts");
   puts("  -l, --load-addr=ADDR  Sets the executable loading address (only");
   puts("                          for executables in raw binary format)");
+  puts("  -L, --lanes=FILE      Runs a copy of the program for each line of");
+  puts("                          FILE in lockstep, with the line as input,");
+  puts("                          and prints the output of each copy");
+  puts("  -m, --mem-patterns    Prints the strides and reuse distances of the");
+  puts("                          memory accesses of each instruction, and");
+  puts("                          the working set size over time");
+  puts("  -M, --host-mmu        Maps the memory of the program in the address");
+  puts("                          space of the simulator, and uses the host");
+  puts("                          MMU to detect invalid accesses (Linux only)");
+  puts("  -p, --plugin=FILE[,ARGS]");
+  puts("                        Loads the plugin in the shared object FILE,");
+  puts("                          passing ARGS to it (can be repeated)");
+  puts("  -P, --profile         Prints the instructions spent in each");
+  puts("                          function, call graph edge, loop and");
+  puts("                          source line, the trip counts of the loops");
+  puts("                          and the source lines never executed");
+  puts("  -R, --roi             Runs the analyses only in the region of");
+  puts("                          interest marked by the program");
+  puts("  -s, --stats           Prints the number of executed instructions");
+  puts("                          and the simulation speed on exit");
+  puts("  -S, --stack-size=SIZE");
+  puts("                        Reserves SIZE bytes for the stack of each");
+  puts("                          hart, with an optional K or M suffix");
+  puts("                          (default 1M)");
+  puts("  -t, --telemetry=FILE[,N]");
+  puts("                        Publishes the progress of the simulation in");
+  puts("                          FILE every N instructions, to be viewed");
+  puts("                          with simtop");
   puts("  -x, --prg-exit-code   Exits the simulator with the same exit code");
   puts("                          as the simulated program. In case of faults");
   puts("                          produces POSIX-style exit codes.");
@@ -51,16 +103,74 @@ int exitCode(t_exitCode code, bool toPosix)
 }
 
 
+void printStats(uint64_t instRet, struct timespec *start, struct timespec *end)
+{
+  double seconds = (double)(end->tv_sec - start->tv_sec) +
+      (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+  fprintf(stderr, "Instructions retired: %" PRIu64 "\n", instRet);
+  fprintf(stderr, "Simulation time: %.6f s\n", seconds);
+  if (seconds > 0)
+    fprintf(stderr, "Simulation speed: %.3f MIPS\n",
+        (double)instRet / seconds / 1e6);
+}
+
+
+int runLanes(const char *inputs, bool stats, bool prgExitCode)
+{
+  if (!lckStart(inputs, cpuGetRegister(CPU_REG_PC), ldrGetImageEnd())) {
+    fprintf(stderr, "Could not read the inputs of the lanes, exiting.\n");
+    return exitCode(SIM_EXIT_INVALID_ARGS, prgExitCode);
+  }
+
+  struct timespec startTime, endTime;
+  clock_gettime(CLOCK_MONOTONIC, &startTime);
+  lckRun();
+  clock_gettime(CLOCK_MONOTONIC, &endTime);
+  lckPrintOutput(stdout, stderr);
+
+  if (stats) {
+    printStats(lckGetInstRetCount(), &startTime, &endTime);
+    uint64_t steps = lckGetStepCount();
+    fprintf(stderr, "Lockstep steps: %" PRIu64 "\n", steps);
+    if (steps > 0)
+      fprintf(stderr, "Average active lanes: %.2f\n",
+          (double)lckGetInstRetCount() / (double)steps);
+  }
+
+  t_lckLaneStatus status = lckGetStatus();
+  if (status == LCK_LANE_MEMORY_FAULT)
+    return exitCode(SIM_EXIT_SIGSEGV, prgExitCode);
+  else if (status == LCK_LANE_ILL_INST_FAULT)
+    return exitCode(SIM_EXIT_SIGILL, prgExitCode);
+  if (prgExitCode)
+    return lckGetExitCode();
+  return 0;
+}
+
+
 int main(int argc, char *argv[])
 {
   int ch;
   char *tmpStr;
   static const struct option options[] = {
+      {        "cache", required_argument, NULL, 'c'},
       {        "debug",       no_argument, NULL, 'd'},
       {        "entry", required_argument, NULL, 'e'},
+      {      "fs-root", required_argument, NULL, 'f'},
       {         "help",       no_argument, NULL, 'h'},
+      {   "inst-stats", optional_argument, NULL, 'i'},
       {    "load-addr", required_argument, NULL, 'l'},
+      {        "lanes", required_argument, NULL, 'L'},
+      {  "mem-patterns",       no_argument, NULL, 'm'},
+      {     "host-mmu",       no_argument, NULL, 'M'},
+      {       "plugin", required_argument, NULL, 'p'},
+      {      "profile",       no_argument, NULL, 'P'},
+      {          "roi",       no_argument, NULL, 'R'},
+      {        "stats",       no_argument, NULL, 's'},
+      {   "stack-size", required_argument, NULL, 'S'},
+      {    "telemetry", required_argument, NULL, 't'},
       {"prg-exit-code",       no_argument, NULL, 'x'},
+      {           NULL,                 0, NULL,   0}
   };
 
   char *name = argv[0];
@@ -69,9 +179,34 @@ int main(int argc, char *argv[])
   bool entryIsSet = false;
   t_memAddress load = 0;
   bool prgExitCode = false;
+  bool stats = false;
+  bool memPatterns = false;
+  bool hostMMU = false;
+  bool profile = false;
+  bool instStats = false;
+  bool roi = false;
+  uint64_t samplePeriod = 0, sampleLength = 0;
+  char *telemetry = NULL;
+  uint64_t telemetryInterval = TLM_DEFAULT_INTERVAL;
+  static t_cacheConfig cacheConfigs[CACHE_MAX_CONFIGS];
+  int numCacheConfigs = 0;
+  char *fsRoot = NULL;
+  char *lanes = NULL;
+  unsigned long long stackSize;
 
-  while ((ch = getopt_long(argc, argv, "de:hl:x", options, NULL)) != -1) {
+  while ((ch = getopt_long(argc, argv, "c:de:f:hi::l:L:mMp:PRsS:t:x",
+              options, NULL)) != -1) {
     switch (ch) {
+      case 'c':
+        for (tmpStr = strtok(optarg, ","); tmpStr; tmpStr = strtok(NULL, ",")) {
+          if (numCacheConfigs == CACHE_MAX_CONFIGS ||
+              !cacheParseConfig(tmpStr, &cacheConfigs[numCacheConfigs])) {
+            fprintf(stderr, "Invalid cache configuration %s\n", tmpStr);
+            return 1;
+          }
+          numCacheConfigs++;
+        }
+        break;
       case 'd':
         debug = true;
         break;
@@ -83,6 +218,16 @@ int main(int argc, char *argv[])
           return 1;
         }
         break;
+      case 'f':
+        fsRoot = optarg;
+        break;
+      case 'i':
+        instStats = true;
+        if (optarg && !smpParseConfig(optarg, &samplePeriod, &sampleLength)) {
+          fprintf(stderr, "Invalid sampling configuration\n");
+          return 1;
+        }
+        break;
       case 'l':
         load = (t_memAddress)strtoul(optarg, &tmpStr, 0);
         if (tmpStr == optarg) {
@@ -90,6 +235,61 @@ int main(int argc, char *argv[])
           return 1;
         }
         break;
+      case 'L':
+        lanes = optarg;
+        break;
+      case 'm':
+        memPatterns = true;
+        break;
+      case 'M':
+        hostMMU = true;
+        break;
+      case 'p':
+        tmpStr = strchr(optarg, ',');
+        if (tmpStr)
+          *tmpStr++ = '\0';
+        if (plgLoad(optarg, tmpStr) != PLG_NO_ERROR) {
+          fprintf(stderr, "Could not load plugin %s\n", optarg);
+          return 1;
+        }
+        break;
+      case 'P':
+        profile = true;
+        break;
+      case 'R':
+        roi = true;
+        break;
+      case 's':
+        stats = true;
+        break;
+      case 'S':
+        stackSize = strtoull(optarg, &tmpStr, 0);
+        if (*tmpStr == 'k' || *tmpStr == 'K') {
+          stackSize *= 1024;
+          tmpStr++;
+        } else if (*tmpStr == 'm' || *tmpStr == 'M') {
+          stackSize *= 1024 * 1024;
+          tmpStr++;
+        }
+        if (tmpStr == optarg || *tmpStr != '\0' ||
+            stackSize > UINT32_MAX ||
+            svSetStackSize((t_memSize)stackSize) != SV_NO_ERROR) {
+          fprintf(stderr, "Invalid stack size\n");
+          return 1;
+        }
+        break;
+      case 't':
+        telemetry = optarg;
+        tmpStr = strchr(optarg, ',');
+        if (tmpStr) {
+          *tmpStr++ = '\0';
+          telemetryInterval = strtoull(tmpStr, &tmpStr, 0);
+          if (*tmpStr != '\0' || telemetryInterval == 0) {
+            fprintf(stderr, "Invalid telemetry interval\n");
+            return 1;
+          }
+        }
+        break;
       case 'x':
         prgExitCode = true;
         break;
@@ -112,23 +312,64 @@ int main(int argc, char *argv[])
     return exitCode(SIM_EXIT_INVALID_ARGS, prgExitCode);
   }
 
-  if (debug)
+  if (lanes && (debug || numCacheConfigs > 0 || memPatterns || profile ||
+                   instStats || roi || telemetry || hostMMU || plgEvents)) {
+    fprintf(stderr, "Lockstep execution does not support the debugger, the "
+                    "analyses and the plugins, exiting.\n");
+    return exitCode(SIM_EXIT_INVALID_ARGS, prgExitCode);
+  }
+  if (hostMMU && memEnableHostMMU() != MEM_NO_ERROR) {
+    fprintf(stderr, "The host MMU backend is not available, exiting.\n");
+    return 1;
+  }
+  // Breakpoints and single stepping work on individual instructions, and
+  // plugins must observe every one of them
+  if (debug) {
     dbgEnable();
+    cpuSetFusion(false);
+  }
+  if (numCacheConfigs > 0 && !trcStart()) {
+    fprintf(stderr, "Could not record the memory references, exiting.\n");
+    return 1;
+  }
+  if (memPatterns && !patStart()) {
+    fprintf(stderr, "Could not start the memory access analysis, exiting.\n");
+    return 1;
+  }
+  if (telemetry && !tlmStart(telemetry, telemetryInterval)) {
+    fprintf(stderr, "Could not create the telemetry file, exiting.\n");
+    return 1;
+  }
+  if (profile && !prfStart()) {
+    fprintf(stderr, "Could not start the profiler, exiting.\n");
+    return 1;
+  }
+  if (plgEvents & (PLG_EVENT_INST_RETIRED | PLG_EVENT_BRANCH))
+    cpuSetFusion(false);
+  if ((instStats || roi) &&
+      !smpStart(instStats, roi, samplePeriod, sampleLength, !debug)) {
+    fprintf(stderr, "Could not start the instruction statistics, exiting.\n");
+    return 1;
+  }
 
   t_ldrError ldrErr;
-  t_ldrFileType excType = ldrDetectExecType(argv[0]);
+  t_ldrFileType excType = LDR_FORMAT_DETECT_ERROR;
+  if (ldrOpen(argv[0]) == LDR_NO_ERROR)
+    excType = ldrDetectExecType();
   if (excType == LDR_FORMAT_BINARY) {
     if (!entryIsSet)
       entry = load;
-    ldrErr = ldrLoadBinary(argv[0], load, entry);
+    ldrErr = ldrLoadBinary(load, entry);
   } else if (excType == LDR_FORMAT_ELF) {
-    ldrErr = ldrLoadELF(argv[0]);
+    ldrErr = ldrLoadELF();
     if (entryIsSet)
       cpuSetRegister(CPU_REG_PC, entry);
   } else {
+    ldrClose();
     fprintf(stderr, "Could not open executable, exiting.\n");
     return exitCode(SIM_EXIT_INVALID_FILE, prgExitCode);
   }
+  ldrClose();
 
   if (ldrErr == LDR_INVALID_ARCH) {
     fprintf(stderr, "Not a valid RISC-V executable, exiting.\n");
@@ -141,22 +382,72 @@ int main(int argc, char *argv[])
     return exitCode(SIM_EXIT_INVALID_FILE, prgExitCode);
   }
 
-  t_svStatus status = initSupervisor();
+  if (lanes)
+    return runLanes(lanes, stats, prgExitCode);
+  // The source lines are only known once the program is loaded
+  if (profile && linAvailable() && !linStart()) {
+    fprintf(stderr, "Could not start the profiler, exiting.\n");
+    return 1;
+  }
+
+  t_svStatus status = initSupervisor(ldrGetImageEnd());
+  if (fsRoot && svSetFileRoot(fsRoot) != SV_NO_ERROR) {
+    fprintf(stderr, "Could not set the file system root, exiting.\n");
+    return exitCode(SIM_EXIT_INVALID_ARGS, prgExitCode);
+  }
 
   if (debug)
     dbgRequestEnter();
 
+  struct timespec startTime, endTime;
+  clock_gettime(CLOCK_MONOTONIC, &startTime);
+  // Telemetry and switches between fast-forward and detailed simulation
+  // only happen between batches of instructions, so that they cost nothing
+  // in the inner loop
+  uint64_t telemetryLeft = telemetry ? telemetryInterval : UINT64_MAX;
   while (status == SV_STATUS_RUNNING) {
-    status = svVMTick();
+    uint64_t batch = smpGetBatch(), i;
+    if (batch > telemetryLeft)
+      batch = telemetryLeft;
+    uint64_t instRet = cpuGetMainInstRetCount();
+    status = svVMRun(batch, &i);
+    smpAdvance(cpuGetMainInstRetCount() - instRet);
+    telemetryLeft -= i;
+    if (telemetryLeft == 0) {
+      tlmUpdate();
+      telemetryLeft = telemetryInterval;
+    }
   }
+  svStopAllHarts();
+  clock_gettime(CLOCK_MONOTONIC, &endTime);
+  plgNotifyExit();
+  tlmStop();
+
+  if (numCacheConfigs > 0) {
+    static t_cacheStats cacheStats[CACHE_MAX_CONFIGS];
+    if (!trcIsComplete())
+      fprintf(stderr, "Out of memory, the reference trace is truncated.\n");
+    cacheSimulate(cacheConfigs, cacheStats, numCacheConfigs);
+    cachePrintTable(stderr, cacheConfigs, cacheStats, numCacheConfigs);
+  }
+  if (memPatterns)
+    patPrintReport(stderr);
+  if (profile) {
+    prfPrintReport(stderr);
+    linPrintReport(stderr);
+  }
+  smpPrintReport(stderr);
+
+  if (stats)
+    printStats(svGetInstRetCount(), &startTime, &endTime);
 
   if (status == SV_STATUS_MEMORY_FAULT) {
     fprintf(stderr, "Memory fault at address 0x%08x, execution stopped.\n",
-        memGetLastFaultAddress());
+        svGetFaultAddress());
     return exitCode(SIM_EXIT_SIGSEGV, prgExitCode);
   } else if (status == SV_STATUS_ILL_INST_FAULT) {
     fprintf(stderr, "Illegal instruction at address 0x%08x\n",
-        cpuGetRegister(CPU_REG_PC));
+        svGetFaultPC());
     return exitCode(SIM_EXIT_SIGILL, prgExitCode);
   }
   if (prgExitCode)
@@ -0,0 +1,193 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/mman.h>
+#endif
+#include "telemetry.h"
+
+
+void usage(const char *name)
+{
+  puts("Telemetry viewer for simrv32im, (c) 2022-24 Politecnico di Milano");
+  printf("usage: %s [options] file\n\n", name);
+  puts("Shows the telemetry published by \"simrv32im -t file\".\n");
+  puts("Options:");
+  puts("  -d, --delay=MS        Refreshes the screen every MS milliseconds");
+  puts("                          (default 1000)");
+  puts("  -n, --once            Prints the telemetry once and exits");
+  puts("  -h, --help            Displays available options");
+}
+
+
+#ifndef _WIN32
+
+/* Copies the page while the simulator is not updating it */
+static bool readPage(const volatile t_tlmPage *page, t_tlmPage *out)
+{
+  for (int tries = 0; tries < 1000; tries++) {
+    uint32_t seq = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+    if (seq & 1)
+      continue;
+    memcpy(out, (const void *)page, sizeof(t_tlmPage));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&page->sequence, __ATOMIC_RELAXED) == seq)
+      return true;
+  }
+  return false;
+}
+
+static void printSize(uint64_t size)
+{
+  if (size >= 1024 * 1024)
+    printf("%.1f MiB", (double)size / (1024.0 * 1024.0));
+  else
+    printf("%.1f KiB", (double)size / 1024.0);
+}
+
+static void printPage(const t_tlmPage *page, bool alive)
+{
+  uint64_t elapsed = (page->updateTime - page->startTime) / 1000000000;
+  const char *state = page->state == TLM_STATE_EXITED ? "exited" :
+      alive ? "running" : "not responding";
+  printf("simrv32im pid %" PRId64 " %s, %02" PRIu64 ":%02" PRIu64 ":%02" PRIu64
+         "\n\n",
+      page->pid, state, elapsed / 3600, elapsed / 60 % 60, elapsed % 60);
+  printf("Instructions retired:  %" PRIu64 "\n", page->instRet);
+  printf("Current PC:            0x%08" PRIx32 "\n", page->pc);
+  double average = 0;
+  if (page->updateTime > page->startTime)
+    average = (double)page->instRet * 1e3 /
+        (double)(page->updateTime - page->startTime);
+  if (page->state == TLM_STATE_EXITED)
+    printf("Speed:                 %.3f MIPS on average", average);
+  else
+    printf("Speed:                 %.3f MIPS (average %.3f MIPS)",
+        (double)page->instPerSecond / 1e6, average);
+  printf("\nHarts:                 %" PRIu32 "\n", page->numHarts);
+  printf("Memory footprint:      ");
+  printSize(page->memFootprint);
+  printf("\n\n%10s %14s\n", "SYSCALL", "CALLS");
+  uint32_t n = page->numSyscalls;
+  if (n > TLM_MAX_SYSCALLS)
+    n = TLM_MAX_SYSCALLS;
+  for (uint32_t i = 0; i < n; i++)
+    printf("%10" PRIu32 " %14" PRIu64 "\n", page->syscalls[i].number,
+        page->syscalls[i].count);
+  fflush(stdout);
+}
+
+static int viewPage(const char *path, long delay, bool once)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Could not open %s\n", path);
+    return 1;
+  }
+  void *map = mmap(NULL, sizeof(t_tlmPage), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    fprintf(stderr, "Could not map %s\n", path);
+    return 1;
+  }
+  const volatile t_tlmPage *page = map;
+
+  while (__atomic_load_n(&page->magic, __ATOMIC_ACQUIRE) != TLM_MAGIC) {
+    if (once) {
+      fprintf(stderr, "%s is not a telemetry file\n", path);
+      return 1;
+    }
+    usleep(100000);
+  }
+  if (page->version != TLM_VERSION) {
+    fprintf(stderr, "Unsupported telemetry version %" PRIu32 "\n",
+        page->version);
+    return 1;
+  }
+
+  struct timespec wait = {delay / 1000, delay % 1000 * 1000000};
+  struct timespec retry = {0, 1000000};
+  int res = 0;
+  for (;;) {
+    t_tlmPage copy;
+    if (!readPage(page, &copy)) {
+      // An update stays unfinished if the simulator died in the middle
+      if (kill((pid_t)page->pid, 0) != 0) {
+        fprintf(stderr, "The simulator stopped while updating %s\n", path);
+        res = 1;
+        break;
+      }
+      nanosleep(&retry, NULL);
+      continue;
+    }
+    bool alive = kill((pid_t)copy.pid, 0) == 0;
+    if (!once)
+      printf("\033[H\033[2J");
+    printPage(&copy, alive);
+    if (once || copy.state == TLM_STATE_EXITED || !alive)
+      break;
+    nanosleep(&wait, NULL);
+  }
+  munmap(map, sizeof(t_tlmPage));
+  return res;
+}
+
+#endif
+
+
+int main(int argc, char *argv[])
+{
+  int ch;
+  char *tmpStr;
+  static const struct option options[] = {
+      {"delay", required_argument, NULL, 'd'},
+      { "help",       no_argument, NULL, 'h'},
+      { "once",       no_argument, NULL, 'n'},
+      {   NULL,                 0, NULL,   0},
+  };
+
+  char *name = argv[0];
+  long delay = 1000;
+  bool once = false;
+
+  while ((ch = getopt_long(argc, argv, "d:hn", options, NULL)) != -1) {
+    switch (ch) {
+      case 'd':
+        delay = strtol(optarg, &tmpStr, 0);
+        if (tmpStr == optarg || delay <= 0) {
+          fprintf(stderr, "Invalid delay\n");
+          return 1;
+        }
+        break;
+      case 'n':
+        once = true;
+        break;
+      case 'h':
+        usage(name);
+        return 0;
+      default:
+        usage(name);
+        return 1;
+    }
+  }
+  argc -= optind;
+  argv += optind;
+
+  if (argc != 1) {
+    usage(name);
+    return 1;
+  }
+#ifdef _WIN32
+  fprintf(stderr, "Telemetry is not supported on this platform\n");
+  return 1;
+#else
+  return viewPage(argv[0], delay, once);
+#endif
+}
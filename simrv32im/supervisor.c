@@ -1,48 +1,627 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
 #include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#if defined(SYS_openat2) && __has_include(<linux/openat2.h>)
+#include <linux/openat2.h>
+#define SV_HAVE_OPENAT2
+#endif
+#endif
 #include "supervisor.h"
 #include "memory.h"
 #include "debugger.h"
+#include "plugin.h"
+#include "sample.h"
 
-const t_memAddress svStackTop = 0x80000000;
-t_memAddress svStackBottom;
+typedef struct svHart {
+  t_cpuHart *cpu;
+  pthread_t thread;
+  t_memAddress stackTop;
+  t_memAddress stackBottom;
+  t_memAddress stackLimit;
+  t_cpuURegValue arg;
+  uint64_t instRet;
+  bool finished;
+} t_svHart;
+
+const t_memAddress svStackTop = SV_STACK_TOP;
+t_memSize svStackSize = SV_DEFAULT_STACK_SIZE;
+t_memAddress svHeapStart;
+t_memAddress svHeapBreak;
 t_isaInt svExitCode;
+// Directory open with -f, all the files are opened relative to it
+int svFileRoot = -1;
+int svFiles[SV_MAX_FILES];
+
+t_svHart svHarts[SV_MAX_HARTS];
+unsigned int svNumHarts = 1;
+__thread t_svHart *svCurHart = &svHarts[0];
+// Protects all the supervisor state. Every system call runs with the lock
+// held, so that the harts observe them in a sequential order, except while
+// it waits for host I/O.
+pthread_mutex_t svLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t svHartFinished = PTHREAD_COND_INITIALIZER;
+// Set once by the first hart that ends the program, polled by the others
+t_svStatus svStopStatus = SV_STATUS_RUNNING;
+t_memAddress svFaultAddress;
+t_cpuURegValue svFaultPC;
+// Instructions retired by the harts which were already joined
+uint64_t svJoinedInstRet = 0;
+
+
+t_svError svSetStackSize(t_memSize size)
+{
+  if (size == 0 || size % SV_STACK_PAGE_SIZE != 0 || size >= svStackTop)
+    return SV_MEMORY_ERROR;
+  svStackSize = size;
+  return SV_NO_ERROR;
+}
+
+t_memSize svGetStackSize(void)
+{
+  return svStackSize;
+}
 
 
-t_svError initSupervisor(void)
+t_svError initSupervisor(t_memAddress programBreak)
 {
-  svStackBottom = svStackTop - SV_STACK_PAGE_SIZE;
-  t_memError merr = memMapArea(svStackBottom, SV_STACK_PAGE_SIZE, NULL);
+  for (int i = 0; i < SV_MAX_FILES; i++)
+    svFiles[i] = -1;
+
+  // The whole stack is mapped up front, its pages only take host memory
+  // once they are touched. Hart zero can still grow past it one page at a
+  // time, as long as no other hart is started.
+  t_svHart *hart = &svHarts[0];
+  hart->stackTop = svStackTop;
+  hart->stackBottom = svStackTop - svStackSize;
+  hart->stackLimit = 0;
+  t_memError merr = memMapArea(hart->stackBottom, svStackSize, NULL);
   if (merr != MEM_NO_ERROR)
     return SV_MEMORY_ERROR;
   cpuSetRegister(CPU_REG_SP, svStackTop - 4);
+
+  svHeapStart = (programBreak + SV_HEAP_PAGE_SIZE - 1) &
+      ~(t_memAddress)(SV_HEAP_PAGE_SIZE - 1);
+  svHeapBreak = svHeapStart;
   return SV_NO_ERROR;
 }
 
 
-void svExpandStack(void)
+/* End of the heap pages which contain the program break */
+static t_memAddress svGetHeapEnd(void)
+{
+  return (svHeapBreak + SV_HEAP_PAGE_SIZE - 1) &
+      ~(t_memAddress)(SV_HEAP_PAGE_SIZE - 1);
+}
+
+/* Maps the heap pages in the given range which were never touched. Returns
+ * false if one of them could not be mapped. */
+static bool svMaterializeHeap(t_memAddress addr, t_memSize size)
+{
+  t_memAddress end = addr + size;
+  if (end < addr || end > svHeapBreak)
+    end = svHeapBreak;
+  if (addr < svHeapStart)
+    addr = svHeapStart;
+
+  t_memAddress page = addr & ~(t_memAddress)(SV_HEAP_PAGE_SIZE - 1);
+  for (; page < end; page += SV_HEAP_PAGE_SIZE) {
+    t_memError err = memMapArea(page, SV_HEAP_PAGE_SIZE, NULL);
+    if (err == MEM_NO_ERROR)
+      continue;
+    // pages which were already touched are not remapped, but they must
+    // not be partially taken by something else
+    uint8_t *buf;
+    t_memSize avail;
+    if (err != MEM_EXTENT_MAPPED ||
+        memGetHostBuffer(page, SV_HEAP_PAGE_SIZE, &buf, &avail) !=
+            MEM_NO_ERROR ||
+        avail != SV_HEAP_PAGE_SIZE)
+      return false;
+  }
+  return true;
+}
+
+/* Lowest address reserved to the stacks. Hart zero grows its stack freely
+ * until another hart is started, afterwards each hart owns a window of
+ * svStackSize bytes below the top of the stack. */
+static t_memAddress svGetStacksBottom(void)
+{
+  if (svNumHarts == 1)
+    return svHarts[0].stackBottom;
+  return svStackTop - svNumHarts * svStackSize;
+}
+
+/* Highest program break, leaving a guard page below the stacks. The heap is
+ * mapped in whole pages, none of which may overlap the stacks. */
+static t_memAddress svGetHeapLimit(void)
+{
+  return (svGetStacksBottom() - SV_STACK_PAGE_SIZE) &
+      ~(t_memAddress)(SV_HEAP_PAGE_SIZE - 1);
+}
+
+bool svHandleMemoryFault(void)
 {
+  t_svHart *hart = svCurHart;
   t_memAddress faultAddr = memGetLastFaultAddress();
-  if (faultAddr < svStackBottom &&
-      faultAddr >= (svStackBottom - SV_STACK_PAGE_SIZE)) {
-    svStackBottom -= SV_STACK_PAGE_SIZE;
-    memMapArea(svStackBottom, SV_STACK_PAGE_SIZE, NULL);
+  bool handled = false;
+
+  pthread_mutex_lock(&svLock);
+  if (faultAddr < hart->stackBottom &&
+      faultAddr >= (hart->stackBottom - SV_STACK_PAGE_SIZE) &&
+      faultAddr >= hart->stackLimit && faultAddr >= svGetHeapEnd()) {
+    handled = memMapArea(hart->stackBottom - SV_STACK_PAGE_SIZE,
+                  SV_STACK_PAGE_SIZE, NULL) == MEM_NO_ERROR;
+    if (handled)
+      hart->stackBottom -= SV_STACK_PAGE_SIZE;
+  } else if (faultAddr >= svHeapStart && faultAddr < svHeapBreak) {
+    handled = svMaterializeHeap(faultAddr, 1);
   }
+  pthread_mutex_unlock(&svLock);
+  return handled;
 }
 
 
-enum {
-  SV_SYSCALL_PRINT_INT = 1,
-  SV_SYSCALL_READ_INT = 5,
-  SV_SYSCALL_EXIT_0 = 10,
-  SV_SYSCALL_PRINT_CHAR = 11,
-  SV_SYSCALL_READ_CHAR = 12,
-  SV_SYSCALL_EXIT = 93
-};
+static int32_t svSysSbrk(t_cpuURegValue increment)
+{
+  t_memAddress oldBreak = svHeapBreak;
+  t_memAddress newBreak = oldBreak + increment;
+  t_memAddress limit = svGetHeapLimit();
+  if ((t_cpuSRegValue)increment >= 0) {
+    if (newBreak < oldBreak || newBreak > limit)
+      return -1;
+  } else {
+    if (newBreak > oldBreak || newBreak < svHeapStart)
+      return -1;
+  }
+  svHeapBreak = newBreak;
+  return (int32_t)oldBreak;
+}
 
-t_svStatus svHandleEnvCall(void)
+static int32_t svSysBrk(t_memAddress newBreak)
+{
+  t_memAddress limit = svGetHeapLimit();
+  if (newBreak >= svHeapStart && newBreak <= limit)
+    svHeapBreak = newBreak;
+  return (int32_t)svHeapBreak;
+}
+
+
+t_svError svSetFileRoot(const char *path)
+{
+  int fd = open(path, O_RDONLY | O_DIRECTORY);
+  if (fd < 0)
+    return SV_FILE_ERROR;
+  if (svFileRoot >= 0)
+    close(svFileRoot);
+  svFileRoot = fd;
+  return SV_NO_ERROR;
+}
+
+
+static bool svCheckGuestRange(t_memAddress addr, t_memSize size)
+{
+  if (addr + size < addr)
+    return false;
+  if (!svMaterializeHeap(addr, size))
+    return false;
+  while (size > 0) {
+    uint8_t *buf;
+    t_memSize chunk;
+    if (memGetHostBuffer(addr, size, &buf, &chunk) != MEM_NO_ERROR)
+      return false;
+    addr += chunk;
+    size -= chunk;
+  }
+  return true;
+}
+
+/* Reads through the host buffers, as system calls must not fault */
+static bool svReadGuestString(t_memAddress addr, char *out, size_t bufsz)
+{
+  size_t i = 0;
+  while (i < bufsz) {
+    uint8_t *buf;
+    t_memSize chunk;
+    if (memGetHostBuffer(addr + (t_memAddress)i, (t_memSize)(bufsz - i), &buf,
+            &chunk) != MEM_NO_ERROR)
+      return false;
+    for (t_memSize j = 0; j < chunk; j++, i++) {
+      out[i] = (char)buf[j];
+      if (buf[j] == '\0')
+        return true;
+    }
+  }
+  return false;
+}
+
+static bool svPathIsConfined(const char *path)
+{
+  if (path[0] == '\0' || path[0] == '/' || path[0] == '\\' ||
+      strchr(path, ':'))
+    return false;
+  const char *comp = path;
+  while (*comp != '\0') {
+    size_t len = strcspn(comp, "/\\");
+    if (len == 2 && comp[0] == '.' && comp[1] == '.')
+      return false;
+    comp += len;
+    if (*comp != '\0')
+      comp++;
+  }
+  return true;
+}
+
+/* Opens a path which svPathIsConfined accepted below the file system root.
+ * The path is resolved by the kernel without leaving the root where openat2
+ * is available. Otherwise it is walked one component at a time, and no
+ * symbolic link is followed. */
+static int svOpenBeneathRoot(const char *path, int flags)
+{
+#ifdef SV_HAVE_OPENAT2
+  struct open_how how = {0};
+  how.flags = (uint64_t)flags;
+  how.mode = flags & O_CREAT ? 0666 : 0;
+  how.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+  int fd = (int)syscall(SYS_openat2, svFileRoot, path, &how, sizeof(how));
+  if (fd >= 0 || (errno != ENOSYS && errno != EPERM))
+    return fd;
+#endif
+  int dir = svFileRoot;
+  const char *comp = path;
+  for (;;) {
+    size_t len = strcspn(comp, "/");
+    char name[SV_MAX_PATH];
+    memcpy(name, comp, len);
+    name[len] = '\0';
+    comp += len;
+    while (*comp == '/')
+      comp++;
+    int fd;
+    if (*comp == '\0')
+      fd = openat(dir, name, flags | O_NOFOLLOW, 0666);
+    else
+      fd = openat(dir, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+    if (dir != svFileRoot)
+      close(dir);
+    if (fd < 0 || *comp == '\0')
+      return fd;
+    dir = fd;
+  }
+}
+
+static int svGetHostFile(t_cpuURegValue fd)
+{
+  if (fd < 3 || fd >= SV_MAX_FILES)
+    return -1;
+  return svFiles[fd];
+}
+
+
+static int32_t svSysOpen(t_memAddress pathAddr, t_cpuURegValue flags)
+{
+  char path[SV_MAX_PATH];
+  if (svFileRoot < 0 || !svReadGuestString(pathAddr, path, SV_MAX_PATH))
+    return -1;
+  if (!svPathIsConfined(path))
+    return -1;
+
+  int hostFlags;
+  if (flags == SV_OPEN_READ)
+    hostFlags = O_RDONLY;
+  else if (flags == SV_OPEN_WRITE)
+    hostFlags = O_WRONLY | O_CREAT | O_TRUNC;
+  else if (flags == SV_OPEN_APPEND)
+    hostFlags = O_WRONLY | O_CREAT | O_APPEND;
+  else
+    return -1;
+#ifdef O_BINARY
+  hostFlags |= O_BINARY;
+#endif
+
+  int fd;
+  for (fd = 3; fd < SV_MAX_FILES; fd++) {
+    if (svFiles[fd] < 0)
+      break;
+  }
+  if (fd == SV_MAX_FILES)
+    return -1;
+
+  int hostFd = svOpenBeneathRoot(path, hostFlags);
+  if (hostFd < 0)
+    return -1;
+  svFiles[fd] = hostFd;
+  return fd;
+}
+
+static int32_t svSysClose(t_cpuURegValue fd)
+{
+  int hostFd = svGetHostFile(fd);
+  if (hostFd < 0)
+    return -1;
+  svFiles[fd] = -1;
+  return close(hostFd) < 0 ? -1 : 0;
+}
+
+/* Called without svLock held, as reading and writing may block */
+static long svHostRead(
+    t_cpuURegValue fd, int hostFd, uint8_t *buf, size_t size)
+{
+  if (fd == 0) {
+    if (!isatty(fileno(stdin))) {
+      size_t n = fread(buf, 1, size, stdin);
+      return (n == 0 && ferror(stdin)) ? -1 : (long)n;
+    }
+    // Mimic the line discipline of terminals, otherwise interactive
+    // programs would block until the whole buffer is filled
+    size_t n = 0;
+    while (n < size) {
+      int c = getchar();
+      if (c == EOF)
+        break;
+      buf[n++] = (uint8_t)c;
+      if (c == '\n')
+        break;
+    }
+    return (long)n;
+  }
+  if (hostFd < 0)
+    return -1;
+  return (long)read(hostFd, buf, size);
+}
+
+static long svHostWrite(
+    t_cpuURegValue fd, int hostFd, uint8_t *buf, size_t size)
+{
+  if (fd == 1 || fd == 2) {
+    FILE *fp = fd == 1 ? stdout : stderr;
+    size_t n = fwrite(buf, 1, size, fp);
+    return (n == 0 && ferror(fp)) ? -1 : (long)n;
+  }
+  if (hostFd < 0)
+    return -1;
+  return (long)write(hostFd, buf, size);
+}
+
+static int32_t svSysReadWrite(
+    t_cpuURegValue fd, t_memAddress addr, t_cpuURegValue size, bool isWrite)
+{
+  if (size > INT32_MAX || !svCheckGuestRange(addr, size))
+    return -1;
+
+  // The other harts keep running while the host performs the I/O. Guest
+  // memory is never unmapped, so the buffers stay valid. Like on a host
+  // system, closing a file while another hart uses it is a race of the
+  // program.
+  int hostFd = svGetHostFile(fd);
+  int32_t total = 0;
+  while (size > 0) {
+    uint8_t *buf;
+    t_memSize chunk;
+    memGetHostBuffer(addr, size, &buf, &chunk);
+    long n;
+    pthread_mutex_unlock(&svLock);
+    if (isWrite)
+      n = svHostWrite(fd, hostFd, buf, chunk);
+    else
+      n = svHostRead(fd, hostFd, buf, chunk);
+    pthread_mutex_lock(&svLock);
+    if (n < 0)
+      return total > 0 ? total : -1;
+    total += (int32_t)n;
+    addr += (t_memAddress)n;
+    size -= (t_cpuURegValue)n;
+    if ((t_memSize)n < chunk)
+      break;
+  }
+  return total;
+}
+
+static int32_t svSysLSeek(
+    t_cpuURegValue fd, t_cpuURegValue offset, t_cpuURegValue whence)
+{
+  int hostFd = svGetHostFile(fd);
+  if (hostFd < 0)
+    return -1;
+  int hostWhence;
+  if (whence == 0)
+    hostWhence = SEEK_SET;
+  else if (whence == 1)
+    hostWhence = SEEK_CUR;
+  else if (whence == 2)
+    hostWhence = SEEK_END;
+  else
+    return -1;
+  off_t res = lseek(hostFd, (off_t)(int32_t)offset, hostWhence);
+  if (res < 0 || res > INT32_MAX)
+    return -1;
+  return (int32_t)res;
+}
+
+
+static t_svStatus svSysMemCopy(
+    t_memAddress dst, t_memAddress src, t_cpuURegValue size)
+{
+  if (!svCheckGuestRange(src, size) || !svCheckGuestRange(dst, size))
+    return SV_STATUS_MEMORY_FAULT;
+
+  // When the destination overlaps the tail of the source, a forward copy
+  // split over several areas would read bytes it has already overwritten.
+  uint8_t *tmp = NULL;
+  if (dst > src && dst - src < size) {
+    uint8_t *srcBuf, *dstBuf;
+    t_memSize srcChunk, dstChunk;
+    memGetHostBuffer(src, size, &srcBuf, &srcChunk);
+    memGetHostBuffer(dst, size, &dstBuf, &dstChunk);
+    if (srcChunk == size && dstChunk == size) {
+      memmove(dstBuf, srcBuf, size);
+      return SV_STATUS_RUNNING;
+    }
+    tmp = malloc(size);
+    if (!tmp)
+      return SV_STATUS_MEMORY_FAULT;
+    t_memAddress addr = src;
+    uint8_t *p = tmp;
+    for (t_cpuURegValue left = size; left > 0;) {
+      memGetHostBuffer(addr, left, &srcBuf, &srcChunk);
+      memcpy(p, srcBuf, srcChunk);
+      addr += srcChunk;
+      p += srcChunk;
+      left -= srcChunk;
+    }
+  }
+
+  uint8_t *p = tmp;
+  while (size > 0) {
+    uint8_t *srcBuf, *dstBuf;
+    t_memSize srcChunk, dstChunk;
+    memGetHostBuffer(dst, size, &dstBuf, &dstChunk);
+    t_memSize chunk = dstChunk;
+    if (tmp) {
+      memcpy(dstBuf, p, chunk);
+      p += chunk;
+    } else {
+      memGetHostBuffer(src, chunk, &srcBuf, &srcChunk);
+      chunk = srcChunk;
+      memmove(dstBuf, srcBuf, chunk);
+    }
+    dst += chunk;
+    src += chunk;
+    size -= chunk;
+  }
+  free(tmp);
+  return SV_STATUS_RUNNING;
+}
+
+static t_svStatus svSysMemSet(
+    t_memAddress dst, t_cpuURegValue value, t_cpuURegValue size)
+{
+  if (!svCheckGuestRange(dst, size))
+    return SV_STATUS_MEMORY_FAULT;
+  while (size > 0) {
+    uint8_t *buf;
+    t_memSize chunk;
+    memGetHostBuffer(dst, size, &buf, &chunk);
+    memset(buf, (int)(value & 0xFF), chunk);
+    dst += chunk;
+    size -= chunk;
+  }
+  return SV_STATUS_RUNNING;
+}
+
+static t_svStatus svSysMemCmp(
+    t_memAddress a, t_memAddress b, t_cpuURegValue size, int32_t *res)
+{
+  if (!svCheckGuestRange(a, size) || !svCheckGuestRange(b, size))
+    return SV_STATUS_MEMORY_FAULT;
+  *res = 0;
+  while (size > 0 && *res == 0) {
+    uint8_t *bufA, *bufB;
+    t_memSize chunkA, chunkB;
+    memGetHostBuffer(a, size, &bufA, &chunkA);
+    memGetHostBuffer(b, chunkA, &bufB, &chunkB);
+    int cmp = memcmp(bufA, bufB, chunkB);
+    *res = cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+    a += chunkB;
+    b += chunkB;
+    size -= chunkB;
+  }
+  return SV_STATUS_RUNNING;
+}
+
+
+static void svStop(t_svStatus status)
+{
+  if (svStopStatus != SV_STATUS_RUNNING)
+    return;
+  svFaultAddress = memGetLastFaultAddress();
+  svFaultPC = cpuGetRegister(CPU_REG_PC);
+  __atomic_store_n(&svStopStatus, status, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&svHartFinished);
+}
+
+static void *svHartMain(void *arg)
+{
+  t_svHart *hart = (t_svHart *)arg;
+  svCurHart = hart;
+  cpuSetCurrentHart(hart->cpu);
+  cpuSetRegister(CPU_REG_SP, hart->stackTop - 4);
+  cpuSetRegister(CPU_REG_A0, hart->arg);
+
+  // A hart ends when it exits, or after svEndTick stopped the program
+  svVMRun(UINT64_MAX, NULL);
+
+  pthread_mutex_lock(&svLock);
+  hart->instRet = cpuGetInstRetCount();
+  hart->finished = true;
+  pthread_cond_broadcast(&svHartFinished);
+  pthread_mutex_unlock(&svLock);
+  return NULL;
+}
+
+static int32_t svSysHartStart(t_memAddress pc, t_cpuURegValue arg)
+{
+  if (svNumHarts == SV_MAX_HARTS ||
+      svStackSize > svStackTop / (svNumHarts + 1))
+    return -1;
+  unsigned int id = svNumHarts;
+  t_svHart *hart = &svHarts[id];
+  hart->stackTop = svStackTop - id * svStackSize;
+  hart->stackLimit = hart->stackTop - svStackSize;
+  hart->stackBottom = hart->stackLimit;
+  hart->arg = arg;
+  hart->finished = false;
+
+  // The new stack window must not overlap the heap or the stack of hart
+  // zero, which becomes bounded from now on
+  if (svGetHeapEnd() > hart->stackLimit - SV_STACK_PAGE_SIZE)
+    return -1;
+  if (id == 1) {
+    if (svHarts[0].stackBottom < svStackTop - svStackSize)
+      return -1;
+    svHarts[0].stackLimit = svStackTop - svStackSize;
+  }
+  if (memMapArea(hart->stackBottom, svStackSize, NULL) != MEM_NO_ERROR)
+    return -1;
+
+  hart->cpu = cpuNewHart(id, pc);
+  if (!hart->cpu)
+    return -1;
+  svNumHarts++;
+  if (pthread_create(&hart->thread, NULL, svHartMain, hart) != 0) {
+    svNumHarts--;
+    cpuDeleteHart(hart->cpu);
+    hart->cpu = NULL;
+    return -1;
+  }
+  return (int32_t)id;
+}
+
+static int32_t svSysHartJoin(t_cpuURegValue id)
+{
+  if (id == 0 || id >= svNumHarts || &svHarts[id] == svCurHart)
+    return -1;
+  // the lock is released while waiting
+  while (!svHarts[id].finished && svStopStatus == SV_STATUS_RUNNING)
+    pthread_cond_wait(&svHartFinished, &svLock);
+  return 0;
+}
+
+
+static t_svStatus svDispatchEnvCall(void)
 {
   t_cpuURegValue syscallId = cpuGetRegister(CPU_REG_A7);
+  t_cpuURegValue a0 = cpuGetRegister(CPU_REG_A0);
+  t_cpuURegValue a1 = cpuGetRegister(CPU_REG_A1);
+  t_cpuURegValue a2 = cpuGetRegister(CPU_REG_A2);
+  t_svStatus status;
   int32_t ret;
 
   switch (syscallId) {
@@ -51,22 +630,92 @@ t_svStatus svHandleEnvCall(void)
       break;
     case SV_SYSCALL_READ_INT:
       fputs("int value? >", stdout);
+      pthread_mutex_unlock(&svLock);
       fscanf(stdin, "%" PRId32, &ret);
+      pthread_mutex_lock(&svLock);
       cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
       break;
     case SV_SYSCALL_EXIT_0:
-      svExitCode = 0;
+      if (svStopStatus == SV_STATUS_RUNNING)
+        svExitCode = 0;
       return SV_STATUS_TERMINATED;
     case SV_SYSCALL_PRINT_CHAR:
       putchar((int)cpuGetRegister(CPU_REG_A0));
       break;
     case SV_SYSCALL_READ_CHAR:
+      pthread_mutex_unlock(&svLock);
       ret = getchar();
+      pthread_mutex_lock(&svLock);
       cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
       break;
     case SV_SYSCALL_EXIT:
-      svExitCode = (int)cpuGetRegister(CPU_REG_A0);
+      if (svStopStatus == SV_STATUS_RUNNING)
+        svExitCode = (int)cpuGetRegister(CPU_REG_A0);
+      return SV_STATUS_TERMINATED;
+    case SV_SYSCALL_SBRK:
+      ret = svSysSbrk(a0);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_BRK:
+      ret = svSysBrk(a0);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_OPEN:
+      ret = svSysOpen(a0, a1);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_CLOSE:
+      ret = svSysClose(a0);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_READ:
+      ret = svSysReadWrite(a0, a1, a2, false);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_WRITE:
+      ret = svSysReadWrite(a0, a1, a2, true);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_LSEEK:
+      ret = svSysLSeek(a0, a1, a2);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_MEMCPY:
+    case SV_SYSCALL_MEMMOVE:
+      status = svSysMemCopy(a0, a1, a2);
+      if (status != SV_STATUS_RUNNING)
+        return status;
+      break;
+    case SV_SYSCALL_MEMSET:
+      status = svSysMemSet(a0, a1, a2);
+      if (status != SV_STATUS_RUNNING)
+        return status;
+      break;
+    case SV_SYSCALL_MEMCMP:
+      status = svSysMemCmp(a0, a1, a2, &ret);
+      if (status != SV_STATUS_RUNNING)
+        return status;
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_HART_START:
+      ret = svSysHartStart(a0, a1);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_HART_EXIT:
+      // stopping hart zero ends the whole program
+      if (svCurHart != &svHarts[0])
+        return SV_STATUS_HART_EXITED;
+      if (svStopStatus == SV_STATUS_RUNNING)
+        svExitCode = (int)a0;
       return SV_STATUS_TERMINATED;
+    case SV_SYSCALL_HART_JOIN:
+      ret = svSysHartJoin(a0);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
+    case SV_SYSCALL_SIM_CONTROL:
+      ret = smpControl(a0);
+      cpuSetRegister(CPU_REG_A0, (t_cpuURegValue)ret);
+      break;
     default:
       return SV_STATUS_INVALID_SYSCALL;
   }
@@ -74,41 +723,147 @@ t_svStatus svHandleEnvCall(void)
   return SV_STATUS_RUNNING;
 }
 
+t_svStatus svHandleEnvCall(void)
+{
+  pthread_mutex_lock(&svLock);
+  if (plgEvents & PLG_EVENT_SYSCALL)
+    plgNotifySyscall((uint32_t)(svCurHart - svHarts),
+        cpuGetRegister(CPU_REG_PC), cpuGetRegister(CPU_REG_A7));
+  t_svStatus status = svDispatchEnvCall();
+  pthread_mutex_unlock(&svLock);
+  return status;
+}
+
 
 t_isaInt svGetExitCode(void)
 {
   return svExitCode;
 }
 
+t_memAddress svGetFaultAddress(void)
+{
+  return svFaultAddress;
+}
 
-t_svStatus svVMTick(void)
+t_cpuURegValue svGetFaultPC(void)
+{
+  return svFaultPC;
+}
+
+uint64_t svGetInstRetCount(void)
+{
+  return cpuGetInstRetCount() + svJoinedInstRet;
+}
+
+unsigned int svGetNumHarts(void)
+{
+  return __atomic_load_n(&svNumHarts, __ATOMIC_RELAXED);
+}
+
+
+void svStopAllHarts(void)
+{
+  pthread_mutex_lock(&svLock);
+  svStop(SV_STATUS_KILLED);
+  pthread_mutex_unlock(&svLock);
+  for (unsigned int i = 1; i < svNumHarts; i++) {
+    pthread_join(svHarts[i].thread, NULL);
+    cpuDeleteHart(svHarts[i].cpu);
+    svJoinedInstRet += svHarts[i].instRet;
+  }
+  svNumHarts = 1;
+}
+
+
+static t_svStatus svHandleCpuStatus(t_cpuStatus cpuStatus)
 {
   t_svStatus status = SV_STATUS_RUNNING;
+  if (cpuStatus == CPU_STATUS_MEMORY_FAULT && svHandleMemoryFault()) {
+    cpuClearLastFault();
+    cpuStatus = cpuTick();
+  }
 
-  t_dbgResult dbgRes = dbgTick();
-  if (dbgRes == DBG_RESULT_EXIT) {
-    status = SV_STATUS_KILLED;
-  } else {
-    t_cpuStatus cpuStatus = cpuTick();
-    if (cpuStatus == CPU_STATUS_MEMORY_FAULT) {
-      svExpandStack();
+  if (cpuStatus == CPU_STATUS_ECALL_TRAP) {
+    status = svHandleEnvCall();
+    if (status == SV_STATUS_RUNNING)
       cpuClearLastFault();
-      cpuStatus = cpuTick();
-    }
+  } else if (cpuStatus == CPU_STATUS_EBREAK_TRAP) {
+    if (dbgGetEnabled() && svCurHart == &svHarts[0])
+      dbgRequestEnter();
+    cpuClearLastFault();
+  } else if (cpuStatus == CPU_STATUS_ILL_INST_FAULT)
+    status = SV_STATUS_ILL_INST_FAULT;
+  else if (cpuStatus == CPU_STATUS_MEMORY_FAULT)
+    status = SV_STATUS_MEMORY_FAULT;
+  return status;
+}
 
-    if (cpuStatus == CPU_STATUS_ECALL_TRAP) {
-      status = svHandleEnvCall();
-      if (status == SV_STATUS_RUNNING)
-        cpuClearLastFault();
-    } else if (cpuStatus == CPU_STATUS_EBREAK_TRAP) {
-      if (dbgGetEnabled())
-        dbgRequestEnter();
-      cpuClearLastFault();
-    } else if (cpuStatus == CPU_STATUS_ILL_INST_FAULT)
-      status = SV_STATUS_ILL_INST_FAULT;
-    else if (cpuStatus == CPU_STATUS_MEMORY_FAULT)
-      status = SV_STATUS_MEMORY_FAULT;
+static t_svStatus svEndTick(t_svStatus status)
+{
+  if (status != SV_STATUS_RUNNING && status != SV_STATUS_HART_EXITED) {
+    pthread_mutex_lock(&svLock);
+    svStop(status);
+    pthread_mutex_unlock(&svLock);
+  }
+  return status;
+}
+
+t_svStatus svVMTick(void)
+{
+  t_svStatus status = __atomic_load_n(&svStopStatus, __ATOMIC_ACQUIRE);
+  if (status != SV_STATUS_RUNNING)
+    return status;
+
+  // The debugger only controls hart zero
+  t_dbgResult dbgRes = DBG_RESULT_CONTINUE;
+  if (svCurHart == &svHarts[0])
+    dbgRes = dbgTick();
+  if (dbgRes == DBG_RESULT_EXIT)
+    status = SV_STATUS_KILLED;
+  else
+    status = svHandleCpuStatus(cpuTick());
+  return svEndTick(status);
+}
+
+
+#ifdef MEM_HOST_MMU_SUPPORTED
+/* Faults caught by the host MMU interrupt cpuTick and resume here, then they
+ * are handled like the ones reported by the memory functions. */
+static t_svStatus svVMRunHostMMU(uint64_t maxTicks, uint64_t *outTicks)
+{
+  // Both are live across the jump back from the fault handler
+  volatile uint64_t i = 0;
+  volatile t_svStatus status = SV_STATUS_RUNNING;
+  sigjmp_buf recovery;
+  if (sigsetjmp(recovery, 0) != 0) {
+    status = svEndTick(svHandleCpuStatus(cpuRaiseMemoryFault()));
+    i++;
   }
+  memSetFaultRecovery(&recovery);
+  while (i < maxTicks && status == SV_STATUS_RUNNING) {
+    status = svVMTick();
+    i++;
+  }
+  memSetFaultRecovery(NULL);
+  if (outTicks)
+    *outTicks = i;
+  return status;
+}
+#endif
 
+t_svStatus svVMRun(uint64_t maxTicks, uint64_t *outTicks)
+{
+#ifdef MEM_HOST_MMU_SUPPORTED
+  if (memHostMMUEnabled())
+    return svVMRunHostMMU(maxTicks, outTicks);
+#endif
+  uint64_t i = 0;
+  t_svStatus status = SV_STATUS_RUNNING;
+  while (i < maxTicks && status == SV_STATUS_RUNNING) {
+    status = svVMTick();
+    i++;
+  }
+  if (outTicks)
+    *outTicks = i;
   return status;
 }
@@ -3,13 +3,52 @@
 
 #include "isa.h"
 #include "cpu.h"
+#include "memory.h"
 
 #define SV_STACK_PAGE_SIZE 4096
+#define SV_HEAP_PAGE_SIZE 65536
+#define SV_MAX_FILES 32
+#define SV_MAX_PATH 1024
+#define SV_MAX_HARTS 16
+#define SV_DEFAULT_STACK_SIZE 0x100000
+#define SV_STACK_TOP 0x80000000
+
+/* Flags accepted by the open system call (same as RARS) */
+enum {
+  SV_OPEN_READ = 0,
+  SV_OPEN_WRITE = 1,
+  SV_OPEN_APPEND = 9
+};
+
+enum {
+  SV_SYSCALL_PRINT_INT = 1,
+  SV_SYSCALL_READ_INT = 5,
+  SV_SYSCALL_SBRK = 9,
+  SV_SYSCALL_EXIT_0 = 10,
+  SV_SYSCALL_PRINT_CHAR = 11,
+  SV_SYSCALL_READ_CHAR = 12,
+  SV_SYSCALL_CLOSE = 57,
+  SV_SYSCALL_LSEEK = 62,
+  SV_SYSCALL_READ = 63,
+  SV_SYSCALL_WRITE = 64,
+  SV_SYSCALL_EXIT = 93,
+  SV_SYSCALL_BRK = 214,
+  SV_SYSCALL_OPEN = 1024,
+  SV_SYSCALL_MEMCPY = 2048,
+  SV_SYSCALL_MEMMOVE = 2049,
+  SV_SYSCALL_MEMSET = 2050,
+  SV_SYSCALL_MEMCMP = 2051,
+  SV_SYSCALL_HART_START = 2064,
+  SV_SYSCALL_HART_EXIT = 2065,
+  SV_SYSCALL_HART_JOIN = 2066,
+  SV_SYSCALL_SIM_CONTROL = 2080
+};
 
 typedef int t_svError;
 enum {
   SV_NO_ERROR = 0,
-  SV_MEMORY_ERROR = -1
+  SV_MEMORY_ERROR = -1,
+  SV_FILE_ERROR = -2
 };
 
 typedef int t_svStatus;
@@ -17,14 +56,26 @@ enum {
   SV_STATUS_RUNNING = 0,
   SV_STATUS_TERMINATED = 1,
   SV_STATUS_KILLED = 2,
+  SV_STATUS_HART_EXITED = 3,
   SV_STATUS_MEMORY_FAULT = CPU_STATUS_MEMORY_FAULT,
   SV_STATUS_ILL_INST_FAULT = CPU_STATUS_ILL_INST_FAULT,
   SV_STATUS_INVALID_SYSCALL = -1000
 };
 
 
-t_svError initSupervisor(void);
+/* Sets the size of the stack reserved to each hart, which must be a multiple
+ * of SV_STACK_PAGE_SIZE. Must be called before initSupervisor. */
+t_svError svSetStackSize(t_memSize size);
+t_memSize svGetStackSize(void);
+t_svError initSupervisor(t_memAddress programBreak);
+t_svError svSetFileRoot(const char *path);
 t_svStatus svVMTick(void);
+t_svStatus svVMRun(uint64_t maxTicks, uint64_t *outTicks);
 t_isaInt svGetExitCode(void);
+t_memAddress svGetFaultAddress(void);
+t_cpuURegValue svGetFaultPC(void);
+uint64_t svGetInstRetCount(void);
+unsigned int svGetNumHarts(void);
+void svStopAllHarts(void);
 
 #endif
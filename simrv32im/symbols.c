@@ -0,0 +1,79 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include "symbols.h"
+
+typedef struct symEntry {
+  t_memAddress addr;
+  char name[SYM_MAX_NAME];
+} t_symEntry;
+
+t_symEntry *symTable = NULL;
+size_t symCount = 0;
+size_t symCapacity = 0;
+bool symSorted = true;
+
+
+bool symAdd(const char *name, t_memAddress addr)
+{
+  if (symCount == symCapacity) {
+    size_t newCapacity = symCapacity ? symCapacity * 2 : 64;
+    t_symEntry *newTable = realloc(symTable, newCapacity * sizeof(t_symEntry));
+    if (!newTable)
+      return false;
+    symTable = newTable;
+    symCapacity = newCapacity;
+  }
+  t_symEntry *sym = &symTable[symCount++];
+  sym->addr = addr;
+  strncpy(sym->name, name, SYM_MAX_NAME - 1);
+  sym->name[SYM_MAX_NAME - 1] = '\0';
+  symSorted = false;
+  return true;
+}
+
+static int symCompare(const void *a, const void *b)
+{
+  const t_symEntry *x = (const t_symEntry *)a, *y = (const t_symEntry *)b;
+  if (x->addr != y->addr)
+    return x->addr < y->addr ? -1 : 1;
+  return strcmp(x->name, y->name);
+}
+
+const char *symLookup(t_memAddress addr, t_memAddress *offset)
+{
+  if (!symSorted) {
+    qsort(symTable, symCount, sizeof(t_symEntry), symCompare);
+    symSorted = true;
+  }
+  // Find the first symbol after the address
+  size_t lo = 0, hi = symCount;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (symTable[mid].addr <= addr)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == 0)
+    return NULL;
+  // Prefer the first of multiple symbols at the same address
+  t_symEntry *sym = &symTable[lo - 1];
+  while (sym > symTable && sym[-1].addr == sym->addr)
+    sym--;
+  *offset = addr - sym->addr;
+  return sym->name;
+}
+
+void symFormat(char *buf, size_t bufSize, t_memAddress addr)
+{
+  t_memAddress offset;
+  const char *name = symLookup(addr, &offset);
+  if (!name)
+    snprintf(buf, bufSize, "0x%08" PRIx32, addr);
+  else if (offset == 0)
+    snprintf(buf, bufSize, "%s", name);
+  else
+    snprintf(buf, bufSize, "%s+0x%" PRIx32, name, offset);
+}
@@ -0,0 +1,20 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "memory.h"
+
+/* Symbols of the program, loaded from the symbol table of ELF executables.
+ * Used to print addresses as label names in reports. */
+
+#define SYM_MAX_NAME 64
+
+bool symAdd(const char *name, t_memAddress addr);
+/* Returns the symbol at or immediately before `addr', or NULL if there is
+ * none. The distance from the symbol is returned in `offset'. */
+const char *symLookup(t_memAddress addr, t_memAddress *offset);
+/* Writes `addr' as "symbol", "symbol+0xOFFSET" or "0xADDRESS". */
+void symFormat(char *buf, size_t bufSize, t_memAddress addr);
+
+#endif
@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#include "telemetry.h"
+#include "plugin.h"
+#include "supervisor.h"
+#include "memory.h"
+
+t_tlmPage *tlmPage = NULL;
+uint64_t tlmInterval = TLM_DEFAULT_INTERVAL;
+uint64_t tlmLastInstRet = 0;
+uint64_t tlmLastTime = 0;
+
+// Updated under the supervisor lock by the system call hook, and copied to
+// the page by tlmUpdate()
+t_tlmSyscallCount tlmSyscalls[TLM_MAX_SYSCALLS];
+uint32_t tlmNumSyscalls = 0;
+
+
+static uint64_t tlmGetTime(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+static void tlmSyscall(void *data, uint32_t hart, uint32_t pc, uint32_t number)
+{
+  uint32_t n = tlmNumSyscalls;
+  for (uint32_t i = 0; i < n; i++) {
+    if (tlmSyscalls[i].number == number) {
+      __atomic_fetch_add(&tlmSyscalls[i].count, 1, __ATOMIC_RELAXED);
+      return;
+    }
+  }
+  if (n == TLM_MAX_SYSCALLS)
+    return;
+  tlmSyscalls[n].number = number;
+  tlmSyscalls[n].count = 1;
+  __atomic_store_n(&tlmNumSyscalls, n + 1, __ATOMIC_RELEASE);
+}
+
+bool tlmStart(const char *path, uint64_t interval)
+{
+#ifdef _WIN32
+  return false;
+#else
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+  if (ftruncate(fd, sizeof(t_tlmPage)) < 0) {
+    close(fd);
+    return false;
+  }
+  void *page = mmap(
+      NULL, sizeof(t_tlmPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (page == MAP_FAILED)
+    return false;
+
+  t_plgHooks hooks = {0};
+  hooks.syscall = tlmSyscall;
+  if (plgRegister(&hooks) != PLG_NO_ERROR) {
+    munmap(page, sizeof(t_tlmPage));
+    return false;
+  }
+
+  tlmPage = (t_tlmPage *)page;
+  tlmInterval = interval;
+  tlmLastTime = tlmGetTime();
+  tlmPage->version = TLM_VERSION;
+  tlmPage->pid = (int64_t)getpid();
+  tlmPage->startTime = tlmLastTime;
+  tlmPage->updateTime = tlmLastTime;
+  tlmPage->state = TLM_STATE_RUNNING;
+  // Readers ignore the page until the magic number appears
+  __atomic_store_n(&tlmPage->magic, TLM_MAGIC, __ATOMIC_RELEASE);
+  return true;
+#endif
+}
+
+uint64_t tlmGetInterval(void)
+{
+  return tlmInterval;
+}
+
+void tlmUpdate(void)
+{
+  if (!tlmPage)
+    return;
+  uint64_t now = tlmGetTime();
+  uint64_t instRet = svGetInstRetCount();
+
+  __atomic_fetch_add(&tlmPage->sequence, 1, __ATOMIC_ACQ_REL);
+  tlmPage->updateTime = now;
+  tlmPage->instRet = instRet;
+  if (now > tlmLastTime)
+    tlmPage->instPerSecond =
+        (instRet - tlmLastInstRet) * 1000000000 / (now - tlmLastTime);
+  tlmPage->pc = cpuGetRegister(CPU_REG_PC);
+  tlmPage->numHarts = svGetNumHarts();
+  tlmPage->memFootprint = memGetMappedSize();
+  uint32_t n = __atomic_load_n(&tlmNumSyscalls, __ATOMIC_ACQUIRE);
+  for (uint32_t i = 0; i < n; i++) {
+    tlmPage->syscalls[i].number = tlmSyscalls[i].number;
+    tlmPage->syscalls[i].count =
+        __atomic_load_n(&tlmSyscalls[i].count, __ATOMIC_RELAXED);
+  }
+  tlmPage->numSyscalls = n;
+  __atomic_fetch_add(&tlmPage->sequence, 1, __ATOMIC_RELEASE);
+
+  tlmLastTime = now;
+  tlmLastInstRet = instRet;
+}
+
+void tlmStop(void)
+{
+  if (!tlmPage)
+    return;
+  tlmUpdate();
+  __atomic_store_n(&tlmPage->state, TLM_STATE_EXITED, __ATOMIC_RELEASE);
+#ifndef _WIN32
+  munmap(tlmPage, sizeof(t_tlmPage));
+#endif
+  tlmPage = NULL;
+}
@@ -0,0 +1,61 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Telemetry page, published by the simulator in a file mapped in memory
+ * (for example in /dev/shm) and read by simtop. The simulator updates it
+ * every TLM_DEFAULT_INTERVAL instructions of hart zero, or at the interval
+ * given on the command line.
+ *
+ * The page is protected by a sequence counter: it is odd while an update is
+ * in progress, and readers must retry if it changed while they were
+ * reading. */
+
+#define TLM_MAGIC 0x4d4c5452 // "RTLM"
+#define TLM_VERSION 1
+#define TLM_MAX_SYSCALLS 32
+#define TLM_DEFAULT_INTERVAL 10000000
+
+enum {
+  TLM_STATE_RUNNING = 0,
+  TLM_STATE_EXITED = 1
+};
+
+typedef struct tlmSyscallCount {
+  uint32_t number;
+  uint32_t reserved;
+  uint64_t count;
+} t_tlmSyscallCount;
+
+typedef struct tlmPage {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t sequence;
+  uint32_t state;
+  int64_t pid;
+  // Nanoseconds of CLOCK_MONOTONIC
+  uint64_t startTime;
+  uint64_t updateTime;
+  // Instructions retired by hart zero and by the harts which exited
+  uint64_t instRet;
+  // Measured between the last two updates
+  uint64_t instPerSecond;
+  uint32_t pc;
+  uint32_t numHarts;
+  uint64_t memFootprint;
+  uint32_t numSyscalls;
+  uint32_t reserved;
+  t_tlmSyscallCount syscalls[TLM_MAX_SYSCALLS];
+} t_tlmPage;
+
+
+/* Used by the simulator */
+
+bool tlmStart(const char *path, uint64_t interval);
+uint64_t tlmGetInterval(void);
+void tlmUpdate(void);
+void tlmStop(void);
+
+#endif
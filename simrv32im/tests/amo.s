@@ -0,0 +1,78 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.align 2
+word:
+        .word 10
+.text
+_start: la s0,word
+        li t0,5
+        amoadd.w a0,t0,(s0)
+        li t1,10
+        bne a0,t1,fail
+        lw a0,0(s0)
+        li t1,15
+        bne a0,t1,fail
+        li t0,-3
+        amoswap.w a0,t0,(s0)
+        li t1,15
+        bne a0,t1,fail
+        # signed and unsigned minimum/maximum on -3
+        li t0,2
+        amomin.w a0,t0,(s0)
+        lw a0,0(s0)
+        li t1,-3
+        bne a0,t1,fail
+        amomaxu.w.aqrl a0,t0,(s0)
+        lw a0,0(s0)
+        li t1,-3
+        bne a0,t1,fail
+        amominu.w a0,t0,(s0)
+        lw a0,0(s0)
+        li t1,2
+        bne a0,t1,fail
+        li t0,-1
+        amomax.w a0,t0,(s0)
+        lw a0,0(s0)
+        li t1,2
+        bne a0,t1,fail
+        # logic operations
+        li t0,0xF0
+        amoor.w a0,t0,(s0)
+        li t0,0x3C
+        amoxor.w a0,t0,(s0)
+        li t0,0xFE
+        amoand.w a0,t0,(s0)
+        lw a0,0(s0)
+        li t1,0xCE
+        bne a0,t1,fail
+        # LR/SC succeeds with a reservation and fails without
+        lr.w a0,(s0)
+        addi a0,a0,1
+        sc.w t0,a0,(s0)
+        bnez t0,fail
+        lw a0,0(s0)
+        li t1,0xCF
+        bne a0,t1,fail
+        sc.w t0,a0,(s0)
+        beqz t0,fail
+        # the only hart is hart zero
+        csrr a0,mhartid
+        bnez a0,fail
+        j pass
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
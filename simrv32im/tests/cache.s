@@ -0,0 +1,37 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.align 2
+array:  .space 4096
+.text
+_start: # run while recording the reference trace for the cache model
+        li t0,4
+1:      la a0,array
+        li a1,1024
+2:      lw a2,0(a0)
+        addi a2,a2,1
+        sw a2,0(a0)
+        addi a0,a0,4
+        addi a1,a1,-1
+        bnez a1,2b
+        addi t0,t0,-1
+        bnez t0,1b
+        lw a2,-4(a0)
+        li t2,4
+        bne a2,t2,fail
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
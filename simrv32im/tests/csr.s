@@ -0,0 +1,45 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.text
+_start: rdinstret t0
+        nop
+        nop
+        rdinstret t1
+        sub t2, t1, t0
+        li t3, 3
+        bne t2, t3, fail
+        rdcycle t0
+        nop
+        rdcycle t1
+        sub t2, t1, t0
+        li t3, 2
+        bne t2, t3, fail
+        rdinstreth t1
+        bnez t1, fail
+        rdcycleh t1
+        bnez t1, fail
+        rdtime t0
+        rdtimeh t1
+        csrrsi t0, instret, 0
+        csrrci t1, instret, 0
+        blt t1, t0, fail
+        csrrs t0, cycle, x0
+        csrrc t1, cycle, x0
+        blt t1, t0, fail
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,55 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+file_name:
+        .ascii "file.txt\0";
+.text
+_start: # open must fail outside of a file system root
+        la a0,file_name
+        li a1,0
+        li a7,1024
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        # invalid file descriptors
+        li a0,3
+        li a7,57
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        li a0,20
+        la a1,pass_string
+        li a2,1
+        li a7,63
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        # unmapped buffer
+        li a0,1
+        li a1,0
+        li a2,4
+        li a7,64
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        # write to standard output
+        li a0,1
+        la a1,pass_string
+        li a2,6
+        li a7,64
+        ecall
+        li t0,6
+        bne a0,t0,fail
+        li a7,93
+        li a0,0
+        ecall
+fail:   li a0,1
+        la a1,fail_string
+        li a2,5
+        li a7,64
+        ecall
+        li a7,93
+        li a0,1
+        ecall
@@ -0,0 +1,74 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+inside_name:
+        .ascii "sub/inside.txt\0";
+outside_name:
+        .ascii "outside.txt\0";
+up_name:
+        .ascii "sub/up/fsroot.s\0";
+created_name:
+        .ascii "created.txt\0";
+.align 2
+buf:    .space 8
+.text
+_start: # run with the file system root prepared by the Makefile
+        # a file inside the root can be read
+        la a0,inside_name
+        li a1,0
+        li a7,1024
+        ecall
+        blt a0,zero,fail
+        addi s0,a0,0
+        la a1,buf
+        li a2,6
+        li a7,63
+        ecall
+        li t0,6
+        bne a0,t0,fail
+        la t1,buf
+        lb t0,0(t1)
+        li t2,105         # 'i'
+        bne t0,t2,fail
+        addi a0,s0,0
+        li a7,57
+        ecall
+        bnez a0,fail
+        # symbolic links which lead out of the root are not followed
+        la a0,outside_name
+        li a1,0
+        li a7,1024
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        la a0,up_name
+        li a1,0
+        li a7,1024
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        # not even to create a file
+        la a0,created_name
+        li a1,1
+        li a7,1024
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        li a0,1
+        la a1,pass_string
+        li a2,6
+        li a7,64
+        ecall
+        li a7,93
+        li a0,0
+        ecall
+fail:   li a0,1
+        la a1,fail_string
+        li a2,5
+        li a7,64
+        ecall
+        li a7,93
+        li a0,1
+        ecall
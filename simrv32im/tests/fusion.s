@@ -0,0 +1,81 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.align 2
+val:    .word 0x1234
+buf:    .word 0
+.text
+_start: # lui + addi, counted as two instructions
+        rdinstret t0
+        lui a0,0x12
+        addi a0,a0,0x345
+        rdinstret t1
+        sub t1,t1,t0
+        li t2,3
+        bne t1,t2,fail
+        li t2,0x12345
+        bne a0,t2,fail
+        # jumping into the second instruction of a pair executes it alone
+        li a0,5
+        j 1f
+        lui a0,0x12
+1:      addi a0,a0,1
+        li t2,6
+        bne a0,t2,fail
+        # auipc + addi/load/store
+        la a1,buf
+        lw a2,val
+        li t2,0x1234
+        bne a2,t2,fail
+        sw a2,buf,t3
+        lw a3,0(a1)
+        bne a3,a2,fail
+        # set + branch on zero, both operand orders
+        li a0,3
+        li a1,4
+        slt t4,a0,a1
+        beqz t4,fail
+        sltu t4,a1,a0
+        bnez t4,fail
+        slti t4,a0,3
+        bne zero,t4,fail
+        sltiu t4,a0,4
+        beq zero,t4,fail
+        # the branch target can also be the second instruction of a pair
+        li s2,0
+2:      addi s2,s2,1
+        slti t4,s2,10
+        bnez t4,2b
+        li t2,10
+        bne s2,t2,fail
+        # seqz / snez after sub
+        sub a2,a0,a0
+        sltiu a2,a2,1
+        li t2,1
+        bne a2,t2,fail
+        sub a2,a1,a0
+        sltiu a2,a2,1
+        bnez a2,fail
+        sub a2,a1,a0
+        sltu a2,zero,a2
+        li t2,1
+        bne a2,t2,fail
+        sub a2,a0,a0
+        sltu a2,zero,a2
+        bnez a2,fail
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
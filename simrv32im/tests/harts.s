@@ -0,0 +1,123 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.align 2
+counter:
+        .word 0
+lock:
+        .word 0
+shared:
+        .word 0
+llsc:
+        .word 0
+ids:
+        .space 16
+.text
+_start: # start three more harts, each one runs worker(hart number)
+        li s2,1
+1:      la a0,worker
+        addi a1,s2,0
+        li a7,2064
+        ecall
+        bne a0,s2,fail
+        addi s2,s2,1
+        li t0,4
+        blt s2,t0,1b
+        li a0,0
+        jal worker
+        # wait for the other harts
+        li s2,1
+2:      addi a0,s2,0
+        li a7,2066
+        ecall
+        bnez a0,fail
+        addi s2,s2,1
+        li t0,4
+        blt s2,t0,2b
+        # joining an unknown hart fails
+        li a0,9
+        li a7,2066
+        ecall
+        beqz a0,fail
+        # 4 harts times 1000 iterations
+        la t0,counter
+        lw t1,0(t0)
+        li t2,4000
+        bne t1,t2,fail
+        la t0,shared
+        lw t1,0(t0)
+        bne t1,t2,fail
+        la t0,llsc
+        lw t1,0(t0)
+        bne t1,t2,fail
+        # every hart saw its own mhartid
+        la t0,ids
+        li t1,0
+3:      slli t2,t1,2
+        add t2,t2,t0
+        lw t2,0(t2)
+        bne t2,t1,fail
+        addi t1,t1,1
+        li t2,4
+        blt t1,t2,3b
+        j pass
+
+worker: # a0 = hart number
+        csrr t0,mhartid
+        bne t0,a0,fail
+        la t1,ids
+        slli t2,t0,2
+        add t1,t1,t2
+        sw t0,0(t1)
+        # the stack is private to each hart
+        addi sp,sp,-16
+        sw ra,12(sp)
+        sw t0,8(sp)
+        la s3,counter
+        la s4,lock
+        la s5,shared
+        la s7,llsc
+        li s6,1000
+4:      li t0,1
+        amoadd.w zero,t0,(s3)
+        # increment with a LR/SC sequence
+7:      lr.w t0,(s7)
+        addi t0,t0,1
+        sc.w t1,t0,(s7)
+        bnez t1,7b
+        # increment a plain variable inside a spin lock
+        li t0,1
+5:      amoswap.w.aq t1,t0,(s4)
+        bnez t1,5b
+        lw t1,0(s5)
+        addi t1,t1,1
+        sw t1,0(s5)
+        amoswap.w.rl zero,zero,(s4)
+        addi s6,s6,-1
+        bnez s6,4b
+        lw t0,8(sp)
+        csrr t1,mhartid
+        bne t0,t1,fail
+        lw ra,12(sp)
+        addi sp,sp,16
+        beqz t0,6f
+        li a7,2065
+        ecall
+6:      jalr zero,0(ra)
+
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,50 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.text
+_start: # run with a 4 KiB stack: the heap must stop at a whole heap page
+        # below the stack guard page
+        li a0,0
+        li a7,214
+        ecall
+        addi s0,a0,0
+        li a0,0x7FFFE000
+        li a7,214
+        ecall
+        bne a0,s0,fail
+        li s1,0x7FFF0000
+        addi a0,s1,0
+        li a7,214
+        ecall
+        bne a0,s1,fail
+        li a0,1
+        li a7,9
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        # the whole last page of the heap is usable
+        li t0,0x12345678
+        sw t0,-4(s1)
+        lw t1,-4(s1)
+        bne t1,t0,fail
+        li t1,-0x10000
+        add t1,s1,t1
+        sw t0,0(t1)
+        lw t2,0(t1)
+        bne t2,t0,fail
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,81 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.align 2
+value:
+        .word 0x12345678
+data_end:
+.text
+_start: # data is accessible, with any alignment
+        la t0,value
+        lw t1,0(t0)
+        li t2,0x12345678
+        bne t1,t2,fail
+        lbu t1,3(t0)
+        li t2,0x12
+        bne t1,t2,fail
+        lhu t1,1(t0)
+        li t2,0x3456
+        bne t1,t2,fail
+        # the rest of the last page of data reads as zero and is writable
+        la t0,data_end
+        li t3,4095
+        or t3,t0,t3
+        addi t3,t3,-3
+        lw t1,0(t0)
+        bnez t1,fail
+        lw t1,0(t3)
+        bnez t1,fail
+        li t2,0x13579BDF
+        sw t2,0(t0)
+        lw t1,0(t0)
+        bne t1,t2,fail
+        sw t2,0(t3)
+        lw t1,0(t3)
+        bne t1,t2,fail
+        # the stack grows one page at a time, 64 KiB below its top
+        addi s0,sp,0
+        li t0,16
+        li t1,0x5A5A5A5A
+        li t3,4096
+1:      sub sp,sp,t3
+        sw t1,0(sp)
+        addi t0,t0,-1
+        bnez t0,1b
+        lw t2,0(sp)
+        bne t1,t2,fail
+        addi sp,s0,0
+        # heap pages are materialized on the first access
+        li a0,0x20000
+        li a7,9
+        ecall
+        li t1,0x1FFFE
+        add t1,a0,t1
+        lhu t2,0(t1)
+        bnez t2,fail
+        li t0,0x55AA
+        sh t0,0(t1)
+        lhu t2,0(t1)
+        bne t0,t2,fail
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      bnez s1,3f
+        # the page after the data faults
+        la t0,data_end
+        li t1,4095
+        or t0,t0,t1
+        lbu t1,1(t0)
+3:      li a7,93
+        addi a0,s1,0
+        ecall
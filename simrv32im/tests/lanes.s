@@ -0,0 +1,50 @@
+.data
+value:
+        .word 100
+.text
+_start: # each lane reads its own number
+        li a7,5
+        ecall
+        addi s0,a0,0
+        li t0,-1
+        beq s0,t0,negative
+        blt s0,t0,fault
+        # sum of the squares below n, pushing every partial sum
+        li t0,0
+        li t1,0
+1:      bge t0,s0,2f
+        mul t2,t0,t0
+        add t1,t1,t2
+        addi sp,sp,-4
+        sw t1,0(sp)
+        addi t0,t0,1
+        j 1b
+2:      slli t3,s0,2
+        add sp,sp,t3
+        addi a0,t1,0
+        jal print
+        # the data segment is private to each lane
+        la t4,value
+        lw t5,0(t4)
+        add t5,t5,t1
+        sw t5,0(t4)
+        lw a0,0(t4)
+        jal print
+        li a0,0
+        li a7,93
+        ecall
+negative:
+        li a0,-1
+        jal print
+        li a0,3
+        li a7,93
+        ecall
+fault:  li t0,0x10
+        lw a0,0(t0)
+        jal print
+print:  li a7,1
+        ecall
+        li a0,10
+        li a7,11
+        ecall
+        jalr zero,0(ra)
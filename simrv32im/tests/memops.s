@@ -0,0 +1,115 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.text
+_start: # grow the heap to two pages, s0 points 8 bytes before the boundary
+        li a0,0x20000
+        li a7,9
+        ecall
+        li t0,0xFFF8
+        add s0,a0,t0
+        # memset across the page boundary
+        addi a0,s0,0
+        li a1,0x1A5
+        li a2,16
+        li a7,2050
+        ecall
+        bne a0,s0,fail
+        lw t0,0(s0)
+        li t1,0xA5A5A5A5
+        bne t0,t1,fail
+        lw t0,12(s0)
+        bne t0,t1,fail
+        lw t0,16(s0)
+        bnez t0,fail
+        # write 0,1,2,...,15 with a plain loop
+        li t0,0
+1:      add t1,s0,t0
+        sb t0,0(t1)
+        addi t0,t0,1
+        li t1,16
+        blt t0,t1,1b
+        # memcpy to the stack
+        addi sp,sp,-32
+        addi a0,sp,0
+        addi a1,s0,0
+        li a2,16
+        li a7,2048
+        ecall
+        bne a0,sp,fail
+        lw t0,0(sp)
+        li t1,0x03020100
+        bne t0,t1,fail
+        lw t0,12(sp)
+        li t1,0x0F0E0D0C
+        bne t0,t1,fail
+        # memcmp equal, less and greater
+        addi a0,sp,0
+        addi a1,s0,0
+        li a2,16
+        li a7,2051
+        ecall
+        bnez a0,fail
+        li t0,0x7F
+        sb t0,15(sp)
+        addi a0,s0,0
+        addi a1,sp,0
+        li a2,16
+        li a7,2051
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        addi a0,sp,0
+        addi a1,s0,0
+        li a2,16
+        li a7,2051
+        ecall
+        li t0,1
+        bne a0,t0,fail
+        # only the first n bytes are compared
+        addi a0,sp,0
+        addi a1,s0,0
+        li a2,15
+        li a7,2051
+        ecall
+        bnez a0,fail
+        # overlapping memmove across the page boundary
+        addi a0,s0,4
+        addi a1,s0,0
+        li a2,12
+        li a7,2049
+        ecall
+        lw t0,4(s0)
+        li t1,0x03020100
+        bne t0,t1,fail
+        lw t0,12(s0)
+        li t1,0x0B0A0908
+        bne t0,t1,fail
+        addi a0,s0,0
+        addi a1,s0,4
+        li a2,12
+        li a7,2049
+        ecall
+        lw t0,0(s0)
+        li t1,0x03020100
+        bne t0,t1,fail
+        lw t0,8(s0)
+        li t1,0x0B0A0908
+        bne t0,t1,fail
+        addi sp,sp,32
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,42 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.align 2
+counter:
+        .word 0
+.text
+_start: # run with all the hooks of the icount plugin enabled
+        li t0,10
+        la a1,counter
+1:      lw t1,0(a1)
+        addi t1,t1,1
+        sw t1,0(a1)
+        li t2,2
+        amoadd.w zero,t2,(a1)
+        addi t0,t0,-1
+        bnez t0,1b
+        jal ra,func
+        lw t1,0(a1)
+        li t2,30
+        bne t1,t2,fail
+        li t2,42
+        bne a0,t2,fail
+        j pass
+func:   li a0,42
+        jalr zero,0(ra)
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
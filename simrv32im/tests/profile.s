@@ -0,0 +1,50 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.text
+_start: # run with the loop and call graph profiler enabled
+        li s2,0
+        li s3,3
+outer:  li s4,4
+inner:  addi a0,s4,0
+        jal ra,fact
+        add s2,s2,a0
+        addi s4,s4,-1
+        bnez s4,inner
+        addi s3,s3,-1
+        bnez s3,outer
+        li t0,99          # 3 * (24 + 6 + 2 + 1)
+        bne s2,t0,fail
+        j pass
+
+fact:   addi sp,sp,-8
+        sw ra,4(sp)
+        sw a0,0(sp)
+        li t0,1
+        ble a0,t0,1f
+        addi a0,a0,-1
+        jal ra,fact
+        lw t0,0(sp)
+        mul a0,a0,t0
+        j 2f
+1:      li a0,1
+2:      lw ra,4(sp)
+        addi sp,sp,8
+        jalr zero,0(ra)
+
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,50 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.align 2
+buf:    .space 64
+.text
+_start: # run with the statistics restricted to the region of interest
+        li t0,100         # not in the region of interest
+1:      addi t0,t0,-1
+        bnez t0,1b
+        li a7,2080        # SIM_CONTROL
+        li a0,0           # begin of the region of interest
+        ecall
+        bnez a0,fail
+        la t1,buf
+        li t0,16
+1:      lw t2,0(t1)
+        addi t2,t2,1
+        sw t2,0(t1)
+        addi t1,t1,4
+        addi t0,t0,-1
+        bnez t0,1b
+        li a7,2080
+        li a0,1           # end of the region of interest
+        ecall
+        bnez a0,fail
+        li a7,2080
+        li a0,3           # statistics dump
+        ecall
+        li a7,2080
+        li a0,42          # invalid command
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,111 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.align 2
+buf:
+        .space 16
+.text
+_start: # assembled with -c, most instructions below become 16-bit
+        li s0,0                 # c.li
+        li a0,31                # c.li
+        addi a0,a0,-1           # c.addi
+        li t0,30
+        bne a0,t0,fail
+        lui a1,0x1F             # c.lui
+        li t0,0x1F000
+        bne a1,t0,fail
+        lui a1,0xFFFE0          # c.lui, negative
+        li t0,0xFFFE0000
+        bne a1,t0,fail
+        addi a2,a0,0            # c.mv
+        add a2,a2,a0            # c.add
+        li t0,60
+        bne a2,t0,fail
+        slli a2,a2,2            # c.slli
+        li t0,240
+        bne a2,t0,fail
+        li a3,-16
+        srai a3,a3,2            # c.srai
+        li t0,-4
+        bne a3,t0,fail
+        srli a3,a3,28           # c.srli
+        li t0,15
+        bne a3,t0,fail
+        andi a3,a3,-6           # c.andi
+        li t0,10
+        bne a3,t0,fail
+        li a4,12
+        sub a4,a4,a3            # c.sub
+        li t0,2
+        bne a4,t0,fail
+        xor a4,a4,a3            # c.xor
+        li t0,8
+        bne a4,t0,fail
+        or a4,a3,a4             # c.or
+        bne a4,a3,fail
+        and a4,a4,a0            # c.and
+        li t0,10
+        bne a4,t0,fail
+        # stack pointer relative forms
+        addi sp,sp,-32          # c.addi16sp
+        addi a5,sp,16           # c.addi4spn
+        sw a3,16(sp)            # c.swsp
+        lw s1,0(a5)             # c.lw
+        bne s1,a3,fail
+        sw a0,4(a5)             # c.sw
+        lw s1,20(sp)            # c.lwsp
+        bne s1,a0,fail
+        addi sp,sp,32           # c.addi16sp
+        la a5,buf
+        sw a0,12(a5)            # c.sw
+        lw s1,12(a5)            # c.lw
+        bne s1,a0,fail
+        # compressed branches and jumps, both directions
+        li s1,3
+1:      addi s1,s1,-1
+        bnez s1,1b              # c.bnez
+        beqz s1,2f              # c.beqz
+        j fail
+2:      jal ra,func             # c.jal
+        li t0,42
+        bne a0,t0,fail
+        li a0,0
+        la t1,func
+        jalr ra,0(t1)           # c.jalr
+        li t0,42
+        bne a0,t0,fail
+        # 32-bit instructions at 2-byte aligned addresses
+        nop                     # c.nop
+        li a0,0x12345
+        li t0,0x12345
+        bne a0,t0,fail
+        # alignment is filled with c.nop when needed
+        nop
+        .align 3
+aligned:
+        la t0,aligned
+        andi t0,t0,7
+        bnez t0,fail
+        # jumps that do not fit are relaxed to 32-bit
+        j far
+        .space 2100
+far:
+        j pass
+func:   li a0,42
+        jalr zero,0(ra)         # c.jr
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,28 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.text
+_start: # run with sampled instruction statistics
+        li t0,10000
+        li t1,0
+1:      add t1,t1,t0
+        addi t0,t0,-1
+        bnez t0,1b
+        li t2,50005000
+        bne t1,t2,fail
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
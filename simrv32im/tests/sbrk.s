@@ -0,0 +1,71 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.text
+_start: # the heap starts empty, page aligned after the data segment
+        li a0,0
+        li a7,9
+        ecall
+        addi s0,a0,0
+        la t0,fail_string
+        bleu s0,t0,fail
+        li a0,0
+        li a7,214
+        ecall
+        bne a0,s0,fail
+        # grow the heap and touch both ends of it
+        li a0,0x20000
+        li a7,9
+        ecall
+        bne a0,s0,fail
+        li t0,0x12345678
+        sw t0,0(s0)
+        li t1,0x1FFFC
+        add t1,s0,t1
+        sw t0,0(t1)
+        lw t2,0(s0)
+        bne t2,t0,fail
+        lw t2,0(t1)
+        bne t2,t0,fail
+        # untouched pages read as zero
+        li t1,0x10000
+        add t1,s0,t1
+        lw t2,0(t1)
+        bnez t2,fail
+        # brk moves the break to an absolute address
+        li t1,0x30000
+        add a0,s0,t1
+        li a7,214
+        ecall
+        add t1,s0,t1
+        bne a0,t1,fail
+        # shrinking below the start of the heap is not allowed
+        li a0,-0x40000
+        li a7,9
+        ecall
+        li t0,-1
+        bne a0,t0,fail
+        li a0,-0x30000
+        li a7,9
+        ecall
+        bne a0,t1,fail
+        li a0,0
+        li a7,214
+        ecall
+        bne a0,s0,fail
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,44 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.text
+        .file 1 "sum.src"
+_start: # run with the profiler, checks the report of sum.src
+        .loc 1 2
+        li s2,0
+        li s3,10
+        .loc 1 3
+loop:   add s2,s2,s3
+        .loc 1 4
+        addi s3,s3,-1
+        .loc 1 3
+        bnez s3,loop
+        .loc 1 5
+        li t0,55
+        bne s2,t0,fail
+        .loc 1 6
+        j pass
+        .loc 1 7
+        li s2,0
+        .loc 1 8
+        li s3,0
+        .loc 1 10
+        li s4,0
+        .loc 1 0
+
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,60 @@
+.data
+pass_string:
+        .ascii "PASS!\n\0";
+fail_string:
+        .ascii "FAIL\n\0";
+.text
+_start: # recurse 4 MiB deep into the stack reserved with -S 8M
+        li a0,262144
+        jal ra,sum
+        li t0,262144
+        bne a0,t0,fail
+        # the heap cannot grow into the reserved stack
+        li a0,0
+        li a7,214
+        ecall
+        addi s0,a0,0
+        li a0,0x7F800000
+        li a7,214
+        ecall
+        bne a0,s0,fail
+        # and stops at the last whole heap page below the guard page
+        li a0,0x7F7FF000
+        li a7,214
+        ecall
+        bne a0,s0,fail
+        li a0,0x7F7F0000
+        li a7,214
+        ecall
+        li t0,0x7F7F0000
+        bne a0,t0,fail
+        j pass
+        # returns a0 after pushing a0 frames of 16 bytes
+sum:    beqz a0,3f
+        addi sp,sp,-16
+        sw ra,12(sp)
+        sw a0,8(sp)
+        addi a0,a0,-1
+        jal ra,sum
+        lw t0,8(sp)
+        sub t0,t0,a0
+        li t1,1
+        bne t0,t1,fail
+        addi a0,a0,1
+        lw ra,12(sp)
+        addi sp,sp,16
+3:      jalr zero,0(ra)
+pass:   la s0,pass_string
+        li s1,0
+        j 1f
+fail:   la s0,fail_string
+        li s1,1
+1:      lb a0,0(s0)
+        beqz a0,2f
+        li a7,11
+        ecall
+        addi s0,s0,1
+        j 1b
+2:      li a7,93
+        addi a0,s1,0
+        ecall
@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include "trace.h"
+#include "plugin.h"
+
+#define TRC_CHUNK_SIZE (1024 * 1024)
+// Longest encoding of a record: 32 bits of delta plus 2 bits of kind
+#define TRC_MAX_RECORD 5
+
+struct trcChunk {
+  struct trcChunk *next;
+  size_t used;
+  uint8_t data[TRC_CHUNK_SIZE];
+};
+
+// Each record is a LEB128 number holding the kind of the reference in the
+// two least significant bits, and the zigzag-encoded difference from the
+// previous address of the same kind in the others. Sequential fetches and
+// strided accesses thus take a single byte.
+t_trcChunk *trcFirst = NULL;
+t_trcChunk *trcLast = NULL;
+t_memAddress trcLastAddr[TRC_NUM_KINDS];
+uint64_t trcCount = 0;
+size_t trcSize = 0;
+bool trcComplete = true;
+pthread_mutex_t trcLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void trcAppend(t_trcKind kind, t_memAddress addr)
+{
+  pthread_mutex_lock(&trcLock);
+  if (!trcLast || trcLast->used > TRC_CHUNK_SIZE - TRC_MAX_RECORD) {
+    t_trcChunk *chunk = malloc(sizeof(t_trcChunk));
+    if (!chunk) {
+      trcComplete = false;
+      pthread_mutex_unlock(&trcLock);
+      return;
+    }
+    chunk->next = NULL;
+    chunk->used = 0;
+    if (trcLast)
+      trcLast->next = chunk;
+    else
+      trcFirst = chunk;
+    trcLast = chunk;
+  }
+
+  uint32_t delta = addr - trcLastAddr[kind];
+  trcLastAddr[kind] = addr;
+  uint32_t zigzag = (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+  uint64_t value = ((uint64_t)zigzag << 2) | (uint64_t)kind;
+  uint8_t *p = trcLast->data + trcLast->used;
+  uint8_t *start = p;
+  while (value >= 0x80) {
+    *p++ = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  *p++ = (uint8_t)value;
+  trcLast->used += (size_t)(p - start);
+  trcSize += (size_t)(p - start);
+  trcCount++;
+  pthread_mutex_unlock(&trcLock);
+}
+
+static void trcInstRetired(
+    void *data, uint32_t hart, uint32_t pc, uint32_t inst)
+{
+  trcAppend(TRC_FETCH, pc);
+}
+
+static void trcMemAccess(void *data, uint32_t hart, uint32_t pc,
+    uint32_t addr, uint32_t size, int flags)
+{
+  if (flags & PLG_MEM_READ)
+    trcAppend(TRC_READ, addr);
+  if (flags & PLG_MEM_WRITE)
+    trcAppend(TRC_WRITE, addr);
+}
+
+bool trcStart(void)
+{
+  t_plgHooks hooks = {0};
+  hooks.instRetired = trcInstRetired;
+  hooks.memAccess = trcMemAccess;
+  return plgRegister(&hooks) == PLG_NO_ERROR;
+}
+
+
+uint64_t trcGetCount(void)
+{
+  return trcCount;
+}
+
+size_t trcGetSize(void)
+{
+  return trcSize;
+}
+
+bool trcIsComplete(void)
+{
+  return trcComplete;
+}
+
+
+void trcRewind(t_trcCursor *cursor)
+{
+  cursor->chunk = trcFirst;
+  cursor->offset = 0;
+  for (int i = 0; i < TRC_NUM_KINDS; i++)
+    cursor->last[i] = 0;
+}
+
+bool trcNext(t_trcCursor *cursor, t_trcKind *outKind, t_memAddress *outAddr)
+{
+  const t_trcChunk *chunk = cursor->chunk;
+  if (chunk && cursor->offset == chunk->used) {
+    chunk = cursor->chunk = chunk->next;
+    cursor->offset = 0;
+  }
+  if (!chunk)
+    return false;
+
+  const uint8_t *p = chunk->data + cursor->offset;
+  uint64_t value = 0;
+  int shift = 0;
+  do {
+    value |= (uint64_t)(*p & 0x7F) << shift;
+    shift += 7;
+  } while (*p++ & 0x80);
+  cursor->offset = (size_t)(p - chunk->data);
+
+  t_trcKind kind = (t_trcKind)(value & 3);
+  uint32_t zigzag = (uint32_t)(value >> 2);
+  uint32_t delta = (zigzag >> 1) ^ (uint32_t)-(int32_t)(zigzag & 1);
+  cursor->last[kind] += delta;
+  *outKind = kind;
+  *outAddr = cursor->last[kind];
+  return true;
+}
@@ -0,0 +1,37 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "memory.h"
+
+/* Memory reference trace of the simulated program, recorded in memory in a
+ * compact delta-encoded form and replayed by the analysis tools. */
+
+typedef int t_trcKind;
+enum {
+  TRC_FETCH = 0,
+  TRC_READ = 1,
+  TRC_WRITE = 2,
+  TRC_NUM_KINDS
+};
+
+typedef struct trcChunk t_trcChunk;
+
+/* Position inside the trace. A cursor must be initialized by trcRewind(),
+ * and independent cursors can be used concurrently. */
+typedef struct trcCursor {
+  const t_trcChunk *chunk;
+  size_t offset;
+  t_memAddress last[TRC_NUM_KINDS];
+} t_trcCursor;
+
+bool trcStart(void);
+uint64_t trcGetCount(void);
+size_t trcGetSize(void);
+bool trcIsComplete(void);
+
+void trcRewind(t_trcCursor *cursor);
+bool trcNext(t_trcCursor *cursor, t_trcKind *outKind, t_memAddress *outAddr);
+
+#endif